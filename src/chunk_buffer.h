@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Fixed-size output buffer that hands out full chunks to a sink
+ *
+ * Used to stream responses whose size is not known up front (JSON documents,
+ * log query results) without first building them in a String: the memory
+ * held per response is N bytes, whatever the response size.
+ */
+template <size_t N>
+class ChunkBuffer {
+public:
+  /** @brief Receives each chunk; @p len is never 0 */
+  typedef void (*Sink)(void* ctx, const char* data, size_t len);
+
+  ChunkBuffer(Sink sink, void* ctx) : sink_(sink), ctx_(ctx) {}
+
+  size_t write(const uint8_t* data, size_t len) {
+    size_t left = len;
+    while (left > 0) {
+      size_t n = N - len_;
+      if (n > left) n = left;
+      memcpy(buf_ + len_, data, n);
+      len_ += n;
+      data += n;
+      left -= n;
+      if (len_ == N) flush();
+    }
+    total_ += len;
+    return len;
+  }
+
+  size_t write(uint8_t c) { return write(&c, 1); }
+
+  /** @brief Hand out whatever is buffered */
+  void flush() {
+    if (len_ == 0) return;
+    sink_(ctx_, buf_, len_);
+    len_ = 0;
+    chunks_++;
+  }
+
+  /** @brief Bytes written so far */
+  size_t total() const { return total_; }
+
+  /** @brief Chunks handed to the sink so far */
+  size_t chunks() const { return chunks_; }
+
+private:
+  Sink sink_;
+  void* ctx_;
+  size_t len_ = 0;
+  size_t total_ = 0;
+  size_t chunks_ = 0;
+  char buf_[N];
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Arduino.h>
+#include "chunk_buffer.h"
+#include "instrumented_web_server.h"
+
+// Chunk size for streamed responses; one chunk fits in a single TCP segment
+#define RESPONSE_CHUNK_SIZE 1024
+
+/**
+ * @brief Print target that sends everything written to it as chunked
+ *        transfer encoding through a fixed buffer
+ *
+ * Call begin() to send the status line and headers, write the body through
+ * the Print interface, then end() to flush and send the terminating chunk.
+ */
+class ChunkedResponse : public Print {
+public:
+  explicit ChunkedResponse(InstrumentedWebServer& server) : server_(server), buffer_(sendChunk, &server) {}
+
+  void begin(int code, const char* contentType) {
+    server_.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server_.send(code, contentType, "");
+  }
+
+  size_t write(uint8_t c) override { return buffer_.write(c); }
+  size_t write(const uint8_t* data, size_t len) override { return buffer_.write(data, len); }
+
+  void end() {
+    buffer_.flush();
+    server_.sendContent("");
+  }
+
+  size_t bytesSent() const { return buffer_.total(); }
+
+private:
+  static void sendChunk(void* ctx, const char* data, size_t len) {
+    static_cast<InstrumentedWebServer*>(ctx)->sendContent(data, len);
+  }
+
+  InstrumentedWebServer& server_;
+  ChunkBuffer<RESPONSE_CHUNK_SIZE> buffer_;
+};
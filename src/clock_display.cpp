@@ -1,6 +1,7 @@
 #include "clock_display.h"
 #include "led_controller.h"
 #include "led_state.h"
+#include "light_fader.h"
 #include "setup_state.h"
 #include "night_mode.h"
 #include "time_sync.h"
@@ -75,7 +76,8 @@ bool ClockDisplay::update() {
 // ============================================================================
 
 bool ClockDisplay::checkClockEnabled() {
-    if (!clockEnabled) {
+    // Keep rendering while a transition fades the clock out
+    if (!clockEnabled && !lightFader.active()) {
         animation_.active = false;
         showLeds({});
         resetNoTimeIndicator();
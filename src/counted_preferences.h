@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Preferences.h>
+#include "perf_stats.h"
+
+/**
+ * @brief Preferences that count every key written for the NVS writes sensor
+ *
+ * Each put is its own flash write, so counting happens here rather than in
+ * totals kept next to each flush. Only the put calls the firmware uses are
+ * wrapped; use this class wherever settings are written.
+ */
+class CountedPreferences : public Preferences {
+public:
+  size_t putUChar(const char* key, uint8_t value) { return counted(Preferences::putUChar(key, value)); }
+  size_t putUShort(const char* key, uint16_t value) { return counted(Preferences::putUShort(key, value)); }
+  size_t putUInt(const char* key, uint32_t value) { return counted(Preferences::putUInt(key, value)); }
+  size_t putULong(const char* key, uint32_t value) { return counted(Preferences::putULong(key, value)); }
+  size_t putBool(const char* key, bool value) { return counted(Preferences::putBool(key, value)); }
+  size_t putString(const char* key, const String& value) { return counted(Preferences::putString(key, value)); }
+
+private:
+  // Every call counts: an empty string reports 0 bytes but is still written
+  static size_t counted(size_t written) {
+    perfStats().addNvsWrites(1);
+    return written;
+  }
+};
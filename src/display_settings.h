@@ -1,8 +1,9 @@
 #pragma once
-#include <Preferences.h>
+#include "counted_preferences.h"
 
 #include "grid_layout.h"
 #include "log.h"
+#include "state_dirty.h"
 
 constexpr GridVariant FIRMWARE_DEFAULT_GRID_VARIANT = GridVariant::NL_V4;
 enum class WordAnimationMode : uint8_t { Classic = 0 };
@@ -78,6 +79,7 @@ public:
     if (hetIsDurationSec_ == s) return;
     hetIsDurationSec_ = s;
     markDirty();
+    stateMarkDirty(DIRTY_HETIS);
   }
 
   void setSellMode(bool on) {
@@ -90,6 +92,7 @@ public:
     if (animateWords_ == on) return;
     animateWords_ = on;
     markDirty();
+    stateMarkDirty(DIRTY_ANIMATE);
   }
 
   void setAnimationMode(WordAnimationMode mode) {
@@ -106,6 +109,7 @@ public:
     if (autoUpdate_ == on) return;
     autoUpdate_ = on;
     markDirty();
+    stateMarkDirty(DIRTY_AUTO_UPDATE);
   }
 
   void setUpdateChannel(const String& channel) {
@@ -115,10 +119,12 @@ public:
     if (ch == updateChannel_) return;
     updateChannel_ = ch;
     markDirty();
+    stateMarkDirty(DIRTY_UPDATE_CHANNEL);
     logInfo(String("🔀 Update channel set to ") + updateChannel_);
     if (updateChannel_ == "develop" && autoUpdate_) {
       autoUpdate_ = false;
       markDirty();
+      stateMarkDirty(DIRTY_AUTO_UPDATE);
       logInfo("🔁 Automatic updates disabled for develop channel");
     }
   }
@@ -205,7 +211,7 @@ private:
   bool dirty_ = false;
   unsigned long lastFlush_ = 0;
   
-  Preferences prefs_;
+  CountedPreferences prefs_;
   
   static const unsigned long AUTO_FLUSH_DELAY_MS = 5000;  // 5 seconds
 };
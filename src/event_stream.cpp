@@ -0,0 +1,101 @@
+#include "event_stream.h"
+
+bool EventStream::attach(WiFiClient client) {
+  int slot = -1;
+  for (uint8_t i = 0; i < MAX_CLIENTS; ++i) {
+    if (!clients_[i] || !clients_[i].connected()) {
+      clients_[i].stop();
+      slot = i;
+      break;
+    }
+  }
+  if (slot < 0) {
+    client.print("HTTP/1.1 503 Service Unavailable\r\nContent-Type: text/plain\r\n"
+                 "Connection: close\r\nContent-Length: 18\r\n\r\nToo many listeners");
+    client.stop();
+    return false;
+  }
+  client.print("HTTP/1.1 200 OK\r\n"
+               "Content-Type: text/event-stream\r\n"
+               "Cache-Control: no-cache\r\n"
+               "Connection: keep-alive\r\n"
+               "Access-Control-Allow-Origin: *\r\n\r\n"
+               "retry: 5000\n\n");
+  clients_[slot] = client;
+  lastSlot_ = (uint8_t)slot;
+  return true;
+}
+
+// Note: nothing in here may call the logger; log streaming is one of our callers.
+bool EventStream::writeEvent(WiFiClient& client, const char* event, const String& data, uint32_t id) {
+  char head[48];
+  int n = 0;
+  if (id != 0) {
+    n += snprintf(head + n, sizeof(head) - n, "id: %lu\n", (unsigned long)id);
+  }
+  if (event && *event) {
+    n += snprintf(head + n, sizeof(head) - n, "event: %s\n", event);
+  }
+  if (n > 0 && client.write((const uint8_t*)head, (size_t)n) == 0) return false;
+
+  const char* p = data.c_str();
+  size_t len = data.length();
+  // Trailing newlines belong to the log line format, not to the event
+  while (len > 0 && (p[len - 1] == '\n' || p[len - 1] == '\r')) len--;
+  size_t start = 0;
+  do {
+    size_t end = start;
+    while (end < len && p[end] != '\n') end++;
+    size_t lineLen = end - start;
+    if (lineLen > 0 && p[end - 1] == '\r') lineLen--;
+    if (client.write((const uint8_t*)"data: ", 6) == 0) return false;
+    if (lineLen > 0 && client.write((const uint8_t*)(p + start), lineLen) == 0) return false;
+    if (client.write((const uint8_t*)"\n", 1) == 0) return false;
+    start = end + 1;
+  } while (start < len);
+  return client.write((const uint8_t*)"\n", 1) == 1;
+}
+
+void EventStream::sendTo(uint8_t slot, const char* event, const String& data, uint32_t id) {
+  if (slot >= MAX_CLIENTS) return;
+  WiFiClient& c = clients_[slot];
+  if (!c || !c.connected()) return;
+  if (!writeEvent(c, event, data, id)) {
+    c.stop();
+  }
+}
+
+void EventStream::broadcast(const char* event, const String& data, uint32_t id) {
+  for (uint8_t i = 0; i < MAX_CLIENTS; ++i) {
+    sendTo(i, event, data, id);
+  }
+}
+
+void EventStream::loop() {
+  unsigned long now = millis();
+  bool keepAlive = (now - lastKeepAliveMs_) >= KEEPALIVE_INTERVAL_MS;
+  if (keepAlive) lastKeepAliveMs_ = now;
+  for (uint8_t i = 0; i < MAX_CLIENTS; ++i) {
+    WiFiClient& c = clients_[i];
+    if (!c) continue;
+    if (!c.connected()) {
+      c.stop();
+      continue;
+    }
+    // Discard anything the browser sends on an event stream
+    while (c.available()) c.read();
+    if (keepAlive && c.write((const uint8_t*)":\n\n", 3) == 0) {
+      c.stop();
+    }
+  }
+}
+
+uint8_t EventStream::clientCount() const {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < MAX_CLIENTS; ++i) {
+    // connected() is non-const on WiFiClient
+    WiFiClient& c = const_cast<WiFiClient&>(clients_[i]);
+    if (c && c.connected()) n++;
+  }
+  return n;
+}
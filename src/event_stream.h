@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+/**
+ * @brief Server-sent events (text/event-stream) fan-out for the web server
+ *
+ * The synchronous WebServer can only answer one request at a time, so live
+ * updates are pushed over connections that are detached from the server:
+ * a route handler hands its client to attach(), after which events are
+ * written straight to the socket from the main loop. The number of open
+ * streams is capped to keep socket and heap usage bounded.
+ */
+class EventStream {
+public:
+  static const uint8_t MAX_CLIENTS = 3;
+
+  /**
+   * @brief Take over a client connection and send the SSE response header
+   * @return false when all slots are in use (a 503 has been sent)
+   */
+  bool attach(WiFiClient client);
+
+  /**
+   * @brief Send one event to a single attached client (used for backlog replay)
+   */
+  void sendTo(uint8_t slot, const char* event, const String& data, uint32_t id);
+
+  /**
+   * @brief Send one event to every attached client
+   * @param event Event name, or nullptr for the default "message" event
+   * @param data Payload; embedded newlines are split into multiple data lines
+   * @param id Event id (0 = omit); browsers resend it as Last-Event-ID
+   */
+  void broadcast(const char* event, const String& data, uint32_t id = 0);
+
+  /**
+   * @brief Drop closed connections and send keep-alive comments
+   * @note Call from the main loop
+   */
+  void loop();
+
+  uint8_t clientCount() const;
+  bool hasClients() const { return clientCount() > 0; }
+
+  /** @brief Slot index of the most recently attached client */
+  uint8_t lastAttachedSlot() const { return lastSlot_; }
+
+private:
+  bool writeEvent(WiFiClient& client, const char* event, const String& data, uint32_t id);
+
+  WiFiClient clients_[MAX_CLIENTS];
+  uint8_t lastSlot_ = 0;
+  unsigned long lastKeepAliveMs_ = 0;
+
+  static const unsigned long KEEPALIVE_INTERVAL_MS = 15000;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Bump allocator over a caller-owned buffer, for short-lived parses that
+// must not touch the heap. ArduinoJson 7 has no StaticJsonDocument; a
+// JsonDocument given an allocator backed by this arena is its replacement.
+//
+// Space is reclaimed only from the end: deallocate() and a growing
+// reallocate() work in place for the most recent block, which is how a
+// JsonDocument fills its pools and strings. Everything else is released
+// when the arena goes out of scope or reset() is called.
+
+class FixedArena {
+public:
+  static const size_t ALIGN = 8;
+
+  /** @param buffer Aligned to ALIGN (declare it alignas(FixedArena::ALIGN)) */
+  FixedArena(void* buffer, size_t size)
+      : buffer_(static_cast<uint8_t*>(buffer)), size_(size) {}
+
+  /** @return nullptr when the buffer is exhausted */
+  void* allocate(size_t size) {
+    size_t start = top_ + HEADER;
+    size_t end = start + roundUp(size);
+    if (end > size_ || end < start) return nullptr;
+    Header* h = header(start);
+    h->size = (uint32_t)size;
+    h->prev = (uint32_t)last_;
+    last_ = start;
+    top_ = end;
+    if (top_ > highWater_) highWater_ = top_;
+    return buffer_ + start;
+  }
+
+  void deallocate(void* p) {
+    if (!p || offsetOf(p) != last_) return;
+    top_ = last_ - HEADER;
+    last_ = header(last_)->prev;
+  }
+
+  void* reallocate(void* p, size_t size) {
+    if (!p) return allocate(size);
+    size_t offset = offsetOf(p);
+    Header* h = header(offset);
+    if (offset == last_) {
+      size_t end = offset + roundUp(size);
+      if (end > size_) return nullptr;
+      h->size = (uint32_t)size;
+      top_ = end;
+      if (top_ > highWater_) highWater_ = top_;
+      return p;
+    }
+    if (size <= h->size) return p;  // Shrink in place; the tail stays unused
+    void* moved = allocate(size);
+    if (moved) memcpy(moved, p, h->size);
+    return moved;
+  }
+
+  void reset() {
+    top_ = 0;
+    last_ = 0;
+  }
+
+  size_t used() const { return top_; }
+  size_t highWater() const { return highWater_; }
+
+private:
+  struct Header {
+    uint32_t size;
+    uint32_t prev;  // Offset of the block before this one (0: none)
+  };
+  static const size_t HEADER = (sizeof(Header) + ALIGN - 1) / ALIGN * ALIGN;
+
+  static size_t roundUp(size_t n) { return (n + ALIGN - 1) / ALIGN * ALIGN; }
+  size_t offsetOf(const void* p) const { return static_cast<const uint8_t*>(p) - buffer_; }
+  Header* header(size_t offset) { return reinterpret_cast<Header*>(buffer_ + offset - HEADER); }
+
+  uint8_t* buffer_;
+  size_t size_;
+  size_t top_ = 0;
+  size_t last_ = 0;      // Offset of the most recent block (0: none)
+  size_t highWater_ = 0;
+};
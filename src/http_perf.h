@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-route counters for the web server: calls, handler time and bytes sent.
+// Everything lives in a fixed table sized at compile time; routes registered
+// beyond HTTP_PERF_MAX_ROUTES are simply not measured.
+
+#define HTTP_PERF_MAX_ROUTES 80
+
+/**
+ * @brief Counters for one registered route
+ */
+struct HttpRouteStats {
+  const char* path;     // Registered path (string literal)
+  uint8_t method;       // HTTPMethod
+  uint32_t calls;
+  uint32_t maxUs;       // Slowest single call
+  uint64_t totalUs;     // Cumulative handler time
+  uint32_t bytes;       // Response body bytes sent from the handler
+};
+
+/**
+ * @brief Fixed-size route statistics table
+ */
+class HttpPerf {
+public:
+  /**
+   * @brief Register a route
+   * @return Slot for begin(), or -1 when the table is full
+   */
+  int add(const char* path, uint8_t method) {
+    if (count_ >= HTTP_PERF_MAX_ROUTES) return -1;
+    HttpRouteStats& s = routes_[count_];
+    s = HttpRouteStats();
+    s.path = path;
+    s.method = method;
+    return count_++;
+  }
+
+  /** @brief A handler for @p slot starts running */
+  void begin(int slot, uint32_t nowUs) {
+    active_ = (slot >= 0 && slot < count_) ? slot : -1;
+    startUs_ = nowUs;
+  }
+
+  /**
+   * @brief The running handler returned
+   * @param countCall false for work that belongs to a call already counted (upload chunks)
+   */
+  void end(uint32_t nowUs, bool countCall = true) {
+    if (active_ < 0) return;
+    HttpRouteStats& s = routes_[active_];
+    uint32_t elapsed = nowUs - startUs_;
+    if (countCall) s.calls++;
+    s.totalUs += elapsed;
+    if (elapsed > s.maxUs) s.maxUs = elapsed;
+    active_ = -1;
+  }
+
+  /** @brief Attribute response bytes to the running handler (ignored outside handlers) */
+  void addBytes(size_t n) {
+    if (active_ >= 0) routes_[active_].bytes += (uint32_t)n;
+  }
+
+  /** @brief Clear all counters, keeping the registered routes */
+  void reset() {
+    for (int i = 0; i < count_; ++i) {
+      routes_[i].calls = 0;
+      routes_[i].maxUs = 0;
+      routes_[i].totalUs = 0;
+      routes_[i].bytes = 0;
+    }
+  }
+
+  int count() const { return count_; }
+  const HttpRouteStats& at(int slot) const { return routes_[slot]; }
+
+private:
+  HttpRouteStats routes_[HTTP_PERF_MAX_ROUTES];
+  int count_ = 0;
+  int active_ = -1;
+  uint32_t startUs_ = 0;
+};
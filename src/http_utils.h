@@ -0,0 +1,141 @@
+#pragma once
+
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// Small header parsing helpers for the web server. They work on plain C
+// strings so they can be tested natively, without WebServer.
+
+/**
+ * @brief Check whether an Accept-Encoding header allows a gzip response
+ * @note Honours "q=0" (explicitly refused) and the "*" wildcard
+ */
+inline bool httpAcceptsGzip(const char* header) {
+  if (!header) return false;
+  int gzipQ = -1;   // q-value in thousandths; -1 = not mentioned
+  int starQ = -1;
+  const char* p = header;
+  while (*p) {
+    while (*p == ' ' || *p == '\t' || *p == ',') p++;
+    const char* name = p;
+    while (*p && *p != ',' && *p != ';' && *p != ' ' && *p != '\t') p++;
+    size_t nameLen = (size_t)(p - name);
+    int q = 1000;
+    // Parameters up to the next coding
+    while (*p && *p != ',') {
+      if (*p == ';') {
+        p++;
+        while (*p == ' ' || *p == '\t') p++;
+        if ((p[0] == 'q' || p[0] == 'Q') && p[1] == '=') {
+          double v = strtod(p + 2, nullptr);
+          q = (v <= 0) ? 0 : (v >= 1 ? 1000 : (int)(v * 1000 + 0.5));
+        }
+      } else {
+        p++;
+      }
+    }
+    if ((nameLen == 4 && strncasecmp(name, "gzip", 4) == 0) ||
+        (nameLen == 6 && strncasecmp(name, "x-gzip", 6) == 0)) {
+      gzipQ = q;
+    } else if (nameLen == 1 && name[0] == '*') {
+      starQ = q;
+    }
+  }
+  if (gzipQ >= 0) return gzipQ > 0;
+  return starQ > 0;
+}
+
+/**
+ * @brief Format a strong ETag from a content CRC and length
+ * @param encoded true for the gzip representation, which gets its own tag
+ */
+inline void httpFormatEtag(char* out, size_t len, uint32_t crc, uint32_t size, bool encoded) {
+  snprintf(out, len, "\"%08lx-%lx%s\"", (unsigned long)crc, (unsigned long)size, encoded ? "-gz" : "");
+}
+
+/**
+ * @brief Check an If-None-Match header against the current ETag
+ * @note Uses the weak comparison RFC 9110 prescribes for If-None-Match
+ */
+inline bool httpEtagMatches(const char* header, const char* etag) {
+  if (!header || !etag) return false;
+  if (etag[0] == 'W' && etag[1] == '/') etag += 2;
+  size_t etagLen = strlen(etag);
+  const char* p = header;
+  while (*p) {
+    while (*p == ' ' || *p == '\t' || *p == ',') p++;
+    if (!*p) break;
+    if (*p == '*') return true;
+    if (p[0] == 'W' && p[1] == '/') p += 2;
+    const char* tag = p;
+    if (*p == '"') {
+      const char* close = strchr(p + 1, '"');
+      p = close ? close + 1 : p + strlen(p);
+    } else {
+      while (*p && *p != ',' && *p != ' ' && *p != '\t') p++;
+    }
+    if ((size_t)(p - tag) == etagLen && strncmp(tag, etag, etagLen) == 0) return true;
+  }
+  return false;
+}
+
+enum class HttpRange : uint8_t {
+  Full,           // No usable Range header: send the whole representation (200)
+  Partial,        // Send [first, last] (206)
+  Unsatisfiable,  // Range lies outside the content (416)
+};
+
+/**
+ * @brief Parse a single-range "bytes=" Range header against a content size
+ * @param[out] first,last Inclusive byte positions when Partial is returned
+ * @note Multiple ranges and unknown units fall back to Full, as RFC 9110 allows
+ */
+inline HttpRange httpParseRange(const char* header, uint32_t size, uint32_t& first, uint32_t& last) {
+  if (!header) return HttpRange::Full;
+  while (*header == ' ' || *header == '\t') header++;
+  if (strncasecmp(header, "bytes=", 6) != 0) return HttpRange::Full;
+  const char* p = header + 6;
+  while (*p == ' ' || *p == '\t') p++;
+  if (strchr(p, ',')) return HttpRange::Full;
+
+  bool hasFirst = isdigit((unsigned char)*p);
+  char* endp;
+  unsigned long long a = hasFirst ? strtoull(p, &endp, 10) : 0;
+  if (hasFirst) p = endp;
+  while (*p == ' ' || *p == '\t') p++;
+  if (*p != '-') return HttpRange::Full;
+  p++;
+  while (*p == ' ' || *p == '\t') p++;
+  bool hasLast = isdigit((unsigned char)*p);
+  unsigned long long b = hasLast ? strtoull(p, &endp, 10) : 0;
+  if (hasLast) p = endp;
+  while (*p == ' ' || *p == '\t') p++;
+  if (*p || (!hasFirst && !hasLast)) return HttpRange::Full;
+
+  if (!hasFirst) {
+    // Suffix range: the last b bytes
+    if (b == 0 || size == 0) return HttpRange::Unsatisfiable;
+    first = b >= size ? 0 : (uint32_t)(size - b);
+    last = size - 1;
+    return HttpRange::Partial;
+  }
+  if (hasLast && b < a) return HttpRange::Full;  // Syntactically invalid: ignore
+  if (a >= size) return HttpRange::Unsatisfiable;
+  first = (uint32_t)a;
+  last = (!hasLast || b >= size) ? size - 1 : (uint32_t)b;
+  return HttpRange::Partial;
+}
+
+/** @brief Format a Content-Range value; @p size only for an unsatisfiable range */
+inline void httpFormatContentRange(char* out, size_t len, HttpRange range, uint32_t first, uint32_t last, uint32_t size) {
+  if (range == HttpRange::Partial) {
+    snprintf(out, len, "bytes %lu-%lu/%lu", (unsigned long)first, (unsigned long)last, (unsigned long)size);
+  } else {
+    snprintf(out, len, "bytes */%lu", (unsigned long)size);
+  }
+}
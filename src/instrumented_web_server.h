@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WebServer.h>
+#include "http_perf.h"
+
+/**
+ * @brief WebServer that measures every route it serves
+ *
+ * Owns the per-route statistics. Table routes are timed by WebRouter; routes
+ * registered with on() are wrapped here. The send functions used by our
+ * handlers add the body bytes to the route that is running. Statistics are
+ * served at /api/perf/http.
+ */
+class InstrumentedWebServer : public WebServer {
+public:
+  explicit InstrumentedWebServer(int port) : WebServer(port) {}
+
+  void on(const char* uri, THandlerFunction fn) {
+    on(uri, HTTP_ANY, fn);
+  }
+
+  void on(const char* uri, HTTPMethod method, THandlerFunction fn) {
+    int slot = perf_.add(uri, method);
+    WebServer::on(uri, method, timed(slot, fn, true));
+  }
+
+  void on(const char* uri, HTTPMethod method, THandlerFunction fn, THandlerFunction upload) {
+    int slot = perf_.add(uri, method);
+    WebServer::on(uri, method, timed(slot, fn, true), timed(slot, upload, false));
+  }
+
+  void send(int code, const char* contentType = nullptr, const String& content = String("")) {
+    perf_.addBytes(content.length());
+    WebServer::send(code, contentType, content);
+  }
+
+  void send(int code, const String& contentType, const String& content) {
+    perf_.addBytes(content.length());
+    WebServer::send(code, contentType, content);
+  }
+
+  void send_P(int code, const char* contentType, const char* content, size_t contentLength) {
+    perf_.addBytes(contentLength);
+    WebServer::send_P(code, contentType, content, contentLength);
+  }
+
+  void sendContent(const String& content) {
+    perf_.addBytes(content.length());
+    WebServer::sendContent(content);
+  }
+
+  void sendContent(const char* content, size_t size) {
+    perf_.addBytes(size);
+    WebServer::sendContent(content, size);
+  }
+
+  template <typename T>
+  size_t streamFile(T& file, const String& contentType, const int code = 200) {
+    size_t sent = WebServer::streamFile(file, contentType, code);
+    perf_.addBytes(sent);
+    return sent;
+  }
+
+  HttpPerf& perf() { return perf_; }
+
+private:
+  THandlerFunction timed(int slot, THandlerFunction fn, bool countCall) {
+    return [this, slot, fn, countCall]() {
+      perf_.begin(slot, micros());
+      fn();
+      perf_.end(micros(), countCall);
+    };
+  }
+
+  HttpPerf perf_;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "chunked_response.h"
+#include "instrumented_web_server.h"
+
+/**
+ * @brief Serialize a JSON document straight into a chunked response
+ * @note Peak memory is the document plus one chunk, however large the output
+ */
+inline void sendJson(InstrumentedWebServer& server, const JsonDocument& doc, int code = 200) {
+  ChunkedResponse response(server);
+  response.begin(code, "application/json");
+  serializeJson(doc, response);
+  response.end();
+}
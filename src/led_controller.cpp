@@ -3,6 +3,8 @@
 #include "grid_layout.h"
 #include "led_state.h"
 #include "night_mode.h"
+#include "light_fader.h"
+#include "perf_stats.h"
 
 #include <vector>
 
@@ -26,10 +28,31 @@ static void ensureStripLength() {
     strip.show();
   }
 }
-#else
-static std::vector<uint16_t> lastShown;
+
+// Push a frame out, timing strip.show() for the diagnostics sensors
+static void showFrame() {
+  uint32_t startUs = micros();
+  strip.show();
+  perfStats().frame(micros() - startUs);
+}
+
+// Colour and brightness of this frame: a transition in progress, else the stored state
+static LightLevel frameLevel() {
+  return lightFader.sample(millis(), ledState.level());
+}
 #endif
 
+// LEDs of the most recent frame; frameVersion changes whenever the set of lit LEDs does
+static std::vector<uint16_t> lastShown;
+static uint32_t frameVersion = 0;
+
+static void rememberFrame(const std::vector<uint16_t> &ledIndices) {
+  if (ledIndices != lastShown) {
+    lastShown = ledIndices;
+    frameVersion++;
+  }
+}
+
 void initLeds() {
 #ifndef PIO_UNIT_TESTING
   ensureStripLength();
@@ -37,29 +60,26 @@ void initLeds() {
   strip.setBrightness(brightness);
   strip.clear();
   strip.show();
-#else
-  lastShown.clear();
 #endif
+  rememberFrame(std::vector<uint16_t>());
 }
 
 void showLeds(const std::vector<uint16_t> &ledIndices) {
 #ifndef PIO_UNIT_TESTING
   ensureStripLength();
   strip.clear();
+  LightLevel level = frameLevel();
+  uint32_t color = strip.Color(level.r, level.g, level.b, level.w);
   for (uint16_t idx : ledIndices) {
     if (idx < strip.numPixels()) {
-      // Use the calculated RGB and W
-      uint8_t r, g, b, w;
-      ledState.getRGBW(r, g, b, w);
-      strip.setPixelColor(idx, strip.Color(r, g, b, w));
+      strip.setPixelColor(idx, color);
     }
   }
-  uint8_t brightness = nightMode.applyToBrightness(ledState.getBrightness());
+  uint8_t brightness = nightMode.applyToBrightness(level.brightness);
   strip.setBrightness(brightness);
-  strip.show();
-#else
-  lastShown = ledIndices;
+  showFrame();
 #endif
+  rememberFrame(ledIndices);
 }
 
 void showLedsWithBrightness(const std::vector<uint16_t> &ledIndices, 
@@ -67,8 +87,8 @@ void showLedsWithBrightness(const std::vector<uint16_t> &ledIndices,
 #ifndef PIO_UNIT_TESTING
   ensureStripLength();
   strip.clear();
-  uint8_t r, g, b, w;
-  ledState.getRGBW(r, g, b, w);
+  LightLevel level = frameLevel();
+  uint8_t r = level.r, g = level.g, b = level.b, w = level.w;
   
   for (size_t i = 0; i < ledIndices.size() && i < brightnessMultipliers.size(); ++i) {
     uint16_t idx = ledIndices[i];
@@ -82,12 +102,19 @@ void showLedsWithBrightness(const std::vector<uint16_t> &ledIndices,
       strip.setPixelColor(idx, strip.Color(finalR, finalG, finalB, finalW));
     }
   }
-  uint8_t brightness = nightMode.applyToBrightness(ledState.getBrightness());
+  uint8_t brightness = nightMode.applyToBrightness(level.brightness);
   strip.setBrightness(brightness);
-  strip.show();
-#else
-  lastShown = ledIndices;
+  showFrame();
 #endif
+  rememberFrame(ledIndices);
+}
+
+const std::vector<uint16_t>& ledLastFrame() {
+  return lastShown;
+}
+
+uint32_t ledFrameVersion() {
+  return frameVersion;
 }
 
 #ifdef PIO_UNIT_TESTING
@@ -11,6 +11,9 @@ void initLeds();
 void showLeds(const std::vector<uint16_t> &ledIndices);
 void showLedsWithBrightness(const std::vector<uint16_t> &ledIndices, 
                             const std::vector<uint8_t> &brightnessMultipliers);
+// LED indices of the last frame shown, and a counter that changes with them
+const std::vector<uint16_t>& ledLastFrame();
+uint32_t ledFrameVersion();
 
 #ifdef PIO_UNIT_TESTING
 const std::vector<uint16_t>& test_getLastShownLeds();
@@ -1,2 +1,3 @@
 #include "led_state.h"
 LedState ledState;
+LightFader lightFader;
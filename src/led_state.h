@@ -1,7 +1,9 @@
 #ifndef LED_STATE_H
 #define LED_STATE_H
 
-#include <Preferences.h>
+#include "counted_preferences.h"
+#include "state_dirty.h"
+#include "light_fader.h"
 
 class LedState {
 public:
@@ -27,8 +29,10 @@ public:
      * @param r Red component (0-255)
      * @param g Green component (0-255)
      * @param b Blue component (0-255)
+     * @note Drops a transition in progress, so the new colour shows at once
      */
     void setRGB(uint8_t r, uint8_t g, uint8_t b) {
+        lightFader.cancel();
         // Early exit if no change
         if (red_ == r && green_ == g && blue_ == b) {
             return;
@@ -43,16 +47,20 @@ public:
         }
         
         markDirty();  // Flag for later persistence
+        stateMarkDirty(DIRTY_LIGHT);
     }
 
     /**
      * @brief Set brightness (immediate in-memory, deferred persistence)
      * @param b Brightness value (0-255)
+     * @note Drops a transition in progress, so the new brightness shows at once
      */
     void setBrightness(uint8_t b) {
+        lightFader.cancel();
         if (brightness_ == b) return;
         brightness_ = b;
         markDirty();
+        stateMarkDirty(DIRTY_LIGHT);
     }
 
     /**
@@ -89,6 +97,9 @@ public:
     void getRGBW(uint8_t &r, uint8_t &g, uint8_t &b, uint8_t &w) const {
         r = red_; g = green_; b = blue_; w = white_;
     }
+    LightLevel level() const {
+        return LightLevel{ red_, green_, blue_, white_, brightness_ };
+    }
     
     // New: Query persistence state
     bool isDirty() const { return dirty_; }
@@ -109,7 +120,7 @@ private:
     bool dirty_ = false;
     unsigned long lastFlush_ = 0;
     
-    Preferences prefs_;
+    CountedPreferences prefs_;
     
     static const unsigned long AUTO_FLUSH_DELAY_MS = 5000;  // 5 seconds
 };
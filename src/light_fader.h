@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+
+// Colour and brightness of the clock face, as handed to the LED strip
+struct LightLevel {
+  uint8_t r, g, b, w;
+  uint8_t brightness;
+};
+
+// Time-based fade between two light levels, for Home Assistant transitions.
+// The LED controller samples it on every render tick, so a fade needs no
+// work of its own and never blocks. Progress is a 16-bit fraction of the
+// duration and every channel is interpolated in integer arithmetic.
+
+class LightFader {
+public:
+  static const uint32_t MAX_DURATION_MS = 3600000;  // Longer requests are clamped
+
+  /** @param durationMs 0 cancels any fade in progress */
+  void start(const LightLevel& from, const LightLevel& to, uint32_t durationMs, uint32_t nowMs) {
+    if (durationMs > MAX_DURATION_MS) durationMs = MAX_DURATION_MS;
+    from_ = from;
+    to_ = to;
+    startMs_ = nowMs;
+    durationMs_ = durationMs;
+    running_ = durationMs > 0;
+  }
+
+  void cancel() { running_ = false; }
+
+  /** @brief A fade has not reached its target yet */
+  bool active() const { return running_; }
+
+  /**
+   * @brief Level to show at @p nowMs
+   * @param steady Returned when no fade is running
+   * @note The sample at or after the end returns the target and ends the fade
+   */
+  LightLevel sample(uint32_t nowMs, const LightLevel& steady) {
+    if (!running_) return steady;
+    uint32_t elapsed = nowMs - startMs_;
+    if (elapsed >= durationMs_) {
+      running_ = false;
+      return to_;
+    }
+    int32_t t = (int32_t)(((uint64_t)elapsed << 16) / durationMs_);  // 0..65535
+    LightLevel out;
+    out.r = lerp(from_.r, to_.r, t);
+    out.g = lerp(from_.g, to_.g, t);
+    out.b = lerp(from_.b, to_.b, t);
+    out.w = lerp(from_.w, to_.w, t);
+    out.brightness = lerp(from_.brightness, to_.brightness, t);
+    return out;
+  }
+
+private:
+  static uint8_t lerp(uint8_t a, uint8_t b, int32_t t) {
+    return (uint8_t)(a + ((((int32_t)b - a) * t) >> 16));
+  }
+
+  LightLevel from_ = {};
+  LightLevel to_ = {};
+  uint32_t startMs_ = 0;
+  uint32_t durationMs_ = 0;
+  bool running_ = false;
+};
+
+extern LightFader lightFader;
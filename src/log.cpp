@@ -24,17 +24,41 @@ String logLatestFilePath() {
 
 void logRewriteUnsynced() {}
 
+uint32_t logLatestSeq() {
+  return 0;
+}
+
+uint32_t logOldestSeq() {
+  return 0;
+}
+
+size_t logForEachSince(uint32_t, const std::function<void(uint32_t, const String&)>&) {
+  return 0;
+}
+
+size_t logQueryFile(const String&, const LogQuery&, size_t, const std::function<void(const char*, size_t)>&, LogQueryStats*) {
+  return 0;
+}
+
+void logLoop() {}
+
 #else
 
-#include <Preferences.h>
+#include "counted_preferences.h"
 #include <time.h>
 #include <stdlib.h>
+#include <memory>
 #include "fs_compat.h"
+#include "log_codec.h"
+#include "perf_stats.h"
+#include "state_dirty.h"
 
 LogLevel LOG_LEVEL = DEFAULT_LOG_LEVEL;
 
 String logBuffer[LOG_BUFFER_SIZE];
 int logIndex = 0;
+static uint32_t logSeqBuffer[LOG_BUFFER_SIZE];
+static uint32_t logNextSeq = 1;
 
 static bool fileSinkEnabled = false;
 static File logFile;
@@ -43,6 +67,31 @@ static unsigned long lastFlushMs = 0;
 static const unsigned long LOG_FLUSH_INTERVAL_MS = 5000;
 static uint32_t LOG_RETENTION_DAYS = 1;
 static bool LOG_DELETE_ON_BOOT = true;
+// Sparse seek index for the current dated log file (empty path = not indexed)
+static LogIndexBuilder logIndexBuilder;
+static String currentIndexPath;
+// Collapses identical consecutive records into one "repeated N times" record
+static LogRepeatFilter repeatFilter;
+// Set on boot and at day rollover: finished dated logs are waiting to be compressed
+static bool archivePending = true;
+
+// Incremental conversion of the uptime-stamped boot log, driven by logLoop()
+static const char* UNSYNCED_LOG_PATH = "/logs/unsynced.log";
+static const unsigned long LOG_REWRITE_SLICE_MS = 8;
+struct UnsyncedRewrite {
+  bool active;
+  File in;
+  uint64_t bootEpochMs;
+  uint32_t lines;
+  bool passthrough;   // Line longer than the buffer: the rest is copied as-is
+  uint32_t passSod;
+  int passLevel;
+  size_t lineLen;
+  char line[192];
+};
+static UnsyncedRewrite unsyncedRewrite = {};
+static void rewriteUnsyncedSlice();
+static void abortArchive();
 
 static void closeLogFile() {
   if (logFile) {
@@ -63,6 +112,24 @@ static String determineLogTag() {
   return String(buf);
 }
 
+static String indexPathFor(const String& logPath) {
+  if (logPath.endsWith(".log")) return logPath.substring(0, logPath.length() - 4) + ".idx";
+  if (logPath.endsWith(".log.gz")) return logPath.substring(0, logPath.length() - 7) + ".idx";
+  return String();
+}
+
+// True for names starting with a YYYY-MM-DD date
+static bool isDatedLogName(const String& name) {
+  return name.length() >= 10 && isdigit(name[0]) && isdigit(name[3]) && name[4] == '-' && name[7] == '-';
+}
+
+static void appendIndexEntry(const String& idxPath, const LogIndexEntry& e) {
+  File idx = FS_IMPL.open(idxPath, "a");
+  if (!idx) return;
+  idx.write((const uint8_t*)&e, sizeof(e));
+  idx.close();
+}
+
 static void ensureLogDirectory() {
   if (!FS_IMPL.exists("/logs")) {
     FS_IMPL.mkdir("/logs");
@@ -74,6 +141,10 @@ static void ensureLogFile() {
   String tag = determineLogTag();
   if (tag.length() == 0) return;
   if (!logFile || tag != currentLogTag) {
+    if (currentLogTag.length() && tag != currentLogTag) {
+      // Day rollover (or first sync): yesterday's file can be archived from logLoop()
+      archivePending = true;
+    }
     closeLogFile();
     ensureLogDirectory();
     // Cleanup old logs before opening new file
@@ -81,6 +152,14 @@ static void ensureLogFile() {
     if (dir) {
       time_t now = time(nullptr);
       const time_t cutoff = (LOG_RETENTION_DAYS > 0) ? now - (LOG_RETENTION_DAYS * 86400UL) : 0;
+      // Dated files (log, archive, index) expire by the date in their name: compressing an
+      // archive rewrites it, so its modification time says nothing about its age
+      char cutoffDate[16] = "";
+      if (cutoff > 1640995200) {
+        struct tm ct = {};
+        localtime_r(&cutoff, &ct);
+        strftime(cutoffDate, sizeof(cutoffDate), "%Y-%m-%d", &ct);
+      }
       while (true) {
         File entry = dir.openNextFile();
         if (!entry) break;
@@ -94,6 +173,8 @@ static void ensureLogFile() {
             if (entry.getLastWrite() > 0 && now >= 86400UL && (now - entry.getLastWrite()) > 86400UL) {
               removeFile = true;
             }
+          } else if (cutoffDate[0] && isDatedLogName(name)) {
+            removeFile = strncmp(name.c_str(), cutoffDate, 10) < 0;
           } else if (cutoff > 0 && entry.getLastWrite() > 0) {
             if (entry.getLastWrite() < cutoff) {
               removeFile = true;
@@ -120,6 +201,9 @@ static void ensureLogFile() {
       return;
     }
     currentLogTag = tag;
+    // Unsynced logs only carry uptime, so there is nothing to seek on
+    currentIndexPath = (tag == "unsynced") ? String() : indexPathFor(path);
+    logIndexBuilder.reset((uint32_t)logFile.size());
     // Truncate overly large log directory by deleting files older than 7 days
   }
 }
@@ -134,9 +218,10 @@ static inline const char* levelToTag(int level) {
   }
 }
 
-static String makeLogPrefix(int level) {
+static String makeLogPrefix(int level, uint32_t* sodOut) {
   // Prefer localtime_r with TZ applied; fall back to uptime if RTC not set yet
   time_t now = time(nullptr);
+  *sodOut = LOG_SOD_INVALID;
   // Consider time unsynced if before 2022-01-01
   if (now < 1640995200) {
     unsigned long nowMs = millis();
@@ -147,6 +232,7 @@ static String makeLogPrefix(int level) {
 
   struct tm lt = {};
   localtime_r(&now, &lt);
+  *sodOut = (uint32_t)(lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec);
   char datebuf[32];
   char tzbuf[8];
   strftime(datebuf, sizeof(datebuf), "%Y-%m-%d %H:%M:%S", &lt);
@@ -158,15 +244,19 @@ static String makeLogPrefix(int level) {
   return String(out);
 }
 
-void log(String msg, int level) {
-  // Filter: only log messages at or above current threshold
-  if (level < LOG_LEVEL) return;
-
-  // if (telnetClient && telnetClient.connected()) {
-  //   telnetClient.print(msg);
-  // }
+// Write to the open log file and keep the seek index in step
+static void appendToLogFile(const char* data, size_t len, uint32_t sod, int level, bool endsLine) {
+  logFile.write((const uint8_t*)data, len);
+  LogIndexEntry block;
+  if (logIndexBuilder.add((uint32_t)len, sod, level, endsLine, block) && currentIndexPath.length()) {
+    appendIndexEntry(currentIndexPath, block);
+  }
+}
 
-  String line = makeLogPrefix(level) + msg;
+static void writeRecord(const String& msg, int level) {
+  uint32_t startUs = micros();
+  uint32_t sod;
+  String line = makeLogPrefix(level, &sod) + msg;
 #ifdef ENABLE_DEBUG_LOGGING
   Serial.print(line);
 #endif
@@ -174,7 +264,7 @@ void log(String msg, int level) {
   if (fileSinkEnabled) {
     ensureLogFile();
     if (logFile) {
-      logFile.print(line);
+      appendToLogFile(line.c_str(), line.length(), sod, level, line.endsWith("\n"));
       unsigned long now = millis();
       if (lastFlushMs == 0 || (now - lastFlushMs) >= LOG_FLUSH_INTERVAL_MS || line.endsWith("\n")) {
         logFile.flush();
@@ -185,7 +275,29 @@ void log(String msg, int level) {
 
   // Store in ring buffer any message that passes the filter
   logBuffer[logIndex] = line;
+  logSeqBuffer[logIndex] = logNextSeq++;
   logIndex = (logIndex + 1) % LOG_BUFFER_SIZE;
+  perfStats().logWrite(micros() - startUs);
+}
+
+static void writeRepeatSummary(uint32_t repeats, int level) {
+  if (repeats == 0) return;
+  writeRecord(String("(previous message repeated ") + String(repeats) + (repeats == 1 ? " time)\n" : " times)\n"), level);
+}
+
+void log(String msg, int level) {
+  // Filter: only log messages at or above current threshold
+  if (level < LOG_LEVEL) return;
+
+  // if (telnetClient && telnetClient.connected()) {
+  //   telnetClient.print(msg);
+  // }
+
+  if (repeatFilter.check(msg.c_str(), msg.length(), level)) return;
+  int repeatLevel;
+  uint32_t repeats = repeatFilter.takeCollapsed(repeatLevel);
+  writeRepeatSummary(repeats, repeatLevel);
+  writeRecord(msg, level);
 }
 
 void logln(String msg, int level) {
@@ -193,9 +305,10 @@ void logln(String msg, int level) {
 }
 
 void setLogLevel(LogLevel level) {
+  if (LOG_LEVEL != level) stateMarkDirty(DIRTY_LOG_LEVEL);
   LOG_LEVEL = level;
   // Persist new level
-  Preferences prefs;
+  CountedPreferences prefs;
   prefs.begin("wc_log", false);
   prefs.putUChar("level", (uint8_t)level);
   prefs.end();
@@ -203,9 +316,9 @@ void setLogLevel(LogLevel level) {
 
 void setLogRetentionDays(uint32_t days) {
   if (days < 1) days = 1;
-  if (days > 10) days = 10;
+  if (days > 30) days = 30;
   LOG_RETENTION_DAYS = days;
-  Preferences prefs;
+  CountedPreferences prefs;
   prefs.begin("wc_log", false);
   prefs.putUInt("retention", days);
   prefs.end();
@@ -217,7 +330,7 @@ uint32_t getLogRetentionDays() {
 
 void setLogDeleteOnBoot(bool enabled) {
   LOG_DELETE_ON_BOOT = enabled;
-  Preferences prefs;
+  CountedPreferences prefs;
   prefs.begin("wc_log", false);
   prefs.putBool("delOnBoot", enabled);
   prefs.end();
@@ -270,15 +383,27 @@ void logEnableFileSink() {
   }
 
   fileSinkEnabled = true;
+  archivePending = true;
   currentLogTag = "";
   ensureLogFile();
 }
 
+static void stopUnsyncedRewrite() {
+  if (unsyncedRewrite.in) unsyncedRewrite.in.close();
+  unsyncedRewrite.active = false;
+}
+
 void logCloseFile() {
+  stopUnsyncedRewrite();
+  abortArchive();
   closeLogFile();
 }
 
 void logFlushFile() {
+  // Readers should see a run of repeats that is still in progress
+  int repeatLevel;
+  uint32_t repeats = repeatFilter.takePending(repeatLevel);
+  writeRepeatSummary(repeats, repeatLevel);
   if (logFile) {
     logFile.flush();
     lastFlushMs = millis();
@@ -296,7 +421,7 @@ String logLatestFilePath() {
     if (!entry) break;
     if (!entry.isDirectory()) {
       String name = entry.name();
-      if (name.length()) {
+      if (name.endsWith(".log")) {
         if (latest.length() == 0 || name.compareTo(latest) > 0) {
           latest = name;
         }
@@ -308,51 +433,382 @@ String logLatestFilePath() {
   return latest;
 }
 
-// Rewrites unsynced (uptime-based) logs into a dated log once time is synced.
-void logRewriteUnsynced() {
-  const char* UNSYNCED = "/logs/unsynced.log";
-  time_t now = time(nullptr);
-  // Only run if time is valid and the unsynced log exists
-  if (now < 1640995200) return;
-  if (!FS_IMPL.exists(UNSYNCED)) return;
+uint32_t logLatestSeq() {
+  return logNextSeq - 1;
+}
 
-  File in = FS_IMPL.open(UNSYNCED, "r");
-  if (!in) return;
+uint32_t logOldestSeq() {
+  // Slot at logIndex is the oldest once the buffer has wrapped; otherwise slot 0
+  uint32_t seq = logSeqBuffer[logIndex];
+  if (seq == 0) seq = logSeqBuffer[0];
+  return seq;
+}
+
+size_t logForEachSince(uint32_t since, const std::function<void(uint32_t, const String&)>& fn) {
+  if (since >= logLatestSeq()) return 0;
+  size_t visited = 0;
+  int i = logIndex;
+  for (int count = 0; count < LOG_BUFFER_SIZE; count++) {
+    uint32_t seq = logSeqBuffer[i];
+    if (seq > since) {
+      fn(seq, logBuffer[i]);
+      visited++;
+    }
+    i = (i + 1) % LOG_BUFFER_SIZE;
+  }
+  return visited;
+}
 
-  String outPath = String("/logs/") + determineLogTag() + String(".log");
-  File out = FS_IMPL.open(outPath, "a");
-  if (!out) {
-    in.close();
+// Reads [from, to) of a log file line by line and emits the lines matching the query.
+// Lines longer than the line buffer are truncated. Returns true once the limit is reached.
+struct LogQueryScan {
+  const LogQuery* query;
+  size_t limit;
+  const std::function<void(const char*, size_t)>* emit;
+  LogQueryStats stats;
+  char line[320];
+  size_t lineLen;
+};
+
+static void finishQueryLine(LogQueryScan& s) {
+  LogLineInfo info;
+  logParseLine(s.line, s.lineLen, info);
+  if (logLineMatches(s.line, s.lineLen, info, *s.query)) {
+    (*s.emit)(s.line, s.lineLen);
+    s.stats.matches++;
+  }
+  s.lineLen = 0;
+}
+
+static size_t readFromFile(void* ctx, uint8_t* buf, size_t len) {
+  return static_cast<File*>(ctx)->read(buf, len);
+}
+
+// Byte range of a log file; compressed archives are inflated from the sync point at `from`
+struct LogRangeReader {
+  File* file;
+  LogInflater* inflater;  // nullptr for plain files
+  uint32_t fileSize;
+  uint32_t left;
+
+  bool open(uint32_t from, uint32_t to) {
+    if (!file->seek(from)) return false;
+    left = to - from;
+    if (inflater) {
+      inflater->begin(readFromFile, file, from == 0, from);
+      if (to < fileSize) inflater->setLimit(to);
+    }
+    return true;
+  }
+
+  int read(uint8_t* buf, size_t len) {
+    if (inflater) return inflater->read(buf, len);
+    if (left == 0) return 0;
+    if (len > left) len = left;
+    size_t n = file->read(buf, len);
+    left -= n;
+    return (int)n;
+  }
+};
+
+static bool scanLogRange(LogRangeReader& r, uint32_t from, uint32_t to, LogQueryScan& s) {
+  if (!r.open(from, to)) return false;
+  uint8_t buf[256];
+  s.lineLen = 0;
+  while (true) {
+    int got = r.read(buf, sizeof(buf));
+    if (got <= 0) break;
+    size_t n = (size_t)got;
+    s.stats.bytesScanned += n;
+    for (size_t i = 0; i < n; ++i) {
+      char c = (char)buf[i];
+      if (c == '\n') {
+        finishQueryLine(s);
+        if (s.stats.matches >= s.limit) return true;
+      } else if (c != '\r' && s.lineLen < sizeof(s.line)) {
+        s.line[s.lineLen++] = c;
+      }
+    }
+  }
+  if (s.lineLen > 0) finishQueryLine(s);
+  return s.stats.matches >= s.limit;
+}
+
+size_t logQueryFile(const String& path, const LogQuery& q, size_t limit,
+                    const std::function<void(const char*, size_t)>& emit, LogQueryStats* stats) {
+  if (path == String("/logs/") + currentLogTag + ".log") {
+    logFlushFile();
+  }
+  File f = FS_IMPL.open(path, "r");
+  if (!f) return 0;
+  std::unique_ptr<LogInflater> inflater;
+  if (path.endsWith(".gz")) {
+    inflater.reset(new (std::nothrow) LogInflater());
+    if (!inflater) {
+      f.close();
+      return 0;
+    }
+  }
+
+  LogQueryScan s;
+  s.query = &q;
+  s.limit = limit;
+  s.emit = &emit;
+  s.stats = {};
+  s.lineLen = 0;
+  const uint32_t size = (uint32_t)f.size();
+  s.stats.fileBytes = size;
+  LogRangeReader reader = { &f, inflater.get(), size, 0 };
+
+  // Walk the index in file order: gaps between blocks are always scanned (lines written
+  // without an index entry), blocks are only read when their summary can match.
+  uint32_t pos = 0;
+  bool done = false;
+  String idxPath = indexPathFor(path);
+  File idx = idxPath.length() ? FS_IMPL.open(idxPath, "r") : File();
+  if (idx) {
+    LogIndexEntry e;
+    while (!done && idx.read((uint8_t*)&e, sizeof(e)) == sizeof(e)) {
+      if (e.start < pos || e.end <= e.start || e.end > size) continue;  // stale entry
+      if (e.start > pos) done = scanLogRange(reader, pos, e.start, s);
+      if (done) break;
+      if (logBlockMayMatch(e, q)) {
+        done = scanLogRange(reader, e.start, e.end, s);
+      } else {
+        s.stats.blocksSkipped++;
+      }
+      pos = e.end;
+    }
+    idx.close();
+  }
+  if (!done && pos < size) scanLogRange(reader, pos, size, s);
+  f.close();
+  if (stats) *stats = s.stats;
+  return s.stats.matches;
+}
+
+static bool writeToFile(void* ctx, const uint8_t* data, size_t len) {
+  return static_cast<File*>(ctx)->write(data, len) == len;
+}
+
+// Feed [from, to) of the source file to the deflater
+static bool deflateRange(File& in, uint32_t from, uint32_t to, LogDeflater& z) {
+  if (to <= from) return true;
+  if (!in.seek(from)) return false;
+  uint8_t buf[256];
+  uint32_t left = to - from;
+  while (left > 0) {
+    size_t n = in.read(buf, left < sizeof(buf) ? left : sizeof(buf));
+    if (n == 0 || !z.write(buf, n)) return false;
+    left -= n;
+  }
+  return true;
+}
+
+// Compression of one finished /logs/<date>.log into <date>.log.gz, LOG_ARCHIVE_CHUNK input
+// bytes per logLoop() call. Index blocks become sync points in the archive, and the .idx is
+// rewritten with compressed offsets so queries can still seek.
+static const uint32_t LOG_ARCHIVE_CHUNK = 2048;
+struct LogArchiveJob {
+  enum Stage : uint8_t { GAP, BLOCK, TAIL };
+  bool active = false;
+  String path;
+  File in, out, idxIn, idxOut;
+  std::unique_ptr<LogDeflater> z;
+  uint32_t size = 0;
+  uint32_t pos = 0;          // Next input byte
+  uint32_t target = 0;       // End of the range being compressed
+  uint32_t syncedInput = 0;  // Input position of the last sync point (0 = stream start)
+  Stage stage = TAIL;
+  LogIndexEntry entry = {};  // Current block; start/end become compressed offsets as they are known
+  uint32_t entryEnd = 0;     // Source end of the current block
+  unsigned long startedMs = 0;
+};
+static LogArchiveJob archiveJob;
+
+// Move on to the next valid index entry, or to the tail of the file
+static void nextArchiveEntry(LogArchiveJob& job) {
+  if (job.idxIn && job.idxOut) {
+    LogIndexEntry e;
+    while (job.idxIn.read((uint8_t*)&e, sizeof(e)) == sizeof(e)) {
+      if (e.start < job.pos || e.end <= e.start || e.end > job.size) continue;
+      job.entry = e;
+      job.entryEnd = e.end;
+      job.stage = LogArchiveJob::GAP;
+      job.target = e.start;
+      return;
+    }
+  }
+  job.stage = LogArchiveJob::TAIL;
+  job.target = job.size;
+}
+
+static void closeArchiveFiles(LogArchiveJob& job) {
+  if (job.in) job.in.close();
+  if (job.out) job.out.close();
+  if (job.idxIn) job.idxIn.close();
+  if (job.idxOut) job.idxOut.close();
+  job.z.reset();
+  job.active = false;
+}
+
+// Drop a job in progress together with its partial output
+static void abortArchive() {
+  LogArchiveJob& job = archiveJob;
+  if (!job.active) return;
+  bool hadIndex = (bool)job.idxOut;
+  closeArchiveFiles(job);
+  FS_IMPL.remove(job.path + ".gz");
+  if (hadIndex) FS_IMPL.remove(indexPathFor(job.path) + ".tmp");
+}
+
+static bool startArchive(const String& path) {
+  LogArchiveJob& job = archiveJob;
+  job.path = path;
+  job.in = FS_IMPL.open(path, "r");
+  if (!job.in) return false;
+  job.out = FS_IMPL.open(path + ".gz", "w");
+  job.active = true;
+  String idxPath = indexPathFor(path);
+  job.idxIn = FS_IMPL.exists(idxPath) ? FS_IMPL.open(idxPath, "r") : File();
+  job.idxOut = job.idxIn ? FS_IMPL.open(idxPath + ".tmp", "w") : File();
+  job.z.reset(new (std::nothrow) LogDeflater());
+  if (!job.out || !job.z || !job.z->begin(writeToFile, &job.out, (uint32_t)time(nullptr))) {
+    abortArchive();
+    return false;
+  }
+  job.size = (uint32_t)job.in.size();
+  job.pos = 0;
+  job.syncedInput = 0;
+  job.startedMs = millis();
+  nextArchiveEntry(job);
+  return true;
+}
+
+/**
+ * @brief Compress the next chunk of the running job
+ * @param done Set once the archive is complete
+ * @return false on an I/O or codec error
+ */
+static bool archiveStep(bool& done) {
+  LogArchiveJob& job = archiveJob;
+  LogDeflater& z = *job.z;
+  done = false;
+  uint32_t budget = LOG_ARCHIVE_CHUNK;
+  while (budget > 0) {
+    if (job.pos < job.target) {
+      uint32_t n = job.target - job.pos < budget ? job.target - job.pos : budget;
+      if (!deflateRange(job.in, job.pos, job.pos + n, z)) return false;
+      job.pos += n;
+      budget -= n;
+      continue;
+    }
+    switch (job.stage) {
+      case LogArchiveJob::GAP:
+        // Consecutive blocks share one sync point
+        if (z.inputBytes() != job.syncedInput && !z.sync()) return false;
+        job.entry.start = z.offset();
+        job.stage = LogArchiveJob::BLOCK;
+        job.target = job.entryEnd;
+        break;
+      case LogArchiveJob::BLOCK:
+        if (!z.sync()) return false;
+        job.syncedInput = z.inputBytes();
+        job.entry.end = z.offset();
+        if (job.idxOut.write((const uint8_t*)&job.entry, sizeof(job.entry)) != sizeof(job.entry)) return false;
+        nextArchiveEntry(job);
+        break;
+      case LogArchiveJob::TAIL:
+        done = true;
+        return z.finish();
+    }
+  }
+  return true;
+}
+
+// Swap the finished archive in for the plain log
+static void completeArchive() {
+  LogArchiveJob& job = archiveJob;
+  bool hadIndex = (bool)job.idxOut;
+  closeArchiveFiles(job);
+  FS_IMPL.remove(job.path);
+  if (hadIndex) {
+    String idxPath = indexPathFor(job.path);
+    FS_IMPL.remove(idxPath);
+    FS_IMPL.rename(idxPath + ".tmp", idxPath);
+  }
+}
+
+// Find one finished dated .log (not today's) that still needs compressing
+static String findLogToArchive() {
+  File dir = FS_IMPL.open("/logs");
+  if (!dir) return String();
+  String found;
+  String current = currentLogTag + ".log";
+  while (found.length() == 0) {
+    File entry = dir.openNextFile();
+    if (!entry) break;
+    if (!entry.isDirectory()) {
+      String name = entry.name();
+      if (name.startsWith("/")) name = name.substring(1);
+      if (name.startsWith("logs/")) name = name.substring(5);
+      if (isDatedLogName(name) && name.endsWith(".log") && name != current) {
+        found = String("/logs/") + name;
+      }
+    }
+    entry.close();
+  }
+  dir.close();
+  return found;
+}
+
+void logLoop() {
+  if (unsyncedRewrite.active) {
+    rewriteUnsyncedSlice();
+    return;
+  }
+  if (archiveJob.active) {
+    bool done = false;
+    if (!archiveStep(done)) {
+      String path = archiveJob.path;
+      abortArchive();
+      logWarn("Failed to archive " + path + "; keeping it uncompressed");
+      archivePending = false;  // retry at the next rollover or boot
+    } else if (done) {
+      String path = archiveJob.path;
+      unsigned long elapsed = millis() - archiveJob.startedMs;
+      completeArchive();
+      logInfo("🗜️ Archived " + path + ".gz in " + String(elapsed) + " ms");
+    }
+    return;
+  }
+  if (!archivePending || !fileSinkEnabled) return;
+  // Only once the clock is synced: before that there is no "today" to compare with
+  if (time(nullptr) < 1640995200 || currentLogTag.length() == 0 || currentLogTag == "unsynced") return;
+  // One file at a time, a chunk per call, keeps the loop responsive after a long power-off
+  String path = findLogToArchive();
+  if (path.length() == 0) {
+    archivePending = false;
     return;
   }
+  if (!startArchive(path)) {
+    logWarn("Failed to archive " + path + "; keeping it uncompressed");
+    archivePending = false;
+  }
+}
 
-  // Approximate boot epoch from current epoch minus uptime (millis)
-  uint64_t nowMs = millis();
-  uint64_t nowEpochMs = ((uint64_t)now) * 1000ULL;
-  uint64_t bootEpochMs = (nowEpochMs > nowMs) ? (nowEpochMs - nowMs) : 0;
-
-  bool converted = false;
-  while (in.available()) {
-    String line = in.readStringUntil('\n');
-    if (line.length() == 0) continue;
-    // Expected prefix: [uptime %lu.%03lus][LEVEL] ...
-    int upPos = line.indexOf("[uptime ");
-    if (upPos != 0) continue;
-    int dotPos = line.indexOf('.', upPos + 8);
-    int sPos = line.indexOf("s][", dotPos);
-    if (dotPos < 0 || sPos < 0) continue;
-    int lvlStart = sPos + 3;
-    int lvlEnd = line.indexOf(']', lvlStart);
-    if (lvlEnd < 0) continue;
-    String secStr = line.substring(upPos + 8, dotPos);
-    String msStr = line.substring(dotPos + 1, sPos);
-    String lvlStr = line.substring(lvlStart, lvlEnd);
-    String msg = line.substring(lvlEnd + 2); // skip "] "
-    uint64_t upSec = (uint64_t)secStr.toInt();
-    uint64_t upMs = (uint64_t)msStr.toInt();
-    uint64_t lineMs = bootEpochMs + (upSec * 1000ULL) + upMs;
+// Convert the buffered start of an unsynced line and append it to today's log.
+// complete=false means the line continues beyond the buffer (copied verbatim afterwards).
+static void rewriteUnsyncedLine(bool complete) {
+  UnsyncedRewrite& rw = unsyncedRewrite;
+  const char* rest = rw.line;
+  size_t restLen = rw.lineLen;
+  uint32_t sod = LOG_SOD_INVALID;
+  int level = -1;
+  LogUptimePrefix up;
+  if (logParseUptimePrefix(rw.line, rw.lineLen, up)) {
+    uint64_t lineMs = rw.bootEpochMs + (uint64_t)up.seconds * 1000ULL + up.millis;
     time_t lineSec = (time_t)(lineMs / 1000ULL);
-    uint16_t lineMsPart = (uint16_t)(lineMs % 1000ULL);
     struct tm lt = {};
     localtime_r(&lineSec, &lt);
     char datebuf[32];
@@ -360,16 +816,101 @@ void logRewriteUnsynced() {
     strftime(datebuf, sizeof(datebuf), "%Y-%m-%d %H:%M:%S", &lt);
     strftime(tzbuf, sizeof(tzbuf), "%Z", &lt);
     char prefix[96];
-    snprintf(prefix, sizeof(prefix), "[%s.%03u %s][%s] ", datebuf, (unsigned)lineMsPart, tzbuf, lvlStr.c_str());
-    out.print(prefix);
-    out.println(msg);
-    converted = true;
+    int n = snprintf(prefix, sizeof(prefix), "[%s.%03u %s][%.*s] ", datebuf, (unsigned)(lineMs % 1000ULL), tzbuf,
+                     (int)up.levelLen, rw.line + up.levelStart);
+    sod = (uint32_t)(lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec);
+    level = logLevelFromTag(rw.line + up.levelStart, up.levelLen);
+    if (n > 0) appendToLogFile(prefix, (size_t)n < sizeof(prefix) ? (size_t)n : sizeof(prefix) - 1, sod, level, false);
+    rest = rw.line + up.msgOffset;
+    restLen = rw.lineLen - up.msgOffset;
   }
-  out.flush();
-  in.close();
-  if (converted) {
-    FS_IMPL.remove(UNSYNCED);
+  // Lines without an uptime prefix (continuations) are kept as they are
+  if (restLen > 0) appendToLogFile(rest, restLen, sod, level, false);
+  if (complete) {
+    appendToLogFile("\n", 1, sod, level, true);
+    rw.lines++;
+  } else {
+    rw.passthrough = true;
+    rw.passSod = sod;
+    rw.passLevel = level;
   }
+  rw.lineLen = 0;
+}
+
+// Process the unsynced log for about LOG_REWRITE_SLICE_MS. A line copied verbatim is
+// always finished first: live records written meanwhile would end up inside it.
+static void rewriteUnsyncedSlice() {
+  UnsyncedRewrite& rw = unsyncedRewrite;
+  if (!fileSinkEnabled) {
+    stopUnsyncedRewrite();
+    return;
+  }
+  ensureLogFile();
+  // Wait until the sink has finished its current line so records do not get glued together
+  if (!logFile || !logIndexBuilder.atLineStart()) return;
+
+  unsigned long started = millis();
+  uint8_t buf[128];
+  while (millis() - started < LOG_REWRITE_SLICE_MS || rw.passthrough) {
+    size_t n = rw.in.read(buf, sizeof(buf));
+    if (n == 0) {
+      if (rw.lineLen > 0) rewriteUnsyncedLine(true);
+      if (rw.passthrough) appendToLogFile("\n", 1, rw.passSod, rw.passLevel, true);
+      logFile.flush();
+      stopUnsyncedRewrite();
+      FS_IMPL.remove(UNSYNCED_LOG_PATH);
+      logInfo("🕒 Rewrote " + String(rw.lines) + " boot log lines with real timestamps");
+      return;
+    }
+    size_t i = 0;
+    while (i < n) {
+      if (rw.passthrough) {
+        size_t j = i;
+        while (j < n && buf[j] != '\n') j++;
+        if (j > i) appendToLogFile((const char*)buf + i, j - i, rw.passSod, rw.passLevel, false);
+        if (j < n) {
+          appendToLogFile("\n", 1, rw.passSod, rw.passLevel, true);
+          rw.passthrough = false;
+          rw.lines++;
+        }
+        i = j + 1;
+        continue;
+      }
+      char c = (char)buf[i++];
+      if (c == '\n') {
+        if (rw.lineLen > 0) rewriteUnsyncedLine(true);
+      } else if (c != '\r') {
+        rw.line[rw.lineLen++] = c;
+        if (rw.lineLen == sizeof(rw.line)) rewriteUnsyncedLine(false);
+      }
+    }
+  }
+  logFile.flush();
+}
+
+// Starts rewriting the unsynced (uptime-based) log into today's dated log once time is synced.
+// The work itself is done in small slices from logLoop() so the clock keeps running.
+void logRewriteUnsynced() {
+  time_t now = time(nullptr);
+  // Only run if time is valid and the unsynced log exists
+  if (now < 1640995200 || unsyncedRewrite.active) return;
+  if (!FS_IMPL.exists(UNSYNCED_LOG_PATH)) return;
+
+  // Moves the sink off unsynced.log and onto today's file
+  ensureLogFile();
+  if (!fileSinkEnabled || !logFile || currentLogTag == "unsynced") return;
+
+  UnsyncedRewrite& rw = unsyncedRewrite;
+  rw.in = FS_IMPL.open(UNSYNCED_LOG_PATH, "r");
+  if (!rw.in) return;
+  // Approximate boot epoch from current epoch minus uptime (millis)
+  uint64_t nowMs = millis();
+  uint64_t nowEpochMs = ((uint64_t)now) * 1000ULL;
+  rw.bootEpochMs = (nowEpochMs > nowMs) ? (nowEpochMs - nowMs) : 0;
+  rw.lines = 0;
+  rw.lineLen = 0;
+  rw.passthrough = false;
+  rw.active = true;
 }
 
 #endif // PIO_UNIT_TESTING
@@ -1,7 +1,9 @@
 #pragma once
 #include <Arduino.h>
+#include <functional>
 // #include "network.h"  // For access to telnetClient
 #include "config.h"
+#include "log_format.h"
 
 #ifndef LOG_LEVEL_ENUM_DEFINED
 #define LOG_LEVEL_ENUM_DEFINED
@@ -24,6 +26,9 @@ void logln(String msg, int level = LOG_LEVEL_INFO);
 #define logWarn(msg)  logln(msg, LOG_LEVEL_WARN)
 #define logError(msg) logln(msg, LOG_LEVEL_ERROR)
 
+// Rate-limited variants for messages that repeat during outages (see log_throttle.h)
+#include "log_throttle.h"
+
 void setLogLevel(LogLevel level);
 void setLogRetentionDays(uint32_t days);
 uint32_t getLogRetentionDays();
@@ -36,3 +41,25 @@ void logCloseFile();
 void logFlushFile();
 String logLatestFilePath();
 void logRewriteUnsynced();
+// Background maintenance (archives finished daily logs as .log.gz); call from the main loop
+void logLoop();
+
+// Sequence-numbered access to the in-memory ring buffer.
+// Every record gets a monotonically increasing sequence number (starting at 1),
+// so clients can ask for "everything after N" instead of the whole buffer.
+uint32_t logLatestSeq();   // 0 when nothing has been logged yet
+uint32_t logOldestSeq();   // oldest record still held in the ring buffer
+size_t logForEachSince(uint32_t since, const std::function<void(uint32_t seq, const String& line)>& fn);
+
+// Server-side query of a log file on flash. Uses the sparse .idx written next to
+// each dated log to skip blocks that cannot match; emit() is called per matching
+// line (without the trailing newline). Returns the number of matches.
+struct LogQueryStats {
+  size_t matches;
+  uint32_t fileBytes;
+  uint32_t bytesScanned;
+  uint32_t blocksSkipped;
+};
+size_t logQueryFile(const String& path, const LogQuery& q, size_t limit,
+                    const std::function<void(const char* line, size_t len)>& emit,
+                    LogQueryStats* stats = nullptr);
@@ -0,0 +1,495 @@
+#include "log_codec.h"
+
+#include <new>
+#include <string.h>
+
+static const int WINDOW = LOG_CODEC_WINDOW;
+static const int BUF_SIZE = 2 * LOG_CODEC_WINDOW;
+static const int MIN_MATCH = 3;
+static const int MAX_MATCH = 258;
+static const int HASH_SIZE = 1024;
+static const int MAX_CHAIN = 16;
+
+static const uint16_t LENGTH_BASE[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t LENGTH_EXTRA[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t DIST_BASE[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t DIST_EXTRA[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+uint32_t logCrc32(uint32_t crc, const uint8_t* data, size_t len) {
+  // Nibble table: 64 bytes of flash instead of 1 KB
+  static const uint32_t TABLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C };
+  crc = ~crc;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ TABLE[crc & 0x0F];
+    crc = (crc >> 4) ^ TABLE[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+static inline int hash3(const uint8_t* p) {
+  return ((p[0] << 6) ^ (p[1] << 3) ^ p[2]) & (HASH_SIZE - 1);
+}
+
+// ---------------------------------------------------------------- deflate
+
+bool LogDeflater::begin(LogCodecWrite out, void* ctx, uint32_t mtime) {
+  release();
+  write_ = out;
+  ctx_ = ctx;
+  buf_ = new (std::nothrow) uint8_t[BUF_SIZE];
+  head_ = new (std::nothrow) int16_t[HASH_SIZE];
+  prev_ = new (std::nothrow) int16_t[WINDOW];
+  if (!buf_ || !head_ || !prev_) {
+    release();
+    return false;
+  }
+  outLen_ = 0;
+  bitBuf_ = 0;
+  bitCount_ = 0;
+  blockOpen_ = false;
+  failed_ = false;
+  crc_ = 0;
+  inBytes_ = 0;
+  outBytes_ = 0;
+  resetWindow();
+
+  const uint8_t header[10] = {
+    0x1F, 0x8B, 8, 0,
+    (uint8_t)mtime, (uint8_t)(mtime >> 8), (uint8_t)(mtime >> 16), (uint8_t)(mtime >> 24),
+    0, 3 };
+  for (uint8_t b : header) putByte(b);
+  return !failed_;
+}
+
+void LogDeflater::release() {
+  delete[] buf_;
+  delete[] head_;
+  delete[] prev_;
+  buf_ = nullptr;
+  head_ = nullptr;
+  prev_ = nullptr;
+}
+
+void LogDeflater::resetWindow() {
+  pos_ = 0;
+  end_ = 0;
+  for (int i = 0; i < HASH_SIZE; ++i) head_[i] = -1;
+  for (int i = 0; i < WINDOW; ++i) prev_[i] = -1;
+}
+
+void LogDeflater::slide() {
+  memmove(buf_, buf_ + WINDOW, end_ - WINDOW);
+  pos_ -= WINDOW;
+  end_ -= WINDOW;
+  for (int i = 0; i < HASH_SIZE; ++i) head_[i] = head_[i] >= WINDOW ? head_[i] - WINDOW : -1;
+  for (int i = 0; i < WINDOW; ++i) prev_[i] = prev_[i] >= WINDOW ? prev_[i] - WINDOW : -1;
+}
+
+bool LogDeflater::write(const uint8_t* data, size_t len) {
+  if (!buf_ || failed_) return false;
+  crc_ = logCrc32(crc_, data, len);
+  inBytes_ += len;
+  while (len > 0) {
+    size_t room = BUF_SIZE - end_;
+    size_t n = len < room ? len : room;
+    memcpy(buf_ + end_, data, n);
+    end_ += (int)n;
+    data += n;
+    len -= n;
+    compress(false);
+    if (end_ == BUF_SIZE) slide();
+  }
+  return !failed_;
+}
+
+void LogDeflater::compress(bool flush) {
+  while (pos_ < end_) {
+    int avail = end_ - pos_;
+    // Keep a full lookahead unless we are flushing
+    if (!flush && avail < MAX_MATCH) break;
+
+    int bestLen = 0;
+    int bestDist = 0;
+    if (avail >= MIN_MATCH) {
+      int maxLen = avail < MAX_MATCH ? avail : MAX_MATCH;
+      const uint8_t* cur = buf_ + pos_;
+      int h = hash3(cur);
+      int cand = head_[h];
+      int chain = MAX_CHAIN;
+      while (cand >= 0 && chain-- > 0) {
+        int dist = pos_ - cand;
+        if (dist > WINDOW) break;
+        const uint8_t* p = buf_ + cand;
+        if (p[bestLen] == cur[bestLen] && p[0] == cur[0]) {
+          int l = 0;
+          while (l < maxLen && p[l] == cur[l]) l++;
+          if (l > bestLen) {
+            bestLen = l;
+            bestDist = dist;
+            if (l == maxLen) break;
+          }
+        }
+        int next = prev_[cand & (WINDOW - 1)];
+        if (next >= cand) break;  // slot was reused by a newer position
+        cand = next;
+      }
+    }
+
+    int advance = 1;
+    if (bestLen >= MIN_MATCH) {
+      match(bestLen, bestDist);
+      advance = bestLen;
+    } else {
+      literal(buf_[pos_]);
+    }
+    // Index every position we step over so later matches can find it
+    for (int i = 0; i < advance; ++i, ++pos_) {
+      if (end_ - pos_ >= MIN_MATCH) {
+        int h = hash3(buf_ + pos_);
+        prev_[pos_ & (WINDOW - 1)] = head_[h];
+        head_[h] = (int16_t)pos_;
+      }
+    }
+  }
+}
+
+void LogDeflater::literal(uint8_t c) {
+  if (!blockOpen_) {
+    putBits(0, 1);  // BFINAL = 0
+    putBits(1, 2);  // BTYPE = fixed Huffman
+    blockOpen_ = true;
+  }
+  if (c < 144) {
+    putCode(0x30 + c, 8);
+  } else {
+    putCode(0x190 + (c - 144), 9);
+  }
+}
+
+void LogDeflater::match(int len, int dist) {
+  if (!blockOpen_) {
+    putBits(0, 1);
+    putBits(1, 2);
+    blockOpen_ = true;
+  }
+  int lc = 28;
+  while (LENGTH_BASE[lc] > len) lc--;
+  int sym = 257 + lc;
+  if (sym < 280) {
+    putCode(sym - 256, 7);
+  } else {
+    putCode(0xC0 + (sym - 280), 8);
+  }
+  if (LENGTH_EXTRA[lc]) putBits(len - LENGTH_BASE[lc], LENGTH_EXTRA[lc]);
+
+  int dc = 29;
+  while (DIST_BASE[dc] > dist) dc--;
+  putCode(dc, 5);
+  if (DIST_EXTRA[dc]) putBits(dist - DIST_BASE[dc], DIST_EXTRA[dc]);
+}
+
+void LogDeflater::endBlock() {
+  if (blockOpen_) {
+    putCode(0, 7);  // end-of-block
+    blockOpen_ = false;
+  }
+}
+
+bool LogDeflater::sync() {
+  if (!buf_ || failed_) return false;
+  compress(true);
+  endBlock();
+  // Empty stored block: byte-aligns the stream
+  putBits(0, 1);
+  putBits(0, 2);
+  alignToByte();
+  putByte(0x00);
+  putByte(0x00);
+  putByte(0xFF);
+  putByte(0xFF);
+  flushOut();
+  // No back-references across a sync point
+  resetWindow();
+  return !failed_;
+}
+
+bool LogDeflater::finish() {
+  if (!buf_ || failed_) {
+    release();
+    return false;
+  }
+  compress(true);
+  endBlock();
+  putBits(1, 1);  // final, empty fixed block
+  putBits(1, 2);
+  putCode(0, 7);
+  alignToByte();
+  for (int i = 0; i < 4; ++i) putByte((uint8_t)(crc_ >> (8 * i)));
+  for (int i = 0; i < 4; ++i) putByte((uint8_t)(inBytes_ >> (8 * i)));
+  flushOut();
+  release();
+  return !failed_;
+}
+
+void LogDeflater::putBits(uint32_t value, uint8_t count) {
+  bitBuf_ |= value << bitCount_;
+  bitCount_ += count;
+  while (bitCount_ >= 8) {
+    putByte((uint8_t)bitBuf_);
+    bitBuf_ >>= 8;
+    bitCount_ -= 8;
+  }
+}
+
+void LogDeflater::putCode(uint32_t code, uint8_t len) {
+  // Huffman codes are sent most significant bit first
+  uint32_t rev = 0;
+  for (uint8_t i = 0; i < len; ++i) {
+    rev = (rev << 1) | (code & 1);
+    code >>= 1;
+  }
+  putBits(rev, len);
+}
+
+void LogDeflater::alignToByte() {
+  if (bitCount_ > 0) {
+    putByte((uint8_t)bitBuf_);
+  }
+  bitBuf_ = 0;
+  bitCount_ = 0;
+}
+
+void LogDeflater::putByte(uint8_t b) {
+  out_[outLen_++] = b;
+  if (outLen_ == sizeof(out_)) flushOut();
+}
+
+void LogDeflater::flushOut() {
+  if (outLen_ == 0) return;
+  if (!failed_ && !write_(ctx_, out_, outLen_)) failed_ = true;
+  outBytes_ += (uint32_t)outLen_;
+  outLen_ = 0;
+}
+
+// ---------------------------------------------------------------- inflate
+
+void LogInflater::begin(LogCodecRead in, void* ctx, bool gzip, uint32_t startOffset) {
+  read_ = in;
+  ctx_ = ctx;
+  inLen_ = 0;
+  inPos_ = 0;
+  inOffset_ = startOffset;
+  limit_ = 0;
+  bitBuf_ = 0;
+  bitCount_ = 0;
+  eof_ = false;
+  gzip_ = gzip;
+  lastBlock_ = false;
+  verified_ = false;
+  state_ = gzip ? GZIP_HEADER : BLOCK_HEADER;
+  wpos_ = 0;
+  total_ = 0;
+  crc_ = 0;
+}
+
+int LogInflater::pullByte() {
+  if (inPos_ == inLen_) {
+    inLen_ = read_(ctx_, in_, sizeof(in_));
+    inPos_ = 0;
+    if (inLen_ == 0) {
+      eof_ = true;
+      return -1;
+    }
+  }
+  inOffset_++;
+  return in_[inPos_++];
+}
+
+uint32_t LogInflater::getBits(uint8_t n) {
+  while (bitCount_ < n) {
+    int c = pullByte();
+    if (c < 0) return 0;
+    bitBuf_ |= (uint32_t)c << bitCount_;
+    bitCount_ += 8;
+  }
+  uint32_t v = bitBuf_ & ((1UL << n) - 1);
+  bitBuf_ >>= n;
+  bitCount_ -= n;
+  return v;
+}
+
+int LogInflater::decodeLiteral() {
+  // Fixed code lengths: 7 bits (256-279), 8 bits (0-143, 280-287), 9 bits (144-255)
+  uint32_t code = 0;
+  for (int len = 1; len <= 9; ++len) {
+    code = (code << 1) | getBits(1);
+    if (eof_) return -1;
+    if (len == 7 && code <= 0x17) return 256 + (int)code;
+    if (len == 8) {
+      if (code >= 0x30 && code <= 0xBF) return (int)code - 0x30;
+      if (code >= 0xC0 && code <= 0xC7) return 280 + (int)code - 0xC0;
+    }
+    if (len == 9 && code >= 0x190) return 144 + (int)code - 0x190;
+  }
+  return -1;
+}
+
+bool LogInflater::readGzipHeader() {
+  uint8_t h[10];
+  for (int i = 0; i < 10; ++i) h[i] = (uint8_t)getBits(8);
+  if (eof_ || h[0] != 0x1F || h[1] != 0x8B || h[2] != 8) return false;
+  uint8_t flags = h[3];
+  if (flags & 0x04) {  // FEXTRA
+    uint32_t xlen = getBits(16);
+    while (xlen-- > 0 && !eof_) getBits(8);
+  }
+  if (flags & 0x08) {  // FNAME
+    while (!eof_ && getBits(8) != 0) {}
+  }
+  if (flags & 0x10) {  // FCOMMENT
+    while (!eof_ && getBits(8) != 0) {}
+  }
+  if (flags & 0x02) getBits(16);  // FHCRC
+  return !eof_;
+}
+
+int LogInflater::read(uint8_t* out, size_t len) {
+  size_t produced = 0;
+  while (produced < len) {
+    switch (state_) {
+      case GZIP_HEADER:
+        state_ = readGzipHeader() ? BLOCK_HEADER : FAILED;
+        break;
+
+      case BLOCK_HEADER: {
+        if (lastBlock_) {
+          state_ = gzip_ ? TRAILER : DONE;
+          break;
+        }
+        // Sync points are byte aligned, so no bits of the next byte are buffered there
+        if (limit_ && bitCount_ == 0 && inOffset_ >= limit_) {
+          state_ = DONE;
+          break;
+        }
+        lastBlock_ = getBits(1) != 0;
+        uint32_t type = getBits(2);
+        if (eof_) {
+          state_ = FAILED;
+        } else if (type == 0) {
+          // Stored: skip to the byte boundary, then LEN / NLEN
+          bitBuf_ = 0;
+          bitCount_ = 0;
+          uint32_t l = getBits(16);
+          uint32_t nl = getBits(16);
+          if (eof_ || (l ^ 0xFFFF) != nl) {
+            state_ = FAILED;
+          } else {
+            storedLeft_ = (uint16_t)l;
+            state_ = STORED;
+          }
+        } else if (type == 1) {
+          state_ = FIXED;
+        } else {
+          state_ = FAILED;  // dynamic Huffman is not supported
+        }
+        break;
+      }
+
+      case STORED:
+        while (storedLeft_ > 0 && produced < len) {
+          uint8_t b = (uint8_t)getBits(8);
+          if (eof_) break;
+          out[produced++] = b;
+          window_[wpos_] = b;
+          wpos_ = (wpos_ + 1) & (LOG_CODEC_WINDOW - 1);
+          total_++;
+          storedLeft_--;
+        }
+        if (eof_) state_ = FAILED;
+        else if (storedLeft_ == 0) state_ = BLOCK_HEADER;
+        break;
+
+      case FIXED: {
+        int sym = decodeLiteral();
+        if (sym < 0) {
+          state_ = FAILED;
+        } else if (sym < 256) {
+          out[produced++] = (uint8_t)sym;
+          window_[wpos_] = (uint8_t)sym;
+          wpos_ = (wpos_ + 1) & (LOG_CODEC_WINDOW - 1);
+          total_++;
+        } else if (sym == 256) {
+          state_ = BLOCK_HEADER;
+        } else if (sym > 285) {
+          state_ = FAILED;
+        } else {
+          int lc = sym - 257;
+          copyLen_ = LENGTH_BASE[lc] + (uint16_t)getBits(LENGTH_EXTRA[lc]);
+          uint32_t dc = 0;
+          for (int i = 0; i < 5; ++i) dc = (dc << 1) | getBits(1);
+          if (dc > 29) {
+            state_ = FAILED;
+            break;
+          }
+          uint32_t dist = DIST_BASE[dc] + getBits(DIST_EXTRA[dc]);
+          if (eof_ || dist > LOG_CODEC_WINDOW || dist > total_) {
+            state_ = FAILED;
+          } else {
+            copyDist_ = (uint16_t)dist;
+            state_ = COPY;
+          }
+        }
+        break;
+      }
+
+      case COPY:
+        while (copyLen_ > 0 && produced < len) {
+          uint8_t b = window_[(wpos_ - copyDist_) & (LOG_CODEC_WINDOW - 1)];
+          out[produced++] = b;
+          window_[wpos_] = b;
+          wpos_ = (wpos_ + 1) & (LOG_CODEC_WINDOW - 1);
+          total_++;
+          copyLen_--;
+        }
+        if (copyLen_ == 0) state_ = FIXED;
+        break;
+
+      case TRAILER: {
+        crc_ = logCrc32(crc_, out, produced);
+        bitBuf_ = 0;
+        bitCount_ = 0;
+        uint32_t crc = getBits(16);
+        crc |= getBits(16) << 16;
+        uint32_t isize = getBits(16);
+        isize |= getBits(16) << 16;
+        verified_ = !eof_ && crc == crc_ && isize == total_;
+        state_ = DONE;
+        return (int)produced;
+      }
+
+      case DONE:
+        if (gzip_) crc_ = logCrc32(crc_, out, produced);
+        return (int)produced;
+
+      case FAILED:
+        if (produced > 0) {
+          if (gzip_) crc_ = logCrc32(crc_, out, produced);
+          return (int)produced;
+        }
+        return -1;
+    }
+  }
+  if (gzip_) crc_ = logCrc32(crc_, out, produced);
+  return (int)produced;
+}
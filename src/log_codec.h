@@ -0,0 +1,153 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Minimal streaming gzip codec for archived log files.
+//
+// The deflater does LZ77 over a small sliding window and emits fixed-Huffman
+// blocks only, which keeps its RAM use to ~10 KB while it runs and makes the
+// output readable by any gzip tool or browser. The inflater understands
+// stored and fixed-Huffman blocks with back-references up to
+// LOG_CODEC_WINDOW bytes: everything our own deflater (or `zlib` with
+// Z_FIXED and a matching window) produces.
+//
+// sync() ends the current block with an empty stored block and forgets the
+// window, so decompression can start at the returned offset. The log seek
+// index uses this to keep working on compressed archives.
+
+#define LOG_CODEC_WINDOW 2048
+
+/** @brief CRC-32 (gzip polynomial); start with crc = 0 */
+uint32_t logCrc32(uint32_t crc, const uint8_t* data, size_t len);
+
+/** @brief Output callback; return false to abort */
+typedef bool (*LogCodecWrite)(void* ctx, const uint8_t* data, size_t len);
+/** @brief Input callback; returns bytes read, 0 at end of input */
+typedef size_t (*LogCodecRead)(void* ctx, uint8_t* data, size_t len);
+
+/**
+ * @brief Streaming gzip compressor with a LOG_CODEC_WINDOW byte window
+ */
+class LogDeflater {
+public:
+  LogDeflater() {}
+  ~LogDeflater() { release(); }
+
+  /**
+   * @brief Allocate buffers and write the gzip header
+   * @return false when memory could not be allocated or the write failed
+   */
+  bool begin(LogCodecWrite out, void* ctx, uint32_t mtime = 0);
+
+  /** @brief Compress more input */
+  bool write(const uint8_t* data, size_t len);
+
+  /**
+   * @brief Emit all pending input and a sync point
+   * @note After this, offset() is a position where inflation can restart
+   */
+  bool sync();
+
+  /** @brief Write the final block and gzip trailer, then free the buffers */
+  bool finish();
+
+  /** @brief Compressed bytes produced so far */
+  uint32_t offset() const { return outBytes_ + (uint32_t)outLen_; }
+
+  /** @brief Uncompressed bytes consumed so far */
+  uint32_t inputBytes() const { return inBytes_; }
+
+private:
+  LogDeflater(const LogDeflater&) = delete;
+  LogDeflater& operator=(const LogDeflater&) = delete;
+
+  void release();
+  void compress(bool flush);
+  void slide();
+  void resetWindow();
+  void literal(uint8_t c);
+  void match(int len, int dist);
+  void endBlock();
+  void putBits(uint32_t value, uint8_t count);
+  void putCode(uint32_t code, uint8_t len);
+  void putByte(uint8_t b);
+  void alignToByte();
+  void flushOut();
+
+  LogCodecWrite write_ = nullptr;
+  void* ctx_ = nullptr;
+  uint8_t* buf_ = nullptr;     // 2 * LOG_CODEC_WINDOW: history + lookahead
+  int16_t* head_ = nullptr;    // hash -> most recent position
+  int16_t* prev_ = nullptr;    // position -> previous position with same hash
+  int pos_ = 0;
+  int end_ = 0;
+  uint8_t out_[128];
+  size_t outLen_ = 0;
+  uint32_t bitBuf_ = 0;
+  uint8_t bitCount_ = 0;
+  bool blockOpen_ = false;
+  bool failed_ = false;
+  uint32_t crc_ = 0;
+  uint32_t inBytes_ = 0;
+  uint32_t outBytes_ = 0;
+};
+
+/**
+ * @brief Pull-style decompressor for stored and fixed-Huffman deflate streams
+ */
+class LogInflater {
+public:
+  /**
+   * @brief Start decoding
+   * @param gzip true to parse the gzip header/trailer, false for a raw deflate
+   *        stream starting at a sync point
+   * @param startOffset Position of the first input byte (for inputOffset())
+   */
+  void begin(LogCodecRead in, void* ctx, bool gzip, uint32_t startOffset = 0);
+
+  /** @brief Stop at the first block boundary at or after this input offset */
+  void setLimit(uint32_t offset) { limit_ = offset; }
+
+  /**
+   * @brief Decompress up to @p len bytes
+   * @return bytes produced, 0 at the end of the stream (or limit), -1 on corrupt input
+   */
+  int read(uint8_t* out, size_t len);
+
+  /** @brief Input bytes consumed, including startOffset */
+  uint32_t inputOffset() const { return inOffset_; }
+
+  /** @brief True once a gzip trailer was read and CRC and length matched */
+  bool verified() const { return verified_; }
+
+private:
+  enum State : uint8_t { GZIP_HEADER, BLOCK_HEADER, STORED, FIXED, COPY, TRAILER, DONE, FAILED };
+
+  uint32_t getBits(uint8_t n);
+  int pullByte();
+  int decodeLiteral();
+  bool readGzipHeader();
+
+  LogCodecRead read_ = nullptr;
+  void* ctx_ = nullptr;
+  uint8_t in_[128];
+  size_t inLen_ = 0;
+  size_t inPos_ = 0;
+  uint32_t inOffset_ = 0;
+  uint32_t limit_ = 0;
+  uint32_t bitBuf_ = 0;
+  uint8_t bitCount_ = 0;
+  bool eof_ = false;
+  bool gzip_ = false;
+  bool lastBlock_ = false;
+  bool verified_ = false;
+  State state_ = DONE;
+  uint16_t storedLeft_ = 0;
+  uint16_t copyLen_ = 0;
+  uint16_t copyDist_ = 0;
+  uint8_t window_[LOG_CODEC_WINDOW];
+  uint16_t wpos_ = 0;
+  uint32_t total_ = 0;
+  uint32_t crc_ = 0;
+};
@@ -0,0 +1,173 @@
+#include "log_format.h"
+
+#include <ctype.h>
+#include <string.h>
+
+// Same order as the LogLevel enum in log.h
+static const char* const LEVEL_TAGS[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+static const int LEVEL_COUNT = sizeof(LEVEL_TAGS) / sizeof(LEVEL_TAGS[0]);
+
+static bool parseDigits(const char* p, int count, uint32_t& value) {
+  value = 0;
+  for (int i = 0; i < count; ++i) {
+    if (!isdigit((unsigned char)p[i])) return false;
+    value = value * 10 + (uint32_t)(p[i] - '0');
+  }
+  return true;
+}
+
+int logLevelFromTag(const char* tag, size_t len) {
+  for (int i = 0; i < LEVEL_COUNT; ++i) {
+    if (strlen(LEVEL_TAGS[i]) != len) continue;
+    bool same = true;
+    for (size_t c = 0; c < len; ++c) {
+      if (toupper((unsigned char)tag[c]) != LEVEL_TAGS[i][c]) {
+        same = false;
+        break;
+      }
+    }
+    if (same) return i;
+  }
+  return -1;
+}
+
+bool logParseLine(const char* line, size_t len, LogLineInfo& out) {
+  out.sod = LOG_SOD_INVALID;
+  out.level = -1;
+  if (len < 2 || line[0] != '[') return false;
+
+  const char* close = (const char*)memchr(line, ']', len);
+  if (!close) return false;
+  // "[YYYY-MM-DD HH:MM:SS" — the hour starts at offset 12
+  if ((size_t)(close - line) >= 20 && line[11] == ' ' && line[14] == ':' && line[17] == ':') {
+    uint32_t h, m, s;
+    if (parseDigits(line + 12, 2, h) && parseDigits(line + 15, 2, m) && parseDigits(line + 18, 2, s) &&
+        h < 24 && m < 60 && s < 60) {
+      out.sod = h * 3600 + m * 60 + s;
+    }
+  } else if (strncmp(line, "[uptime ", 8) != 0) {
+    return false;
+  }
+
+  const char* lvl = close + 1;
+  const char* endp = line + len;
+  if (lvl >= endp || *lvl != '[') return false;
+  lvl++;
+  const char* lvlEnd = (const char*)memchr(lvl, ']', endp - lvl);
+  if (!lvlEnd) return false;
+  out.level = logLevelFromTag(lvl, lvlEnd - lvl);
+  return out.level >= 0;
+}
+
+bool logParseUptimePrefix(const char* line, size_t len, LogUptimePrefix& out) {
+  // [uptime %lu.%03lus][LEVEL] message
+  if (len < 8 || strncmp(line, "[uptime ", 8) != 0) return false;
+  size_t i = 8;
+  uint32_t sec = 0;
+  size_t digits = 0;
+  while (i < len && isdigit((unsigned char)line[i]) && digits < 10) {
+    sec = sec * 10 + (uint32_t)(line[i] - '0');
+    i++;
+    digits++;
+  }
+  if (digits == 0 || i + 4 > len || line[i] != '.') return false;
+  uint32_t ms;
+  if (!parseDigits(line + i + 1, 3, ms)) return false;
+  i += 4;
+  if (i + 3 > len || line[i] != 's' || line[i + 1] != ']' || line[i + 2] != '[') return false;
+  i += 3;
+  const char* lvlEnd = (const char*)memchr(line + i, ']', len - i);
+  if (!lvlEnd) return false;
+  out.seconds = sec;
+  out.millis = (uint16_t)ms;
+  out.levelStart = i;
+  out.levelLen = (size_t)(lvlEnd - (line + i));
+  size_t msg = (size_t)(lvlEnd - line) + 1;
+  if (msg < len && line[msg] == ' ') msg++;
+  out.msgOffset = msg;
+  return true;
+}
+
+bool logParseClock(const char* text, uint32_t& sod) {
+  if (!text) return false;
+  size_t len = strlen(text);
+  if (len != 5 && len != 8) return false;
+  uint32_t h, m, s = 0;
+  if (!parseDigits(text, 2, h) || text[2] != ':' || !parseDigits(text + 3, 2, m)) return false;
+  if (len == 8 && (text[5] != ':' || !parseDigits(text + 6, 2, s))) return false;
+  if (h > 23 || m > 59 || s > 59) return false;
+  sod = h * 3600 + m * 60 + s;
+  return true;
+}
+
+static bool containsIgnoreCase(const char* hay, size_t len, const char* needle) {
+  size_t n = strlen(needle);
+  if (n == 0) return true;
+  if (n > len) return false;
+  for (size_t i = 0; i + n <= len; ++i) {
+    size_t k = 0;
+    while (k < n && tolower((unsigned char)hay[i + k]) == tolower((unsigned char)needle[k])) k++;
+    if (k == n) return true;
+  }
+  return false;
+}
+
+static bool hasTimeRange(const LogQuery& q) {
+  return q.fromSod > 0 || q.toSod < 86399;
+}
+
+bool logLineMatches(const char* line, size_t len, const LogLineInfo& info, const LogQuery& q) {
+  if (info.level >= 0 && info.level < q.minLevel) return false;
+  if (info.level < 0 && q.minLevel > 0) return false;
+  if (hasTimeRange(q)) {
+    if (info.sod == LOG_SOD_INVALID) return false;
+    if (info.sod < q.fromSod || info.sod > q.toSod) return false;
+  }
+  if (q.needle && !containsIgnoreCase(line, len, q.needle)) return false;
+  return true;
+}
+
+bool logBlockMayMatch(const LogIndexEntry& e, const LogQuery& q) {
+  // Levels at or above the requested minimum
+  uint8_t wanted = (uint8_t)(0xFF << (q.minLevel > 0 ? q.minLevel : 0));
+  if ((e.levelMask & wanted) == 0) return false;
+  if (hasTimeRange(q)) {
+    if (e.maxSod < q.fromSod || e.minSod > q.toSod) return false;
+  }
+  return true;
+}
+
+void LogIndexBuilder::reset(uint32_t offset) {
+  offset_ = offset;
+  lines_ = 0;
+  open_ = false;
+  atLineStart_ = true;
+}
+
+bool LogIndexBuilder::add(uint32_t len, uint32_t sod, int level, bool endsLine, LogIndexEntry& out) {
+  if (!open_ && atLineStart_) {
+    block_ = {};
+    block_.start = offset_;
+    block_.minSod = LOG_SOD_INVALID;
+    open_ = true;
+  }
+  offset_ += len;
+  atLineStart_ = endsLine;
+  if (!open_) return false;
+
+  if (sod != LOG_SOD_INVALID) {
+    if (block_.minSod == LOG_SOD_INVALID || sod < block_.minSod) block_.minSod = sod;
+    if (sod > block_.maxSod) block_.maxSod = sod;
+  }
+  if (level >= 0 && level < 8) block_.levelMask |= (uint8_t)(1u << level);
+  if (endsLine) lines_++;
+
+  if (endsLine && lines_ >= LOG_INDEX_BLOCK_RECORDS) {
+    block_.end = offset_;
+    out = block_;
+    open_ = false;
+    lines_ = 0;
+    return true;
+  }
+  return false;
+}
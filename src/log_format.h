@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Helpers for the on-disk log format and its sparse seek index.
+//
+// Dated log lines look like "[YYYY-MM-DD HH:MM:SS.mmm TZ][LEVEL] message".
+// Next to every /logs/<date>.log a <date>.idx file holds one LogIndexEntry per
+// block of LOG_INDEX_BLOCK_RECORDS lines, so a query can skip whole blocks
+// that cannot match instead of reading the full file over SPIFFS.
+// Everything here is plain C data so it can be unit tested on the host.
+// Blocks with no timestamps (uptime lines) keep minSod = LOG_SOD_INVALID.
+
+#define LOG_INDEX_BLOCK_RECORDS 64
+#define LOG_SOD_INVALID 0xFFFFFFFFUL
+
+/**
+ * @brief One indexed block of a log file: byte range plus what it contains
+ * @note Stored verbatim in the .idx file (little-endian, 20 bytes)
+ */
+struct LogIndexEntry {
+  uint32_t start;      // Offset of the first line of the block
+  uint32_t end;        // Offset just past the last line of the block
+  uint32_t minSod;     // Earliest seconds-of-day in the block
+  uint32_t maxSod;     // Latest seconds-of-day in the block
+  uint8_t levelMask;   // Bit n set when the block has a line of level n
+  uint8_t reserved[3];
+};
+
+/**
+ * @brief Parsed prefix of a single log line
+ */
+struct LogLineInfo {
+  uint32_t sod;        // Seconds since local midnight, LOG_SOD_INVALID for uptime lines
+  int level;           // LOG_LEVEL_*, or -1 when the prefix is not recognised
+};
+
+/**
+ * @brief Fields of an "[uptime S.mmms][LEVEL] " prefix (written before NTP sync)
+ * @note Positions are offsets into the parsed line, so no copies are made
+ */
+struct LogUptimePrefix {
+  uint32_t seconds;
+  uint16_t millis;
+  size_t levelStart;
+  size_t levelLen;
+  size_t msgOffset;   // First byte of the message after "] "
+};
+
+/**
+ * @brief Filter for a log query; unset fields match everything
+ */
+struct LogQuery {
+  int minLevel = 0;
+  uint32_t fromSod = 0;
+  uint32_t toSod = 86399;
+  const char* needle = nullptr;   // Case-insensitive substring, nullptr/"" = any
+};
+
+/**
+ * @brief Map a level tag ("DEBUG", "INFO", ...) to its LOG_LEVEL_* value
+ * @return -1 when the tag is unknown
+ */
+int logLevelFromTag(const char* tag, size_t len);
+
+/**
+ * @brief Parse the "[date time][LEVEL] " or "[uptime ...][LEVEL] " line prefix
+ * @return false when the line has no recognisable prefix
+ */
+bool logParseLine(const char* line, size_t len, LogLineInfo& out);
+
+/**
+ * @brief Parse the uptime prefix of an unsynced log line
+ * @return false when the line does not start with "[uptime "
+ */
+bool logParseUptimePrefix(const char* line, size_t len, LogUptimePrefix& out);
+
+/**
+ * @brief Parse a "HH:MM" or "HH:MM:SS" query argument into seconds-of-day
+ * @return false on malformed input
+ */
+bool logParseClock(const char* text, uint32_t& sod);
+
+/**
+ * @brief Check a single parsed line against a query
+ * @note Lines without a timestamp only pass when the query has no time range
+ */
+bool logLineMatches(const char* line, size_t len, const LogLineInfo& info, const LogQuery& q);
+
+/**
+ * @brief Check whether an indexed block can contain matching lines
+ */
+bool logBlockMayMatch(const LogIndexEntry& e, const LogQuery& q);
+
+/**
+ * @brief Accumulates written lines into index blocks
+ *
+ * Feed every write to the log file through add(); when a block of
+ * LOG_INDEX_BLOCK_RECORDS complete lines has been collected it is returned
+ * for appending to the .idx file.
+ */
+class LogIndexBuilder {
+public:
+  /** @brief Start over at the given file offset (file (re)opened) */
+  void reset(uint32_t offset);
+
+  /**
+   * @brief Account for one write to the log file
+   * @param len Bytes written
+   * @param sod Seconds-of-day of the record
+   * @param level Record level
+   * @param endsLine true when the write ended with a newline
+   * @return true when a block was completed and stored in @p out
+   */
+  bool add(uint32_t len, uint32_t sod, int level, bool endsLine, LogIndexEntry& out);
+
+  uint32_t offset() const { return offset_; }
+
+  /** @brief False while the last write left a line unfinished */
+  bool atLineStart() const { return atLineStart_; }
+
+private:
+  uint32_t offset_ = 0;
+  LogIndexEntry block_ = {};
+  uint16_t lines_ = 0;
+  bool open_ = false;
+  bool atLineStart_ = true;
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Helpers that keep noisy, repeating log messages from flooding the log file.
+//
+// LogRepeatFilter collapses identical consecutive records into a single
+// "repeated N times" record (used inside log()).
+// LogRateLimiter is a token bucket for one call site; use it through the
+// logWarnLimited()/logInfoLimited() macros, which only build the message
+// String when the record will actually be written.
+
+/**
+ * @brief Token bucket: @p burst records at once, then one per @p refillMs
+ */
+class LogRateLimiter {
+public:
+  LogRateLimiter(uint8_t burst, uint32_t refillMs)
+    : tokens_(burst), burst_(burst), refillMs_(refillMs) {}
+
+  /**
+   * @brief Take a token if one is available
+   * @param now Current millis()
+   * @return false when the record should be dropped (counted as suppressed)
+   */
+  bool allow(unsigned long now) {
+    if (!started_) {
+      started_ = true;
+      lastRefillMs_ = now;
+    }
+    unsigned long elapsed = now - lastRefillMs_;
+    if (refillMs_ > 0 && elapsed >= refillMs_) {
+      unsigned long add = elapsed / refillMs_;
+      lastRefillMs_ += add * refillMs_;
+      tokens_ = (tokens_ + add >= burst_) ? burst_ : (uint8_t)(tokens_ + add);
+    }
+    if (tokens_ == burst_) {
+      // A full bucket does not bank time
+      lastRefillMs_ = now;
+    }
+    if (tokens_ == 0) {
+      if (suppressed_ < UINT32_MAX) suppressed_++;
+      return false;
+    }
+    tokens_--;
+    return true;
+  }
+
+  /** @brief Number of records dropped since the last call (and reset it) */
+  uint32_t takeSuppressed() {
+    uint32_t n = suppressed_;
+    suppressed_ = 0;
+    return n;
+  }
+
+private:
+  uint8_t tokens_;
+  uint8_t burst_;
+  uint32_t refillMs_;
+  unsigned long lastRefillMs_ = 0;
+  uint32_t suppressed_ = 0;
+  bool started_ = false;
+};
+
+/**
+ * @brief Detects a record identical to the previous one
+ *
+ * Only a hash of the last message is kept, so no copy of the String is held.
+ * Partial lines (no trailing newline) are never collapsed.
+ */
+class LogRepeatFilter {
+public:
+  /**
+   * @brief Check a record before it is written
+   * @return true when it repeats the previous record and should be dropped
+   */
+  bool check(const char* msg, size_t len, int level) {
+    bool completeLine = len > 0 && msg[len - 1] == '\n';
+    uint32_t hash = completeLine ? hashOf(msg, len, level) : 0;
+    if (completeLine && valid_ && hash == lastHash_ && len == lastLen_) {
+      if (repeats_ < UINT32_MAX) repeats_++;
+      return true;
+    }
+    // A different record ends the run; hand its count to takeCollapsed()
+    if (repeats_ > 0) {
+      collapsed_ = repeats_;
+      collapsedLevel_ = lastLevel_;
+      repeats_ = 0;
+    }
+    valid_ = completeLine;
+    lastHash_ = hash;
+    lastLen_ = len;
+    lastLevel_ = level;
+    return false;
+  }
+
+  /** @brief Repeats of the run that check() just ended (0 = none) */
+  uint32_t takeCollapsed(int& level) {
+    uint32_t n = collapsed_;
+    level = collapsedLevel_;
+    collapsed_ = 0;
+    return n;
+  }
+
+  /** @brief Repeats counted so far in the current run; counting starts over */
+  uint32_t takePending(int& level) {
+    uint32_t n = repeats_;
+    level = lastLevel_;
+    repeats_ = 0;
+    return n;
+  }
+
+private:
+  static uint32_t hashOf(const char* msg, size_t len, int level) {
+    // FNV-1a
+    uint32_t h = 2166136261u ^ (uint32_t)level;
+    for (size_t i = 0; i < len; ++i) {
+      h ^= (uint8_t)msg[i];
+      h *= 16777619u;
+    }
+    return h;
+  }
+
+  uint32_t lastHash_ = 0;
+  size_t lastLen_ = 0;
+  int lastLevel_ = 0;
+  uint32_t repeats_ = 0;
+  uint32_t collapsed_ = 0;
+  int collapsedLevel_ = 0;
+  bool valid_ = false;
+};
+
+// Per-call-site rate limit. The message expression is only evaluated when the
+// record passes both the level filter and the bucket; the number of dropped
+// records is appended to the next one that gets through.
+#ifndef LOG_LIMIT_BURST
+#define LOG_LIMIT_BURST 3
+#endif
+#ifndef LOG_LIMIT_REFILL_MS
+#define LOG_LIMIT_REFILL_MS 300000UL  // one record per 5 minutes after the burst
+#endif
+
+#define logLimited(level, burst, refillMs, msg) do { \
+    static LogRateLimiter _logLimiter((burst), (refillMs)); \
+    if ((level) >= LOG_LEVEL && _logLimiter.allow(millis())) { \
+      uint32_t _logSkipped = _logLimiter.takeSuppressed(); \
+      if (_logSkipped) { \
+        logln(String(msg) + " (" + String(_logSkipped) + " similar suppressed)", (level)); \
+      } else { \
+        logln(msg, (level)); \
+      } \
+    } \
+  } while (0)
+
+#define logInfoLimited(msg) logLimited(LOG_LEVEL_INFO, LOG_LIMIT_BURST, LOG_LIMIT_REFILL_MS, msg)
+#define logWarnLimited(msg) logLimited(LOG_LEVEL_WARN, LOG_LIMIT_BURST, LOG_LIMIT_REFILL_MS, msg)
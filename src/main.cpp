@@ -22,6 +22,7 @@
 #include <WebServer.h>
 #include "wordclock.h"
 #include "web_routes.h"
+#include "instrumented_web_server.h"
 #include "network_init.h"
 #include "log.h"
 #include "config.h"
@@ -36,6 +37,8 @@
 #include "led_state.h"
 #include "settings_migration.h"
 #include "system_utils.h"
+#include "state_events.h"
+#include "perf_stats.h"
 
 
 bool clockEnabled = true;
@@ -50,7 +53,7 @@ static bool g_serverInitialized = false;
 
 
 // Webserver
-WebServer server(80);
+InstrumentedWebServer server(80);
 
 // Tracking (handled inside loop as statics)
 
@@ -145,6 +148,7 @@ void setup() {
 
 // Loop: hoofdprogramma, verwerkt webrequests, OTA, MQTT en kloklogica
 void loop() {
+  perfStats().loopTick(micros());
   processNetwork();
   if (isWiFiConnected() && !g_serverInitialized) {
     initWebServer(server);
@@ -174,9 +178,12 @@ void loop() {
   }
   if (g_serverInitialized) {
     server.handleClient();
+    webRoutesLoop();
   }
   ArduinoOTA.handle();
   mqttEventLoop();
+  stateEventsLoop();
+  logLoop();
 
   // Periodic settings flush (every ~1 second)
   static unsigned long lastSettingsFlush = 0;
@@ -1,12 +1,17 @@
 #include "mqtt_client.h"
 #include "mqtt_command_handler.h"
 #include "mqtt_discovery_builder.h"
+#include "mqtt_topics.h"
+#include "mqtt_outbox.h"
+#include "mqtt_transport.h"
+#include "fixed_arena.h"
 #include <WiFi.h>
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
 #include "config.h"
 #include "display_settings.h"
 #include "led_state.h"
+#include "light_fader.h"
 #include "log.h"
 #include "ota_updater.h"
 #include "wordclock.h"
@@ -14,47 +19,44 @@
 #include "sequence_controller.h"
 #include "mqtt_settings.h"
 #include <esp_system.h>
-#include <Preferences.h>
+#include <esp_heap_caps.h>
+#include "counted_preferences.h"
 #include "night_mode.h"
+#include "perf_stats.h"
 #include "system_utils.h"
+#include "state_events.h"
+#include "state_dirty.h"
 
 extern DisplaySettings displaySettings;
 extern bool clockEnabled;
 extern StartupSequence startupSequence;
 
-static WiFiClient espClient;
-static PubSubClient mqtt(espClient);
+static MqttTransport transport;
+static PubSubClient mqtt(transport);
 
 static String uniqId;
 static MqttSettings g_mqttCfg;
-static String base;         // e.g., MQTT_BASE_TOPIC
-static String availTopic;   // base + "/availability"
-static String tBirth;
+static MqttTopics g_topics;  // base from g_mqttCfg.baseTopic
 static bool g_connected = false;
-static String g_lastErr;
 
-// Topics
-static String tLightState, tLightSet;
-static String tClockState, tClockSet;
-static String tAnimState, tAnimSet;
-static String tAutoUpdState, tAutoUpdSet;
-static String tHetIsState, tHetIsSet;
-static String tLogLvlState, tLogLvlSet;
-static String tRestartCmd, tSeqCmd, tUpdateCmd;
-static String tNightEnabledState, tNightEnabledSet;
-static String tNightOverrideState, tNightOverrideSet;
-static String tNightActiveState;
-static String tNightEffectState, tNightEffectSet;
-static String tNightDimState, tNightDimSet;
-static String tNightStartState, tNightStartSet;
-static String tNightEndState, tNightEndSet;
-static String tVersion, tUiVersion, tIp, tRssi, tUptime;
-static String tHeap, tWifiChan, tBootReason, tResetCount;
-static String tUpdateChannelState, tUpdateAutoAllowed, tUpdateAvailable;
+// Connection set-up is a state machine that mqtt_loop() advances a step at
+// a time, so an unreachable broker never stalls the display
+enum class MqttPhase : uint8_t {
+  Idle,        // Waiting for the next attempt (reconnectDelayMs)
+  Transport,   // Resolving the broker and opening TCP
+  Handshake,   // CONNECT sent, waiting for CONNACK
+  Subscribe,   // SUBSCRIBE_PER_LOOP topics per pass
+  Online,
+};
+static MqttPhase g_phase = MqttPhase::Idle;
+static size_t g_subscribeNext = 0;
+static const size_t SUBSCRIBE_PER_LOOP = 4;
+static bool g_discoveryPending = false;  // Home Assistant (re)started
+static String g_lastErr;
 
 static unsigned long lastReconnectAttempt = 0;
-static unsigned long lastStateAt = 0;
-static const unsigned long STATE_INTERVAL_MS = 30000; // 30s
+static unsigned long lastDiagAt = 0;
+static const unsigned long DIAG_INTERVAL_MS = 120000; // RSSI, heap, IP, channel, perf
 static const unsigned long RECONNECT_DELAY_MIN_MS = 2000;
 static const unsigned long RECONNECT_DELAY_MAX_MS = 60000;
 static unsigned long reconnectDelayMs = RECONNECT_DELAY_MIN_MS;
@@ -62,126 +64,174 @@ static uint8_t reconnectAttempts = 0;
 static bool reconnectAborted = false;
 
 static void buildTopics() {
-  base = g_mqttCfg.baseTopic;
-  availTopic = base + "/availability";
-  tBirth        = base + "/birth";
-  tLightState   = base + "/light/state";
-  tLightSet     = base + "/light/set";
-  tClockState   = base + "/clock/state";
-  tClockSet     = base + "/clock/set";
-  tAnimState    = base + "/animate/state";
-  tAnimSet      = base + "/animate/set";
-  tAutoUpdState = base + "/autoupdate/state";
-  tAutoUpdSet   = base + "/autoupdate/set";
-  tHetIsState   = base + "/hetis/state";
-  tHetIsSet     = base + "/hetis/set";
-  tNightEnabledState = base + "/nightmode/enabled/state";
-  tNightEnabledSet   = base + "/nightmode/enabled/set";
-  tNightOverrideState = base + "/nightmode/override/state";
-  tNightOverrideSet   = base + "/nightmode/override/set";
-  tNightActiveState   = base + "/nightmode/active";
-  tNightEffectState = base + "/nightmode/effect/state";
-  tNightEffectSet   = base + "/nightmode/effect/set";
-  tNightDimState    = base + "/nightmode/dim/state";
-  tNightDimSet      = base + "/nightmode/dim/set";
-  tNightStartState  = base + "/nightmode/start/state";
-  tNightStartSet    = base + "/nightmode/start/set";
-  tNightEndState    = base + "/nightmode/end/state";
-  tNightEndSet      = base + "/nightmode/end/set";
-  tLogLvlState  = base + "/loglevel/state";
-  tLogLvlSet    = base + "/loglevel/set";
-  tRestartCmd   = base + "/restart/press";
-  tSeqCmd       = base + "/sequence/press";
-  tUpdateCmd    = base + "/update/press";
-  tVersion      = base + "/version";
-  tUiVersion    = base + "/uiversion";
-  tIp           = base + "/ip";
-  tRssi         = base + "/rssi";
-  tUptime       = base + "/laststartup";
-  tHeap         = base + "/heap";
-  tWifiChan     = base + "/wifi_channel";
-  tBootReason   = base + "/boot_reason";
-  tResetCount   = base + "/reset_count";
-  tUpdateChannelState = base + "/update/channel";
-  tUpdateAutoAllowed  = base + "/update/auto_allowed";
-  tUpdateAvailable    = base + "/update/available";
-}
-
-static void publishDiscovery() {
-  String nodeId = uniqId;
-  
-  MqttDiscoveryBuilder builder(mqtt, g_mqttCfg.discoveryPrefix, 
-                               nodeId, base, availTopic);
-  
-  // Set device information
-  builder.setDeviceInfo(CLOCK_NAME, "Chronolett Wordclock", "Lumetric", FIRMWARE_VERSION);
+  if (!g_topics.setBase(g_mqttCfg.baseTopic.c_str())) {
+    logWarn(String("MQTT base topic longer than ") + MQTT_TOPIC_BASE_MAX + " characters, truncated");
+  }
+}
+
+// Owned copy of a topic, for callers that keep it or need two at once
+static String topicStr(MqttTopic t) {
+  return String(g_topics.get(t));
+}
+
+static const char* topic(MqttTopic t) {
+  return g_topics.get(t);
+}
+
+// State messages go through the outbox, except during the full publish on
+// connect: that path blocks anyway and its ~25 topics would overflow the queue.
+static MqttOutbox g_outbox;
+static bool g_sendDirect = false;
+static bool g_outboxResync = false;  // Something was dropped; republish state once drained
+static const uint32_t OUTBOX_BUDGET_US = 3000;  // Per mqtt_loop()
+
+static void send(MqttTopic t, const char* payload) {
+  if (g_sendDirect) {
+    mqtt.publish(topic(t), payload, true);
+    return;
+  }
+  if (g_outbox.push(t, payload) == MqttOutbox::Result::Dropped) g_outboxResync = true;
+}
+
+static bool sendQueued(const MqttOutboxEntry& e) {
+  return mqtt.publish(topic(e.topic), (const uint8_t*)e.payload, e.length, e.retained);
+}
+
+static void addDiscoveryEntities(MqttDiscoveryBuilder& builder) {
+  const String& nodeId = uniqId;
   
   // Light entity
-  builder.addLight(tLightState, tLightSet);
+  builder.addLight(topicStr(MqttTopic::LightState), topicStr(MqttTopic::LightSet));
   
   // Switches
-  builder.addSwitch("Animate words", nodeId + "_anim", tAnimState, tAnimSet);
-  builder.addSwitch("Auto update", nodeId + "_autoupd", tAutoUpdState, tAutoUpdSet);
+  builder.addSwitch("Animate words", nodeId + "_anim", topicStr(MqttTopic::AnimState), topicStr(MqttTopic::AnimSet));
+  builder.addSwitch("Auto update", nodeId + "_autoupd", topicStr(MqttTopic::AutoUpdState), topicStr(MqttTopic::AutoUpdSet));
   builder.addSwitch("Night mode enabled", nodeId + "_night_enabled", 
-                   tNightEnabledState, tNightEnabledSet);
+                   topicStr(MqttTopic::NightEnabledState), topicStr(MqttTopic::NightEnabledSet));
   
   // Select entities
   builder.addSelect("Night mode effect", nodeId + "_night_effect",
-                   tNightEffectState, tNightEffectSet,
+                   topicStr(MqttTopic::NightEffectState), topicStr(MqttTopic::NightEffectSet),
                    {"DIM", "OFF"});
   builder.addSelect("Night mode override", nodeId + "_night_override",
-                   tNightOverrideState, tNightOverrideSet,
+                   topicStr(MqttTopic::NightOverrideState), topicStr(MqttTopic::NightOverrideSet),
                    {"AUTO", "ON", "OFF"});
   builder.addSelect("Log level", nodeId + "_loglevel",
-                   tLogLvlState, tLogLvlSet,
+                   topicStr(MqttTopic::LogLvlState), topicStr(MqttTopic::LogLvlSet),
                    {"DEBUG", "INFO", "WARN", "ERROR"});
   
   // Number entities
   builder.addNumber("Night mode dim %", nodeId + "_night_dim",
-                   tNightDimState, tNightDimSet,
+                   topicStr(MqttTopic::NightDimState), topicStr(MqttTopic::NightDimSet),
                    0, 100, 1, "%");
   builder.addNumber("'HET IS' seconds", nodeId + "_hetis",
-                   tHetIsState, tHetIsSet,
+                   topicStr(MqttTopic::HetIsState), topicStr(MqttTopic::HetIsSet),
                    0, 360, 1, "s");
   
   // Binary sensor
   builder.addBinarySensor("Night mode active", nodeId + "_night_active",
-                         tNightActiveState);
+                         topicStr(MqttTopic::NightActiveState));
   
   // Buttons
-  builder.addButton("Restart", nodeId + "_restart", tRestartCmd, "restart");
-  builder.addButton("Start sequence", nodeId + "_sequence", tSeqCmd);
-  builder.addButton("Check for update", nodeId + "_update", tUpdateCmd, "update");
+  builder.addButton("Restart", nodeId + "_restart", topicStr(MqttTopic::RestartCmd), "restart");
+  builder.addButton("Start sequence", nodeId + "_sequence", topicStr(MqttTopic::SeqCmd));
+  builder.addButton("Check for update", nodeId + "_update", topicStr(MqttTopic::UpdateCmd), "update");
   
   // Sensors
-  builder.addSensor("Firmware Version", nodeId + "_version", tVersion);
-  builder.addSensor("UI Version", nodeId + "_uiversion", tUiVersion);
-  builder.addSensor("IP Address", nodeId + "_ip", tIp);
-  builder.addSensor("WiFi RSSI", nodeId + "_rssi", tRssi, "dBm", "signal_strength");
-  builder.addSensor("Last Startup", nodeId + "_uptime", tUptime, "s");
-  builder.addSensor("Free Heap (bytes)", nodeId + "_heap", tHeap, "bytes");
-  builder.addSensor("WiFi Channel", nodeId + "_wifichan", tWifiChan);
-  builder.addSensor("Boot Reason", nodeId + "_bootreason", tBootReason);
-  builder.addSensor("Reset Count", nodeId + "_resetcount", tResetCount);
+  builder.addSensor("Firmware Version", nodeId + "_version", topicStr(MqttTopic::Version));
+  builder.addSensor("UI Version", nodeId + "_uiversion", topicStr(MqttTopic::UiVersion));
+  builder.addSensor("IP Address", nodeId + "_ip", topicStr(MqttTopic::Ip));
+  builder.addSensor("WiFi RSSI", nodeId + "_rssi", topicStr(MqttTopic::Rssi), "dBm", "signal_strength");
+  builder.addSensor("Last Startup", nodeId + "_uptime", topicStr(MqttTopic::Uptime), "s");
+  builder.addSensor("Free Heap (bytes)", nodeId + "_heap", topicStr(MqttTopic::Heap), "bytes");
+  builder.addSensor("WiFi Channel", nodeId + "_wifichan", topicStr(MqttTopic::WifiChan));
+  builder.addSensor("Boot Reason", nodeId + "_bootreason", topicStr(MqttTopic::BootReason));
+  builder.addSensor("Reset Count", nodeId + "_resetcount", topicStr(MqttTopic::ResetCount));
+
+  // Performance (diagnostic): figures over the last diagnostics interval
+  builder.addSensor("Loop Time Avg", nodeId + "_loop_avg", topicStr(MqttTopic::LoopAvg),
+                   "μs", "duration", "measurement", "diagnostic");
+  builder.addSensor("Loop Time Max", nodeId + "_loop_max", topicStr(MqttTopic::LoopMax),
+                   "μs", "duration", "measurement", "diagnostic");
+  builder.addSensor("Frame Rate", nodeId + "_fps", topicStr(MqttTopic::Fps),
+                   "fps", "", "measurement", "diagnostic");
+  builder.addSensor("LED Show Time", nodeId + "_show_time", topicStr(MqttTopic::ShowTime),
+                   "μs", "duration", "measurement", "diagnostic");
+  builder.addSensor("Largest Free Block (bytes)", nodeId + "_heap_block", topicStr(MqttTopic::HeapBlock),
+                   "bytes", "", "measurement", "diagnostic");
+  builder.addSensor("Heap Fragmentation", nodeId + "_heap_frag", topicStr(MqttTopic::HeapFrag),
+                   "%", "", "measurement", "diagnostic");
+  builder.addSensor("Log Write Time", nodeId + "_log_write", topicStr(MqttTopic::LogWrite),
+                   "μs", "duration", "measurement", "diagnostic");
+  builder.addSensor("NVS Writes", nodeId + "_nvs_writes", topicStr(MqttTopic::NvsWrites),
+                   "", "", "total_increasing", "diagnostic");
   
   // Text entities (time inputs)
   builder.addText("Night mode start", nodeId + "_night_start",
-                 tNightStartState, tNightStartSet,
+                 topicStr(MqttTopic::NightStartState), topicStr(MqttTopic::NightStartSet),
                  5, 5, "^([01][0-9]|2[0-3]):[0-5][0-9]$");
   builder.addText("Night mode end", nodeId + "_night_end",
-                 tNightEndState, tNightEndSet,
+                 topicStr(MqttTopic::NightEndState), topicStr(MqttTopic::NightEndSet),
                  5, 5, "^([01][0-9]|2[0-3]):[0-5][0-9]$");
-  
-  // Publish all entities
-  builder.publish();
+}
+
+// Discovery goes out one entity per mqtt_loop() pass. The configs are
+// retained, so they only need to go out when they differ from what this
+// broker last received: a first pass only hashes them and is compared with
+// the hash stored in NVS.
+struct DiscoveryRun {
+  bool active = false;
+  bool force = false;   // Home Assistant came online; skip the hash check
+  int next = -1;        // Entity to publish next; -1 before the hash pass
+  uint32_t hash = 0;
+  int failed = 0;
+};
+static DiscoveryRun g_discovery;
+
+static void startDiscovery(bool force) {
+  g_discovery = DiscoveryRun();
+  g_discovery.active = true;
+  g_discovery.force = force;
+}
+
+static void discoveryStep() {
+  String baseTopic(g_topics.base());
+  MqttDiscoveryBuilder builder(mqtt, g_mqttCfg.discoveryPrefix, 
+                               uniqId, baseTopic, topicStr(MqttTopic::Availability));
+  builder.setDeviceInfo(CLOCK_NAME, "Chronolett Wordclock", "Lumetric", FIRMWARE_VERSION);
+
+  if (g_discovery.next < 0) {
+    builder.setPublishing(false);
+    builder.addToHash(g_mqttCfg.host + ":" + String((unsigned)g_mqttCfg.port));
+    addDiscoveryEntities(builder);
+    g_discovery.hash = builder.hash();
+    uint32_t stored = mqtt_discovery_hash_load();
+    if (!g_discovery.force && stored != 0 && g_discovery.hash == stored) {
+      logInfo("MQTT discovery unchanged, not republished");
+      g_discovery.active = false;
+      return;
+    }
+    g_discovery.next = 0;
+    return;
+  }
+
+  builder.select(g_discovery.next);
+  addDiscoveryEntities(builder);
+  g_discovery.failed += builder.failed();
+  if (++g_discovery.next < builder.count()) return;
+
+  logInfo(String("Published ") + builder.count() + " discovery entities");
+  // A partial publish is retried on the next connect
+  mqtt_discovery_hash_save(g_discovery.failed == 0 ? g_discovery.hash : 0);
+  g_discovery.active = false;
 }
 
 static void publishAvailability(const char* st) {
-  mqtt.publish(availTopic.c_str(), st, true);
+  mqtt.publish(topic(MqttTopic::Availability), st, true);
 }
 
-// Publisher functions (now non-static so they can be accessed by command handlers)
-void publishLightState() {
+// State publishers, also used to echo commands
+static void publishLightState() {
   JsonDocument doc;
   uint8_t r, g, b, w; ledState.getRGBW(r,g,b,w);
   doc["state"] = clockEnabled ? "ON" : "OFF";
@@ -189,19 +239,19 @@ void publishLightState() {
   JsonObject col = doc["color"].to<JsonObject>();
   col["r"] = r; col["g"] = g; col["b"] = b;
   String out; serializeJson(doc, out);
-  mqtt.publish(tLightState.c_str(), out.c_str(), true);
+  send(MqttTopic::LightState, out.c_str());
 }
 
-void publishSwitch(const String& topic, bool on) {
-  mqtt.publish(topic.c_str(), on ? "ON" : "OFF", true);
+static void publishSwitch(MqttTopic t, bool on) {
+  send(t, on ? "ON" : "OFF");
 }
 
-void publishNumber(const String& topic, int v) {
+static void publishNumber(MqttTopic t, int v) {
   char buf[16]; snprintf(buf, sizeof(buf), "%d", v);
-  mqtt.publish(topic.c_str(), buf, true);
+  send(t, buf);
 }
 
-void publishSelect(const String& topic) {
+static void publishSelect(MqttTopic t) {
   extern LogLevel LOG_LEVEL;
   const char* s = "INFO";
   switch (LOG_LEVEL) {
@@ -210,10 +260,10 @@ void publishSelect(const String& topic) {
     case LOG_LEVEL_WARN:  s = "WARN";  break;
     case LOG_LEVEL_ERROR: s = "ERROR"; break;
   }
-  mqtt.publish(topic.c_str(), s, true);
+  send(t, s);
 }
 
-void publishNightOverrideState() {
+static void publishNightOverrideState() {
   const char* s = "AUTO";
   switch (nightMode.getOverride()) {
     case NightModeOverride::ForceOn:  s = "ON"; break;
@@ -221,28 +271,28 @@ void publishNightOverrideState() {
     case NightModeOverride::Auto:
     default:                         s = "AUTO"; break;
   }
-  mqtt.publish(tNightOverrideState.c_str(), s, true);
+  send(MqttTopic::NightOverrideState, s);
 }
 
-void publishNightActiveState() {
-  mqtt.publish(tNightActiveState.c_str(), nightMode.isActive() ? "ON" : "OFF", true);
+static void publishNightActiveState() {
+  send(MqttTopic::NightActiveState, nightMode.isActive() ? "ON" : "OFF");
 }
 
-void publishNightEffectState() {
+static void publishNightEffectState() {
   const char* s = (nightMode.getEffect() == NightModeEffect::Off) ? "OFF" : "DIM";
-  mqtt.publish(tNightEffectState.c_str(), s, true);
+  send(MqttTopic::NightEffectState, s);
 }
 
 
-void publishNightDimState() {
-  publishNumber(tNightDimState, nightMode.getDimPercent());
+static void publishNightDimState() {
+  publishNumber(MqttTopic::NightDimState, nightMode.getDimPercent());
 }
 
-void publishNightScheduleState() {
+static void publishNightScheduleState() {
   String start = nightMode.formatMinutes(nightMode.getStartMinutes());
   String end = nightMode.formatMinutes(nightMode.getEndMinutes());
-  mqtt.publish(tNightStartState.c_str(), start.c_str(), true);
-  mqtt.publish(tNightEndState.c_str(), end.c_str(), true);
+  send(MqttTopic::NightStartState, start.c_str());
+  send(MqttTopic::NightEndState, end.c_str());
 }
 
 // Cache computed boot time string once NTP is synced
@@ -275,56 +325,123 @@ static const char* reset_reason_to_str(esp_reset_reason_t r) {
   }
 }
 
-void mqtt_publish_state(bool force) {
-  unsigned long now = millis();
-  if (!force && (now - lastStateAt) < STATE_INTERVAL_MS) return;
-  lastStateAt = now;
-  if (!mqtt.connected()) return;
-
-  publishLightState();
-  publishSwitch(tAnimState, displaySettings.getAnimateWords());
-  publishSwitch(tAutoUpdState, displaySettings.getAutoUpdate());
-  publishNumber(tHetIsState, displaySettings.getHetIsDurationSec());
-  publishSwitch(tNightEnabledState, nightMode.isEnabled());
-  publishNightEffectState();
-  publishNightDimState();
-  publishNightScheduleState();
-  publishNightOverrideState();
-  publishNightActiveState();
-  publishSelect(tLogLvlState);
-
-  // Update channel / auto-update status
+static void publishUpdateState() {
   String updCh = displaySettings.getUpdateChannel();
-  mqtt.publish(tUpdateChannelState.c_str(), updCh.c_str(), true);
+  send(MqttTopic::UpdateChannelState, updCh.c_str());
   bool autoAllowed = displaySettings.getAutoUpdate() && updCh != "develop";
-  mqtt.publish(tUpdateAutoAllowed.c_str(), autoAllowed ? "ON" : "OFF", true);
-  mqtt.publish(tUpdateAvailable.c_str(), "unknown", true); // placeholder until a remote check runs
-
-  mqtt.publish(tVersion.c_str(), FIRMWARE_VERSION, true);
-  mqtt.publish(tUiVersion.c_str(), UI_VERSION, true);
-  mqtt.publish(tIp.c_str(), WiFi.localIP().toString().c_str(), true);
-  char rssi[16]; snprintf(rssi, sizeof(rssi), "%d", WiFi.RSSI()); mqtt.publish(tRssi.c_str(), rssi, true);
-  char heap[24]; snprintf(heap, sizeof(heap), "%u", (unsigned)esp_get_free_heap_size()); mqtt.publish(tHeap.c_str(), heap, true);
-  char ch[8]; snprintf(ch, sizeof(ch), "%d", WiFi.channel()); mqtt.publish(tWifiChan.c_str(), ch, true);
+  send(MqttTopic::UpdateAutoAllowed, autoAllowed ? "ON" : "OFF");
+}
+
+// Publish the retained state topics for the fields flagged in @p dirty (see state_dirty.h)
+static void publishDirty(uint32_t dirty) {
+  if (dirty & DIRTY_LIGHT) publishLightState();
+  if (dirty & DIRTY_ANIMATE) publishSwitch(MqttTopic::AnimState, displaySettings.getAnimateWords());
+  if (dirty & DIRTY_AUTO_UPDATE) publishSwitch(MqttTopic::AutoUpdState, displaySettings.getAutoUpdate());
+  if (dirty & DIRTY_HETIS) publishNumber(MqttTopic::HetIsState, displaySettings.getHetIsDurationSec());
+  if (dirty & DIRTY_LOG_LEVEL) publishSelect(MqttTopic::LogLvlState);
+  if (dirty & (DIRTY_UPDATE_CHANNEL | DIRTY_AUTO_UPDATE)) publishUpdateState();
+  if (dirty & DIRTY_NIGHT_ENABLED) publishSwitch(MqttTopic::NightEnabledState, nightMode.isEnabled());
+  if (dirty & DIRTY_NIGHT_EFFECT) publishNightEffectState();
+  if (dirty & DIRTY_NIGHT_DIM) publishNightDimState();
+  if (dirty & DIRTY_NIGHT_SCHEDULE) publishNightScheduleState();
+  if (dirty & DIRTY_NIGHT_OVERRIDE) publishNightOverrideState();
+  if (dirty & DIRTY_NIGHT_ACTIVE) publishNightActiveState();
+}
+
+// Values that only change across a reboot; published once per connection
+static void publishStatic() {
+  send(MqttTopic::UpdateAvailable, "unknown"); // placeholder until a remote check runs
+  send(MqttTopic::Version, FIRMWARE_VERSION);
+  send(MqttTopic::UiVersion, UI_VERSION);
   if (g_bootReasonStr.length() == 0) {
     g_bootReasonStr = reset_reason_to_str(esp_reset_reason());
   }
-  mqtt.publish(tBootReason.c_str(), g_bootReasonStr.c_str(), true);
-  char rc[16]; snprintf(rc, sizeof(rc), "%lu", (unsigned long)g_resetCount); mqtt.publish(tResetCount.c_str(), rc, true);
+  send(MqttTopic::BootReason, g_bootReasonStr.c_str());
+  char rc[16]; snprintf(rc, sizeof(rc), "%lu", (unsigned long)g_resetCount); send(MqttTopic::ResetCount, rc);
+  send(MqttTopic::Uptime, g_bootTimeSet ? g_bootTimeStr.c_str() : "unknown");
+}
+
+// Performance counters since the previous call; starts the next window
+static void publishPerf() {
+  PerfStats& perf = perfStats();
+  unsigned long now = millis();
+  publishNumber(MqttTopic::LoopAvg, (int)perf.loop().avgUs());
+  publishNumber(MqttTopic::LoopMax, (int)perf.loop().maxUs);
+  uint32_t fps = perf.fpsTenths(now);
+  char fpsStr[16]; snprintf(fpsStr, sizeof(fpsStr), "%u.%u", (unsigned)(fps / 10), (unsigned)(fps % 10)); send(MqttTopic::Fps, fpsStr);
+  publishNumber(MqttTopic::ShowTime, (int)perf.show().avgUs());
+  publishNumber(MqttTopic::LogWrite, (int)perf.logWrites().avgUs());
+  publishNumber(MqttTopic::NvsWrites, (int)perf.nvsWrites());
+  uint32_t freeBytes = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  uint32_t block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  publishNumber(MqttTopic::HeapBlock, (int)block);
+  publishNumber(MqttTopic::HeapFrag, PerfStats::fragmentationPercent(freeBytes, block));
+  perf.startWindow(now);
+}
+
+// Volatile diagnostics, refreshed every DIAG_INTERVAL_MS
+static void publishDiagnostics() {
+  send(MqttTopic::Ip, WiFi.localIP().toString().c_str());
+  char rssi[16]; snprintf(rssi, sizeof(rssi), "%d", WiFi.RSSI()); send(MqttTopic::Rssi, rssi);
+  char heap[24]; snprintf(heap, sizeof(heap), "%u", (unsigned)esp_get_free_heap_size()); send(MqttTopic::Heap, heap);
+  char ch[8]; snprintf(ch, sizeof(ch), "%d", WiFi.channel()); send(MqttTopic::WifiChan, ch);
+  publishPerf();
+}
 
-  // Publish last startup timestamp (local time) once NTP is synced
+// Last startup timestamp (local time), known once NTP is synced
+static bool updateBootTime() {
+  if (g_bootTimeSet) return false;
   time_t nowEpoch = time(nullptr);
-  if (!g_bootTimeSet && nowEpoch >= 1640995200) { // 2022-01-01 as "time is valid" threshold
-    time_t boot = nowEpoch - (time_t)(millis() / 1000UL);
-    struct tm lt = {};
-    localtime_r(&boot, &lt);
-    char buf[32];
-    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &lt);
-    g_bootTimeStr = String(buf);
-    g_bootTimeSet = true;
+  if (nowEpoch < 1640995200) return false; // 2022-01-01 as "time is valid" threshold
+  time_t boot = nowEpoch - (time_t)(millis() / 1000UL);
+  struct tm lt = {};
+  localtime_r(&boot, &lt);
+  char buf[32];
+  strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &lt);
+  g_bootTimeStr = String(buf);
+  g_bootTimeSet = true;
+  return true;
+}
+
+// Fields without a setter hook (clockEnabled) are caught by the fingerprints
+static void onStateChanged(uint8_t groups) {
+  if (groups & STATE_LIGHT) stateMarkDirty(DIRTY_LIGHT);
+}
+
+void mqtt_publish_state(bool force) {
+  // Flags stay set; the full publish on connect covers them
+  if (g_phase != MqttPhase::Online || !mqtt.connected()) return;
+  unsigned long now = millis();
+
+  if (force) {
+    // Everything goes out now, so anything still queued is stale
+    g_outbox.clear();
+    g_outboxResync = false;
+    g_sendDirect = true;
+    stateTakeDirty();
+    publishDirty(DIRTY_ALL);
+    updateBootTime();
+    publishStatic();
+    publishDiagnostics();
+    g_sendDirect = false;
+    lastDiagAt = now;
+    return;
+  }
+
+  if (g_outboxResync && g_outbox.empty()) {
+    // Messages were dropped under backpressure: queue the current state again
+    g_outboxResync = false;
+    stateMarkDirty(DIRTY_ALL);
+    if (g_bootTimeSet) send(MqttTopic::Uptime, g_bootTimeStr.c_str());
+  }
+  uint32_t dirty = stateTakeDirty();
+  if (dirty) publishDirty(dirty);
+  if (updateBootTime()) send(MqttTopic::Uptime, g_bootTimeStr.c_str());
+  if (now - lastDiagAt >= DIAG_INTERVAL_MS) {
+    lastDiagAt = now;
+    publishDiagnostics();
   }
-  const char* bootOut = g_bootTimeSet ? g_bootTimeStr.c_str() : "unknown";
-  mqtt.publish(tUptime.c_str(), bootOut, true);
+  g_outbox.drain(sendQueued, OUTBOX_BUDGET_US);
 }
 
 static void publishBirth() {
@@ -332,141 +449,199 @@ static void publishBirth() {
   if (!mqtt.connected()) return;
   String out = String("{\"time\":\"") + (g_bootTimeSet ? g_bootTimeStr : String("unknown")) +
                "\",\"reason\":\"" + (g_bootReasonStr.length() ? g_bootReasonStr : String(reset_reason_to_str(esp_reset_reason()))) + "\"}";
-  mqtt.publish(tBirth.c_str(), out.c_str(), true);
+  mqtt.publish(topic(MqttTopic::Birth), out.c_str(), true);
 }
 
-/**
- * @brief Initialize MQTT command handlers
- * 
- * Registers all command handlers with the command registry.
- * This replaces the large if-else chain that was in handleMessage().
- */
-static void initCommandHandlers() {
-  auto& registry = MqttCommandRegistry::instance();
-  
-  // Light (complex JSON)
-  registry.registerHandler(tLightSet, new LightCommandHandler());
-  
-  // Simple switches
-  registry.registerHandler(tClockSet, new SwitchCommandHandler(
-    "clock",
-    [](bool on) { clockEnabled = on; },
-    []() { publishSwitch(tClockState, clockEnabled); }
-  ));
-  
-  registry.registerHandler(tAnimSet, new SwitchCommandHandler(
-    "animate",
-    [](bool on) { displaySettings.setAnimateWords(on); },
-    []() { publishSwitch(tAnimState, displaySettings.getAnimateWords()); }
-  ));
-  
-  
-  registry.registerHandler(tAutoUpdSet, new SwitchCommandHandler(
-    "auto_update",
-    [](bool on) { displaySettings.setAutoUpdate(on); },
-    []() { publishSwitch(tAutoUpdState, displaySettings.getAutoUpdate()); }
-  ));
-  
-  registry.registerHandler(tNightEnabledSet, new SwitchCommandHandler(
-    "night_enabled",
-    [](bool on) { nightMode.setEnabled(on); },
-    []() { publishSwitch(tNightEnabledState, nightMode.isEnabled()); }
-  ));
-  
-  // Number handlers
-  registry.registerHandler(tHetIsSet, new NumberCommandHandler(
-    0, 360,
-    [](int v) { displaySettings.setHetIsDurationSec((uint16_t)v); },
-    []() { publishNumber(tHetIsState, displaySettings.getHetIsDurationSec()); }
-  ));
-  
-  registry.registerHandler(tNightDimSet, new NumberCommandHandler(
-    0, 100,
-    [](int v) { nightMode.setDimPercent((uint8_t)v); },
-    []() { publishNightDimState(); }
-  ));
-  
-  // Select handlers
-  registry.registerHandler(tNightOverrideSet, new SelectCommandHandler(
-    {"AUTO", "ON", "OFF"},
-    [](const String& val) {
-      if (val == "AUTO") nightMode.setOverride(NightModeOverride::Auto);
-      else if (val == "ON") nightMode.setOverride(NightModeOverride::ForceOn);
-      else if (val == "OFF") nightMode.setOverride(NightModeOverride::ForceOff);
-    },
-    []() { publishNightOverrideState(); publishNightActiveState(); }
-  ));
-  
-  registry.registerHandler(tNightEffectSet, new SelectCommandHandler(
-    {"DIM", "OFF"},
-    [](const String& val) {
-      if (val == "DIM") nightMode.setEffect(NightModeEffect::Dim);
-      else if (val == "OFF") nightMode.setEffect(NightModeEffect::Off);
-    },
-    []() { publishNightEffectState(); }
-  ));
-  
-  registry.registerHandler(tLogLvlSet, new SelectCommandHandler(
-    {"DEBUG", "INFO", "WARN", "ERROR"},
-    [](const String& val) {
-      LogLevel level = LOG_LEVEL_INFO;
-      if (val == "DEBUG") level = LOG_LEVEL_DEBUG;
-      else if (val == "INFO") level = LOG_LEVEL_INFO;
-      else if (val == "WARN") level = LOG_LEVEL_WARN;
-      else if (val == "ERROR") level = LOG_LEVEL_ERROR;
-      setLogLevel(level);
-    },
-    []() { publishSelect(tLogLvlState); }
-  ));
-  
-  // Time string handlers
-  registry.registerHandler(tNightStartSet, new TimeStringCommandHandler(
-    NightMode::parseTimeString,
-    [](uint16_t minutes) { nightMode.setSchedule(minutes, nightMode.getEndMinutes()); },
-    []() { publishNightScheduleState(); },
-    "night_start"
-  ));
-  
-  registry.registerHandler(tNightEndSet, new TimeStringCommandHandler(
-    NightMode::parseTimeString,
-    [](uint16_t minutes) { nightMode.setSchedule(nightMode.getStartMinutes(), minutes); },
-    []() { publishNightScheduleState(); },
-    "night_end"
-  ));
-  
-  // Simple button commands (no response needed)
-  registry.registerLambda(tRestartCmd, [](const String&) {
-    safeRestart();
-  });
-  
-  registry.registerLambda(tSeqCmd, [](const String&) {
-    extern StartupSequence startupSequence;
-    startupSequence.start();
-  });
-  
-  registry.registerLambda(tUpdateCmd, [](const String&) {
-    checkForFirmwareUpdate();
-  });
+// ============================================================================
+// Commands
+// ============================================================================
+
+// ArduinoJson allocator on a FixedArena, so a light command parses without
+// touching the heap (ArduinoJson 7 has no StaticJsonDocument)
+class ArenaJsonAllocator : public ArduinoJson::Allocator {
+public:
+  explicit ArenaJsonAllocator(FixedArena& arena) : arena_(arena) {}
+  void* allocate(size_t size) override { return arena_.allocate(size); }
+  void deallocate(void* p) override { arena_.deallocate(p); }
+  void* reallocate(void* p, size_t size) override { return arena_.reallocate(p, size); }
+
+private:
+  FixedArena& arena_;
+};
+
+// One pool of slots (8 bytes each on the ESP32) plus the strings of a light command
+static const size_t LIGHT_JSON_BUFFER = ARDUINOJSON_POOL_CAPACITY * 2 * sizeof(void*) + 256;
+
+// Level the clock shows with no transition running; switched off is brightness 0
+static LightLevel steadyLightLevel() {
+  LightLevel level = ledState.level();
+  if (!clockEnabled) level.brightness = 0;
+  return level;
 }
 
-/**
- * @brief Handle incoming MQTT message
- * 
- * Simplified handler that delegates to the command registry.
- * Replaced the 107-line if-else chain with this clean implementation.
- */
-static void handleMessage(char* topic, byte* payload, unsigned int length) {
-  String topicStr(topic);
-  String payloadStr;
-  for (unsigned int i = 0; i < length; i++) {
-    payloadStr += (char)payload[i];
+// "transition" is in seconds; 0 when absent or not positive
+static uint32_t transitionMs(JsonVariant transition) {
+  if (!transition.is<float>()) return 0;
+  float seconds = transition.as<float>();
+  if (!(seconds > 0.0f)) return 0;
+  if (seconds > LightFader::MAX_DURATION_MS / 1000.0f) return LightFader::MAX_DURATION_MS;
+  return (uint32_t)(seconds * 1000.0f + 0.5f);
+}
+
+static void applyLightCommand(const MqttPayload& payload) {
+  alignas(FixedArena::ALIGN) uint8_t buffer[LIGHT_JSON_BUFFER];
+  FixedArena arena(buffer, sizeof(buffer));
+  ArenaJsonAllocator allocator(arena);
+  JsonDocument doc(&allocator);
+  // Parsed straight from the client's receive buffer, no String copy
+  DeserializationError err = deserializeJson(doc, payload.data, payload.length);
+  if (err == DeserializationError::NoMemory) {
+    // Larger than any Home Assistant light command; fall back to the heap
+    logDebug("Light command JSON exceeds the stack buffer");
+    doc = JsonDocument();
+    err = deserializeJson(doc, payload.data, payload.length);
   }
-  
-  MqttCommandRegistry::instance().handleMessage(topicStr, payloadStr);
+  if (err) {
+    logWarn(String("Light command JSON parse error: ") + err.c_str());
+    return;
+  }
+
+  // Fade from whatever is on the LEDs right now, mid-transition included
+  uint32_t now = millis();
+  LightLevel from = lightFader.sample(now, steadyLightLevel());
+
+  if (doc["state"].is<const char*>()) {
+    const char* st = doc["state"];
+    clockEnabled = (strcmp(st, "ON") == 0);
+  }
+  if (doc["brightness"].is<int>()) {
+    int br = doc["brightness"].as<int>();
+    br = constrain(br, 0, 255);
+    ledState.setBrightness(br);
+  }
+  if (doc["color"].is<JsonObject>()) {
+    uint8_t r = doc["color"]["r"] | 0;
+    uint8_t g = doc["color"]["g"] | 0;
+    uint8_t b = doc["color"]["b"] | 0;
+    ledState.setRGB(r, g, b);
+  }
+
+  uint32_t fadeMs = transitionMs(doc["transition"]);
+  if (fadeMs > 0) {
+    lightFader.start(from, steadyLightLevel(), fadeMs, now);
+  } else {
+    lightFader.cancel();
+  }
+
+  // Apply display immediately
+  struct tm timeinfo;
+  if (getLocalTime(&timeinfo)) {
+    auto idx = get_led_indices_for_time(&timeinfo);
+    showLeds(idx);
+  }
+
+  publishLightState();
+}
+
+static void setAnimate(bool on) { displaySettings.setAnimateWords(on); }
+static void echoAnimate() { publishSwitch(MqttTopic::AnimState, displaySettings.getAnimateWords()); }
+
+static void setAutoUpdate(bool on) { displaySettings.setAutoUpdate(on); }
+static void echoAutoUpdate() { publishSwitch(MqttTopic::AutoUpdState, displaySettings.getAutoUpdate()); }
+
+static void setClock(bool on) {
+  clockEnabled = on;
+  lightFader.cancel();
+}
+static void echoClock() { publishSwitch(MqttTopic::ClockState, clockEnabled); }
+
+static void setHetIs(int v) { displaySettings.setHetIsDurationSec((uint16_t)v); }
+static void echoHetIs() { publishNumber(MqttTopic::HetIsState, displaySettings.getHetIsDurationSec()); }
+
+static const char* const LOG_LEVEL_OPTIONS[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+static void setLogLevelOption(const char* val) {
+  LogLevel level = LOG_LEVEL_INFO;
+  if (strcmp(val, "DEBUG") == 0) level = LOG_LEVEL_DEBUG;
+  else if (strcmp(val, "WARN") == 0) level = LOG_LEVEL_WARN;
+  else if (strcmp(val, "ERROR") == 0) level = LOG_LEVEL_ERROR;
+  setLogLevel(level);
+}
+static void echoLogLevel() { publishSelect(MqttTopic::LogLvlState); }
+
+static void setNightDim(int v) { nightMode.setDimPercent((uint8_t)v); }
+
+static const char* const NIGHT_EFFECT_OPTIONS[] = { "DIM", "OFF" };
+
+static void setNightEffect(const char* val) {
+  nightMode.setEffect(strcmp(val, "OFF") == 0 ? NightModeEffect::Off : NightModeEffect::Dim);
+}
+
+static void setNightEnabled(bool on) { nightMode.setEnabled(on); }
+static void echoNightEnabled() { publishSwitch(MqttTopic::NightEnabledState, nightMode.isEnabled()); }
+
+static void setNightEnd(uint16_t minutes) { nightMode.setSchedule(nightMode.getStartMinutes(), minutes); }
+static void setNightStart(uint16_t minutes) { nightMode.setSchedule(minutes, nightMode.getEndMinutes()); }
+
+static const char* const NIGHT_OVERRIDE_OPTIONS[] = { "AUTO", "ON", "OFF" };
+
+static void setNightOverride(const char* val) {
+  if (strcmp(val, "ON") == 0) nightMode.setOverride(NightModeOverride::ForceOn);
+  else if (strcmp(val, "OFF") == 0) nightMode.setOverride(NightModeOverride::ForceOff);
+  else nightMode.setOverride(NightModeOverride::Auto);
+}
+static void echoNightOverride() { publishNightOverrideState(); publishNightActiveState(); }
+
+static void pressRestart(const MqttPayload&) { safeRestart(); }
+static void pressSequence(const MqttPayload&) { startupSequence.start(); }
+static void pressUpdate(const MqttPayload&) { checkForFirmwareUpdate(); }
+
+// Sorted by topic suffix; every entry is also subscribed on connect
+static constexpr MqttCommand MQTT_COMMANDS[] = {
+  mqttSwitchCommand(MqttTopic::AnimSet,          "animate",        setAnimate, echoAnimate),
+  mqttSwitchCommand(MqttTopic::AutoUpdSet,       "auto_update",    setAutoUpdate, echoAutoUpdate),
+  mqttSwitchCommand(MqttTopic::ClockSet,         "clock",          setClock, echoClock),
+  mqttNumberCommand(MqttTopic::HetIsSet,         "hetis", 0, 360,  setHetIs, echoHetIs),
+  mqttActionCommand(MqttTopic::LightSet,         applyLightCommand),
+  mqttSelectCommand(MqttTopic::LogLvlSet,        "loglevel",       LOG_LEVEL_OPTIONS, 4, setLogLevelOption, echoLogLevel),
+  mqttNumberCommand(MqttTopic::NightDimSet,      "night_dim", 0, 100, setNightDim, publishNightDimState),
+  mqttSelectCommand(MqttTopic::NightEffectSet,   "night_effect",   NIGHT_EFFECT_OPTIONS, 2, setNightEffect, publishNightEffectState),
+  mqttSwitchCommand(MqttTopic::NightEnabledSet,  "night_enabled",  setNightEnabled, echoNightEnabled),
+  mqttTimeCommand(MqttTopic::NightEndSet,        "night_end",      NightMode::parseTimeString, setNightEnd, publishNightScheduleState),
+  mqttSelectCommand(MqttTopic::NightOverrideSet, "night_override", NIGHT_OVERRIDE_OPTIONS, 3, setNightOverride, echoNightOverride),
+  mqttTimeCommand(MqttTopic::NightStartSet,      "night_start",    NightMode::parseTimeString, setNightStart, publishNightScheduleState),
+  mqttActionCommand(MqttTopic::RestartCmd,       pressRestart),
+  mqttActionCommand(MqttTopic::SeqCmd,           pressSequence),
+  mqttActionCommand(MqttTopic::UpdateCmd,        pressUpdate),
+};
+static constexpr size_t MQTT_COMMAND_COUNT = sizeof(MQTT_COMMANDS) / sizeof(MQTT_COMMANDS[0]);
+static_assert(mqttCommandsSorted(MQTT_COMMANDS, MQTT_COMMAND_COUNT), "MQTT_COMMANDS must be sorted by topic suffix");
+
+static const MqttCommandRegistry g_commands(MQTT_COMMANDS, MQTT_COMMAND_COUNT);
+
+// "<discovery prefix>/status": Home Assistant announces itself with "online"
+static bool isDiscoveryStatus(const char* topicName) {
+  const String& prefix = g_mqttCfg.discoveryPrefix;
+  return strncmp(topicName, prefix.c_str(), prefix.length()) == 0 &&
+         strcmp(topicName + prefix.length(), "/status") == 0;
+}
+
+static void handleMessage(char* topicName, byte* payload, unsigned int length) {
+  if (isDiscoveryStatus(topicName)) {
+    // Republish from mqtt_loop(), not from inside the callback
+    if (length == 6 && memcmp(payload, "online", 6) == 0) g_discoveryPending = true;
+    return;
+  }
+  const char* suffix = g_topics.suffixOf(topicName);
+  if (!suffix) {
+    logWarn(String("Unhandled MQTT topic: ") + topicName);
+    return;
+  }
+  g_commands.handleMessage(suffix, MqttPayload((const char*)payload, length));
 }
 
-static bool mqtt_connect() {
-  if (mqtt.connected()) return true;
+// Start an attempt; false if there is nothing to connect to yet
+static bool beginConnect() {
   if (WiFi.status() != WL_CONNECTED) {
     g_lastErr = "WiFi not connected";
     return false;
@@ -484,44 +659,67 @@ static bool mqtt_connect() {
     buildTopics();
   }
 
+  transport.open(g_mqttCfg.host.c_str(), g_mqttCfg.port);
+  g_phase = MqttPhase::Transport;
+  return true;
+}
+
+// Back off after a failed attempt (exponential with jitter, paused at the maximum)
+static void connectFailed() {
+  // PubSubClient took the provisional CONNACK as accepted; without this it
+  // would skip the CONNECT on the next attempt
+  if (g_phase == MqttPhase::Handshake) mqtt.disconnect();
+  transport.stop();
+  g_phase = MqttPhase::Idle;
+  g_connected = false;
+  lastReconnectAttempt = millis();  // The delay counts from the failure
+  if (reconnectDelayMs < RECONNECT_DELAY_MIN_MS) reconnectDelayMs = RECONNECT_DELAY_MIN_MS;
+  if (reconnectAttempts < 255) reconnectAttempts++;
+  unsigned long nextDelay = reconnectDelayMs * 2;
+  if (nextDelay > RECONNECT_DELAY_MAX_MS) nextDelay = RECONNECT_DELAY_MAX_MS;
+  uint32_t jitter = esp_random() % RECONNECT_DELAY_MIN_MS;
+  unsigned long jittered = nextDelay + jitter;
+  if (jittered > RECONNECT_DELAY_MAX_MS) jittered = RECONNECT_DELAY_MAX_MS;
+  reconnectDelayMs = jittered;
+  if (!reconnectAborted && reconnectDelayMs >= RECONNECT_DELAY_MAX_MS) {
+    String errMsg = String("⏸️ MQTT reconnect paused after reaching max backoff (") +
+                    RECONNECT_DELAY_MAX_MS + " ms); last error: " +
+                    (g_lastErr.length() ? g_lastErr : String("unknown")) +
+                    String(". Will retry on network recovery, config change, or manual reconnect.");
+    logWarn(errMsg);
+    reconnectAborted = true;
+    // Note: reconnectAborted will be cleared on:
+    // 1. Successful connection (onConnected)
+    // 2. Configuration change (mqtt_apply_settings)
+    // 3. Manual reconnect (mqtt_force_reconnect)
+  } else if (g_lastErr != "MQTT not configured") {
+    logWarnLimited(String("MQTT reconnect failed (") + (g_lastErr.length() ? g_lastErr : String("unknown")) +
+                   "); retry in " + reconnectDelayMs + " ms");
+  }
+}
+
+// TCP is up: hand the CONNECT to PubSubClient (see mqtt_transport.h)
+static void sendConnect() {
   String clientId = uniqId;
   bool ok;
   if (g_mqttCfg.user.length() > 0) {
-    ok = mqtt.connect(clientId.c_str(), g_mqttCfg.user.c_str(), g_mqttCfg.pass.c_str(), availTopic.c_str(), 1, true, "offline");
+    ok = mqtt.connect(clientId.c_str(), g_mqttCfg.user.c_str(), g_mqttCfg.pass.c_str(), topic(MqttTopic::Availability), 1, true, "offline");
   } else {
     ok = mqtt.connect(clientId.c_str());
   }
   if (!ok) {
-    int st = mqtt.state();
-    g_connected = false;
-    g_lastErr = String("connect failed (state ") + st + ")";
-    return false;
+    g_lastErr = String("connect failed (state ") + mqtt.state() + ")";
+    connectFailed();
+    return;
   }
+  g_phase = MqttPhase::Handshake;
+}
 
+static void onConnected() {
+  g_phase = MqttPhase::Online;
   publishAvailability("online");
   publishBirth();
-  publishDiscovery();
-  
-  // Initialize command handlers (register all topics)
-  initCommandHandlers();
-
-  // Subscriptions
-  mqtt.subscribe(tLightSet.c_str());
-  mqtt.subscribe(tClockSet.c_str());
-  mqtt.subscribe(tAnimSet.c_str());
-  mqtt.subscribe(tAutoUpdSet.c_str());
-  mqtt.subscribe(tHetIsSet.c_str());
-  mqtt.subscribe(tNightEnabledSet.c_str());
-  mqtt.subscribe(tNightOverrideSet.c_str());
-  mqtt.subscribe(tNightEffectSet.c_str());
-  mqtt.subscribe(tNightDimSet.c_str());
-  mqtt.subscribe(tNightStartSet.c_str());
-  mqtt.subscribe(tNightEndSet.c_str());
-  mqtt.subscribe(tLogLvlSet.c_str());
-  mqtt.subscribe(tRestartCmd.c_str());
-  mqtt.subscribe(tSeqCmd.c_str());
-  mqtt.subscribe(tUpdateCmd.c_str());
-
+  startDiscovery(false);
   mqtt_publish_state(true);
   g_connected = true;
   
@@ -535,8 +733,74 @@ static bool mqtt_connect() {
     logInfo(String("✅ MQTT reconnected successfully after error: ") + g_lastErr);
   }
   g_lastErr = "";
-  
-  return true;
+}
+
+static void subscribeStep() {
+  size_t end = g_subscribeNext + SUBSCRIBE_PER_LOOP;
+  if (end > MQTT_COMMAND_COUNT) end = MQTT_COMMAND_COUNT;
+  for (; g_subscribeNext < end; ++g_subscribeNext) {
+    mqtt.subscribe(topic(MQTT_COMMANDS[g_subscribeNext].topic));
+  }
+  if (g_subscribeNext < MQTT_COMMAND_COUNT) return;
+  mqtt.subscribe((g_mqttCfg.discoveryPrefix + "/status").c_str());
+  onConnected();
+}
+
+// One step of the connection set-up; true once online
+static bool connectStep() {
+  switch (g_phase) {
+    case MqttPhase::Idle:
+      if (millis() - lastReconnectAttempt < reconnectDelayMs) return false;
+      lastReconnectAttempt = millis();
+      if (!beginConnect()) connectFailed();
+      return false;
+
+    case MqttPhase::Transport: {
+      MqttTransport::Step step = transport.poll();
+      if (step == MqttTransport::Step::Handshake) {
+        sendConnect();
+      } else if (step == MqttTransport::Step::Failed) {
+        g_lastErr = transport.error();
+        connectFailed();
+      }
+      return false;
+    }
+
+    case MqttPhase::Handshake: {
+      MqttTransport::Step step = transport.poll();
+      if (step == MqttTransport::Step::Open) {
+        g_subscribeNext = 0;
+        g_phase = MqttPhase::Subscribe;
+      } else if (step == MqttTransport::Step::Failed) {
+        g_lastErr = transport.error();
+        connectFailed();
+      }
+      return false;
+    }
+
+    case MqttPhase::Subscribe:
+      subscribeStep();
+      return false;
+
+    case MqttPhase::Online:
+      if (mqtt.connected()) return true;
+      // Lost: the next attempt starts right away unless the last one was recent
+      g_lastErr = String("connection lost (state ") + mqtt.state() + ")";
+      transport.stop();
+      g_connected = false;
+      g_phase = MqttPhase::Idle;
+      return false;
+  }
+  return false;
+}
+
+// Drop the session or an attempt in progress
+static void resetConnection() {
+  if (g_phase == MqttPhase::Handshake || (g_phase == MqttPhase::Online && mqtt.connected())) mqtt.disconnect();
+  transport.stop();
+  g_phase = MqttPhase::Idle;
+  g_connected = false;
+  g_discovery.active = false;
 }
 
 void mqtt_begin() {
@@ -544,13 +808,14 @@ void mqtt_begin() {
   mqtt_settings_load(g_mqttCfg);
   mqtt.setServer(g_mqttCfg.host.c_str(), g_mqttCfg.port);
   mqtt.setCallback(handleMessage);
+  stateSubscribe(onStateChanged);
   reconnectDelayMs = RECONNECT_DELAY_MIN_MS;
   reconnectAttempts = 0;
   reconnectAborted = false;
   lastReconnectAttempt = 0;
   // Bump reset counter (persisted), and cache boot reason string
   g_bootReasonStr = reset_reason_to_str(esp_reset_reason());
-  Preferences p;
+  CountedPreferences p;
   if (p.begin("sys", false)) {
     uint32_t cnt = p.getULong("resets", 0);
     cnt += 1;
@@ -579,42 +844,13 @@ void mqtt_loop() {
   mqttConfiguredLogged = false;
   if (reconnectAborted) return;
 
-  if (!mqtt.connected()) {
-    unsigned long now = millis();
-    if (now - lastReconnectAttempt >= reconnectDelayMs) {
-      lastReconnectAttempt = now;
-      if (!mqtt_connect()) {
-        g_connected = false;
-        if (reconnectDelayMs < RECONNECT_DELAY_MIN_MS) reconnectDelayMs = RECONNECT_DELAY_MIN_MS;
-        if (reconnectAttempts < 255) reconnectAttempts++;
-        unsigned long nextDelay = reconnectDelayMs * 2;
-        if (nextDelay > RECONNECT_DELAY_MAX_MS) nextDelay = RECONNECT_DELAY_MAX_MS;
-        uint32_t jitter = esp_random() % RECONNECT_DELAY_MIN_MS;
-        unsigned long jittered = nextDelay + jitter;
-        if (jittered > RECONNECT_DELAY_MAX_MS) jittered = RECONNECT_DELAY_MAX_MS;
-        reconnectDelayMs = jittered;
-        if (!reconnectAborted && reconnectDelayMs >= RECONNECT_DELAY_MAX_MS) {
-          String errMsg = String("⏸️ MQTT reconnect paused after reaching max backoff (") +
-                          RECONNECT_DELAY_MAX_MS + " ms); last error: " +
-                          (g_lastErr.length() ? g_lastErr : String("unknown")) +
-                          String(". Will retry on network recovery, config change, or manual reconnect.");
-          logWarn(errMsg);
-          reconnectAborted = true;
-          // Note: reconnectAborted will be cleared on:
-          // 1. Successful connection (mqtt_connect success path)
-          // 2. Configuration change (mqtt_apply_settings)
-          // 3. Manual reconnect (mqtt_force_reconnect)
-          return;
-        } else if (g_lastErr != "MQTT not configured") {
-          String warnMsg = String("MQTT reconnect failed (") + (g_lastErr.length() ? g_lastErr : String("unknown")) +
-                           "); retry in " + reconnectDelayMs + " ms";
-          logWarn(warnMsg);
-        }
-      }
-    }
-    return;
-  }
+  if (!connectStep()) return;
   mqtt.loop();
+  if (g_discoveryPending) {
+    g_discoveryPending = false;
+    startDiscovery(true);
+  }
+  if (g_discovery.active) discoveryStep();
   mqtt_publish_state(false);
 }
 
@@ -626,6 +862,10 @@ const String& mqtt_last_error() {
   return g_lastErr;
 }
 
+MqttOutboxStats mqtt_outbox_stats() {
+  return g_outbox.stats();
+}
+
 void mqtt_apply_settings(const MqttSettings& s) {
   // Persist, then apply live
   MqttSettings toSave = s;
@@ -637,7 +877,7 @@ void mqtt_apply_settings(const MqttSettings& s) {
   g_mqttCfg = toSave;
 
   // Disconnect and reconfigure server and topics
-  if (mqtt.connected()) mqtt.disconnect();
+  resetConnection();
   mqtt.setServer(g_mqttCfg.host.c_str(), g_mqttCfg.port);
 
   // Recompute topics based on new base/discovery
@@ -669,10 +909,14 @@ void mqtt_apply_settings(const MqttSettings& s) {
  * prolonged network outages that triggered reconnection abort.
  */
 void mqtt_force_reconnect() {
-  if (mqtt.connected()) {
+  if (g_phase == MqttPhase::Online) {
     logInfo("MQTT already connected");
     return;
   }
+  if (g_phase != MqttPhase::Idle) {
+    logInfo("MQTT connection attempt already in progress");
+    return;
+  }
   
   if (reconnectAborted) {
     logInfo("🔄 MQTT reconnection re-enabled by force reconnect");
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <Arduino.h>
+#include "mqtt_outbox.h"
 
 void mqtt_begin();
 void mqtt_loop();
+// Queue the state topics flagged in state_dirty.h (and, every couple of
+// minutes, the volatile diagnostics) and drain the outbox for a few ms;
+// force publishes everything right away
 void mqtt_publish_state(bool force = false);
 
 // Apply new settings at runtime: disconnect, update client, reconnect
@@ -16,3 +20,4 @@ void mqtt_force_reconnect();
 // Status helpers for Web UI
 bool mqtt_is_connected();
 const String& mqtt_last_error();
+MqttOutboxStats mqtt_outbox_stats();
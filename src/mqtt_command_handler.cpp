@@ -1,213 +1,111 @@
 #include "mqtt_command_handler.h"
-#include "display_settings.h"
-#include "night_mode.h"
-#include "led_state.h"
 #include "log.h"
-#include "wordclock.h"
-#include "time_mapper.h"
-#include <ArduinoJson.h>
-
-// External references
-extern DisplaySettings displaySettings;
-extern bool clockEnabled;
-
-// Forward declarations for publisher functions (defined in mqtt_client.cpp)
-extern void publishLightState();
-extern void publishSwitch(const String& topic, bool on);
-extern void publishNumber(const String& topic, int v);
-extern void publishSelect(const String& topic);
-extern void publishNightOverrideState();
-extern void publishNightActiveState();
-extern void publishNightEffectState();
-extern void publishNightDimState();
-extern void publishNightScheduleState();
+#include <ctype.h>
+#include <strings.h>
 
 // ============================================================================
-// Registry Implementation
+// Registry
 // ============================================================================
 
-MqttCommandRegistry& MqttCommandRegistry::instance() {
-    static MqttCommandRegistry registry;
-    return registry;
-}
-
-MqttCommandRegistry::~MqttCommandRegistry() {
-    // Clean up owned handler pointers
-    for (auto& pair : handlers_) {
-        delete pair.second;
+const MqttCommand* MqttCommandRegistry::find(const char* suffix) const {
+    if (!suffix) return nullptr;
+    size_t lo = 0, hi = count_;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(MQTT_TOPIC_SUFFIX[(size_t)commands_[mid].topic], suffix);
+        if (cmp == 0) return &commands_[mid];
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid;
     }
-    handlers_.clear();
-    lambdaHandlers_.clear();
+    return nullptr;
 }
 
-void MqttCommandRegistry::registerHandler(const String& topic, MqttCommandHandler* handler) {
-    // Delete any existing handler for this topic
-    auto it = handlers_.find(topic);
-    if (it != handlers_.end()) {
-        delete it->second;
+bool MqttCommandRegistry::handleMessage(const char* suffix, const MqttPayload& payload) const {
+    const MqttCommand* cmd = find(suffix);
+    if (!cmd) {
+        logWarn(String("Unhandled MQTT topic: ") + (suffix ? suffix : ""));
+        return false;
     }
-    handlers_[topic] = handler;
-}
-
-void MqttCommandRegistry::registerLambda(const String& topic, 
-                                        std::function<void(const String&)> handler) {
-    lambdaHandlers_[topic] = handler;
-}
-
-void MqttCommandRegistry::handleMessage(const String& topic, const String& payload) {
-    // Try direct handler first
-    auto it = handlers_.find(topic);
-    if (it != handlers_.end()) {
-        it->second->handle(payload);
-        return;
-    }
-    
-    // Try lambda handler
-    auto lit = lambdaHandlers_.find(topic);
-    if (lit != lambdaHandlers_.end()) {
-        lit->second(payload);
-        return;
-    }
-    
-    logWarn(String("Unhandled MQTT topic: ") + topic);
-}
-
-void MqttCommandRegistry::clear() {
-    for (auto& pair : handlers_) {
-        delete pair.second;
-    }
-    handlers_.clear();
-    lambdaHandlers_.clear();
+    return mqttRunCommand(*cmd, payload);
 }
 
 // ============================================================================
-// Light Command Handler
+// Command kinds
 // ============================================================================
 
-void LightCommandHandler::handle(const String& payload) {
-    JsonDocument doc;
-    DeserializationError err = deserializeJson(doc, payload);
-    if (err) {
-        logWarn(String("Light command JSON parse error: ") + err.c_str());
-        return;
-    }
-    
-    // Handle state (ON/OFF)
-    if (doc["state"].is<const char*>()) {
-        const char* st = doc["state"];
-        clockEnabled = (strcmp(st, "ON") == 0);
-    }
-    
-    // Handle brightness
-    if (doc["brightness"].is<int>()) {
-        int br = doc["brightness"].as<int>();
-        br = constrain(br, 0, 255);
-        ledState.setBrightness(br);
-    }
-    
-    // Handle color
-    if (doc["color"].is<JsonObject>()) {
-        uint8_t r = doc["color"]["r"] | 0;
-        uint8_t g = doc["color"]["g"] | 0;
-        uint8_t b = doc["color"]["b"] | 0;
-        ledState.setRGB(r, g, b);
-    }
-    
-    // Apply display immediately
-    struct tm timeinfo;
-    if (getLocalTime(&timeinfo)) {
-        auto idx = get_led_indices_for_time(&timeinfo);
-        showLeds(idx);
-    }
-    
-    publishLightState();
+static bool parseOnOff(const MqttPayload& payload) {
+    return payload.equals("ON") || payload.equals("on") || payload.equals("1") ||
+           payload.equals("true") || payload.equals("True");
 }
 
-// ============================================================================
-// Switch Command Handler
-// ============================================================================
-
-SwitchCommandHandler::SwitchCommandHandler(const String& name,
-                                          std::function<void(bool)> setter,
-                                          std::function<void()> publisher)
-    : name_(name), setter_(setter), publisher_(publisher) {}
-
-void SwitchCommandHandler::handle(const String& payload) {
-    bool on = (payload == "ON" || payload == "on" || payload == "1" || 
-               payload == "true" || payload == "True");
-    setter_(on);
-    publisher_();
-}
-
-// ============================================================================
-// Number Command Handler
-// ============================================================================
-
-NumberCommandHandler::NumberCommandHandler(int min, int max,
-                                          std::function<void(int)> setter,
-                                          std::function<void()> publisher)
-    : min_(min), max_(max), setter_(setter), publisher_(publisher) {}
-
-void NumberCommandHandler::handle(const String& payload) {
-    int value = payload.toInt();
-    value = constrain(value, min_, max_);
-    setter_(value);
-    publisher_();
+// Same result as String::toInt() (leading blanks, optional sign, digits up
+// to the first other character, 0 if there are none) without a copy. Long
+// digit runs stop accumulating instead of overflowing; they clamp anyway.
+static int32_t parseInteger(const MqttPayload& payload) {
+    const char* p = payload.data;
+    const char* end = p + payload.length;
+    while (p < end && isspace((unsigned char)*p)) p++;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+    int32_t value = 0;
+    for (; p < end && isdigit((unsigned char)*p); ++p) {
+        if (value < 100000000) value = value * 10 + (*p - '0');
+    }
+    return negative ? -value : value;
 }
 
-// ============================================================================
-// Select Command Handler
-// ============================================================================
-
-SelectCommandHandler::SelectCommandHandler(const std::vector<String>& validOptions,
-                                          std::function<void(const String&)> setter,
-                                          std::function<void()> publisher)
-    : validOptions_(validOptions), setter_(setter), publisher_(publisher) {}
-
-void SelectCommandHandler::handle(const String& payload) {
-    // Try exact match first
-    for (const auto& option : validOptions_) {
-        if (payload == option) {
-            setter_(payload);
-            publisher_();
-            return;
-        }
+static const char* matchOption(const MqttCommand& cmd, const MqttPayload& payload) {
+    // Exact match first, then case-insensitive
+    for (uint8_t i = 0; i < cmd.optionCount; ++i) {
+        if (payload.equals(cmd.options[i])) return cmd.options[i];
     }
-    
-    // Try case-insensitive match
-    String payloadUpper = payload;
-    payloadUpper.toUpperCase();
-    for (const auto& option : validOptions_) {
-        String optionUpper = option;
-        optionUpper.toUpperCase();
-        if (payloadUpper == optionUpper) {
-            setter_(option);  // Use the valid option, not the payload
-            publisher_();
-            return;
-        }
+    for (uint8_t i = 0; i < cmd.optionCount; ++i) {
+        if (strlen(cmd.options[i]) == payload.length &&
+            strncasecmp(payload.data, cmd.options[i], payload.length) == 0) return cmd.options[i];
     }
-    
-    logWarn(String("Invalid option for select: ") + payload);
+    return nullptr;
 }
 
-// ============================================================================
-// Time String Command Handler
-// ============================================================================
+bool mqttRunCommand(const MqttCommand& cmd, const MqttPayload& payload) {
+    switch (cmd.kind) {
+        case MqttCommandKind::Action:
+            cmd.action(payload);
+            return true;
+
+        case MqttCommandKind::Switch:
+            cmd.onOff(parseOnOff(payload));
+            break;
+
+        case MqttCommandKind::Number: {
+            int32_t value = parseInteger(payload);
+            if (value < cmd.min) value = cmd.min;
+            if (value > cmd.max) value = cmd.max;
+            cmd.number((int)value);
+            break;
+        }
 
-TimeStringCommandHandler::TimeStringCommandHandler(
-    std::function<bool(const String&, uint16_t&)> parser,
-    std::function<void(uint16_t)> setter,
-    std::function<void()> publisher,
-    const String& name)
-    : parser_(parser), setter_(setter), publisher_(publisher), name_(name) {}
+        case MqttCommandKind::Select: {
+            const char* option = matchOption(cmd, payload);
+            if (!option) {
+                char text[32];
+                logWarn(String("Invalid option for select: ") + payload.copyTo(text, sizeof(text)));
+                return false;
+            }
+            cmd.select(option);  // Use the valid option, not the payload
+            break;
+        }
 
-void TimeStringCommandHandler::handle(const String& payload) {
-    uint16_t minutes = 0;
-    if (!parser_(payload, minutes)) {
-        logWarn(String("Invalid time string for ") + name_ + ": " + payload);
-        return;
+        case MqttCommandKind::Time: {
+            uint16_t minutes = 0;
+            if (!cmd.parseTime(payload.data, payload.length, minutes)) {
+                char text[32];
+                logWarn(String("Invalid time string for ") + cmd.name + ": " + payload.copyTo(text, sizeof(text)));
+                return false;
+            }
+            cmd.time(minutes);
+            break;
+        }
     }
-    setter_(minutes);
-    publisher_();
+    if (cmd.publish) cmd.publish();
+    return true;
 }
-
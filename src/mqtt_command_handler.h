@@ -2,156 +2,151 @@
 #define MQTT_COMMAND_HANDLER_H
 
 #include <Arduino.h>
-#include <functional>
-#include <map>
-#include <vector>
+#include <string.h>
+#include "mqtt_topics.h"
 
-/**
- * @brief Base class for MQTT command handlers
- * 
- * Implements the Command Pattern to replace the large if-else chain
- * in handleMessage(). Each handler encapsulates the logic for one
- * specific MQTT topic/command.
- */
-class MqttCommandHandler {
-public:
-    virtual ~MqttCommandHandler() = default;
-    
-    /**
-     * @brief Handle an incoming MQTT message
-     * @param payload The message payload as a string
-     */
-    virtual void handle(const String& payload) = 0;
-};
+// Command topics the clock subscribes to, as one constant table sorted by
+// topic suffix (like the web route table). An incoming message is matched
+// with a binary search on the part after the base topic; each entry carries
+// its handler inline as plain function pointers, so nothing is allocated to
+// register or dispatch a command. Payloads are passed as a view of the MQTT
+// client's receive buffer and the switch, number, select and time kinds parse
+// them in place.
 
 /**
- * @brief Registry of MQTT command handlers
- * 
- * Maps MQTT topics to their corresponding handlers.
- * Implements Singleton pattern for global access.
+ * @brief A received payload: a view of the client's buffer, not NUL-terminated
+ * @note Only valid for the duration of the callback
  */
-class MqttCommandRegistry {
-public:
-    static MqttCommandRegistry& instance();
-    
-    /**
-     * @brief Register a handler for a specific topic
-     * @param topic MQTT topic to handle
-     * @param handler Handler instance (ownership transferred to registry)
-     */
-    void registerHandler(const String& topic, MqttCommandHandler* handler);
-    
-    /**
-     * @brief Handle an incoming MQTT message
-     * @param topic MQTT topic
-     * @param payload Message payload
-     */
-    void handleMessage(const String& topic, const String& payload);
-    
-    /**
-     * @brief Helper for simple lambda handlers
-     * @param topic MQTT topic
-     * @param handler Lambda function to handle the message
-     */
-    void registerLambda(const String& topic, 
-                       std::function<void(const String&)> handler);
-    
-    /**
-     * @brief Clear all registered handlers (useful for testing)
-     */
-    void clear();
-    
-private:
-    MqttCommandRegistry() = default;
-    ~MqttCommandRegistry();
-    
-    std::map<String, MqttCommandHandler*> handlers_;
-    std::map<String, std::function<void(const String&)>> lambdaHandlers_;
-};
+struct MqttPayload {
+    const char* data;
+    size_t length;
 
-/**
- * @brief Handler for light commands (JSON with state/brightness/color)
- * 
- * Handles complex JSON payloads for controlling the LED light.
- */
-class LightCommandHandler : public MqttCommandHandler {
-public:
-    void handle(const String& payload) override;
-};
+    MqttPayload(const char* text) : data(text), length(text ? strlen(text) : 0) {}
+    MqttPayload(const char* bytes, size_t len) : data(bytes), length(len) {}
 
-/**
- * @brief Generic handler for simple switch commands (ON/OFF)
- * 
- * Handles boolean on/off commands with callback functions.
- */
-class SwitchCommandHandler : public MqttCommandHandler {
-public:
-    SwitchCommandHandler(const String& name, 
-                        std::function<void(bool)> setter,
-                        std::function<void()> publisher);
-    void handle(const String& payload) override;
-    
-private:
-    String name_;
-    std::function<void(bool)> setter_;
-    std::function<void()> publisher_;
+    bool equals(const char* text) const {
+        return strlen(text) == length && memcmp(data, text, length) == 0;
+    }
+
+    /** @brief Copy to @p out as a C string, truncated to fit (for log messages) */
+    const char* copyTo(char* out, size_t size) const {
+        size_t n = length < size - 1 ? length : size - 1;
+        memcpy(out, data, n);
+        out[n] = '\0';
+        return out;
+    }
 };
 
-/**
- * @brief Generic handler for number commands with validation
- * 
- * Handles numeric inputs with min/max constraints.
- */
-class NumberCommandHandler : public MqttCommandHandler {
-public:
-    NumberCommandHandler(int min, int max,
-                        std::function<void(int)> setter,
-                        std::function<void()> publisher);
-    void handle(const String& payload) override;
-    
-private:
-    int min_, max_;
-    std::function<void(int)> setter_;
-    std::function<void()> publisher_;
+/** @brief How a command payload is parsed before the setter runs */
+enum class MqttCommandKind : uint8_t {
+    Action,   // Raw payload (buttons, JSON light commands)
+    Switch,   // ON/OFF
+    Number,   // Integer, clamped to [min, max]
+    Select,   // One of a fixed option list (case-insensitive)
+    Time,     // HH:MM, parsed to minutes after midnight
 };
 
+typedef void (*MqttActionFn)(const MqttPayload& payload);
+typedef void (*MqttSwitchFn)(bool on);
+typedef void (*MqttNumberFn)(int value);
+typedef void (*MqttSelectFn)(const char* option);
+typedef bool (*MqttTimeParseFn)(const char* text, size_t length, uint16_t& minutes);
+typedef void (*MqttTimeFn)(uint16_t minutes);
+typedef void (*MqttPublishFn)();
+
 /**
- * @brief Generic handler for select/enum commands
- * 
- * Handles selection from a list of valid options.
+ * @brief One command topic and its handler
+ *
+ * Build entries with the mqttXxxCommand() helpers below; only the setter
+ * matching @ref kind is set.
  */
-class SelectCommandHandler : public MqttCommandHandler {
-public:
-    SelectCommandHandler(const std::vector<String>& validOptions,
-                        std::function<void(const String&)> setter,
-                        std::function<void()> publisher);
-    void handle(const String& payload) override;
-    
-private:
-    std::vector<String> validOptions_;
-    std::function<void(const String&)> setter_;
-    std::function<void()> publisher_;
+struct MqttCommand {
+    MqttTopic topic;
+    MqttCommandKind kind;
+    const char* name;              // For log messages
+    int16_t min, max;              // Number
+    const char* const* options;    // Select
+    uint8_t optionCount;
+    MqttActionFn action;
+    MqttSwitchFn onOff;
+    MqttNumberFn number;
+    MqttSelectFn select;
+    MqttTimeParseFn parseTime;
+    MqttTimeFn time;
+    MqttPublishFn publish;         // Echo the new state, or nullptr
 };
 
+constexpr MqttCommand mqttActionCommand(MqttTopic topic, MqttActionFn action) {
+    return MqttCommand{ topic, MqttCommandKind::Action, "", 0, 0, nullptr, 0,
+                        action, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+}
+
+constexpr MqttCommand mqttSwitchCommand(MqttTopic topic, const char* name,
+                                        MqttSwitchFn setter, MqttPublishFn publish) {
+    return MqttCommand{ topic, MqttCommandKind::Switch, name, 0, 0, nullptr, 0,
+                        nullptr, setter, nullptr, nullptr, nullptr, nullptr, publish };
+}
+
+constexpr MqttCommand mqttNumberCommand(MqttTopic topic, const char* name, int16_t min, int16_t max,
+                                        MqttNumberFn setter, MqttPublishFn publish) {
+    return MqttCommand{ topic, MqttCommandKind::Number, name, min, max, nullptr, 0,
+                        nullptr, nullptr, setter, nullptr, nullptr, nullptr, publish };
+}
+
+constexpr MqttCommand mqttSelectCommand(MqttTopic topic, const char* name,
+                                        const char* const* options, uint8_t optionCount,
+                                        MqttSelectFn setter, MqttPublishFn publish) {
+    return MqttCommand{ topic, MqttCommandKind::Select, name, 0, 0, options, optionCount,
+                        nullptr, nullptr, nullptr, setter, nullptr, nullptr, publish };
+}
+
+constexpr MqttCommand mqttTimeCommand(MqttTopic topic, const char* name, MqttTimeParseFn parser,
+                                      MqttTimeFn setter, MqttPublishFn publish) {
+    return MqttCommand{ topic, MqttCommandKind::Time, name, 0, 0, nullptr, 0,
+                        nullptr, nullptr, nullptr, nullptr, parser, setter, publish };
+}
+
+/** @brief strcmp() of two topic suffixes, usable in constant expressions */
+constexpr int mqttSuffixCompare(const char* a, const char* b) {
+    return (*a != *b || *a == '\0') ? (int)(unsigned char)*a - (int)(unsigned char)*b
+                                    : mqttSuffixCompare(a + 1, b + 1);
+}
+
+/** @brief True when suffixes strictly increase; use in a static_assert next to the table */
+constexpr bool mqttCommandsSorted(const MqttCommand* commands, size_t count) {
+    return count < 2 || (mqttSuffixCompare(MQTT_TOPIC_SUFFIX[(size_t)commands[0].topic],
+                                           MQTT_TOPIC_SUFFIX[(size_t)commands[1].topic]) < 0 &&
+                         mqttCommandsSorted(commands + 1, count - 1));
+}
+
 /**
- * @brief Handler for time string commands (HH:MM format)
- * 
- * Handles time inputs with validation and parsing.
+ * @brief Dispatches incoming messages to a sorted command table
  */
-class TimeStringCommandHandler : public MqttCommandHandler {
+class MqttCommandRegistry {
 public:
-    TimeStringCommandHandler(std::function<bool(const String&, uint16_t&)> parser,
-                            std::function<void(uint16_t)> setter,
-                            std::function<void()> publisher,
-                            const String& name);
-    void handle(const String& payload) override;
-    
+    constexpr MqttCommandRegistry(const MqttCommand* commands, size_t count)
+        : commands_(commands), count_(count) {}
+
+    /**
+     * @brief Find the command for a topic suffix ("/light/set")
+     * @return nullptr if no command uses that topic
+     */
+    const MqttCommand* find(const char* suffix) const;
+
+    /**
+     * @brief Parse @p payload and run the command registered for @p suffix
+     * @return false if the topic is unknown or the payload was rejected
+     */
+    bool handleMessage(const char* suffix, const MqttPayload& payload) const;
+
+    size_t size() const { return count_; }
+
 private:
-    std::function<bool(const String&, uint16_t&)> parser_;
-    std::function<void(uint16_t)> setter_;
-    std::function<void()> publisher_;
-    String name_;
+    const MqttCommand* commands_;
+    size_t count_;
 };
 
-#endif // MQTT_COMMAND_HANDLER_H
+/** @brief Run one command (parsing and validation per kind) */
+bool mqttRunCommand(const MqttCommand& cmd, const MqttPayload& payload);
 
+#endif // MQTT_COMMAND_HANDLER_H
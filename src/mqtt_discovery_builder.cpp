@@ -1,6 +1,5 @@
 #include "mqtt_discovery_builder.h"
 #include "log.h"
-#include <utility>
 
 MqttDiscoveryBuilder::MqttDiscoveryBuilder(PubSubClient& mqtt,
                                            const String& discoveryPrefix,
@@ -46,221 +45,249 @@ void MqttDiscoveryBuilder::addAvailability(JsonDocument& doc) {
 }
 
 void MqttDiscoveryBuilder::addLight(const String& stateTopic, const String& cmdTopic) {
-    Entity entity;
-    entity.component = "light";
-    entity.objectId = nodeId_ + "_light";
-    
-    entity.config["name"] = deviceName_;
-    entity.config["uniq_id"] = entity.objectId;
-    entity.config["stat_t"] = stateTopic;
-    entity.config["cmd_t"] = cmdTopic;
-    entity.config["schema"] = "json";
-    entity.config["brightness"] = true;
-    entity.config["rgb"] = true;
-    
-    addDeviceInfo(entity.config);
-    addAvailability(entity.config);
-    
-    entities_.push_back(std::move(entity));
+    if (!nextSelected()) return;
+    JsonDocument config;
+    const String objectId = nodeId_ + "_light";
+    
+    config["name"] = deviceName_;
+    config["uniq_id"] = objectId;
+    config["stat_t"] = stateTopic;
+    config["cmd_t"] = cmdTopic;
+    config["schema"] = "json";
+    config["brightness"] = true;
+    config["rgb"] = true;
+    config["transition"] = true;
+    
+    addDeviceInfo(config);
+    addAvailability(config);
+    
+    emit("light", objectId, config);
 }
 
 void MqttDiscoveryBuilder::addSwitch(const String& name, const String& uniqueId,
                                      const String& stateTopic, const String& cmdTopic) {
-    Entity entity;
-    entity.component = "switch";
-    entity.objectId = uniqueId;
+    if (!nextSelected()) return;
+    JsonDocument config;
     
-    entity.config["name"] = name;
-    entity.config["uniq_id"] = uniqueId;
-    entity.config["stat_t"] = stateTopic;
-    entity.config["cmd_t"] = cmdTopic;
-    entity.config["pl_on"] = "ON";
-    entity.config["pl_off"] = "OFF";
+    config["name"] = name;
+    config["uniq_id"] = uniqueId;
+    config["stat_t"] = stateTopic;
+    config["cmd_t"] = cmdTopic;
+    config["pl_on"] = "ON";
+    config["pl_off"] = "OFF";
     
-    addDeviceInfo(entity.config);
-    addAvailability(entity.config);
+    addDeviceInfo(config);
+    addAvailability(config);
     
-    entities_.push_back(std::move(entity));
+    emit("switch", uniqueId, config);
 }
 
 void MqttDiscoveryBuilder::addNumber(const String& name, const String& uniqueId,
                                      const String& stateTopic, const String& cmdTopic,
                                      int min, int max, int step,
                                      const String& unit, const String& mode) {
-    Entity entity;
-    entity.component = "number";
-    entity.objectId = uniqueId;
-    
-    entity.config["name"] = name;
-    entity.config["uniq_id"] = uniqueId;
-    entity.config["stat_t"] = stateTopic;
-    entity.config["cmd_t"] = cmdTopic;
-    entity.config["min"] = min;
-    entity.config["max"] = max;
-    entity.config["step"] = step;
-    entity.config["mode"] = mode;
+    if (!nextSelected()) return;
+    JsonDocument config;
+    
+    config["name"] = name;
+    config["uniq_id"] = uniqueId;
+    config["stat_t"] = stateTopic;
+    config["cmd_t"] = cmdTopic;
+    config["min"] = min;
+    config["max"] = max;
+    config["step"] = step;
+    config["mode"] = mode;
     
     if (unit.length() > 0) {
-        entity.config["unit_of_meas"] = unit;
+        config["unit_of_meas"] = unit;
     }
     
-    addDeviceInfo(entity.config);
-    addAvailability(entity.config);
+    addDeviceInfo(config);
+    addAvailability(config);
     
-    entities_.push_back(std::move(entity));
+    emit("number", uniqueId, config);
 }
 
 void MqttDiscoveryBuilder::addSelect(const String& name, const String& uniqueId,
                                      const String& stateTopic, const String& cmdTopic,
                                      const std::vector<String>& options) {
-    Entity entity;
-    entity.component = "select";
-    entity.objectId = uniqueId;
+    if (!nextSelected()) return;
+    JsonDocument config;
     
-    entity.config["name"] = name;
-    entity.config["uniq_id"] = uniqueId;
-    entity.config["stat_t"] = stateTopic;
-    entity.config["cmd_t"] = cmdTopic;
+    config["name"] = name;
+    config["uniq_id"] = uniqueId;
+    config["stat_t"] = stateTopic;
+    config["cmd_t"] = cmdTopic;
     
-    JsonArray opts = entity.config["options"].to<JsonArray>();
+    JsonArray opts = config["options"].to<JsonArray>();
     for (const auto& option : options) {
         opts.add(option);
     }
     
-    addDeviceInfo(entity.config);
-    addAvailability(entity.config);
+    addDeviceInfo(config);
+    addAvailability(config);
     
-    entities_.push_back(std::move(entity));
+    emit("select", uniqueId, config);
 }
 
 void MqttDiscoveryBuilder::addBinarySensor(const String& name, const String& uniqueId,
                                            const String& stateTopic,
                                            const String& deviceClass) {
-    Entity entity;
-    entity.component = "binary_sensor";
-    entity.objectId = uniqueId;
+    if (!nextSelected()) return;
+    JsonDocument config;
     
-    entity.config["name"] = name;
-    entity.config["uniq_id"] = uniqueId;
-    entity.config["stat_t"] = stateTopic;
-    entity.config["pl_on"] = "ON";
-    entity.config["pl_off"] = "OFF";
+    config["name"] = name;
+    config["uniq_id"] = uniqueId;
+    config["stat_t"] = stateTopic;
+    config["pl_on"] = "ON";
+    config["pl_off"] = "OFF";
     
     if (deviceClass.length() > 0) {
-        entity.config["dev_cla"] = deviceClass;
+        config["dev_cla"] = deviceClass;
     }
     
-    addDeviceInfo(entity.config);
-    addAvailability(entity.config);
+    addDeviceInfo(config);
+    addAvailability(config);
     
-    entities_.push_back(std::move(entity));
+    emit("binary_sensor", uniqueId, config);
 }
 
 void MqttDiscoveryBuilder::addButton(const String& name, const String& uniqueId,
                                      const String& cmdTopic,
                                      const String& deviceClass) {
-    Entity entity;
-    entity.component = "button";
-    entity.objectId = uniqueId;
+    if (!nextSelected()) return;
+    JsonDocument config;
     
-    entity.config["name"] = name;
-    entity.config["uniq_id"] = uniqueId;
-    entity.config["cmd_t"] = cmdTopic;
+    config["name"] = name;
+    config["uniq_id"] = uniqueId;
+    config["cmd_t"] = cmdTopic;
     
     if (deviceClass.length() > 0) {
-        entity.config["dev_cla"] = deviceClass;
+        config["dev_cla"] = deviceClass;
     }
     
-    addDeviceInfo(entity.config);
-    addAvailability(entity.config);
+    addDeviceInfo(config);
+    addAvailability(config);
     
-    entities_.push_back(std::move(entity));
+    emit("button", uniqueId, config);
 }
 
 void MqttDiscoveryBuilder::addSensor(const String& name, const String& uniqueId,
                                      const String& stateTopic,
                                      const String& unit,
                                      const String& deviceClass,
-                                     const String& stateClass) {
-    Entity entity;
-    entity.component = "sensor";
-    entity.objectId = uniqueId;
+                                     const String& stateClass,
+                                     const String& entityCategory) {
+    if (!nextSelected()) return;
+    JsonDocument config;
     
-    entity.config["name"] = name;
-    entity.config["uniq_id"] = uniqueId;
-    entity.config["stat_t"] = stateTopic;
+    config["name"] = name;
+    config["uniq_id"] = uniqueId;
+    config["stat_t"] = stateTopic;
     
     if (unit.length() > 0) {
-        entity.config["unit_of_meas"] = unit;
+        config["unit_of_meas"] = unit;
     }
     if (deviceClass.length() > 0) {
-        entity.config["dev_cla"] = deviceClass;
+        config["dev_cla"] = deviceClass;
     }
     if (stateClass.length() > 0) {
-        entity.config["stat_cla"] = stateClass;
+        config["stat_cla"] = stateClass;
+    }
+    if (entityCategory.length() > 0) {
+        config["ent_cat"] = entityCategory;
     }
     
-    addDeviceInfo(entity.config);
-    addAvailability(entity.config);
+    addDeviceInfo(config);
+    addAvailability(config);
     
-    entities_.push_back(std::move(entity));
+    emit("sensor", uniqueId, config);
 }
 
 void MqttDiscoveryBuilder::addText(const String& name, const String& uniqueId,
                                    const String& stateTopic, const String& cmdTopic,
                                    int minLen, int maxLen,
                                    const String& pattern, const String& mode) {
-    Entity entity;
-    entity.component = "text";
-    entity.objectId = uniqueId;
-    
-    entity.config["name"] = name;
-    entity.config["uniq_id"] = uniqueId;
-    entity.config["stat_t"] = stateTopic;
-    entity.config["cmd_t"] = cmdTopic;
-    entity.config["min"] = minLen;
-    entity.config["max"] = maxLen;
-    entity.config["mode"] = mode;
+    if (!nextSelected()) return;
+    JsonDocument config;
+    
+    config["name"] = name;
+    config["uniq_id"] = uniqueId;
+    config["stat_t"] = stateTopic;
+    config["cmd_t"] = cmdTopic;
+    config["min"] = minLen;
+    config["max"] = maxLen;
+    config["mode"] = mode;
     
     if (pattern.length() > 0) {
-        entity.config["pattern"] = pattern;
+        config["pattern"] = pattern;
     }
     
-    addDeviceInfo(entity.config);
-    addAvailability(entity.config);
+    addDeviceInfo(config);
+    addAvailability(config);
     
-    entities_.push_back(std::move(entity));
+    emit("text", uniqueId, config);
+}
+
+// Largest config (the light entity with device info) is well under this
+static const size_t DISCOVERY_PAYLOAD_MAX = 1024;
+static char s_payload[DISCOVERY_PAYLOAD_MAX];
+
+static uint32_t fnv1a(uint32_t h, const char* s, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (uint8_t)s[i];
+        h *= 16777619u;
+    }
+    return h;
 }
 
-void MqttDiscoveryBuilder::publishEntity(const Entity& entity) {
-    String topic = discoveryPrefix_ + "/" + entity.component + "/" + 
-                   entity.objectId + "/config";
+void MqttDiscoveryBuilder::emit(const char* component, const String& objectId, const JsonDocument& config) {
+    String topic = discoveryPrefix_ + "/" + component + "/" + objectId + "/config";
+    
+    size_t len = measureJson(config);
+    if (len >= DISCOVERY_PAYLOAD_MAX) {
+        logWarn(String("Discovery config too large: ") + component + "/" + objectId);
+        failed_++;
+        return;
+    }
+    serializeJson(config, s_payload, sizeof(s_payload));
     
-    String output;
-    serializeJson(entity.config, output);
+    hash_ = fnv1a(hash_, topic.c_str(), topic.length() + 1);
+    hash_ = fnv1a(hash_, s_payload, len + 1);
+    if (!publishing_) return;
     
-    if (mqtt_.publish(topic.c_str(), output.c_str(), true)) {
-        logDebug(String("Published discovery: ") + entity.component + "/" + entity.objectId);
+    if (!bufferSized_) {
+        mqtt_.setBufferSize(DISCOVERY_PAYLOAD_MAX);
+        bufferSized_ = true;
+    }
+    if (mqtt_.publish(topic.c_str(), s_payload, true)) {
+        logDebug(String("Published discovery: ") + component + "/" + objectId);
     } else {
-        logWarn(String("Failed to publish: ") + entity.component + "/" + entity.objectId);
+        logWarn(String("Failed to publish: ") + component + "/" + objectId);
+        failed_++;
     }
+    published_++;
 }
 
 int MqttDiscoveryBuilder::publish() {
-    mqtt_.setBufferSize(1024);
-    
-    int published = 0;
-    for (const auto& entity : entities_) {
-        publishEntity(entity);
-        published++;
-        delay(10);  // Small delay between publishes
+    if (publishing_) {
+        logInfo(String("Published ") + published_ + " discovery entities");
     }
-    
-    logInfo(String("Published ") + published + " discovery entities");
-    return published;
+    return published_;
 }
 
-void MqttDiscoveryBuilder::clear() {
-    entities_.clear();
+void MqttDiscoveryBuilder::addToHash(const String& text) {
+    hash_ = fnv1a(hash_, text.c_str(), text.length() + 1);
 }
 
+bool MqttDiscoveryBuilder::nextSelected() {
+    int index = seen_++;
+    return only_ < 0 || index == only_;
+}
+
+void MqttDiscoveryBuilder::clear() {
+    seen_ = 0;
+    published_ = 0;
+    failed_ = 0;
+    hash_ = 2166136261u;
+}
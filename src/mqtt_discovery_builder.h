@@ -13,7 +13,12 @@
  * - Handling common device information
  * - Managing topic generation
  * - Providing type-safe entity builders
- * - Batching publications
+ * - Streaming: each addXxx() serializes its entity into one shared buffer
+ *   and publishes it right away, so only one config is in memory at a time
+ * - Hashing every topic and payload, so a caller can run the same
+ *   sequence with publishing disabled and skip unchanged configs
+ *
+ * Call setDeviceInfo() before adding entities.
  */
 class MqttDiscoveryBuilder {
 public:
@@ -66,7 +71,8 @@ public:
                    const String& stateTopic,
                    const String& unit = "",
                    const String& deviceClass = "",
-                   const String& stateClass = "");
+                   const String& stateClass = "",
+                   const String& entityCategory = "");
     
     void addText(const String& name, const String& uniqueId,
                  const String& stateTopic, const String& cmdTopic,
@@ -74,26 +80,55 @@ public:
                  const String& pattern = "", const String& mode = "text");
     
     /**
-     * @brief Publish all configured entities to MQTT
-     * @return Number of entities published
+     * @brief Only hash entities from now on (no MQTT traffic)
+     */
+    void setPublishing(bool on) { publishing_ = on; }
+    
+    /**
+     * @brief Build and emit only the entity at @p index (-1: all of them)
+     *
+     * The other addXxx() calls return without serializing, so running the
+     * same add sequence with an increasing index spreads a publish over
+     * several main loop passes.
+     */
+    void select(int index) { only_ = index; }
+    
+    /**
+     * @brief Entities added since construction or clear(), selected or not
+     */
+    int count() const { return seen_; }
+    
+    /**
+     * @brief Finish a run and log it
+     * @return Number of entities published since construction or clear()
      */
     int publish();
     
     /**
-     * @brief Clear all entities (for republishing)
+     * @brief FNV-1a over every discovery topic and payload added so far
+     */
+    uint32_t hash() const { return hash_; }
+    
+    /**
+     * @brief Mix something that is not part of any config (the broker) into the hash
+     */
+    void addToHash(const String& text);
+    
+    /**
+     * @brief Entities that were too large or failed to publish
+     */
+    int failed() const { return failed_; }
+    
+    /**
+     * @brief Reset the counts and hash (for another run)
      */
     void clear();
     
 private:
-    struct Entity {
-        String component;
-        String objectId;
-        JsonDocument config;
-    };
-    
     void addDeviceInfo(JsonDocument& doc);
     void addAvailability(JsonDocument& doc);
-    void publishEntity(const Entity& entity);
+    bool nextSelected();
+    void emit(const char* component, const String& objectId, const JsonDocument& config);
     
     PubSubClient& mqtt_;
     String discoveryPrefix_;
@@ -106,7 +141,13 @@ private:
     String deviceManufacturer_;
     String deviceSwVersion_;
     
-    std::vector<Entity> entities_;
+    bool publishing_ = true;
+    bool bufferSized_ = false;
+    int only_ = -1;
+    int seen_ = 0;
+    int published_ = 0;
+    int failed_ = 0;
+    uint32_t hash_ = 2166136261u;
 };
 
 #endif // MQTT_DISCOVERY_BUILDER_H
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <Arduino.h>
+#include <string.h>
+#include "mqtt_topics.h"
+
+// Outgoing state messages wait here instead of being written to the socket
+// from inside a command callback. A topic is queued at most once: a newer
+// value replaces the queued one in place, so a burst of commands (a Home
+// Assistant scene) collapses to one write per topic. mqtt_loop() drains the
+// queue within a time budget.
+
+/** @brief Longest payload the outbox stores (the light state JSON is ~70 bytes) */
+#define MQTT_OUTBOX_PAYLOAD_MAX 96
+
+/**
+ * @brief One queued message
+ */
+struct MqttOutboxEntry {
+  MqttTopic topic;
+  bool retained;
+  uint8_t length;
+  char payload[MQTT_OUTBOX_PAYLOAD_MAX + 1];
+};
+
+/**
+ * @brief Counters for the status page
+ */
+struct MqttOutboxStats {
+  uint8_t depth = 0;
+  uint8_t highWater = 0;
+  uint32_t queued = 0;    // New entries
+  uint32_t merged = 0;    // Replaced a queued value for the same topic
+  uint32_t dropped = 0;   // Queue full or payload too long
+  uint32_t sent = 0;
+};
+
+/**
+ * @brief Fixed-capacity FIFO of outgoing messages, coalesced by topic
+ */
+class MqttOutbox {
+public:
+  static const uint8_t CAPACITY = 16;
+
+  enum class Result : uint8_t { Queued, Merged, Dropped };
+
+  /**
+   * @brief Queue @p payload for @p topic, replacing a queued value for the same topic
+   * @return Dropped when the queue is full or the payload does not fit
+   */
+  Result push(MqttTopic topic, const char* payload, bool retained = true) {
+    size_t len = payload ? strlen(payload) : 0;
+    if (len > MQTT_OUTBOX_PAYLOAD_MAX) {
+      stats_.dropped++;
+      return Result::Dropped;
+    }
+    MqttOutboxEntry* slot = nullptr;
+    Result result = Result::Merged;
+    for (uint8_t i = 0; i < count_ && !slot; ++i) {
+      MqttOutboxEntry& e = entries_[(head_ + i) % CAPACITY];
+      if (e.topic == topic) slot = &e;
+    }
+    if (!slot) {
+      if (count_ >= CAPACITY) {
+        stats_.dropped++;
+        return Result::Dropped;
+      }
+      slot = &entries_[(head_ + count_) % CAPACITY];
+      slot->topic = topic;
+      count_++;
+      if (count_ > stats_.highWater) stats_.highWater = count_;
+      result = Result::Queued;
+      stats_.queued++;
+    } else {
+      stats_.merged++;
+    }
+    slot->retained = retained;
+    slot->length = (uint8_t)len;
+    if (len) memcpy(slot->payload, payload, len);
+    slot->payload[len] = '\0';
+    return result;
+  }
+
+  /**
+   * @brief Send queued messages in order until the queue is empty or @p budgetUs is used up
+   * @param publish bool(const MqttOutboxEntry&); false leaves the entry queued and stops
+   * @return Number of messages sent (at least one is attempted per call)
+   */
+  template <typename Publish>
+  uint8_t drain(Publish publish, uint32_t budgetUs) {
+    uint32_t start = micros();
+    uint8_t sent = 0;
+    while (count_ > 0) {
+      if (!publish(entries_[head_])) break;
+      head_ = (head_ + 1) % CAPACITY;
+      count_--;
+      sent++;
+      stats_.sent++;
+      if ((uint32_t)(micros() - start) >= budgetUs) break;
+    }
+    return sent;
+  }
+
+  /** @brief Forget queued messages (counters are kept) */
+  void clear() {
+    head_ = 0;
+    count_ = 0;
+  }
+
+  bool empty() const { return count_ == 0; }
+  uint8_t depth() const { return count_; }
+
+  MqttOutboxStats stats() const {
+    MqttOutboxStats s = stats_;
+    s.depth = count_;
+    return s;
+  }
+
+private:
+  MqttOutboxEntry entries_[CAPACITY];
+  uint8_t head_ = 0;
+  uint8_t count_ = 0;
+  MqttOutboxStats stats_;
+};
@@ -0,0 +1,143 @@
+#include "mqtt_probe.h"
+
+#include <PubSubClient.h>
+#include <WiFiClient.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "log.h"
+
+static const uint32_t PROBE_STACK_BYTES = 6144;
+static const int32_t PROBE_TCP_TIMEOUT_MS = 3000;
+static const uint16_t PROBE_MQTT_TIMEOUT_S = 5;
+
+// Inputs are copied so the task never touches Strings owned by loop()
+struct ProbeJob {
+  char host[96];
+  char user[64];
+  char pass[64];
+  uint16_t port;
+  bool handshake;
+  uint32_t startMs;
+};
+
+static ProbeJob job;
+static MqttProbeResult result;
+static bool unreported = false;
+static uint32_t nextJobId = 1;
+static portMUX_TYPE probeMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void copyField(char* dst, size_t len, const String& src) {
+  strncpy(dst, src.c_str(), len - 1);
+  dst[len - 1] = '\0';
+}
+
+static void finish(MqttProbeState state, int mqttState) {
+  uint32_t elapsed = millis() - job.startMs;
+  portENTER_CRITICAL(&probeMux);
+  result.state = state;
+  result.mqttState = mqttState;
+  result.durationMs = elapsed;
+  unreported = true;
+  portEXIT_CRITICAL(&probeMux);
+}
+
+static void runProbe() {
+  WiFiClient tcp;
+  if (!tcp.connect(job.host, job.port, PROBE_TCP_TIMEOUT_MS)) {
+    finish(MqttProbeState::TcpFailed, 0);
+    return;
+  }
+  tcp.stop();
+
+  if (job.handshake) {
+    WiFiClient mc;
+    PubSubClient client(mc);
+    client.setServer(job.host, job.port);
+    client.setSocketTimeout(PROBE_MQTT_TIMEOUT_S);
+    String cid = String("wordclock_test_") + String(millis());
+    if (!client.connect(cid.c_str(), job.user, job.pass)) {
+      finish(MqttProbeState::AuthFailed, client.state());
+      return;
+    }
+    client.disconnect();
+  }
+  finish(MqttProbeState::Ok, 0);
+}
+
+static void probeTask(void*) {
+  // Clients live in runProbe() so their destructors run before the task is deleted
+  runProbe();
+  vTaskDelete(nullptr);
+}
+
+uint32_t mqttProbeStart(const String& host, uint16_t port, const String& user, const String& pass, bool handshake) {
+  portENTER_CRITICAL(&probeMux);
+  bool busy = result.state == MqttProbeState::Running;
+  uint32_t id = 0;
+  if (!busy) {
+    id = nextJobId++;
+    result = MqttProbeResult();
+    result.job = id;
+    if (nextJobId == 0) nextJobId = 1;
+    result.state = MqttProbeState::Running;
+    unreported = false;
+  }
+  portEXIT_CRITICAL(&probeMux);
+  if (busy) return 0;
+
+  copyField(job.host, sizeof(job.host), host);
+  copyField(job.user, sizeof(job.user), user);
+  copyField(job.pass, sizeof(job.pass), pass);
+  job.port = port;
+  job.handshake = handshake;
+  job.startMs = millis();
+
+  // Core 0 runs the network stack; the clock keeps rendering on core 1
+  if (xTaskCreatePinnedToCore(probeTask, "mqtt_probe", PROBE_STACK_BYTES, nullptr, 1, nullptr, 0) != pdPASS) {
+    logError("❌ MQTT test: could not start task");
+    finish(MqttProbeState::StartFailed, 0);
+  }
+  return id;
+}
+
+bool mqttProbeResult(uint32_t id, MqttProbeResult& out) {
+  portENTER_CRITICAL(&probeMux);
+  bool found = id != 0 && id == result.job;
+  if (found) out = result;
+  portEXIT_CRITICAL(&probeMux);
+  return found;
+}
+
+bool mqttProbeTakeFinished(MqttProbeResult& out) {
+  portENTER_CRITICAL(&probeMux);
+  bool ready = unreported;
+  if (ready) {
+    out = result;
+    unreported = false;
+  }
+  portEXIT_CRITICAL(&probeMux);
+  return ready;
+}
+
+const char* mqttProbeStateName(MqttProbeState state) {
+  switch (state) {
+    case MqttProbeState::Idle:        return "idle";
+    case MqttProbeState::Running:     return "running";
+    case MqttProbeState::Ok:          return "ok";
+    case MqttProbeState::TcpFailed:   return "tcp_failed";
+    case MqttProbeState::AuthFailed:  return "auth_failed";
+    case MqttProbeState::StartFailed: return "start_failed";
+  }
+  return "unknown";
+}
+
+String mqttProbeMessage(const MqttProbeResult& r) {
+  switch (r.state) {
+    case MqttProbeState::Running:     return "Testing";
+    case MqttProbeState::Ok:          return "OK";
+    case MqttProbeState::TcpFailed:   return "TCP connect failed";
+    case MqttProbeState::AuthFailed:  return String("MQTT auth failed (state ") + r.mqttState + ")";
+    case MqttProbeState::StartFailed: return "Could not start test";
+    default:                          return "";
+  }
+}
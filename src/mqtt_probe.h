@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Broker connection test that runs in its own FreeRTOS task, so a slow or
+// unreachable host never stalls loop(). One test runs at a time; the result
+// of the most recent one stays available until the next test starts.
+
+enum class MqttProbeState : uint8_t {
+  Idle,
+  Running,
+  Ok,
+  TcpFailed,    // Host unreachable or port closed
+  AuthFailed,   // Broker refused the MQTT handshake
+  StartFailed,  // Task could not be created
+};
+
+/**
+ * @brief Outcome of a broker test
+ */
+struct MqttProbeResult {
+  uint32_t job = 0;
+  MqttProbeState state = MqttProbeState::Idle;
+  int mqttState = 0;        // PubSubClient::state() for AuthFailed
+  uint32_t durationMs = 0;
+};
+
+/**
+ * @brief Start a broker test in the background
+ * @param handshake Also log in with @p user / @p pass (TCP reachability only when false)
+ * @return Job ID (never 0), or 0 when a test is already running
+ */
+uint32_t mqttProbeStart(const String& host, uint16_t port, const String& user, const String& pass, bool handshake);
+
+/**
+ * @brief Look up a test result
+ * @return false if @p job is not the most recent test
+ */
+bool mqttProbeResult(uint32_t job, MqttProbeResult& out);
+
+/**
+ * @brief Hand over a test that finished since the last call (once per test)
+ * @note Call from loop(); used to push the result to connected clients
+ */
+bool mqttProbeTakeFinished(MqttProbeResult& out);
+
+/** @brief Short name of a probe state ("running", "ok", ...) */
+const char* mqttProbeStateName(MqttProbeState state);
+
+/** @brief Human readable outcome, matching the old synchronous endpoint's messages */
+String mqttProbeMessage(const MqttProbeResult& result);
@@ -1,5 +1,6 @@
 #include "mqtt_settings.h"
 #include <Preferences.h>
+#include "counted_preferences.h"
 
 static const char* NS = "mqtt";
 
@@ -38,7 +39,7 @@ bool mqtt_settings_load(MqttSettings& out) {
 }
 
 bool mqtt_settings_save(const MqttSettings& in) {
-  Preferences p;
+  CountedPreferences p;
   if (!p.begin(NS, /*readOnly*/ false)) return false;
   bool ok = true;
   ok &= p.putString("host", in.host) > 0 || in.host.length() == 0;
@@ -51,3 +52,20 @@ bool mqtt_settings_save(const MqttSettings& in) {
   p.end();
   return ok;
 }
+
+uint32_t mqtt_discovery_hash_load() {
+  Preferences p;
+  if (!p.begin(NS, /*readOnly*/ true)) return 0;
+  uint32_t h = p.getUInt("disc_hash", 0);
+  p.end();
+  return h;
+}
+
+void mqtt_discovery_hash_save(uint32_t hash) {
+  CountedPreferences p;
+  if (!p.begin(NS, /*readOnly*/ false)) return;
+  if (p.getUInt("disc_hash", 0) != hash) {
+    p.putUInt("disc_hash", hash);
+  }
+  p.end();
+}
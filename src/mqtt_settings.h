@@ -18,3 +18,8 @@ bool mqtt_settings_load(MqttSettings& out);
 
 // Save to Preferences (persist across reboots)
 bool mqtt_settings_save(const MqttSettings& in);
+
+// Hash of the last Home Assistant discovery set published (0 = none), so an
+// unchanged set is not republished on every reconnect
+uint32_t mqtt_discovery_hash_load();
+void mqtt_discovery_hash_save(uint32_t hash);
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// MQTT topics of this device: the configured base topic followed by a fixed
+// suffix. The base is stored once, at the front of a small buffer; a topic is
+// composed by copying its suffix behind it, so no per-topic strings are kept.
+// Nothing here depends on PubSubClient, so it can be tested natively.
+
+/** @brief Every topic the clock publishes or subscribes to */
+enum class MqttTopic : uint8_t {
+  Availability,
+  Birth,
+  LightState, LightSet,
+  ClockState, ClockSet,
+  AnimState, AnimSet,
+  AutoUpdState, AutoUpdSet,
+  HetIsState, HetIsSet,
+  NightEnabledState, NightEnabledSet,
+  NightOverrideState, NightOverrideSet,
+  NightActiveState,
+  NightEffectState, NightEffectSet,
+  NightDimState, NightDimSet,
+  NightStartState, NightStartSet,
+  NightEndState, NightEndSet,
+  LogLvlState, LogLvlSet,
+  RestartCmd, SeqCmd, UpdateCmd,
+  Version, UiVersion, Ip, Rssi, Uptime,
+  Heap, WifiChan, BootReason, ResetCount,
+  HeapBlock, HeapFrag, LoopAvg, LoopMax, Fps, ShowTime, LogWrite, NvsWrites,
+  UpdateChannelState, UpdateAutoAllowed, UpdateAvailable,
+  Count
+};
+
+static constexpr size_t MQTT_TOPIC_COUNT = (size_t)MqttTopic::Count;
+
+/** @brief Suffix of each topic, indexed by MqttTopic */
+static constexpr const char* const MQTT_TOPIC_SUFFIX[] = {
+  "/availability",
+  "/birth",
+  "/light/state", "/light/set",
+  "/clock/state", "/clock/set",
+  "/animate/state", "/animate/set",
+  "/autoupdate/state", "/autoupdate/set",
+  "/hetis/state", "/hetis/set",
+  "/nightmode/enabled/state", "/nightmode/enabled/set",
+  "/nightmode/override/state", "/nightmode/override/set",
+  "/nightmode/active",
+  "/nightmode/effect/state", "/nightmode/effect/set",
+  "/nightmode/dim/state", "/nightmode/dim/set",
+  "/nightmode/start/state", "/nightmode/start/set",
+  "/nightmode/end/state", "/nightmode/end/set",
+  "/loglevel/state", "/loglevel/set",
+  "/restart/press", "/sequence/press", "/update/press",
+  "/version", "/uiversion", "/ip", "/rssi", "/laststartup",
+  "/heap", "/wifi_channel", "/boot_reason", "/reset_count",
+  "/heap_block", "/heap_frag", "/perf/loop_avg", "/perf/loop_max", "/perf/fps", "/perf/show_time", "/perf/log_write", "/perf/nvs_writes",
+  "/update/channel", "/update/auto_allowed", "/update/available",
+};
+static_assert(sizeof(MQTT_TOPIC_SUFFIX) / sizeof(MQTT_TOPIC_SUFFIX[0]) == MQTT_TOPIC_COUNT,
+              "one suffix per MqttTopic");
+
+/** @brief strlen() usable in constant expressions */
+constexpr size_t mqttTopicLength(const char* s) {
+  return *s ? 1 + mqttTopicLength(s + 1) : 0;
+}
+
+/** @brief Length of the longest suffix in the table */
+constexpr size_t mqttTopicLongestSuffix(size_t i = 0, size_t longest = 0) {
+  return i >= MQTT_TOPIC_COUNT ? longest
+       : mqttTopicLongestSuffix(i + 1, mqttTopicLength(MQTT_TOPIC_SUFFIX[i]) > longest
+                                          ? mqttTopicLength(MQTT_TOPIC_SUFFIX[i]) : longest);
+}
+
+/** @brief Longest topic (base + suffix) the buffer holds, without terminator */
+static constexpr size_t MQTT_TOPIC_MAX = 127;
+/** @brief Longest base topic that still fits every suffix */
+static constexpr size_t MQTT_TOPIC_BASE_MAX = MQTT_TOPIC_MAX - mqttTopicLongestSuffix();
+
+/**
+ * @brief Base topic plus a scratch buffer to compose full topics in
+ *
+ * get() returns a pointer into the shared buffer, valid until the next get().
+ * PubSubClient copies the topic into its packet buffer, so passing the result
+ * straight to publish()/subscribe() is safe.
+ */
+class MqttTopics {
+public:
+  MqttTopics() { buf_[0] = '\0'; }
+
+  /**
+   * @brief Store the base topic (trailing '/' removed)
+   * @return false if the base was longer than MQTT_TOPIC_BASE_MAX and got truncated
+   */
+  bool setBase(const char* base) {
+    size_t len = base ? strlen(base) : 0;
+    while (len > 0 && base[len - 1] == '/') --len;
+    bool fits = len <= MQTT_TOPIC_BASE_MAX;
+    if (!fits) len = MQTT_TOPIC_BASE_MAX;
+    if (len) memcpy(buf_, base, len);
+    buf_[len] = '\0';
+    baseLen_ = len;
+    return fits;
+  }
+
+  /** @brief Base topic without trailing '/'; shares the buffer with get() */
+  const char* base() {
+    buf_[baseLen_] = '\0';
+    return buf_;
+  }
+
+  size_t baseLength() const { return baseLen_; }
+
+  /** @brief Full topic string for @p t */
+  const char* get(MqttTopic t) {
+    const char* suffix = MQTT_TOPIC_SUFFIX[(size_t)t];
+    memcpy(buf_ + baseLen_, suffix, strlen(suffix) + 1);
+    return buf_;
+  }
+
+  /**
+   * @brief Identify an incoming topic
+   * @return false if @p topic is not one of ours
+   */
+  bool match(const char* topic, MqttTopic& out) const {
+    const char* suffix = suffixOf(topic);
+    if (!suffix) return false;
+    for (size_t i = 0; i < MQTT_TOPIC_COUNT; ++i) {
+      if (strcmp(MQTT_TOPIC_SUFFIX[i], suffix) == 0) {
+        out = (MqttTopic)i;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Part of @p topic after the base ("/light/set")
+   * @return nullptr if @p topic does not start with the base and a '/'
+   */
+  const char* suffixOf(const char* topic) const {
+    if (!topic || strncmp(topic, buf_, baseLen_) != 0) return nullptr;
+    const char* suffix = topic + baseLen_;
+    return *suffix == '/' ? suffix : nullptr;
+  }
+
+private:
+  char buf_[MQTT_TOPIC_MAX + 1];
+  size_t baseLen_ = 0;
+};
@@ -0,0 +1,215 @@
+#include "mqtt_transport.h"
+
+#include <lwip/dns.h>
+#include <lwip/sockets.h>
+
+// CONNACK, session not present, return code 0 (accepted)
+static const uint8_t PROVISIONAL_CONNACK[4] = { 0x20, 0x02, 0x00, 0x00 };
+
+// The DNS callback runs on the lwIP task. Lookups are numbered so that a
+// late answer for an abandoned lookup is ignored.
+static volatile uint32_t dnsSeq = 0;
+static volatile bool dnsDone = false;
+static volatile uint32_t dnsAddr = 0;
+
+static void dnsFound(const char*, const ip_addr_t* addr, void* arg) {
+  if ((uint32_t)(uintptr_t)arg != dnsSeq) return;
+  dnsAddr = addr ? ip4_addr_get_u32(ip_2_ip4(addr)) : 0;
+  dnsDone = true;
+}
+
+void MqttTransport::open(const char* host, uint16_t port) {
+  stop();
+  port_ = port;
+  error_[0] = '\0';
+  stepStart_ = millis();
+
+  if (ip_.fromString(host)) {
+    startTcp();
+    return;
+  }
+  ip_addr_t addr;
+  dnsDone = false;
+  uint32_t seq = ++dnsSeq;
+  err_t err = dns_gethostbyname(host, &addr, dnsFound, (void*)(uintptr_t)seq);
+  if (err == ERR_OK) {
+    ip_ = IPAddress(ip4_addr_get_u32(ip_2_ip4(&addr)));
+    startTcp();
+  } else if (err == ERR_INPROGRESS) {
+    step_ = Step::Resolving;
+  } else {
+    fail("DNS lookup failed");
+  }
+}
+
+MqttTransport::Step MqttTransport::poll() {
+  switch (step_) {
+    case Step::Resolving:
+      if (dnsDone) {
+        if (dnsAddr == 0) {
+          fail("DNS lookup failed");
+        } else {
+          ip_ = IPAddress((uint32_t)dnsAddr);
+          startTcp();
+        }
+      } else if (timedOut(RESOLVE_TIMEOUT_MS)) {
+        fail("DNS timeout");
+      }
+      break;
+    case Step::Connecting:
+      pollTcp();
+      break;
+    case Step::Handshake:
+      pollConnack();
+      break;
+    default:
+      break;
+  }
+  return step_;
+}
+
+void MqttTransport::startTcp() {
+  fd_ = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd_ < 0) {
+    fail("no socket available", errno);
+    return;
+  }
+  lwip_fcntl(fd_, F_SETFL, lwip_fcntl(fd_, F_GETFL, 0) | O_NONBLOCK);
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = (uint32_t)ip_;
+  addr.sin_port = htons(port_);
+  if (lwip_connect(fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+    fail("TCP connect failed", errno);
+    return;
+  }
+  step_ = Step::Connecting;
+  stepStart_ = millis();
+}
+
+void MqttTransport::pollTcp() {
+  fd_set writable;
+  FD_ZERO(&writable);
+  FD_SET(fd_, &writable);
+  struct timeval now = { 0, 0 };
+  int ready = lwip_select(fd_ + 1, nullptr, &writable, nullptr, &now);
+  if (ready < 0) {
+    fail("TCP connect failed", errno);
+    return;
+  }
+  if (ready == 0) {
+    if (timedOut(CONNECT_TIMEOUT_MS)) fail("TCP connect timeout");
+    return;
+  }
+  int sockErr = 0;
+  socklen_t len = sizeof(sockErr);
+  lwip_getsockopt(fd_, SOL_SOCKET, SO_ERROR, &sockErr, &len);
+  if (sockErr != 0) {
+    fail("TCP connect failed", sockErr);
+    return;
+  }
+
+  // WiFiClient expects a blocking socket (it uses select() itself)
+  lwip_fcntl(fd_, F_SETFL, lwip_fcntl(fd_, F_GETFL, 0) & ~O_NONBLOCK);
+  tcp_ = WiFiClient(fd_);
+  fd_ = -1;
+  provisional_ = sizeof(PROVISIONAL_CONNACK);
+  step_ = Step::Handshake;
+  stepStart_ = millis();
+}
+
+void MqttTransport::pollConnack() {
+  if (tcp_.available() < (int)sizeof(PROVISIONAL_CONNACK)) {
+    if (!tcp_.connected()) fail("connection closed during handshake");
+    else if (timedOut(CONNACK_TIMEOUT_MS)) fail("CONNACK timeout");
+    return;
+  }
+  uint8_t ack[4];
+  tcp_.read(ack, sizeof(ack));
+  if (ack[0] != 0x20 || ack[1] != 0x02) {
+    fail("invalid CONNACK");
+  } else if (ack[3] != 0) {
+    // Same numbers as PubSubClient::state()
+    char msg[40];
+    snprintf(msg, sizeof(msg), "broker refused connection (state %u)", ack[3]);
+    fail(msg);
+  } else {
+    step_ = Step::Open;
+  }
+}
+
+void MqttTransport::fail(const char* error, int code) {
+  stop();
+  if (code) snprintf(error_, sizeof(error_), "%s (errno %d)", error, code);
+  else snprintf(error_, sizeof(error_), "%s", error);
+  step_ = Step::Failed;
+}
+
+bool MqttTransport::timedOut(uint32_t limitMs) const {
+  return (uint32_t)(millis() - stepStart_) >= limitMs;
+}
+
+// ============================================================================
+// Client
+// ============================================================================
+
+int MqttTransport::connect(IPAddress, uint16_t) {
+  return 0;
+}
+
+int MqttTransport::connect(const char*, uint16_t) {
+  return 0;
+}
+
+size_t MqttTransport::write(uint8_t b) {
+  return connected() ? tcp_.write(b) : 0;
+}
+
+size_t MqttTransport::write(const uint8_t* buf, size_t size) {
+  return connected() ? tcp_.write(buf, size) : 0;
+}
+
+int MqttTransport::available() {
+  if (provisional_) return provisional_;
+  return step_ == Step::Open ? tcp_.available() : 0;
+}
+
+int MqttTransport::read() {
+  if (provisional_) return PROVISIONAL_CONNACK[sizeof(PROVISIONAL_CONNACK) - provisional_--];
+  return step_ == Step::Open ? tcp_.read() : -1;
+}
+
+int MqttTransport::read(uint8_t* buf, size_t size) {
+  if (provisional_) {
+    size_t n = 0;
+    while (provisional_ && n < size) buf[n++] = (uint8_t)read();
+    return (int)n;
+  }
+  return step_ == Step::Open ? tcp_.read(buf, size) : -1;
+}
+
+int MqttTransport::peek() {
+  if (provisional_) return PROVISIONAL_CONNACK[sizeof(PROVISIONAL_CONNACK) - provisional_];
+  return step_ == Step::Open ? tcp_.peek() : -1;
+}
+
+void MqttTransport::flush() {
+  tcp_.flush();
+}
+
+void MqttTransport::stop() {
+  if (step_ == Step::Resolving) dnsSeq = dnsSeq + 1;  // Drop the pending answer
+  if (fd_ >= 0) {
+    lwip_close(fd_);
+    fd_ = -1;
+  }
+  tcp_.stop();
+  provisional_ = 0;
+  step_ = Step::Idle;
+}
+
+uint8_t MqttTransport::connected() {
+  return (step_ == Step::Handshake || step_ == Step::Open) && tcp_.connected();
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+// Network client for PubSubClient whose connection set-up never blocks.
+// open() starts an asynchronous DNS lookup and poll() moves on to a
+// non-blocking TCP connect, then waits for the broker's CONNACK.
+//
+// PubSubClient::connect() sends CONNECT and then spins until it has read the
+// CONNACK itself. To keep that call from waiting on the network, the
+// transport hands it a provisional "accepted" reply and holds back all
+// received data until the broker's real CONNACK has arrived and been checked
+// by poll(). The caller must not use the session before poll() returns Open.
+
+class MqttTransport : public Client {
+public:
+  enum class Step : uint8_t {
+    Idle,
+    Resolving,    // DNS lookup in flight
+    Connecting,   // TCP connect in flight
+    Handshake,    // TCP up: send CONNECT now; CONNACK pending
+    Open,
+    Failed,       // See error()
+  };
+
+  static const uint32_t RESOLVE_TIMEOUT_MS = 10000;
+  static const uint32_t CONNECT_TIMEOUT_MS = 5000;
+  static const uint32_t CONNACK_TIMEOUT_MS = 5000;
+
+  /**
+   * @brief Start connecting to @p host (name or dotted IPv4 address)
+   * @note Closes any previous connection
+   */
+  void open(const char* host, uint16_t port);
+
+  /**
+   * @brief Advance the set-up without blocking
+   * @return The current step; call once per loop until Open or Failed
+   */
+  Step poll();
+
+  Step step() const { return step_; }
+
+  /** @brief Why the last set-up failed */
+  const char* error() const { return error_; }
+
+  // Client (connect() is not supported; use open())
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char* host, uint16_t port) override;
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size) override;
+  int peek() override;
+  void flush() override;
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+
+private:
+  void startTcp();
+  void pollTcp();
+  void pollConnack();
+  void fail(const char* error, int code = 0);
+  bool timedOut(uint32_t limitMs) const;
+
+  WiFiClient tcp_;
+  Step step_ = Step::Idle;
+  IPAddress ip_;
+  uint16_t port_ = 0;
+  int fd_ = -1;             // Socket while Connecting; owned by tcp_ afterwards
+  uint32_t stepStart_ = 0;
+  uint8_t provisional_ = 0; // Provisional CONNACK bytes not yet read
+  char error_[48] = "";
+};
@@ -5,6 +5,7 @@
 #include "config.h"
 #include "log.h"
 #include "led_controller.h"
+#include "light_fader.h"
 #include "secrets.h"
 #include "system_utils.h"
 
@@ -70,7 +71,7 @@ void processNetwork() {
   if (!connected) {
     unsigned long now = millis();
     if (lastReconnectAttemptMs == 0 || now - lastReconnectAttemptMs >= WIFI_RECONNECT_INTERVAL_MS) {
-      logInfo("🔄 Attempting WiFi reconnect...");
+      logInfoLimited("🔄 Attempting WiFi reconnect...");
       WiFi.reconnect();
       lastReconnectAttemptMs = now;
     }
@@ -87,6 +88,7 @@ void resetWiFiSettings() {
   auto& wm = getManager();
   wm.resetSettings();
   clockEnabled = false;
+  lightFader.cancel();
   showLeds({});
   delay(EEPROM_WRITE_DELAY_MS);
   safeRestart();
@@ -1,6 +1,8 @@
 #include "night_mode.h"
+#include <ctype.h>
+#include <string.h>
 #include "log.h"
-#include "mqtt_client.h"
+#include "state_dirty.h"
 
 NightMode nightMode;
 
@@ -54,6 +56,7 @@ void NightMode::setEnabled(bool on) {
   if (enabled_ == on) return;
   enabled_ = on;
   markDirty();  // Instead of persistEnabled()
+  stateMarkDirty(DIRTY_NIGHT_ENABLED);
   logInfo(String("🌙 Night mode ") + (enabled_ ? "enabled" : "disabled"));
   updateEffectiveState("enabled");
 }
@@ -62,6 +65,7 @@ void NightMode::setEffect(NightModeEffect mode) {
   if (effect_ == mode) return;
   effect_ = mode;
   markDirty();  // Instead of persistEffect()
+  stateMarkDirty(DIRTY_NIGHT_EFFECT);
   const char* label = (effect_ == NightModeEffect::Off) ? "off" : "dim";
   logInfo(String("🌙 Night mode effect -> ") + label);
   updateEffectiveState("effect");
@@ -72,8 +76,8 @@ void NightMode::setDimPercent(uint8_t pct) {
   if (dimPercent_ == pct) return;
   dimPercent_ = pct;
   markDirty();  // Instead of persistDimPercent()
+  stateMarkDirty(DIRTY_NIGHT_DIM);
   logInfo(String("🌙 Night mode dim -> ") + pct + "%");
-  publishState();
 }
 
 void NightMode::setSchedule(uint16_t startMin, uint16_t endMin) {
@@ -83,6 +87,7 @@ void NightMode::setSchedule(uint16_t startMin, uint16_t endMin) {
   startMinutes_ = startMin;
   endMinutes_ = endMin;
   markDirty();  // Instead of persistSchedule()
+  stateMarkDirty(DIRTY_NIGHT_SCHEDULE);
   logInfo(String("🌙 Night schedule -> ") + formatMinutes(startMinutes_) + " - " + formatMinutes(endMinutes_));
   if (overrideMode_ == NightModeOverride::Auto && hasValidTime_) {
     updateEffectiveState("schedule-update");
@@ -92,6 +97,7 @@ void NightMode::setSchedule(uint16_t startMin, uint16_t endMin) {
 void NightMode::setOverride(NightModeOverride mode) {
   if (overrideMode_ == mode) return;
   overrideMode_ = mode;
+  stateMarkDirty(DIRTY_NIGHT_OVERRIDE);
   const char* label = "auto";
   if (mode == NightModeOverride::ForceOn) label = "force-on";
   else if (mode == NightModeOverride::ForceOff) label = "force-off";
@@ -122,16 +128,29 @@ String NightMode::formatMinutes(uint16_t minutes) const {
 }
 
 bool NightMode::parseTimeString(const String& text, uint16_t& minutesOut) {
-  String trimmed = text;
-  trimmed.trim();
-  if (trimmed.length() < 4) return false;
-  int colon = trimmed.indexOf(':');
-  if (colon <= 0) return false;
-  String hStr = trimmed.substring(0, colon);
-  String mStr = trimmed.substring(colon + 1);
-  if (hStr.length() == 0 || mStr.length() == 0) return false;
-  int hour = hStr.toInt();
-  int minute = mStr.toInt();
+  return parseTimeString(text.c_str(), text.length(), minutesOut);
+}
+
+// atol() on [p, end): leading blanks, optional sign, digits
+static int parseField(const char* p, const char* end) {
+  while (p < end && isspace((unsigned char)*p)) p++;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+  int value = 0;
+  for (; p < end && isdigit((unsigned char)*p) && value < 10000; ++p) value = value * 10 + (*p - '0');
+  return negative ? -value : value;
+}
+
+bool NightMode::parseTimeString(const char* text, size_t length, uint16_t& minutesOut) {
+  const char* begin = text;
+  const char* end = text + length;
+  while (begin < end && isspace((unsigned char)*begin)) begin++;
+  while (end > begin && isspace((unsigned char)end[-1])) end--;
+  if (end - begin < 4) return false;
+  const char* colon = static_cast<const char*>(memchr(begin, ':', end - begin));
+  if (!colon || colon == begin || colon + 1 == end) return false;
+  int hour = parseField(begin, colon);
+  int minute = parseField(colon + 1, end);
   if (hour < 0 || hour > 23 || minute < 0 || minute > 59) return false;
   minutesOut = static_cast<uint16_t>(hour * 60 + minute);
   return true;
@@ -186,20 +205,9 @@ void NightMode::updateEffectiveState(const char* reason) {
   } else {
     newActive = (enabled_ && hasValidTime_ && scheduleActive_);
   }
-  if (newActive == active_) {
-    if (reason == nullptr) {
-      return;
-    }
-    // Still publish to keep MQTT consumers updated for dim percent change etc.
-    publishState();
-    return;
-  }
+  if (newActive == active_) return;
   active_ = newActive;
+  stateMarkDirty(DIRTY_NIGHT_ACTIVE);
   const char* label = reason ? reason : "state-change";
   logInfo(String("🌙 Night mode ") + (active_ ? "ACTIVE" : "INACTIVE") + " (" + label + ")");
-  publishState();
-}
-
-void NightMode::publishState() {
-  mqtt_publish_state(true);
 }
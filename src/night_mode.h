@@ -2,7 +2,7 @@
 #define NIGHT_MODE_H
 
 #include <Arduino.h>
-#include <Preferences.h>
+#include "counted_preferences.h"
 #include <time.h>
 
 enum class NightModeEffect : uint8_t {
@@ -47,6 +47,8 @@ public:
 
   String formatMinutes(uint16_t minutes) const;
   static bool parseTimeString(const String& text, uint16_t& minutesOut);
+  /** @brief Same, for @p length bytes that need not be NUL-terminated (an MQTT payload) */
+  static bool parseTimeString(const char* text, size_t length, uint16_t& minutesOut);
 
   /**
    * @brief Force immediate write to persistent storage
@@ -72,9 +74,8 @@ private:
   bool computeScheduleActive(uint16_t minutes) const;
   void markDirty();
   void updateEffectiveState(const char* reason);
-  void publishState();
 
-  Preferences prefs_;
+  CountedPreferences prefs_;
   bool enabled_ = false;
   NightModeEffect effect_ = NightModeEffect::Dim;
   uint8_t dimPercent_ = 20;
@@ -13,6 +13,7 @@
 #include "ota_updater.h"
 #include "display_settings.h"
 #include "system_utils.h"
+#include "ui_assets.h"
 
 static const char* FS_VERSION_FILE = "/.fs_version"; // marker
 static const char* UI_FILES[] = {
@@ -239,12 +240,20 @@ static bool areUiFilesHealthy() {
   return true;
 }
 
+// Pages are compiled into the firmware; SPIFFS copies only matter when the override is enabled
+static bool uiServedFromFirmware() {
+  if (uiAssetCount() == 0 || FS_IMPL.exists(UI_OVERRIDE_MARKER)) return false;
+  logInfo(String("UI served from firmware (bundle ") + uiBundleHash() + "); skipping UI sync.");
+  return true;
+}
+
 void syncUiFilesFromConfiguredVersion() {
   logInfo("🔍 Checking UI files (configured version)...");
   if (!FS_IMPL.begin(true)) {
     logError("FS mount failed");
     return;
   }
+  if (uiServedFromFirmware()) return;
 
   const String targetVersion = UI_VERSION;
   if (targetVersion.isEmpty()) {
@@ -286,6 +295,7 @@ void syncFilesFromManifest() {
     logError("FS mount failed");
     return;
   }
+  if (uiServedFromFirmware()) return;
 
   std::unique_ptr<WiFiClientSecure> client(new WiFiClientSecure());
   client->setInsecure();
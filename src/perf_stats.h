@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdint.h>
+
+// Runtime performance counters behind the diagnostic MQTT sensors: main loop
+// iteration time, frames and strip.show() time, log write latency and NVS
+// writes. Recording is a few adds and compares, cheap enough for the hot
+// paths. The MQTT client reads the figures every diagnostics interval and
+// then starts a new window.
+
+/** @brief Count, sum and maximum of a duration within a window */
+struct PerfTimer {
+  uint32_t count = 0;
+  uint32_t maxUs = 0;
+  uint64_t totalUs = 0;
+
+  void add(uint32_t us) {
+    count++;
+    totalUs += us;
+    if (us > maxUs) maxUs = us;
+  }
+
+  uint32_t avgUs() const { return count ? (uint32_t)(totalUs / count) : 0; }
+};
+
+class PerfStats {
+public:
+  /** @brief Top of the main loop; the time since the previous call is one iteration */
+  void loopTick(uint32_t nowUs) {
+    if (loopSeen_) loop_.add(nowUs - lastLoopUs_);
+    lastLoopUs_ = nowUs;
+    loopSeen_ = true;
+  }
+
+  /** @brief A frame went out to the strip; @p showUs was spent in strip.show() */
+  void frame(uint32_t showUs) { show_.add(showUs); }
+
+  /** @brief A log record was written to its sinks in @p us */
+  void logWrite(uint32_t us) { log_.add(us); }
+
+  /** @brief Keys written to NVS (each put is its own flash write) */
+  void addNvsWrites(uint32_t n) { nvsWrites_ += n; }
+
+  const PerfTimer& loop() const { return loop_; }
+  const PerfTimer& show() const { return show_; }
+  const PerfTimer& logWrites() const { return log_; }
+
+  /** @brief NVS writes since boot; not reset with the window */
+  uint32_t nvsWrites() const { return nvsWrites_; }
+
+  /** @brief Frames per second since the window started, in tenths */
+  uint32_t fpsTenths(uint32_t nowMs) const {
+    uint32_t ms = nowMs - windowStartMs_;
+    return ms ? (uint32_t)((uint64_t)show_.count * 10000 / ms) : 0;
+  }
+
+  /** @brief Clear the timers and start a new window at @p nowMs */
+  void startWindow(uint32_t nowMs) {
+    loop_ = PerfTimer();
+    show_ = PerfTimer();
+    log_ = PerfTimer();
+    windowStartMs_ = nowMs;
+  }
+
+  /**
+   * @brief Share of free heap not available as one block, in percent
+   * @return 0 when everything free is one block (or nothing is free)
+   */
+  static uint8_t fragmentationPercent(uint32_t freeBytes, uint32_t largestBlock) {
+    if (freeBytes == 0 || largestBlock >= freeBytes) return 0;
+    return (uint8_t)(100 - (uint64_t)largestBlock * 100 / freeBytes);
+  }
+
+private:
+  PerfTimer loop_;
+  PerfTimer show_;
+  PerfTimer log_;
+  uint32_t lastLoopUs_ = 0;
+  bool loopSeen_ = false;
+  uint32_t windowStartMs_ = 0;
+  uint32_t nvsWrites_ = 0;
+};
+
+/** @brief The shared counters (function-local so header-only users need no definition) */
+inline PerfStats& perfStats() {
+  static PerfStats stats;
+  return stats;
+}
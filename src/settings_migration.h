@@ -1,7 +1,7 @@
 #ifndef SETTINGS_MIGRATION_H
 #define SETTINGS_MIGRATION_H
 
-#include <Preferences.h>
+#include "counted_preferences.h"
 #include "log.h"
 
 class SettingsMigration {
@@ -9,7 +9,7 @@ public:
     static void migrateIfNeeded() {
         migrateLogDeleteOnBootDefault();
 
-        Preferences prefs;
+        CountedPreferences prefs;
         
         // Check if migration already done
         prefs.begin("wc_system", true);
@@ -38,7 +38,7 @@ public:
     
 private:
     static void migrateLogDeleteOnBootDefault() {
-        Preferences prefs;
+        CountedPreferences prefs;
         prefs.begin("wc_system", false);
         bool done = prefs.getBool("log_del_on_boot_default_v1", false);
         if (done) {
@@ -52,7 +52,8 @@ private:
     }
 
     static void migrateLedState() {
-        Preferences oldPrefs, newPrefs;
+        Preferences oldPrefs;
+        CountedPreferences newPrefs;
         
         if (!oldPrefs.begin("led", true)) {
             return;  // No old data
@@ -82,7 +83,8 @@ private:
     }
     
     static void migrateDisplaySettings() {
-        Preferences oldPrefs, newPrefs;
+        Preferences oldPrefs;
+        CountedPreferences newPrefs;
         
         if (!oldPrefs.begin("display", true)) {
             return;  // No old data
@@ -123,7 +125,8 @@ private:
     }
     
     static void migrateNightMode() {
-        Preferences oldPrefs, newPrefs;
+        Preferences oldPrefs;
+        CountedPreferences newPrefs;
         
         if (!oldPrefs.begin("night", true)) {
             return;  // No old data
@@ -153,7 +156,8 @@ private:
     }
     
     static void migrateSetupState() {
-        Preferences oldPrefs, newPrefs;
+        Preferences oldPrefs;
+        CountedPreferences newPrefs;
         
         if (!oldPrefs.begin("setup", true)) {
             return;  // No old data
@@ -180,7 +184,8 @@ private:
     }
     
     static void migrateLogSettings() {
-        Preferences oldPrefs, newPrefs;
+        Preferences oldPrefs;
+        CountedPreferences newPrefs;
         
         if (!oldPrefs.begin("log", true)) {
             return;  // No old data
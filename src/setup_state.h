@@ -1,6 +1,6 @@
 #pragma once
 
-#include <Preferences.h>
+#include "counted_preferences.h"
 
 // Tracks whether the initial setup wizard has been completed.
 class SetupState {
@@ -35,7 +35,7 @@ private:
   void persist();
   void markDirty();
 
-  Preferences prefs_;
+  CountedPreferences prefs_;
   bool completed_ = false;
   uint8_t version_ = 0;
   bool migratedFromLegacy_ = false;
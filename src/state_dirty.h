@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+// Per-field change bits for the retained MQTT state topics. The setters of
+// LedState, DisplaySettings and NightMode (and setLogLevel) mark the fields
+// they change; the MQTT client takes the mask each loop and publishes only the
+// matching topics. Unlike the fingerprints in state_events.h this is
+// field-level and costs nothing until something changes.
+
+enum StateDirty : uint32_t {
+  DIRTY_LIGHT           = 1u << 0,   // on/off, color, brightness
+  DIRTY_ANIMATE         = 1u << 1,
+  DIRTY_HETIS           = 1u << 2,
+  DIRTY_AUTO_UPDATE     = 1u << 3,
+  DIRTY_UPDATE_CHANNEL  = 1u << 4,
+  DIRTY_LOG_LEVEL       = 1u << 5,
+  DIRTY_NIGHT_ENABLED   = 1u << 6,
+  DIRTY_NIGHT_EFFECT    = 1u << 7,
+  DIRTY_NIGHT_DIM       = 1u << 8,
+  DIRTY_NIGHT_SCHEDULE  = 1u << 9,   // start and end
+  DIRTY_NIGHT_OVERRIDE  = 1u << 10,
+  DIRTY_NIGHT_ACTIVE    = 1u << 11,
+};
+
+#define DIRTY_ALL 0x0FFFu
+
+/** @brief The shared mask (function-local so header-only users need no definition) */
+inline uint32_t& stateDirtyMask() {
+  static uint32_t mask = 0;
+  return mask;
+}
+
+/** @brief Flag fields as changed */
+inline void stateMarkDirty(uint32_t bits) {
+  stateDirtyMask() |= bits;
+}
+
+/**
+ * @brief Return and clear the flagged fields among @p bits
+ * @note Main loop only; setters run on the same task
+ */
+inline uint32_t stateTakeDirty(uint32_t bits = DIRTY_ALL) {
+  uint32_t& mask = stateDirtyMask();
+  uint32_t taken = mask & bits;
+  mask &= ~bits;
+  return taken;
+}
@@ -0,0 +1,91 @@
+#include "state_events.h"
+
+#include <Arduino.h>
+#include "display_settings.h"
+#include "led_controller.h"
+#include "led_state.h"
+#include "log.h"
+#include "night_mode.h"
+
+extern bool clockEnabled;
+extern LogLevel LOG_LEVEL;
+
+// Also bounds the rate of frame events during word animations
+static const unsigned long STATE_POLL_MS = 200;
+
+static StateChangeTracker tracker;
+static unsigned long lastPollMs = 0;
+
+namespace {
+
+// FNV-1a over the fields of one group
+struct Fingerprint {
+  uint32_t h = 2166136261u;
+
+  void add(uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+      h ^= (uint8_t)(v >> (i * 8));
+      h *= 16777619u;
+    }
+  }
+
+  void add(const String& s) {
+    for (size_t i = 0; i < s.length(); ++i) {
+      h ^= (uint8_t)s[i];
+      h *= 16777619u;
+    }
+    add((uint32_t)s.length());
+  }
+};
+
+}  // namespace
+
+static void takeFingerprints(uint32_t (&out)[STATE_GROUP_COUNT]) {
+  Fingerprint light;
+  uint8_t r, g, b, w;
+  ledState.getRGBW(r, g, b, w);
+  light.add(clockEnabled ? 1u : 0u);
+  light.add(((uint32_t)r << 24) | ((uint32_t)g << 16) | ((uint32_t)b << 8) | w);
+  light.add(ledState.getBrightness());
+  out[0] = light.h;
+
+  Fingerprint display;
+  display.add(displaySettings.getAnimateWords() ? 1u : 0u);
+  display.add(displaySettings.getHetIsDurationSec());
+  display.add(displaySettings.isSellMode() ? 1u : 0u);
+  display.add(displaySettings.getGridVariantId());
+  display.add(displaySettings.getAutoUpdate() ? 1u : 0u);
+  display.add(displaySettings.getUpdateChannel());
+  display.add((uint32_t)LOG_LEVEL);
+  out[1] = display.h;
+
+  Fingerprint night;
+  night.add(nightMode.isEnabled() ? 1u : 0u);
+  night.add((uint32_t)nightMode.getEffect());
+  night.add(nightMode.getDimPercent());
+  night.add(((uint32_t)nightMode.getStartMinutes() << 16) | nightMode.getEndMinutes());
+  night.add((uint32_t)nightMode.getOverride());
+  night.add((nightMode.isActive() ? 1u : 0u) | (nightMode.isScheduleActive() ? 2u : 0u) |
+            (nightMode.hasTime() ? 4u : 0u));
+  out[2] = night.h;
+
+  out[3] = ledFrameVersion();
+}
+
+bool stateSubscribe(StateListener listener) {
+  return tracker.subscribe(listener);
+}
+
+void stateNotify(uint8_t groups) {
+  tracker.markChanged(groups);
+}
+
+void stateEventsLoop() {
+  unsigned long now = millis();
+  if (now - lastPollMs < STATE_POLL_MS && tracker.pending() == 0) return;
+  lastPollMs = now;
+  uint32_t fingerprints[STATE_GROUP_COUNT];
+  takeFingerprints(fingerprints);
+  tracker.update(fingerprints);
+  tracker.dispatch();
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Change notifications for the state shown in the web UI and published over
+// MQTT. stateEventsLoop() fingerprints each group of state a few times per
+// second and hands the groups that changed to every listener at once, so the
+// web push channel and the MQTT publishers share one change detector instead
+// of each client polling for it.
+
+enum StateGroup : uint8_t {
+  STATE_LIGHT   = 1 << 0,  // on/off, color, brightness
+  STATE_DISPLAY = 1 << 1,  // animation, HET IS, sell mode, grid, update settings, log level
+  STATE_NIGHT   = 1 << 2,  // night-mode configuration and activation
+  STATE_FRAME   = 1 << 3,  // set of lit LEDs
+};
+
+#define STATE_GROUP_COUNT 4
+#define STATE_ALL 0x0F
+
+/** @brief Called with a StateGroup bitmask of what changed */
+typedef void (*StateListener)(uint8_t groups);
+
+/**
+ * @brief Fingerprint comparison and listener fan-out behind the state events
+ */
+class StateChangeTracker {
+public:
+  static const uint8_t MAX_LISTENERS = 4;
+
+  /** @brief Register a listener; false when the table is full */
+  bool subscribe(StateListener listener) {
+    for (uint8_t i = 0; i < count_; ++i) {
+      if (listeners_[i] == listener) return true;
+    }
+    if (count_ >= MAX_LISTENERS) return false;
+    listeners_[count_++] = listener;
+    return true;
+  }
+
+  /** @brief Report groups as changed without waiting for the next fingerprint */
+  void markChanged(uint8_t groups) { pending_ |= groups; }
+
+  /**
+   * @brief Compare fresh fingerprints (one per group) with the previous ones
+   * @note The first call only records the baseline
+   */
+  void update(const uint32_t (&fingerprints)[STATE_GROUP_COUNT]) {
+    for (uint8_t i = 0; i < STATE_GROUP_COUNT; ++i) {
+      if (primed_ && fingerprints[i] != last_[i]) pending_ |= (uint8_t)(1u << i);
+      last_[i] = fingerprints[i];
+    }
+    primed_ = true;
+  }
+
+  /**
+   * @brief Call every listener once with the changed groups and clear them
+   * @return The groups that were dispatched (0 when nothing changed)
+   */
+  uint8_t dispatch() {
+    uint8_t groups = pending_;
+    if (groups == 0) return 0;
+    pending_ = 0;
+    for (uint8_t i = 0; i < count_; ++i) listeners_[i](groups);
+    return groups;
+  }
+
+  uint8_t pending() const { return pending_; }
+
+private:
+  StateListener listeners_[MAX_LISTENERS] = {};
+  uint8_t count_ = 0;
+  uint8_t pending_ = 0;
+  bool primed_ = false;
+  uint32_t last_[STATE_GROUP_COUNT] = {};
+};
+
+/** @brief Listen for state changes (see StateGroup) */
+bool stateSubscribe(StateListener listener);
+
+/** @brief Force listeners to be told about @p groups on the next loop */
+void stateNotify(uint8_t groups);
+
+/**
+ * @brief Detect changes and notify listeners
+ * @note Call from the main loop; fingerprints are taken every STATE_POLL_MS
+ */
+void stateEventsLoop();
@@ -0,0 +1,44 @@
+#include "ui_assets.h"
+
+#include <string.h>
+
+// include/ui_bundle.h is generated before every firmware build; without it
+// (native tests, or a build that skipped the script) the bundle is empty.
+// A test may define UI_BUNDLE itself and set UI_BUNDLE_EMBEDDED first.
+#if !defined(UI_BUNDLE_EMBEDDED) && defined(__has_include)
+#if __has_include("ui_bundle.h")
+#include "ui_bundle.h"
+#define UI_BUNDLE_EMBEDDED 1
+#endif
+#endif
+
+#ifndef UI_BUNDLE_EMBEDDED
+static const UiAsset UI_BUNDLE[] = { { "", "", nullptr, 0, 0, 0 } };
+#define UI_BUNDLE_HASH ""
+static const size_t UI_BUNDLE_SIZE = 0;
+#else
+static const size_t UI_BUNDLE_SIZE = sizeof(UI_BUNDLE) / sizeof(UI_BUNDLE[0]);
+#endif
+
+const UiAsset* uiAssetFind(const char* path) {
+  if (!path) return nullptr;
+  // The table is sorted by path
+  size_t lo = 0;
+  size_t hi = UI_BUNDLE_SIZE;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    int cmp = strcmp(path, UI_BUNDLE[mid].path);
+    if (cmp == 0) return &UI_BUNDLE[mid];
+    if (cmp < 0) hi = mid;
+    else lo = mid + 1;
+  }
+  return nullptr;
+}
+
+size_t uiAssetCount() {
+  return UI_BUNDLE_SIZE;
+}
+
+const char* uiBundleHash() {
+  return UI_BUNDLE_HASH;
+}
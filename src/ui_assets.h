@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Web UI pages compiled into the firmware by tools/embed_ui.py.
+// Each asset is a gzip stream (fixed Huffman, LOG_CODEC_WINDOW window) so it
+// can be sent as-is with Content-Encoding: gzip, or inflated by LogInflater.
+
+// When this file exists on SPIFFS, files there take precedence over the bundle
+#define UI_OVERRIDE_MARKER "/.ui_override"
+
+/**
+ * @brief One embedded file
+ */
+struct UiAsset {
+  const char* path;     // e.g. "/dashboard.html"
+  const char* mime;
+  const uint8_t* gz;    // gzip stream in flash
+  uint32_t gzSize;
+  uint32_t crc;         // CRC32 of the uncompressed content
+  uint32_t length;      // uncompressed size
+};
+
+/** @brief Look up an embedded file by path; nullptr when it is not in the bundle */
+const UiAsset* uiAssetFind(const char* path);
+
+/** @brief Number of embedded files (0 when the firmware was built without a bundle) */
+size_t uiAssetCount();
+
+/** @brief Short hash identifying the embedded bundle, "" without one */
+const char* uiBundleHash();
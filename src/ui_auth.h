@@ -1,6 +1,6 @@
 #pragma once
-#include <Preferences.h>
 #include <Arduino.h>
+#include "counted_preferences.h"
 
 class UiAuth {
 public:
@@ -36,7 +36,7 @@ public:
   }
 
 private:
-  Preferences prefs;
+  CountedPreferences prefs;
   String user;
   String pass;
   bool mustChange = true;
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include "instrumented_web_server.h"
+#include "led_state.h"
+#include "display_settings.h"
+#include "night_mode.h"
+#include "setup_state.h"
+
+/**
+ * @brief Device state the page and dashboard handlers work on
+ *
+ * setupWebRoutes() binds the firmware's singletons; native tests bind their
+ * own instances and a server on MockWebServer, so the handlers run on the
+ * host unchanged.
+ */
+struct WebContext {
+  InstrumentedWebServer& server;
+  LedState& led;
+  DisplaySettings& display;
+  NightMode& night;
+  SetupState& setup;
+  bool& clockEnabled;
+  /** Device figures for the "system" object of /api/state (build, heap, RSSI) */
+  void (*fillSystemInfo)(JsonObject sys);
+};
+
+inline WebContext*& webContextSlot() {
+  static WebContext* ctx = nullptr;
+  return ctx;
+}
+
+/** @brief Make @p ctx the context of every handler; it must outlive the server */
+inline void webBind(WebContext& ctx) { webContextSlot() = &ctx; }
+
+/** @brief The bound context (webBind() must have been called) */
+inline WebContext& web() { return *webContextSlot(); }
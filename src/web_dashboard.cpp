@@ -0,0 +1,580 @@
+#include "web_dashboard.h"
+
+#include <ctype.h>
+#include <functional>
+#include <map>
+#include <time.h>
+#include <vector>
+#include "config.h"
+#include "event_stream.h"
+#include "fs_compat.h"
+#include "grid_layout.h"
+#include "json_response.h"
+#include "led_controller.h"
+#include "light_fader.h"
+#include "log.h"
+#include "state_events.h"
+#include "time_mapper.h"
+#include "web_context.h"
+
+// Live log streaming (SSE) state; g_logStreamSeq is the last record pushed to listeners
+static EventStream g_logStream;
+static uint32_t g_logStreamSeq = 0;
+
+static const char* nightEffectToStr(NightModeEffect effect) {
+  return (effect == NightModeEffect::Off) ? "off" : "dim";
+}
+
+static const char* nightOverrideToStr(NightModeOverride mode) {
+  switch (mode) {
+    case NightModeOverride::ForceOn:  return "force_on";
+    case NightModeOverride::ForceOff: return "force_off";
+    case NightModeOverride::Auto:
+    default:                          return "auto";
+  }
+}
+
+static void fillNightModeConfig(JsonObject obj) {
+  WebContext& w = web();
+  obj["enabled"] = w.night.isEnabled();
+  obj["effect"] = nightEffectToStr(w.night.getEffect());
+  obj["dim_percent"] = w.night.getDimPercent();
+  obj["start"] = w.night.formatMinutes(w.night.getStartMinutes());
+  obj["end"] = w.night.formatMinutes(w.night.getEndMinutes());
+  obj["start_minutes"] = w.night.getStartMinutes();
+  obj["end_minutes"] = w.night.getEndMinutes();
+  obj["override"] = nightOverrideToStr(w.night.getOverride());
+  obj["active"] = w.night.isActive();
+  obj["schedule_active"] = w.night.isScheduleActive();
+  obj["time_synced"] = w.night.hasTime();
+}
+
+static void sendNightModeConfig() {
+  WebContext& w = web();
+  JsonDocument doc;
+  fillNightModeConfig(doc.to<JsonObject>());
+  sendJson(w.server, doc);
+}
+
+// id/key/label/language/version of a grid variant; false when the variant is unknown
+static bool fillGridVariant(JsonObject obj, GridVariant variant) {
+  obj["id"] = gridVariantToId(variant);
+  const GridVariantInfo* info = getGridVariantInfo(variant);
+  if (!info) return false;
+  obj["key"] = info->key;
+  obj["label"] = info->label;
+  obj["language"] = info->language;
+  obj["version"] = info->version;
+  return true;
+}
+
+// Current color as RRGGBB (white maps to FFFFFF)
+static void formatColorHex(char (&buf)[7]) {
+  uint8_t r, g, b, w;
+  web().led.getRGBW(r, g, b, w);
+  if (w > 0) { r = g = b = 255; }
+  snprintf(buf, sizeof(buf), "%02X%02X%02X", r, g, b);
+}
+
+const char* currentLogLevelName() {
+  extern LogLevel LOG_LEVEL; // declared in log.cpp
+  switch (LOG_LEVEL) {
+    case LOG_LEVEL_DEBUG: return "DEBUG";
+    case LOG_LEVEL_WARN:  return "WARN";
+    case LOG_LEVEL_ERROR: return "ERROR";
+    default:              return "INFO";
+  }
+}
+
+// Fields of one StateGroup, in the same layout as the /api/state snapshot
+void fillStateGroup(JsonDocument& doc, uint8_t group) {
+  WebContext& w = web();
+  switch (group) {
+    case STATE_LIGHT: {
+      doc["on"] = w.clockEnabled;
+      char color[7];
+      formatColorHex(color);
+      doc["color"] = color;
+      doc["brightness"] = w.led.getBrightness();
+      break;
+    }
+    case STATE_DISPLAY:
+      doc["animate"] = w.display.getAnimateWords();
+      doc["het_is_sec"] = w.display.getHetIsDurationSec();
+      doc["sell_mode"] = w.display.isSellMode();
+      doc["auto_update"] = w.display.getAutoUpdate();
+      doc["update_channel"] = w.display.getUpdateChannel();
+      fillGridVariant(doc["grid"].to<JsonObject>(), w.display.getGridVariant());
+      doc["system"]["log_level"] = currentLogLevelName();
+      break;
+    case STATE_NIGHT:
+      fillNightModeConfig(doc["night"].to<JsonObject>());
+      break;
+    case STATE_FRAME: {
+      JsonArray leds = doc["frame"].to<JsonArray>();
+      for (uint16_t idx : ledLastFrame()) leds.add(idx);
+      break;
+    }
+  }
+}
+
+// Snapshot of everything the dashboard shows, so a page load needs one request
+void fillStateSnapshot(JsonDocument& doc) {
+  fillStateGroup(doc, STATE_LIGHT);
+  fillStateGroup(doc, STATE_DISPLAY);
+  fillStateGroup(doc, STATE_NIGHT);
+  JsonObject sys = doc["system"].as<JsonObject>();
+  sys["firmware"] = FIRMWARE_VERSION;
+  sys["ui"] = UI_VERSION;
+  sys["uptime_ms"] = millis();
+  WebContext& w = web();
+  if (w.fillSystemInfo) w.fillSystemInfo(sys);
+}
+
+static void sendStateSnapshot() {
+  WebContext& w = web();
+  JsonDocument doc;
+  fillStateSnapshot(doc);
+  sendJson(w.server, doc);
+}
+
+// Hand the current client over to the log event stream and replay the backlog after `since`
+static void attachLogStream(uint32_t since) {
+  WebContext& w = web();
+  if (!g_logStream.attach(w.server.client())) return;
+  const uint8_t slot = g_logStream.lastAttachedSlot();
+  // Newer records are pushed by webLogStreamLoop(); only replay what it already sent
+  logForEachSince(since, [slot](uint32_t seq, const String& line) {
+    if (seq <= g_logStreamSeq) g_logStream.sendTo(slot, nullptr, line, seq);
+  });
+}
+
+void webLogStreamLoop() {
+  g_logStream.loop();
+  const uint32_t latest = logLatestSeq();
+  if (latest == g_logStreamSeq) return;
+  const uint32_t from = g_logStreamSeq;
+  g_logStreamSeq = latest;
+  if (!g_logStream.hasClients()) return;
+  logForEachSince(from, [](uint32_t seq, const String& line) {
+    if (seq <= g_logStreamSeq) g_logStream.broadcast(nullptr, line, seq);
+  });
+}
+
+// Aggregated dashboard state
+void handleApiState() {
+  sendStateSnapshot();
+}
+
+// Get status
+void handleStatus() {
+  WebContext& w = web();
+  String status = w.clockEnabled ? "on" : "off";
+  w.server.send(200, "text/plain", status);
+}
+
+// Turn on/off
+void handleToggle() {
+  WebContext& w = web();
+  String state = w.server.arg("state");
+  w.clockEnabled = (state == "on");
+  lightFader.cancel();  // A Home Assistant fade must not keep the face lit
+  // Apply immediately
+  if (w.clockEnabled) {
+    struct tm timeinfo;
+    if (getLocalTime(&timeinfo)) {
+      auto indices = get_led_indices_for_time(&timeinfo);
+      showLeds(indices);
+    }
+  } else {
+    // Clear LEDs when turning off
+    showLeds({});
+  }
+  w.server.send(200, "text/plain", "OK");
+}
+
+// Get current color as RRGGBB (white maps to FFFFFF)
+void handleGetColor() {
+  WebContext& w = web();
+  char buf[7];
+  formatColorHex(buf);
+  w.server.send(200, "text/plain", String(buf));
+}
+
+void handleSetColor() {
+  WebContext& w = web();
+  if (!w.server.hasArg("color")) {
+    w.server.send(400, "text/plain", "Missing color");
+    return;
+  }
+  String hex = w.server.arg("color");  // "RRGGBB"
+  String filtered;
+  filtered.reserve(hex.length());
+  for (size_t i = 0; i < hex.length(); ++i) {
+    char c = hex.charAt(i);
+    if (isxdigit(static_cast<unsigned char>(c))) {
+      filtered += static_cast<char>(toupper(static_cast<unsigned char>(c)));
+    }
+  }
+  if (filtered.length() != 6) {
+    w.server.send(400, "text/plain", "Invalid color");
+    return;
+  }
+
+  long val = strtol(filtered.c_str(), nullptr, 16);
+  uint8_t r = (val >> 16) & 0xFF;
+  uint8_t g = (val >> 8) & 0xFF;
+  uint8_t b =  val       & 0xFF;
+
+  w.led.setRGB(r, g, b);
+
+  // Refresh display immediately with new color
+  struct tm timeinfo;
+  if (getLocalTime(&timeinfo)) {
+    std::vector<uint16_t> indices = get_led_indices_for_time(&timeinfo);
+    showLeds(indices);
+  }
+
+  w.server.send(200, "text/plain", "OK");
+}
+
+void handleGetBrightness() {
+  WebContext& w = web();
+  uint8_t brightness = w.led.getBrightness();
+  w.server.send(200, "text/plain", String(brightness));
+}
+
+void handleSetBrightness() {
+  WebContext& w = web();
+  if (!w.server.hasArg("level")) {
+    w.server.send(400, "text/plain", "Missing brightness level");
+    return;
+  }
+
+  int level = w.server.arg("level").toInt();
+  level = constrain(level, 0, 255);
+  w.led.setBrightness(level);
+
+    // Apply to active LEDs
+  struct tm timeinfo;
+  if (getLocalTime(&timeinfo)) {
+    auto indices = get_led_indices_for_time(&timeinfo);
+    showLeds(indices);  // uses current color + new brightness
+  }
+
+  w.server.send(200, "text/plain", "OK");
+}
+
+// Word-by-word animation toggle
+void handleGetAnimate() {
+  WebContext& w = web();
+  bool animate = w.display.getAnimateWords();
+  String result = animate ? "on" : "off";
+  w.server.send(200, "text/plain", result);
+}
+
+void handleSetAnimate() {
+  WebContext& w = web();
+  if (!w.server.hasArg("state")) {
+    w.server.send(400, "text/plain", "Missing state");
+    return;
+  }
+  String st = w.server.arg("state");
+  bool on = (st == "on" || st == "1" || st == "true");
+  w.display.setAnimateWords(on);
+logInfo(String("🎞️ Animation ") + (on ? "ON" : "OFF"));
+  w.server.send(200, "text/plain", "OK");
+}
+
+// Het Is duration (0..360 seconds; 0=never, 360=always)
+void handleGetHetIsDuration() {
+  WebContext& w = web();
+  uint16_t duration = w.display.getHetIsDurationSec();
+  w.server.send(200, "text/plain", String(duration));
+}
+
+void handleSetHetIsDuration() {
+  WebContext& w = web();
+  if (!w.server.hasArg("seconds")) {
+    w.server.send(400, "text/plain", "Missing seconds");
+    return;
+  }
+  int val = w.server.arg("seconds").toInt();
+  if (val < 0) val = 0; if (val > 360) val = 360;
+  w.display.setHetIsDurationSec((uint16_t)val);
+logInfo("⏱️ HET IS duration set to " + String(val) + "s");
+  w.server.send(200, "text/plain", "OK");
+}
+
+// Grid variant endpoints
+void handleGetGridVariant() {
+  WebContext& w = web();
+  JsonDocument doc;
+  GridVariant variant = w.display.getGridVariant();
+  if (!fillGridVariant(doc.to<JsonObject>(), variant)) {
+    logWarn("[API] /getGridVariant: No info found for variant ID " + String(gridVariantToId(variant)));
+  }
+  sendJson(w.server, doc);
+}
+
+void handleListGridVariants() {
+  WebContext& w = web();
+  size_t count = 0;
+  const GridVariantInfo* infos = getGridVariantInfos(count);
+  JsonDocument doc;
+  JsonArray arr = doc.to<JsonArray>();
+  GridVariant active = w.display.getGridVariant();
+  for (size_t i = 0; i < count; ++i) {
+    JsonObject o = arr.add<JsonObject>();
+    o["id"] = gridVariantToId(infos[i].variant);
+    o["key"] = infos[i].key;
+    o["label"] = infos[i].label;
+    o["language"] = infos[i].language;
+    o["version"] = infos[i].version;
+    o["active"] = (infos[i].variant == active);
+  }
+  sendJson(w.server, doc);
+}
+
+void handleSetGridVariant() {
+  WebContext& w = web();
+  bool updated = false;
+
+  if (w.server.hasArg("id")) {
+    uint8_t id = static_cast<uint8_t>(w.server.arg("id").toInt());
+    size_t count = 0;
+    getGridVariantInfos(count);
+    if (id < count) {
+      GridVariant variant = gridVariantFromId(id);
+      w.display.setGridVariant(variant);
+      updated = true;
+    }
+  } else if (w.server.hasArg("key")) {
+    String key = w.server.arg("key");
+    GridVariant variant = gridVariantFromKey(key.c_str());
+    const GridVariantInfo* info = getGridVariantInfo(variant);
+    if (info && key == info->key) {
+      w.display.setGridVariant(variant);
+      updated = true;
+    }
+  }
+
+  if (!updated) {
+    w.server.send(400, "text/plain", "Invalid grid variant");
+    return;
+  }
+
+  if (const GridVariantInfo* info = getGridVariantInfo(w.display.getGridVariant())) {
+    logInfo(String("🧩 Grid variant updated to ") + info->label + " (" + info->key + ")");
+  }
+
+  JsonDocument doc;
+  fillGridVariant(doc.to<JsonObject>(), w.display.getGridVariant());
+  sendJson(w.server, doc);
+}
+
+// Night mode configuration
+void handleGetNightModeConfig() {
+  sendNightModeConfig();
+}
+
+void handleSetNightModeConfig() {
+  WebContext& w = web();
+  if (!w.server.hasArg("plain")) {
+    w.server.send(400, "text/plain", "Missing body");
+    return;
+  }
+  JsonDocument doc;
+  DeserializationError err = deserializeJson(doc, w.server.arg("plain"));
+  if (err) {
+    w.server.send(400, "text/plain", "Invalid JSON");
+    return;
+  }
+
+  JsonVariant enabledVar = doc["enabled"];
+  if (!enabledVar.isNull()) {
+    if (enabledVar.is<bool>()) {
+      w.night.setEnabled(enabledVar.as<bool>());
+    } else if (enabledVar.is<int>()) {
+      w.night.setEnabled(enabledVar.as<int>() != 0);
+    } else if (enabledVar.is<const char*>()) {
+      String st = enabledVar.as<const char*>();
+      st.toLowerCase();
+      w.night.setEnabled(st == "true" || st == "on" || st == "1");
+    }
+  }
+
+  JsonVariant effectVar = doc["effect"];
+  if (!effectVar.isNull()) {
+    String eff = effectVar.as<String>();
+    eff.toLowerCase();
+    if (eff == "off") {
+      w.night.setEffect(NightModeEffect::Off);
+    } else if (eff == "dim") {
+      w.night.setEffect(NightModeEffect::Dim);
+    } else {
+      w.server.send(400, "text/plain", "Invalid effect");
+      return;
+    }
+  }
+
+  JsonVariant dimVar = doc["dim_percent"];
+  if (!dimVar.isNull()) {
+    int pct = dimVar.as<int>();
+    if (pct < 0) pct = 0;
+    if (pct > 100) pct = 100;
+    w.night.setDimPercent((uint8_t)pct);
+  }
+
+  uint16_t startMin = w.night.getStartMinutes();
+  uint16_t endMin = w.night.getEndMinutes();
+  bool scheduleUpdate = false;
+
+  JsonVariant startStrVar = doc["start"];
+  if (!startStrVar.isNull()) {
+    String startStr = startStrVar.as<String>();
+    uint16_t parsed = 0;
+    if (!NightMode::parseTimeString(startStr, parsed)) {
+      w.server.send(400, "text/plain", "Invalid start time");
+      return;
+    }
+    startMin = parsed;
+    scheduleUpdate = true;
+  } else {
+    JsonVariant startMinVar = doc["start_minutes"];
+    if (!startMinVar.isNull()) {
+      int parsed = startMinVar.as<int>();
+      if (parsed < 0 || parsed >= (24 * 60)) {
+        w.server.send(400, "text/plain", "Invalid start minutes");
+        return;
+      }
+      startMin = (uint16_t)parsed;
+      scheduleUpdate = true;
+    }
+  }
+
+  JsonVariant endStrVar = doc["end"];
+  if (!endStrVar.isNull()) {
+    String endStr = endStrVar.as<String>();
+    uint16_t parsed = 0;
+    if (!NightMode::parseTimeString(endStr, parsed)) {
+      w.server.send(400, "text/plain", "Invalid end time");
+      return;
+    }
+    endMin = parsed;
+    scheduleUpdate = true;
+  } else {
+    JsonVariant endMinVar = doc["end_minutes"];
+    if (!endMinVar.isNull()) {
+      int parsed = endMinVar.as<int>();
+      if (parsed < 0 || parsed >= (24 * 60)) {
+        w.server.send(400, "text/plain", "Invalid end minutes");
+        return;
+      }
+      endMin = (uint16_t)parsed;
+      scheduleUpdate = true;
+    }
+  }
+
+  if (scheduleUpdate) {
+    w.night.setSchedule(startMin, endMin);
+  }
+
+  JsonVariant overrideVar = doc["override"];
+  if (!overrideVar.isNull()) {
+    String ov = overrideVar.as<String>();
+    ov.toLowerCase();
+    if (ov == "auto") {
+      w.night.setOverride(NightModeOverride::Auto);
+    } else if (ov == "force_on" || ov == "on") {
+      w.night.setOverride(NightModeOverride::ForceOn);
+    } else if (ov == "force_off" || ov == "off") {
+      w.night.setOverride(NightModeOverride::ForceOff);
+    } else {
+      w.server.send(400, "text/plain", "Invalid override");
+      return;
+    }
+  }
+
+  sendNightModeConfig();
+}
+
+// Incremental log tail: returns only records newer than ?since=N (plain text, one record per line).
+// X-Log-Seq carries the cursor for the next poll. With mode=sse the connection stays open and
+// new records are pushed as server-sent events (id = sequence number).
+void handleApiLogsTail() {
+  WebContext& w = web();
+  uint32_t since = 0;
+  if (w.server.hasArg("since")) {
+    since = strtoul(w.server.arg("since").c_str(), nullptr, 10);
+  } else if (w.server.hasHeader("Last-Event-ID")) {
+    since = strtoul(w.server.header("Last-Event-ID").c_str(), nullptr, 10);
+  }
+  if (w.server.arg("mode") == "sse") {
+    attachLogStream(since);
+    return;
+  }
+  const uint32_t latest = logLatestSeq();
+  if (since > latest) {
+    // Cursor from before a reboot; start over
+    w.server.sendHeader("X-Log-Reset", "1");
+    since = 0;
+  } else if (since > 0 && since + 1 < logOldestSeq()) {
+    w.server.sendHeader("X-Log-Truncated", "1");
+  }
+  w.server.sendHeader("X-Log-Seq", String(latest));
+  w.server.sendHeader("Cache-Control", "no-store");
+  ChunkedResponse response(w.server);
+  response.begin(200, "text/plain");
+  logForEachSince(since, [&response](uint32_t, const String& line) {
+    response.write((const uint8_t*)line.c_str(), line.length());
+    if (!line.endsWith("\n")) response.write('\n');
+  });
+  response.end();
+}
+
+// Logs summary
+void handleApiLogsSummary() {
+  WebContext& w = web();
+  logFlushFile();
+  // Deduplicate per date: keep the largest file for each date to match the list view
+  size_t total = 0;
+  size_t count = 0;
+  std::map<String, size_t, std::greater<String>> bestByDate;
+  File dir = FS_IMPL.open("/logs");
+  if (dir) {
+    while (true) {
+      File entry = dir.openNextFile();
+      if (!entry) break;
+      if (!entry.isDirectory()) {
+        String shortName = entry.name();
+        if (shortName.startsWith("/")) shortName = shortName.substring(1);
+        if (shortName.startsWith("logs/")) shortName = shortName.substring(5);
+        if (!shortName.endsWith(".log") && !shortName.endsWith(".log.gz")) {
+          entry.close();
+          continue;
+        }
+        String date = shortName;
+        int dot = date.indexOf('.');
+        if (dot > 0) date = date.substring(0, dot);
+        size_t sz = entry.size();
+        auto it = bestByDate.find(date);
+        if (it == bestByDate.end() || sz > it->second) {
+          bestByDate[date] = sz;
+        }
+      }
+      entry.close();
+    }
+    dir.close();
+  } else {
+    logWarn("[API] /api/logs/summary: Failed to open /logs directory");
+  }
+  for (const auto& kv : bestByDate) {
+    total += kv.second;
+    count++;
+  }
+  JsonDocument doc;
+  doc["total_bytes"] = (uint32_t)total;
+  doc["count"] = (uint32_t)count;
+  sendJson(w.server, doc);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <ArduinoJson.h>
+
+// Dashboard API: light, display and night mode settings, the /api/state
+// snapshot and the log tail. Handlers work on the bound WebContext (web_context.h).
+
+/** @brief Name of the current log level ("DEBUG", "INFO", ...) */
+const char* currentLogLevelName();
+
+/** @brief Fields of one StateGroup, in the same layout as the /api/state snapshot */
+void fillStateGroup(JsonDocument& doc, uint8_t group);
+
+/** @brief Everything the dashboard shows, so a page load needs one request */
+void fillStateSnapshot(JsonDocument& doc);
+
+/** @brief Push new log records to /api/logs/tail?mode=sse listeners (call from webRoutesLoop()) */
+void webLogStreamLoop();
+
+void handleApiState();
+void handleStatus();
+void handleToggle();
+void handleGetColor();
+void handleSetColor();
+void handleGetBrightness();
+void handleSetBrightness();
+void handleGetAnimate();
+void handleSetAnimate();
+void handleGetHetIsDuration();
+void handleSetHetIsDuration();
+void handleGetGridVariant();
+void handleListGridVariants();
+void handleSetGridVariant();
+void handleGetNightModeConfig();
+void handleSetNightModeConfig();
+void handleApiLogsTail();
+void handleApiLogsSummary();
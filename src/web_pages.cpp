@@ -0,0 +1,285 @@
+#include "web_pages.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <new>
+#include <string.h>
+#include "fs_compat.h"
+#include "http_utils.h"
+#include "log.h"
+#include "log_codec.h"
+#include "ui_assets.h"
+#include "web_context.h"
+
+static size_t readPageFile(void* ctx, uint8_t* buf, size_t len) {
+  return static_cast<File*>(ctx)->read(buf, len);
+}
+
+struct MemoryReader {
+  const uint8_t* data;
+  size_t size;
+  size_t pos;
+};
+
+static size_t readFromMemory(void* ctx, uint8_t* buf, size_t len) {
+  MemoryReader* r = static_cast<MemoryReader*>(ctx);
+  size_t n = std::min(len, r->size - r->pos);
+  memcpy(buf, r->data + r->pos, n);
+  r->pos += n;
+  return n;
+}
+
+// Send a gzip stream decompressed, for clients that do not accept gzip
+static void streamInflated(LogCodecRead read, void* ctx, const char* mime) {
+  WebContext& w = web();
+  std::unique_ptr<LogInflater> inflater(new (std::nothrow) LogInflater());
+  if (!inflater) {
+    w.server.send(503, "text/plain", "Out of memory");
+    return;
+  }
+  inflater->begin(read, ctx, true);
+  w.server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  w.server.send(200, mime, "");
+  uint8_t buf[512];
+  int n;
+  while ((n = inflater->read(buf, sizeof(buf))) > 0) {
+    w.server.sendContent((const char*)buf, (size_t)n);
+  }
+  w.server.sendContent("");
+}
+
+void streamInflated(File& f, const char* mime) {
+  streamInflated(readPageFile, &f, mime);
+}
+
+// Answer a Range request for a file; returns false when the whole file should be sent instead.
+// If-Range is honoured by sending the whole file: we emit no validator it could match.
+bool sendFileRange(File& f, const char* mime, bool gzipEncoded) {
+  WebContext& w = web();
+  if (!w.server.hasHeader("Range") || w.server.hasHeader("If-Range")) return false;
+  uint32_t size = (uint32_t)f.size();
+  uint32_t first = 0, last = 0;
+  HttpRange range = httpParseRange(w.server.header("Range").c_str(), size, first, last);
+  if (range == HttpRange::Full) return false;
+  char contentRange[48];
+  httpFormatContentRange(contentRange, sizeof(contentRange), range, first, last, size);
+  w.server.sendHeader("Content-Range", contentRange);
+  if (range == HttpRange::Unsatisfiable) {
+    w.server.send(416, "text/plain", "");
+    return true;
+  }
+  if (!f.seek(first)) {
+    w.server.send(500, "text/plain", "Seek failed");
+    return true;
+  }
+  if (gzipEncoded) w.server.sendHeader("Content-Encoding", "gzip");
+  uint32_t remaining = last - first + 1;
+  w.server.setContentLength(remaining);
+  w.server.send(206, mime, "");
+  uint8_t buf[1024];
+  while (remaining > 0) {
+    size_t n = f.read(buf, remaining < sizeof(buf) ? remaining : sizeof(buf));
+    if (n == 0) break;
+    w.server.sendContent((const char*)buf, n);
+    remaining -= (uint32_t)n;
+  }
+  return true;
+}
+
+// Pages are revalidated on every load (no-cache); returns true when a 304 was sent
+static bool sendCacheHeaders(uint32_t crc, uint32_t length, bool encoded) {
+  WebContext& w = web();
+  char etag[32];
+  httpFormatEtag(etag, sizeof(etag), crc, length, encoded);
+  w.server.sendHeader("Cache-Control", "no-cache");
+  w.server.sendHeader("Vary", "Accept-Encoding");
+  w.server.sendHeader("ETag", etag);
+  if (w.server.hasHeader("If-None-Match") && httpEtagMatches(w.server.header("If-None-Match").c_str(), etag)) {
+    w.server.send(304);
+    return true;
+  }
+  return false;
+}
+
+// SPIFFS copies of UI pages are only used when the override marker exists (checked once at startup)
+static bool g_uiOverride = false;
+
+static void serveEmbedded(const UiAsset& asset, const char* mime) {
+  WebContext& w = web();
+  bool acceptGzip = httpAcceptsGzip(w.server.header("Accept-Encoding").c_str());
+  if (sendCacheHeaders(asset.crc, asset.length, acceptGzip)) return;
+  if (acceptGzip) {
+    w.server.sendHeader("Content-Encoding", "gzip");
+    w.server.send_P(200, mime, (const char*)asset.gz, asset.gzSize);
+    return;
+  }
+  MemoryReader reader = { asset.gz, asset.gzSize, 0 };
+  streamInflated(readFromMemory, &reader, mime);
+}
+
+// Content hash of a served file, cached while its size and modification time are unchanged
+struct AssetHash {
+  size_t size;
+  time_t mtime;
+  uint32_t crc;
+  uint32_t length;
+};
+static std::map<String, AssetHash> g_assetHashes;
+
+// CRC32 and length of the (uncompressed) content: read from the gzip trailer, or hashed once for plain files
+static bool assetContentHash(File& f, const String& path, bool gz, uint32_t& crc, uint32_t& length) {
+  size_t size = f.size();
+  time_t mtime = f.getLastWrite();
+  auto it = g_assetHashes.find(path);
+  if (it != g_assetHashes.end() && it->second.size == size && it->second.mtime == mtime) {
+    crc = it->second.crc;
+    length = it->second.length;
+    return true;
+  }
+  if (gz) {
+    uint8_t trailer[8];
+    if (size < 18 || !f.seek(size - 8) || f.read(trailer, sizeof(trailer)) != sizeof(trailer)) {
+      f.seek(0);
+      return false;
+    }
+    crc = (uint32_t)trailer[0] | ((uint32_t)trailer[1] << 8) | ((uint32_t)trailer[2] << 16) | ((uint32_t)trailer[3] << 24);
+    length = (uint32_t)trailer[4] | ((uint32_t)trailer[5] << 8) | ((uint32_t)trailer[6] << 16) | ((uint32_t)trailer[7] << 24);
+  } else {
+    uint8_t buf[256];
+    size_t n;
+    crc = 0;
+    while ((n = f.read(buf, sizeof(buf))) > 0) crc = logCrc32(crc, buf, n);
+    length = (uint32_t)size;
+  }
+  f.seek(0);
+  g_assetHashes[path] = AssetHash{ size, mtime, crc, length };
+  return true;
+}
+
+// Serve a UI page from the firmware bundle, or from SPIFFS (preferring a .gz variant if the
+// client accepts gzip) when the override is enabled or the page is not embedded.
+// Returns false, having sent nothing, when neither has the page.
+static bool servePage(const char* path, const char* mime) {
+  WebContext& w = web();
+  const UiAsset* asset = uiAssetFind(path);
+  if (asset && !(g_uiOverride && (FS_IMPL.exists(path) || FS_IMPL.exists(String(path) + ".gz")))) {
+    serveEmbedded(*asset, mime);
+    return true;
+  }
+  String gzPath = String(path) + ".gz";
+  bool acceptGzip = httpAcceptsGzip(w.server.header("Accept-Encoding").c_str());
+  File f;
+  bool encoded = false;
+  if (acceptGzip) {
+    f = FS_IMPL.open(gzPath, "r");
+    encoded = (bool)f;
+  }
+  if (!f) f = FS_IMPL.open(path, "r");
+  // Only the compressed copy exists and the client cannot take it
+  bool inflate = false;
+  if (!f) {
+    f = FS_IMPL.open(gzPath, "r");
+    inflate = (bool)f;
+  }
+  if (!f) return false;
+
+  uint32_t crc, length;
+  bool fromGz = encoded || inflate;
+  if (assetContentHash(f, fromGz ? gzPath : String(path), fromGz, crc, length) &&
+      sendCacheHeaders(crc, length, encoded)) {
+    f.close();
+    return true;
+  }
+  if (inflate) {
+    streamInflated(f, mime);
+  } else {
+    // streamFile() adds "Content-Encoding: gzip" itself for .gz files
+    w.server.streamFile(f, mime);
+  }
+  f.close();
+  return true;
+}
+
+static void serveFile(const char* path, const char* mime) {
+  if (!servePage(path, mime)) web().server.send(404, "text/plain", String(path) + " not found");
+}
+
+void webPagesBegin() {
+  g_uiOverride = FS_IMPL.exists(UI_OVERRIDE_MARKER);
+  if (uiAssetCount() == 0) {
+    logWarn("No UI bundle in this firmware; serving pages from SPIFFS");
+  } else if (g_uiOverride) {
+    logInfo("UI override enabled: SPIFFS pages take precedence over the firmware bundle");
+  }
+}
+
+// Public landing page: go straight to dashboard (or setup if incomplete)
+void handleRoot() {
+  WebContext& w = web();
+  if (!w.setup.isComplete()) {
+    if (servePage("/setup.html", "text/html")) return;
+    logWarn("[API] /: setup.html not found");
+  }
+  if (servePage("/dashboard.html", "text/html")) return;
+  logError("[API] /: dashboard.html not found");
+  w.server.send(404, "text/plain", "dashboard.html not found");
+}
+
+// Setup page (public). Used when the wizard has not completed yet.
+void handleSetupPage() {
+  serveFile("/setup.html", "text/html");
+}
+
+// Dashboard (protected)
+void handleDashboardPage() {
+  WebContext& w = web();
+  if (!w.setup.isComplete()) {
+    w.server.sendHeader("Location", "/setup.html", true);
+    w.server.send(302, "text/plain", "");
+    return;
+  }
+  serveFile("/dashboard.html", "text/html");
+}
+
+// Protected admin page (Admin auth only)
+void handleAdminPage() {
+  serveFile("/admin.html", "text/html");
+}
+
+void handleLogsPage() {
+  serveFile("/logs.html", "text/html");
+}
+
+// Change password page (protected, but accessible during forced-change flow)
+void handleChangepwPage() {
+  serveFile("/changepw.html", "text/html");
+}
+
+// Update page (protected)
+void handleUpdatePage() {
+  WebContext& w = web();
+  if (!w.setup.isComplete()) {
+    w.server.sendHeader("Location", "/setup.html", true);
+    w.server.send(302, "text/plain", "");
+    return;
+  }
+  serveFile("/update.html", "text/html");
+}
+
+// MQTT settings page (protected)
+void handleMqttPage() {
+  WebContext& w = web();
+  if (!w.setup.isComplete()) {
+    w.server.sendHeader("Location", "/setup.html", true);
+    w.server.send(302, "text/plain", "");
+    return;
+  }
+  serveFile("/mqtt.html", "text/html");
+}
+
+// Favicon placeholder to avoid 404 noise
+void handleFaviconIco() {
+  WebContext& w = web();
+  w.server.send(204);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "fs_compat.h"
+
+// UI pages, served from the firmware bundle (ui_assets.h) or from SPIFFS.
+// Handlers work on the bound WebContext (web_context.h).
+
+/** @brief Read the UI override marker once at startup (call before serving pages) */
+void webPagesBegin();
+
+/** @brief Send a gzip file decompressed, for clients that do not accept gzip */
+void streamInflated(File& f, const char* mime);
+
+/** @brief Answer a Range request for a file; false when the whole file should be sent instead */
+bool sendFileRange(File& f, const char* mime, bool gzipEncoded);
+
+void handleRoot();
+void handleSetupPage();
+void handleDashboardPage();
+void handleAdminPage();
+void handleLogsPage();
+void handleChangepwPage();
+void handleUpdatePage();
+void handleMqttPage();
+void handleFaviconIco();
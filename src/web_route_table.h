@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Route table for the web server: one array of {path, method, auth, handler},
+// sorted by path so a request is matched with a binary search. Nothing here
+// depends on WebServer, so lookups can be tested natively.
+
+/** @brief Access level a route requires; checked by the router before the handler runs */
+enum class WebAuth : uint8_t {
+  None,   // Public (setup flow, factory reset token, ...)
+  Ui,     // Web UI
+  Admin,  // Admin credentials
+};
+
+typedef void (*WebHandler)();
+
+/**
+ * @brief One registered path and method
+ */
+struct WebRoute {
+  const char* path;
+  uint8_t method;       // HTTPMethod; the "any" method matches every request method
+  WebAuth auth;
+  WebHandler handler;
+  WebHandler upload;    // Multipart upload chunks, or nullptr
+};
+
+/** @brief strcmp() usable in constant expressions */
+constexpr int webPathCompare(const char* a, const char* b) {
+  return (*a != *b || *a == '\0') ? (int)(unsigned char)*a - (int)(unsigned char)*b
+                                  : webPathCompare(a + 1, b + 1);
+}
+
+/** @brief True when paths never decrease; use in a static_assert next to the table */
+constexpr bool webRoutesSorted(const WebRoute* routes, size_t count) {
+  return count < 2 || (webPathCompare(routes[0].path, routes[1].path) <= 0 &&
+                       webRoutesSorted(routes + 1, count - 1));
+}
+
+/**
+ * @brief Find the route for a request
+ * @param anyMethod Method value of entries that accept every method (HTTP_ANY)
+ * @return Index into @p routes, or -1. An exact method match wins over an "any" entry.
+ */
+inline int webRouteFind(const WebRoute* routes, size_t count, const char* path, uint8_t method, uint8_t anyMethod) {
+  size_t lo = 0, hi = count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (strcmp(routes[mid].path, path) < 0) lo = mid + 1;
+    else hi = mid;
+  }
+  int fallback = -1;
+  for (size_t i = lo; i < count && strcmp(routes[i].path, path) == 0; ++i) {
+    if (routes[i].method == method) return (int)i;
+    if (routes[i].method == anyMethod && fallback < 0) fallback = (int)i;
+  }
+  return fallback;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WebServer.h>
+#include "instrumented_web_server.h"
+#include "web_route_table.h"
+
+/**
+ * @brief Single WebServer request handler that dispatches a sorted route table
+ *
+ * Replaces one FunctionRequestHandler (and std::function) per route with a
+ * binary search over a constant table. The access check and the per-route
+ * timing from HttpPerf are applied here, the same way for every route.
+ */
+class WebRouter : public RequestHandler {
+public:
+  /**
+   * @param authorize Access check for a route; sends the refusal response itself and returns false
+   */
+  WebRouter(const WebRoute* routes, size_t count, bool (*authorize)(const WebRoute&))
+      : routes_(routes), count_(count), authorize_(authorize) {}
+
+  /** @brief Register the table's routes for statistics and install the router */
+  void attach(InstrumentedWebServer& server) {
+    perf_ = &server.perf();
+    perfFirst_ = -1;
+    for (size_t i = 0; i < count_; ++i) {
+      int slot = perf_->add(routes_[i].path, routes_[i].method);
+      if (i == 0) perfFirst_ = slot;
+    }
+    server.addHandler(this);
+  }
+
+  // WebServer asks canHandle() first, then calls handle()/upload() for the same request
+  bool canHandle(HTTPMethod method, String uri) override {
+    current_ = webRouteFind(routes_, count_, uri.c_str(), (uint8_t)method, (uint8_t)HTTP_ANY);
+    return current_ >= 0;
+  }
+
+  bool canUpload(String) override {
+    return current_ >= 0 && routes_[current_].upload != nullptr;
+  }
+
+  bool handle(WebServer&, HTTPMethod, String) override {
+    if (current_ < 0) return false;
+    run(routes_[current_].handler, true);
+    return true;
+  }
+
+  void upload(WebServer&, String, HTTPUpload&) override {
+    if (current_ >= 0 && routes_[current_].upload) run(routes_[current_].upload, false);
+  }
+
+private:
+  void run(WebHandler fn, bool countCall) {
+    if (!authorize_(routes_[current_])) return;
+    int slot = perfFirst_ < 0 ? -1 : perfFirst_ + current_;
+    if (perf_) perf_->begin(slot, micros());
+    fn();
+    if (perf_) perf_->end(micros(), countCall);
+  }
+
+  const WebRoute* routes_;
+  size_t count_;
+  bool (*authorize_)(const WebRoute&);
+  HttpPerf* perf_ = nullptr;
+  int perfFirst_ = -1;
+  int current_ = -1;
+};
@@ -0,0 +1,1114 @@
+#include "web_routes.h"
+
+#include "network_init.h"
+#include "fs_compat.h"
+#include <Update.h>
+#include <WebServer.h>
+#include <esp_system.h>
+#include <ctype.h>
+#include <PubSubClient.h>
+#include <time.h>
+#include <ArduinoJson.h>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include "secrets.h"
+#include "sequence_controller.h"
+#include "led_state.h"
+#include "log.h"
+#include "time_mapper.h"
+#include "ota_updater.h"
+#include "led_controller.h"
+#include "config.h"
+#include "display_settings.h"
+#include "ui_auth.h"
+#include "wordclock.h"
+#include "clock_display.h"
+#include "mqtt_settings.h"
+#include "mqtt_client.h"
+#include "mqtt_probe.h"
+#include "night_mode.h"
+#include "build_info.h"
+#include "setup_state.h"
+#include "system_utils.h"
+#include "event_stream.h"
+#include "state_events.h"
+#include "log_codec.h"
+#include "http_utils.h"
+#include "json_response.h"
+#include "instrumented_web_server.h"
+#include "web_router.h"
+#include "web_context.h"
+#include "web_dashboard.h"
+#include "web_pages.h"
+#include <WiFi.h>
+#include <Arduino.h>
+
+
+// References to global variables
+extern InstrumentedWebServer server;
+extern String logBuffer[];
+extern int logIndex;
+extern bool clockEnabled;
+extern bool g_wifiHadCredentialsAtBoot;
+
+// Live state push (SSE), fed by the state change listener
+static EventStream g_stateStream;
+
+// Build and radio figures for the "system" object of /api/state
+static void fillSystemInfo(JsonObject sys) {
+  sys["git_branch"] = BUILD_GIT_BRANCH;
+  sys["heap_free"] = ESP.getFreeHeap();
+  sys["rssi"] = WiFi.RSSI();
+}
+
+// The device singletons the page and dashboard handlers work on
+static WebContext g_webContext = { server, ledState, displaySettings, nightMode, setupState, clockEnabled, fillSystemInfo };
+
+// Simple Basic-Auth guard for admin resources
+static bool ensureAdminAuth() {
+  if (!server.authenticate(ADMIN_USER, ADMIN_PASS)) {
+    server.requestAuthentication(BASIC_AUTH, ADMIN_REALM);
+    return false;
+  }
+  return true;
+}
+
+// UI is now open; only admin pages are protected
+static bool ensureUiAuth() {
+  return true;
+}
+
+static void sendSetupStatus() {
+  JsonDocument doc;
+  doc["completed"] = setupState.isComplete();
+  doc["version"] = setupState.getVersion();
+  doc["migrated"] = setupState.wasMigrated();
+  bool staConnected = (WiFi.status() == WL_CONNECTED) || isWiFiConnected() || WiFi.isConnected();
+  String ssid = staConnected ? WiFi.SSID() : WiFi.softAPSSID();
+  IPAddress ip = staConnected ? WiFi.localIP() : WiFi.softAPIP();
+  bool hasSavedSsid = WiFi.SSID().length() > 0;
+  bool hasIp = ip != IPAddress(0, 0, 0, 0);
+  doc["wifi_connected"] = staConnected || hasIp;
+  doc["wifi_configured"] = staConnected || g_wifiHadCredentialsAtBoot || hasSavedSsid || hasIp;
+  doc["wifi_ssid"] = ssid.length() ? ssid : (staConnected ? "unknown" : "AP/Portal");
+  doc["wifi_ip"] = hasIp ? ip.toString() : "";
+  GridVariant active = displaySettings.getGridVariant();
+  doc["grid_variant_id"] = gridVariantToId(active);
+  if (const auto* info = getGridVariantInfo(active)) {
+    doc["grid_variant_key"] = info->key;
+    doc["grid_variant_label"] = info->label;
+  }
+  sendJson(server, doc);
+}
+
+static const char* stateGroupEventName(uint8_t group) {
+  switch (group) {
+    case STATE_LIGHT:   return "light";
+    case STATE_DISPLAY: return "display";
+    case STATE_NIGHT:   return "night";
+    default:            return "frame";
+  }
+}
+
+// One serialization per change, written to every open stream
+static void onStateChanged(uint8_t groups) {
+  if (!g_stateStream.hasClients()) return;
+  for (uint8_t i = 0; i < STATE_GROUP_COUNT; ++i) {
+    uint8_t group = (uint8_t)(1u << i);
+    if (!(groups & group)) continue;
+    JsonDocument doc;
+    fillStateGroup(doc, group);
+    String data;
+    serializeJson(doc, data);
+    g_stateStream.broadcast(stateGroupEventName(group), data);
+  }
+}
+
+static void fillMqttProbe(JsonObject out, const MqttProbeResult& result) {
+  out["job"] = result.job;
+  out["state"] = mqttProbeStateName(result.state);
+  out["message"] = mqttProbeMessage(result);
+  if (result.state != MqttProbeState::Running) out["duration_ms"] = result.durationMs;
+}
+
+static const char* httpMethodName(uint8_t method) {
+  switch (method) {
+    case HTTP_GET:    return "GET";
+    case HTTP_POST:   return "POST";
+    case HTTP_PUT:    return "PUT";
+    case HTTP_DELETE: return "DELETE";
+    case HTTP_ANY:    return "ANY";
+    default:          return "OTHER";
+  }
+}
+
+// Clear persistent settings (factory reset helper)
+static void performFactoryReset() {
+  Preferences p;
+  const char* keys[] = { "ui_auth", "display", "led", "log", "setup" };
+  for (auto ns : keys) {
+    p.begin(ns, false);
+    p.clear();
+    p.end();
+  }
+}
+
+// Clear all log files (helper function)
+static void clearAllLogFiles() {
+  logFlushFile();
+  logCloseFile();
+  size_t deleted = 0;
+  size_t failed = 0;
+  File dir = FS_IMPL.open("/logs");
+  if (dir) {
+    while (true) {
+      File entry = dir.openNextFile();
+      if (!entry) break;
+      if (!entry.isDirectory()) {
+        String name = entry.name();
+        // Normalize path: remove leading "/" and "logs/" prefix if present
+        if (name.startsWith("/")) name = name.substring(1);
+        if (name.startsWith("logs/")) name = name.substring(5);
+        String full = String("/logs/") + name;
+        entry.close();
+        if (FS_IMPL.remove(full)) {
+          deleted++;
+        } else {
+          failed++;
+          logWarn("Failed to remove log file: " + full);
+        }
+      } else {
+        entry.close();
+      }
+    }
+    dir.close();
+    logInfo("🗑️ Cleared " + String(deleted) + " log files" + (failed > 0 ? " (" + String(failed) + " failed)" : ""));
+  } else {
+    logWarn("Failed to open /logs directory for clearing");
+  }
+  // Re-enable file sink (will recreate today's file if needed)
+  logEnableFileSink();
+}
+
+// Resolve the log file for ?date=YYYY-MM-DD (default: latest log); sends the error response itself
+static bool resolveLogFilePath(String& path) {
+  if (server.hasArg("date")) {
+    String date = server.arg("date");
+    bool valid = (date.length() == 10 &&
+                  isdigit(date[0]) && isdigit(date[1]) && isdigit(date[2]) && isdigit(date[3]) &&
+                  date[4] == '-' &&
+                  isdigit(date[5]) && isdigit(date[6]) &&
+                  date[7] == '-' &&
+                  isdigit(date[8]) && isdigit(date[9]));
+    if (!valid) {
+      server.send(400, "text/plain", "Invalid date format");
+      return false;
+    }
+    path = String("/logs/") + date + ".log";
+    // Finished days are archived as .log.gz
+    if (!FS_IMPL.exists(path) && FS_IMPL.exists(path + ".gz")) path += ".gz";
+    return true;
+  }
+  path = logLatestFilePath();
+  if (path.length() == 0) {
+    server.send(404, "text/plain", "No log files available");
+    return false;
+  }
+  if (!path.startsWith("/")) {
+    path = "/" + path;
+  }
+  if (!path.startsWith("/logs/")) {
+    path = String("/logs/") + path;
+  }
+  return true;
+}
+
+// Token for allowing factory reset from Forgot Password page
+static String g_factoryToken;
+static unsigned long g_factoryTokenExp = 0; // millis deadline
+
+static String generateFactoryToken(unsigned long ttl_ms = 60000) {
+  char buf[24];
+  uint32_t r = esp_random();
+  snprintf(buf, sizeof(buf), "%08X%08lX", (unsigned)r, (unsigned long)millis());
+  g_factoryToken = String(buf);
+  g_factoryTokenExp = millis() + ttl_ms;
+  return g_factoryToken;
+}
+
+// Route handlers. Access levels are checked by the router before a handler runs (see ROUTES).
+
+// Factory reset token endpoint (public): returns a short-lived token for reset
+static void handleFactorytoken() {
+  // Issue new token valid for 60s
+  String tok = generateFactoryToken(60000);
+  server.send(200, "text/plain", tok);
+}
+
+// Factory reset (admin or valid token, requires POST). Resets preferences + WiFi and restarts.
+static void handleFactoryreset() {
+  bool allowed = false;
+  // Admin credentials allow reset unconditionally
+  if (server.authenticate(ADMIN_USER, ADMIN_PASS)) {
+    allowed = true;
+  } else {
+    // Check for valid short-lived token
+    if (server.hasArg("token")) {
+      String tok = server.arg("token");
+      if (tok.length() > 0 && tok == g_factoryToken) {
+        unsigned long now = millis();
+        if (g_factoryTokenExp != 0 && (long)(g_factoryTokenExp - now) > 0) {
+          allowed = true;
+        }
+      }
+    }
+  }
+  if (!allowed) {
+    // Admin/token required; return 403 without triggering browser auth popups
+    server.send(403, "text/plain", "Forbidden (admin or valid token required)");
+    return;
+  }
+  server.send(200, "text/html", R"rawliteral(
+    <html>
+      <head><meta http-equiv='refresh' content='8;url=/' /></head>
+      <body>
+        <h1>Factory reset started...</h1>
+        <p>The device will reset to factory defaults and reboot shortly.</p>
+      </body>
+    </html>
+  )rawliteral");
+  delay(200);
+  performFactoryReset();
+  resetWiFiSettings(); // will restart
+}
+
+// Handle password change
+static void handleSetUIPassword() {
+  if (!server.hasArg("new") || !server.hasArg("confirm")) {
+    server.send(400, "text/plain", "Missing fields");
+    return;
+  }
+  String n = server.arg("new");
+  String c = server.arg("confirm");
+  if (n != c) { server.send(400, "text/plain", "Passwords do not match"); return; }
+  if (n.length() < 6) { server.send(400, "text/plain", "Minimum 6 characters"); return; }
+  if (!uiAuth.setPassword(n)) { server.send(500, "text/plain", "Save failed"); return; }
+  server.send(200, "text/plain", "OK");
+}
+
+static void handleApiSetupStatus() {
+  sendSetupStatus();
+}
+
+static void handleApiSetupComplete() {
+  setupState.markComplete();
+  struct tm timeinfo;
+  if (getLocalTime(&timeinfo)) {
+    wordclock_force_animation_for_time(&timeinfo);
+  }
+  server.send(200, "text/plain", "OK");
+}
+
+// Grid endpoints for the setup flow (open when setup is pending; require auth afterwards)
+static void handleApiSetupGridGet() {
+  JsonDocument doc;
+  JsonArray arr = doc["variants"].to<JsonArray>();
+  size_t count = 0;
+  const GridVariantInfo* infos = getGridVariantInfos(count);
+  GridVariant active = displaySettings.getGridVariant();
+  for (size_t i = 0; i < count; ++i) {
+    JsonObject o = arr.add<JsonObject>();
+    o["id"] = gridVariantToId(infos[i].variant);
+    o["key"] = infos[i].key;
+    o["label"] = infos[i].label;
+    o["language"] = infos[i].language;
+    o["version"] = infos[i].version;
+    o["active"] = (infos[i].variant == active);
+  }
+  doc["completed"] = setupState.isComplete();
+  sendJson(server, doc);
+}
+
+static void handleApiSetupGridPost() {
+  if (setupState.isComplete()) {
+    if (!ensureUiAuth()) return;
+  }
+
+  bool updated = false;
+  if (server.hasArg("id")) {
+    uint8_t id = static_cast<uint8_t>(server.arg("id").toInt());
+    size_t count = 0;
+    getGridVariantInfos(count);
+    if (id < count) {
+      GridVariant variant = gridVariantFromId(id);
+      displaySettings.setGridVariant(variant);
+      updated = true;
+    }
+  } else if (server.hasArg("key")) {
+    String key = server.arg("key");
+    GridVariant variant = gridVariantFromKey(key.c_str());
+    const GridVariantInfo* info = getGridVariantInfo(variant);
+    if (info && key == info->key) {
+      displaySettings.setGridVariant(variant);
+      updated = true;
+    }
+  }
+
+  if (!updated) {
+    server.send(400, "text/plain", "Invalid grid variant");
+    return;
+  }
+
+  if (const GridVariantInfo* info = getGridVariantInfo(displaySettings.getGridVariant())) {
+    logInfo(String("🧩 Grid variant updated (setup) to ") + info->label + " (" + info->key + ")");
+  }
+
+  JsonDocument doc;
+  GridVariant variant = displaySettings.getGridVariant();
+  doc["id"] = gridVariantToId(variant);
+  if (const GridVariantInfo* info = getGridVariantInfo(variant)) {
+    doc["key"] = info->key;
+    doc["label"] = info->label;
+    doc["language"] = info->language;
+    doc["version"] = info->version;
+  }
+  doc["completed"] = setupState.isComplete();
+  sendJson(server, doc);
+}
+
+// MQTT config API
+static void handleApiMqttConfigGet() {
+  MqttSettings cfg;
+  mqtt_settings_load(cfg);
+  // Do not expose password; indicate if set
+  String json = "{";
+  json += "\"host\":\"" + cfg.host + "\",";
+  json += "\"port\":" + String(cfg.port) + ",";
+  json += "\"user\":\"" + cfg.user + "\",";
+  json += "\"has_pass\":" + String(cfg.pass.length() > 0 ? "true" : "false") + ",";
+  json += "\"allow_unauth\":" + String(cfg.allowAnonymous ? "true" : "false") + ",";
+  json += "\"discovery\":\"" + cfg.discoveryPrefix + "\",";
+  json += "\"base\":\"" + cfg.baseTopic + "\"";
+  json += "}";
+  server.send(200, "application/json", json);
+}
+
+static void handleApiMqttConfigPost() {
+  MqttSettings current;
+  mqtt_settings_load(current);
+  MqttSettings next = current;
+
+  if (server.hasArg("host")) next.host = server.arg("host");
+  if (server.hasArg("port")) next.port = (uint16_t) server.arg("port").toInt();
+  if (server.hasArg("user")) next.user = server.arg("user");
+  if (server.hasArg("allow_unauth")) next.allowAnonymous = server.arg("allow_unauth") == "1" || server.arg("allow_unauth") == "true" || server.arg("allow_unauth") == "on";
+  if (server.hasArg("pass")) {
+    String p = server.arg("pass");
+    if (p.length() > 0) next.pass = p; // empty means keep existing
+  }
+  if (server.hasArg("discovery")) next.discoveryPrefix = server.arg("discovery");
+  if (server.hasArg("base")) next.baseTopic = server.arg("base");
+
+  // Basic validation
+  if (next.host.length() == 0 || next.port == 0) {
+    server.send(400, "text/plain", "host/port required");
+    return;
+  }
+  if (next.allowAnonymous) {
+    // explicit opt-out from auth -> clear any existing credentials
+    next.user = "";
+    next.pass = "";
+  } else {
+    // Require user+pass when auth is enabled. Allow keeping existing password if already set.
+    bool hasUser = next.user.length() > 0;
+    bool hasPass = next.pass.length() > 0;
+    if (!hasUser || !hasPass) {
+      server.send(400, "text/plain", "user/password required unless 'no auth' is checked");
+      return;
+    }
+  }
+
+  mqtt_apply_settings(next);
+  server.send(200, "text/plain", "OK");
+}
+
+// MQTT runtime status
+static void handleApiMqttStatus() {
+  bool c = mqtt_is_connected();
+  MqttOutboxStats q = mqtt_outbox_stats();
+  char outbox[160];
+  snprintf(outbox, sizeof(outbox),
+           "{\"depth\":%u,\"high_water\":%u,\"queued\":%lu,\"merged\":%lu,\"dropped\":%lu,\"sent\":%lu}",
+           (unsigned)q.depth, (unsigned)q.highWater, (unsigned long)q.queued,
+           (unsigned long)q.merged, (unsigned long)q.dropped, (unsigned long)q.sent);
+  String json = String("{\"connected\":") + (c ? "true" : "false") + 
+                ",\"last_error\":\"" + mqtt_last_error() + "\",\"outbox\":" + outbox + "}";
+  server.send(200, "application/json", json);
+}
+
+// Force MQTT reconnection (clears abort state)
+static void handleApiMqttReconnect() {
+  logInfo("🔄 Force MQTT reconnect requested via web UI");
+  mqtt_force_reconnect();
+  server.send(200, "text/plain", "MQTT reconnection triggered");
+}
+
+// MQTT connection test (does not save). Accepts form-encoded: host, port, user?, pass?
+static void handleApiMqttTestPost() {
+  if (!server.hasArg("host") || !server.hasArg("port")) {
+    server.send(400, "text/plain", "host/port required");
+    return;
+  }
+  String host = server.arg("host");
+  uint16_t port = (uint16_t) server.arg("port").toInt();
+  String user = server.arg("user");
+  String pass = server.arg("pass");
+  bool allowUnauth = server.hasArg("allow_unauth") && (server.arg("allow_unauth") == "1" || server.arg("allow_unauth") == "true" || server.arg("allow_unauth") == "on");
+  if (!allowUnauth) {
+    if (user.length() == 0 || pass.length() == 0) {
+      server.send(400, "text/plain", "user/password required unless 'no auth' is checked");
+      return;
+    }
+  }
+
+  // Runs in the background; the page polls GET /api/mqtt/test?job= or listens for "mqtt_test" on /api/state/events
+  uint32_t job = mqttProbeStart(host, port, user, pass, !allowUnauth);
+  if (job == 0) {
+    server.send(409, "text/plain", "A test is already running");
+    return;
+  }
+  JsonDocument doc;
+  doc["job"] = job;
+  doc["state"] = mqttProbeStateName(MqttProbeState::Running);
+  sendJson(server, doc, 202);
+}
+
+static void handleApiMqttTestGet() {
+  MqttProbeResult result;
+  if (!mqttProbeResult((uint32_t)server.arg("job").toInt(), result)) {
+    server.send(404, "text/plain", "Unknown test");
+    return;
+  }
+  JsonDocument doc;
+  fillMqttProbe(doc.to<JsonObject>(), result);
+  sendJson(server, doc);
+}
+
+// Auto update toggle
+static void handleGetAutoUpdate() {
+  bool autoUpdate = displaySettings.getAutoUpdate();
+  String result = autoUpdate ? "on" : "off";
+  server.send(200, "text/plain", result);
+}
+
+static void handleSetAutoUpdate() {
+  if (!server.hasArg("state")) {
+    server.send(400, "text/plain", "Missing state");
+    return;
+  }
+  String st = server.arg("state");
+  bool on = (st == "on" || st == "1" || st == "true");
+  if (on && displaySettings.getUpdateChannel() == "develop") {
+    server.send(400, "text/plain", "Automatic updates are disabled on the develop channel");
+    return;
+  }
+  displaySettings.setAutoUpdate(on);
+logInfo(String("🔁 Auto firmware updates ") + (on ? "ON" : "OFF"));
+  server.send(200, "text/plain", "OK");
+}
+
+// Update channel (stable/early)
+static void handleApiUpdateChannelGet() {
+  JsonDocument doc;
+  String channel = displaySettings.getUpdateChannel();
+  doc["channel"] = channel;
+  doc["default"] = "stable";
+  sendJson(server, doc);
+}
+
+static void handleApiUpdateChannelPost() {
+  String ch;
+  if (server.hasArg("channel")) {
+    ch = server.arg("channel");
+  } else if (server.hasArg("plain")) {
+    JsonDocument doc;
+    DeserializationError err = deserializeJson(doc, server.arg("plain"));
+    if (!err && doc["channel"].is<const char*>()) {
+      ch = String(doc["channel"].as<const char*>());
+    }
+  }
+  ch.toLowerCase();
+  if (ch != "stable" && ch != "early" && ch != "develop") {
+    server.send(400, "text/plain", "channel must be 'stable', 'early', or 'develop'");
+    return;
+  }
+  displaySettings.setUpdateChannel(ch);
+  JsonDocument doc;
+  doc["channel"] = displaySettings.getUpdateChannel();
+  doc["default"] = "stable";
+  sendJson(server, doc);
+}
+
+// Fetch log
+static void handleLog() {
+  String logContent = "";
+  int i = logIndex;
+  int lineCount = 0;
+  for (int count = 0; count < LOG_BUFFER_SIZE; count++) {
+    String line = logBuffer[i];
+    if (line.length() > 0) {
+      logContent += line + "\n";
+      lineCount++;
+    }
+    i = (i + 1) % LOG_BUFFER_SIZE;
+  }
+  server.send(200, "text/plain", logContent);
+}
+
+// Filter a log file on the device: ?date=YYYY-MM-DD&level=WARN&from=HH:MM&to=HH:MM&q=text&limit=N
+// Matching lines are streamed as plain text; the .idx seek index lets the scan skip blocks
+// outside the time range or without lines of the requested level.
+static void handleApiLogsQuery() {
+  String path;
+  if (!resolveLogFilePath(path)) return;
+  if (!FS_IMPL.exists(path)) {
+    server.send(404, "text/plain", "Log file not found");
+    return;
+  }
+  LogQuery q;
+  if (server.hasArg("level")) {
+    String lvl = server.arg("level");
+    int parsed = logLevelFromTag(lvl.c_str(), lvl.length());
+    if (parsed < 0 && lvl.length() == 1 && isdigit(lvl[0])) parsed = lvl.toInt();
+    if (parsed < 0 || parsed > LOG_LEVEL_ERROR) {
+      server.send(400, "text/plain", "Invalid level");
+      return;
+    }
+    q.minLevel = parsed;
+  }
+  if ((server.hasArg("from") && !logParseClock(server.arg("from").c_str(), q.fromSod)) ||
+      (server.hasArg("to") && !logParseClock(server.arg("to").c_str(), q.toSod))) {
+    server.send(400, "text/plain", "Invalid time, expected HH:MM or HH:MM:SS");
+    return;
+  }
+  // "to=HH:MM" includes the whole minute
+  if (server.hasArg("to") && server.arg("to").length() == 5) q.toSod += 59;
+  String needle = server.arg("q");
+  if (needle.length()) q.needle = needle.c_str();
+  size_t limit = 500;
+  if (server.hasArg("limit")) {
+    long l = server.arg("limit").toInt();
+    if (l > 0) limit = (size_t)l;
+    if (limit > 2000) limit = 2000;
+  }
+
+  server.sendHeader("Cache-Control", "no-store");
+  ChunkedResponse response(server);
+  response.begin(200, "text/plain");
+  LogQueryStats stats = {};
+  logQueryFile(path, q, limit, [&response](const char* line, size_t len) {
+    response.write((const uint8_t*)line, len);
+    response.write('\n');
+  }, &stats);
+  if (stats.matches >= limit) {
+    response.printf("... limit of %u lines reached\n", (unsigned)limit);
+  }
+  response.end();
+}
+
+static void handleApiLogs() {
+  logFlushFile();
+  struct LogItem {
+    String name;
+    size_t size;
+    String date;
+  };
+  // Deduplicate by date: keep the largest file per date
+  std::vector<LogItem> items;
+  std::map<String, LogItem, std::greater<String>> bestByDate;
+  File dir = FS_IMPL.open("/logs");
+  if (dir) {
+    while (true) {
+      File entry = dir.openNextFile();
+      if (!entry) break;
+      if (!entry.isDirectory()) {
+        String name = entry.name();
+        size_t size = entry.size();
+        String shortName = name;
+        if (shortName.startsWith("/")) shortName = shortName.substring(1);
+        if (shortName.startsWith("logs/")) shortName = shortName.substring(5);
+        if (!shortName.endsWith(".log") && !shortName.endsWith(".log.gz")) {
+          // Seek indexes (.idx) are internal
+          entry.close();
+          continue;
+        }
+        String date = shortName;
+        int dot = date.indexOf('.');
+        if (dot > 0) date = date.substring(0, dot);
+        LogItem item;
+        item.name = shortName.length() ? shortName : name;
+        item.size = size;
+        item.date = date;
+        auto it = bestByDate.find(date);
+        if (it == bestByDate.end() || size > it->second.size) {
+          bestByDate[date] = item;
+        }
+      }
+      entry.close();
+    }
+    dir.close();
+  }
+  for (const auto& kv : bestByDate) {
+    items.push_back(kv.second);
+  }
+  JsonDocument doc;
+  JsonArray arr = doc.to<JsonArray>();
+  for (const auto& item : items) {
+    JsonObject o = arr.add<JsonObject>();
+    o["name"] = item.name;
+    o["size"] = item.size;
+    o["date"] = item.date;
+  }
+  sendJson(server, doc);
+}
+
+static void handleApiLogsSettingsGet() {
+  JsonDocument doc;
+  doc["retention_days"] = getLogRetentionDays();
+  doc["delete_on_boot"] = getLogDeleteOnBoot();
+  doc["level"] = (uint8_t)LOG_LEVEL;
+  sendJson(server, doc);
+}
+
+static void handleApiLogsSettingsPost() {
+  if (server.hasArg("retention_days")) {
+    setLogRetentionDays(server.arg("retention_days").toInt());
+  }
+  if (server.hasArg("delete_on_boot")) {
+    setLogDeleteOnBoot(server.arg("delete_on_boot") == "true" || server.arg("delete_on_boot") == "1");
+  }
+  if (server.hasArg("level")) {
+    setLogLevel((LogLevel)server.arg("level").toInt());
+  }
+  server.send(200, "application/json", "{\"status\":\"ok\"}");
+}
+
+static void handleBuildinfo() {
+  JsonDocument doc;
+  doc["firmware"] = FIRMWARE_VERSION;
+  doc["ui"] = UI_VERSION;
+  doc["git_sha"] = BUILD_GIT_SHA;
+  doc["git_branch"] = BUILD_GIT_BRANCH;
+  doc["build_time_utc"] = BUILD_TIME_UTC;
+  doc["environment"] = BUILD_ENV_NAME;
+  sendJson(server, doc);
+}
+
+static void handleApiDeviceInfo() {
+  unsigned long upMs = millis();
+  unsigned long upSec = upMs / 1000UL;
+  unsigned long days = upSec / 86400UL;
+  upSec %= 86400UL;
+  unsigned long hours = upSec / 3600UL;
+  upSec %= 3600UL;
+  unsigned long mins = upSec / 60UL;
+  unsigned long secs = upSec % 60UL;
+  char upBuf[32];
+  snprintf(upBuf, sizeof(upBuf), "%lud %02lu:%02lu:%02lu", days, hours, mins, secs);
+
+  JsonDocument doc;
+  doc["uptime_ms"] = millis();
+  doc["uptime_human"] = upBuf;
+  doc["heap_free"] = ESP.getFreeHeap();
+  doc["heap_min_free"] = ESP.getMinFreeHeap();
+  doc["cpu_freq_mhz"] = ESP.getCpuFreqMHz();
+  doc["chip_model"] = ESP.getChipModel();
+  doc["chip_rev"] = ESP.getChipRevision();
+  doc["sdk"] = ESP.getSdkVersion();
+  doc["rssi"] = WiFi.RSSI();
+#if defined(ARDUINO_ARCH_ESP32)
+  doc["temp_c"] = temperatureRead();
+#endif
+  sendJson(server, doc);
+}
+
+static void handleLogDownload() {
+  logFlushFile();
+  String path;
+  if (!resolveLogFilePath(path)) return;
+  File f = FS_IMPL.open(path, "r");
+  if (!f) {
+    server.send(404, "text/plain", "Log file not found");
+    return;
+  }
+  String filename = path.substring(path.lastIndexOf('/') + 1);
+  bool archived = filename.endsWith(".gz");
+  if (archived) filename.remove(filename.length() - 3);
+  server.sendHeader("Content-Disposition", String("attachment; filename=\"") + filename + "\"");
+  // Ranges address the stored bytes: the plain log, or the gzip stream of an archive
+  bool passThrough = !archived || httpAcceptsGzip(server.header("Accept-Encoding").c_str());
+  server.sendHeader("Accept-Ranges", passThrough ? "bytes" : "none");
+  if (!passThrough) {
+    streamInflated(f, "text/plain");
+  } else if (!sendFileRange(f, "text/plain", archived)) {
+    // An archive goes out as is and the browser inflates it (streamFile() sets Content-Encoding)
+    server.streamFile(f, "text/plain");
+  }
+  f.close();
+}
+
+// Live state: a full "state" event on connect, then partial snapshots per changed group
+static void handleApiStateEvents() {
+  if (!g_stateStream.attach(server.client())) return;
+  JsonDocument doc;
+  fillStateSnapshot(doc);
+  fillStateGroup(doc, STATE_FRAME);
+  String data;
+  serializeJson(doc, data);
+  g_stateStream.sendTo(g_stateStream.lastAttachedSlot(), "state", data, 0);
+}
+
+// Per-route handler time and response size, slowest (by total time) first
+static void handleApiPerfHttp() {
+  const HttpPerf& perf = server.perf();
+  int order[HTTP_PERF_MAX_ROUTES];
+  int used = 0;
+  for (int i = 0; i < perf.count(); ++i) {
+    if (perf.at(i).calls > 0) order[used++] = i;
+  }
+  std::sort(order, order + used, [&perf](int a, int b) { return perf.at(a).totalUs > perf.at(b).totalUs; });
+  JsonDocument doc;
+  doc["uptime_ms"] = millis();
+  doc["registered"] = perf.count();
+  JsonArray routes = doc["routes"].to<JsonArray>();
+  for (int i = 0; i < used; ++i) {
+    const HttpRouteStats& r = perf.at(order[i]);
+    JsonObject o = routes.add<JsonObject>();
+    o["path"] = r.path;
+    o["method"] = httpMethodName(r.method);
+    o["calls"] = r.calls;
+    o["total_us"] = r.totalUs;
+    o["avg_us"] = (uint32_t)(r.totalUs / r.calls);
+    o["max_us"] = r.maxUs;
+    o["bytes"] = r.bytes;
+  }
+  sendJson(server, doc);
+}
+
+static void handleApiPerfHttpReset() {
+  server.perf().reset();
+  server.send(200, "text/plain", "OK");
+}
+
+// Device restart
+static void handleRestart() {
+  logInfo("⚠️ Restart requested via dashboard");
+  // Clear all log files before restart
+  logInfo("🗑️ Clearing all log files before restart");
+  clearAllLogFiles();
+  // Give filesystem time to complete the deletion operations
+  delay(500);
+  server.send(200, "text/html", R"rawliteral(
+    <html>
+      <head>
+        <meta http-equiv='refresh' content='5;url=/' />
+      </head>
+      <body>
+        <h1>Wordclock is restarting...</h1>
+        <p>All logs have been cleared. You will be redirected to the dashboard in 5 seconds.</p>
+      </body>
+    </html>
+  )rawliteral");
+  delay(100);  // Small delay to finish the HTTP response
+  safeRestart();
+}
+
+static void handleResetwifi() {
+logInfo("⚠️ WiFi reset requested via dashboard");
+  server.send(200, "text/html", R"rawliteral(
+    <html>
+      <head>
+        <meta http-equiv='refresh' content='10;url=/' />
+      </head>
+      <body>
+        <h1>Resetting WiFi...</h1>
+        <p>WiFi settings will be cleared. You may need to reconnect to the 'Wordclock' access point.</p>
+      </body>
+    </html>
+  )rawliteral");
+  delay(100);  // Small delay to finish the HTTP response
+  resetWiFiSettings();
+}
+
+static void handleStartSequence() {
+logInfo("✨ Startup sequence started via dashboard");
+  extern StartupSequence startupSequence;
+  startupSequence.start();
+  server.send(200, "text/plain", "Startup sequence executed");
+}
+
+static void handleUploadFirmware() {
+  server.send(200, "text/plain", Update.hasError() ? "Firmware update failed" : "Firmware update successful. Rebooting...");
+  if (!Update.hasError()) {
+    delay(1000);
+    safeRestart();
+  }
+}
+
+static void handleUploadFirmwareChunk() {
+  HTTPUpload& upload = server.upload();
+
+  if (upload.status == UPLOAD_FILE_START) {
+    logInfo("📂 Upload started: " + upload.filename);
+    if (!Update.begin(UPDATE_SIZE_UNKNOWN)) {
+      logError("❌ Update.begin() failed");
+      Update.printError(Serial);
+    }
+  } else if (upload.status == UPLOAD_FILE_WRITE) {
+    size_t written = Update.write(upload.buf, upload.currentSize);
+    if (written != upload.currentSize) {
+      logError("❌ Error writing chunk");
+      Update.printError(Serial);
+    } else {
+      logDebug("✏️ Written: " + String(written) + " bytes");
+    }
+  } else if (upload.status == UPLOAD_FILE_END) {
+    logInfo("📥 Upload completed");
+    logDebug("Total " + String(Update.size()) + " bytes");
+    if (!Update.end(true)) {
+      logError("❌ Update.end() failed");
+      Update.printError(Serial);
+    }
+  }
+}
+
+// Separate endpoint for SPIFFS (UI) updates
+static void handleUploadSpiffs() {
+  server.send(200, "text/plain", Update.hasError() ? "SPIFFS update failed" : "SPIFFS update successful. Rebooting...");
+  if (!Update.hasError()) {
+    delay(1000);
+    safeRestart();
+  }
+}
+
+static void handleUploadSpiffsChunk() {
+  HTTPUpload& upload = server.upload();
+  if (upload.status == UPLOAD_FILE_START) {
+    logInfo("📂 SPIFFS upload started: " + upload.filename);
+    if (!Update.begin(UPDATE_SIZE_UNKNOWN, U_SPIFFS)) {
+      logError("❌ Update.begin(U_SPIFFS) failed");
+      Update.printError(Serial);
+    }
+  } else if (upload.status == UPLOAD_FILE_WRITE) {
+    size_t written = Update.write(upload.buf, upload.currentSize);
+    if (written != upload.currentSize) {
+      logError("❌ Error writing chunk (SPIFFS)");
+      Update.printError(Serial);
+    } else {
+      logDebug("✏️ SPIFFS written: " + String(written) + " bytes");
+    }
+  } else if (upload.status == UPLOAD_FILE_END) {
+    logInfo("📥 SPIFFS upload completed");
+    logDebug("SPIFFS total " + String(Update.size()) + " bytes");
+    if (!Update.end(true)) {
+      logError("❌ Update.end(U_SPIFFS) failed");
+      Update.printError(Serial);
+    }
+  }
+}
+
+static void handleCheckForUpdate() {
+  logInfo("Firmware update manually started via UI");
+  server.send(200, "text/plain", "Firmware update started");
+  delay(100);
+  checkForFirmwareUpdate();
+}
+
+static void handleSyncUI() {
+  logInfo("🗂️ UI sync requested by admin");
+  syncFilesFromManifest();
+  server.send(200, "text/plain", "UI sync started");
+}
+
+// Expose firmware version
+static void handleVersion() {
+  server.send(200, "text/plain", FIRMWARE_VERSION);
+}
+
+// UI version from config
+static void handleUiversion() {
+  server.send(200, "text/plain", UI_VERSION);
+}
+
+// Sell mode endpoints (force 10:47 display)
+static void handleGetSellMode() {
+  server.send(200, "text/plain", displaySettings.isSellMode() ? "on" : "off");
+}
+
+static void handleSetSellMode() {
+  if (!server.hasArg("state")) {
+    server.send(400, "text/plain", "Missing state");
+    return;
+  }
+  String st = server.arg("state");
+  bool on = (st == "on" || st == "1" || st == "true");
+  displaySettings.setSellMode(on);
+  // Trigger animation to new effective time
+  struct tm t = {};
+  if (on) {
+    t.tm_hour = 10;
+    t.tm_min = 47;
+  } else {
+    if (!getLocalTime(&t)) { server.send(200, "text/plain", "OK"); return; }
+  }
+  wordclock_force_animation_for_time(&t);
+logInfo(String("🛒 Sell time ") + (on ? "ON (10:47)" : "OFF"));
+  server.send(200, "text/plain", "OK");
+}
+
+static void handleSetLogLevel() {
+  if (!server.hasArg("level")) {
+    server.send(400, "text/plain", "Missing log level");
+    return;
+  }
+
+  String levelStr = server.arg("level");
+  LogLevel level;
+
+  if (levelStr == "DEBUG") level = LOG_LEVEL_DEBUG;
+  else if (levelStr == "INFO") level = LOG_LEVEL_INFO;
+  else if (levelStr == "WARN") level = LOG_LEVEL_WARN;
+  else if (levelStr == "ERROR") level = LOG_LEVEL_ERROR;
+  else {
+    server.send(400, "text/plain", "Invalid log level");
+    return;
+  }
+
+
+  setLogLevel(level);
+logInfo("🔧 Log level changed to: " + levelStr);
+  server.send(200, "text/plain", "OK");
+}
+
+static void handleGetLogLevel() {
+  // Return current level as string
+  server.send(200, "text/plain", currentLogLevelName());
+}
+
+// Sorted by path (checked at compile time); one entry per path and method
+static constexpr WebRoute ROUTES[] = {
+  { "/",                    HTTP_GET,  WebAuth::None,  handleRoot, nullptr },
+  { "/admin.html",          HTTP_GET,  WebAuth::Admin, handleAdminPage, nullptr },
+  { "/api/device/info",     HTTP_GET,  WebAuth::Ui,    handleApiDeviceInfo, nullptr },
+  { "/api/logs",            HTTP_GET,  WebAuth::Ui,    handleApiLogs, nullptr },
+  { "/api/logs/query",      HTTP_GET,  WebAuth::Ui,    handleApiLogsQuery, nullptr },
+  { "/api/logs/settings",   HTTP_GET,  WebAuth::Ui,    handleApiLogsSettingsGet, nullptr },
+  { "/api/logs/settings",   HTTP_POST, WebAuth::Ui,    handleApiLogsSettingsPost, nullptr },
+  { "/api/logs/summary",    HTTP_GET,  WebAuth::Ui,    handleApiLogsSummary, nullptr },
+  { "/api/logs/tail",       HTTP_GET,  WebAuth::Ui,    handleApiLogsTail, nullptr },
+  { "/api/mqtt/config",     HTTP_GET,  WebAuth::Ui,    handleApiMqttConfigGet, nullptr },
+  { "/api/mqtt/config",     HTTP_POST, WebAuth::Ui,    handleApiMqttConfigPost, nullptr },
+  { "/api/mqtt/reconnect",  HTTP_POST, WebAuth::Ui,    handleApiMqttReconnect, nullptr },
+  { "/api/mqtt/status",     HTTP_GET,  WebAuth::Ui,    handleApiMqttStatus, nullptr },
+  { "/api/mqtt/test",       HTTP_GET,  WebAuth::Ui,    handleApiMqttTestGet, nullptr },
+  { "/api/mqtt/test",       HTTP_POST, WebAuth::Ui,    handleApiMqttTestPost, nullptr },
+  { "/api/perf/http",       HTTP_GET,  WebAuth::Ui,    handleApiPerfHttp, nullptr },
+  { "/api/perf/http/reset", HTTP_POST, WebAuth::Admin, handleApiPerfHttpReset, nullptr },
+  { "/api/setup/complete",  HTTP_POST, WebAuth::None,  handleApiSetupComplete, nullptr },
+  { "/api/setup/grid",      HTTP_GET,  WebAuth::None,  handleApiSetupGridGet, nullptr },
+  { "/api/setup/grid",      HTTP_POST, WebAuth::None,  handleApiSetupGridPost, nullptr },
+  { "/api/setup/status",    HTTP_GET,  WebAuth::None,  handleApiSetupStatus, nullptr },
+  { "/api/state",           HTTP_GET,  WebAuth::Ui,    handleApiState, nullptr },
+  { "/api/state/events",    HTTP_GET,  WebAuth::Ui,    handleApiStateEvents, nullptr },
+  { "/api/update/channel",  HTTP_GET,  WebAuth::Ui,    handleApiUpdateChannelGet, nullptr },
+  { "/api/update/channel",  HTTP_POST, WebAuth::Ui,    handleApiUpdateChannelPost, nullptr },
+  { "/buildinfo",           HTTP_GET,  WebAuth::Ui,    handleBuildinfo, nullptr },
+  { "/changepw.html",       HTTP_GET,  WebAuth::Admin, handleChangepwPage, nullptr },
+  { "/checkForUpdate",      HTTP_ANY,  WebAuth::Ui,    handleCheckForUpdate, nullptr },
+  { "/dashboard.html",      HTTP_GET,  WebAuth::Ui,    handleDashboardPage, nullptr },
+  { "/factoryreset",        HTTP_POST, WebAuth::None,  handleFactoryreset, nullptr },
+  { "/factorytoken",        HTTP_GET,  WebAuth::None,  handleFactorytoken, nullptr },
+  { "/favicon.ico",         HTTP_GET,  WebAuth::None,  handleFaviconIco, nullptr },
+  { "/getAnimate",          HTTP_ANY,  WebAuth::Ui,    handleGetAnimate, nullptr },
+  { "/getAutoUpdate",       HTTP_ANY,  WebAuth::Ui,    handleGetAutoUpdate, nullptr },
+  { "/getBrightness",       HTTP_ANY,  WebAuth::Ui,    handleGetBrightness, nullptr },
+  { "/getColor",            HTTP_GET,  WebAuth::Ui,    handleGetColor, nullptr },
+  { "/getGridVariant",      HTTP_ANY,  WebAuth::Ui,    handleGetGridVariant, nullptr },
+  { "/getHetIsDuration",    HTTP_ANY,  WebAuth::Ui,    handleGetHetIsDuration, nullptr },
+  { "/getLogLevel",         HTTP_GET,  WebAuth::Ui,    handleGetLogLevel, nullptr },
+  { "/getNightModeConfig",  HTTP_GET,  WebAuth::Ui,    handleGetNightModeConfig, nullptr },
+  { "/getSellMode",         HTTP_ANY,  WebAuth::Ui,    handleGetSellMode, nullptr },
+  { "/listGridVariants",    HTTP_ANY,  WebAuth::Ui,    handleListGridVariants, nullptr },
+  { "/log",                 HTTP_ANY,  WebAuth::Ui,    handleLog, nullptr },
+  { "/log/download",        HTTP_GET,  WebAuth::Ui,    handleLogDownload, nullptr },
+  { "/logs.html",           HTTP_GET,  WebAuth::Ui,    handleLogsPage, nullptr },
+  { "/mqtt.html",           HTTP_GET,  WebAuth::Ui,    handleMqttPage, nullptr },
+  { "/resetwifi",           HTTP_ANY,  WebAuth::Ui,    handleResetwifi, nullptr },
+  { "/restart",             HTTP_ANY,  WebAuth::Ui,    handleRestart, nullptr },
+  { "/setAnimate",          HTTP_ANY,  WebAuth::Ui,    handleSetAnimate, nullptr },
+  { "/setAutoUpdate",       HTTP_ANY,  WebAuth::Ui,    handleSetAutoUpdate, nullptr },
+  { "/setBrightness",       HTTP_ANY,  WebAuth::Ui,    handleSetBrightness, nullptr },
+  { "/setColor",            HTTP_GET,  WebAuth::Ui,    handleSetColor, nullptr },
+  { "/setGridVariant",      HTTP_ANY,  WebAuth::Ui,    handleSetGridVariant, nullptr },
+  { "/setHetIsDuration",    HTTP_ANY,  WebAuth::Ui,    handleSetHetIsDuration, nullptr },
+  { "/setLogLevel",         HTTP_ANY,  WebAuth::Ui,    handleSetLogLevel, nullptr },
+  { "/setNightModeConfig",  HTTP_POST, WebAuth::Ui,    handleSetNightModeConfig, nullptr },
+  { "/setSellMode",         HTTP_ANY,  WebAuth::Ui,    handleSetSellMode, nullptr },
+  { "/setUIPassword",       HTTP_POST, WebAuth::Admin, handleSetUIPassword, nullptr },
+  { "/setup.html",          HTTP_GET,  WebAuth::None,  handleSetupPage, nullptr },
+  { "/startSequence",       HTTP_ANY,  WebAuth::Ui,    handleStartSequence, nullptr },
+  { "/status",              HTTP_ANY,  WebAuth::Ui,    handleStatus, nullptr },
+  { "/syncUI",              HTTP_POST, WebAuth::Admin, handleSyncUI, nullptr },
+  { "/toggle",              HTTP_ANY,  WebAuth::Ui,    handleToggle, nullptr },
+  { "/uiversion",           HTTP_ANY,  WebAuth::Ui,    handleUiversion, nullptr },
+  { "/update.html",         HTTP_GET,  WebAuth::Ui,    handleUpdatePage, nullptr },
+  { "/uploadFirmware",      HTTP_POST, WebAuth::Ui,    handleUploadFirmware, handleUploadFirmwareChunk },
+  { "/uploadSpiffs",        HTTP_POST, WebAuth::Ui,    handleUploadSpiffs, handleUploadSpiffsChunk },
+  { "/version",             HTTP_ANY,  WebAuth::Ui,    handleVersion, nullptr },
+};
+static_assert(webRoutesSorted(ROUTES, sizeof(ROUTES) / sizeof(ROUTES[0])), "ROUTES must be sorted by path");
+
+// Refuses the request (and sends the challenge or error) when the route's access level is not met
+static bool authorizeRoute(const WebRoute& route) {
+  bool ok = true;
+  switch (route.auth) {
+    case WebAuth::Ui:    ok = ensureUiAuth(); break;
+    case WebAuth::Admin: ok = ensureAdminAuth(); break;
+    case WebAuth::None:  break;
+  }
+  if (!ok) logWarn(String("[API] ") + route.path + ": Auth failed");
+  return ok;
+}
+
+static WebRouter g_router(ROUTES, sizeof(ROUTES) / sizeof(ROUTES[0]), authorizeRoute);
+
+// Register the route table and the request headers handlers read
+void setupWebRoutes() {
+  // Capture Accept-Encoding so we can serve gzip if available, If-None-Match for revalidation,
+  // Range/If-Range for partial log downloads
+  static const char* headerKeys[] = { "Accept-Encoding", "If-None-Match", "Last-Event-ID", "Range", "If-Range" };
+  server.collectHeaders(headerKeys, 5);
+
+  stateSubscribe(onStateChanged);
+
+  webBind(g_webContext);
+  webPagesBegin();
+
+  g_router.attach(server);
+}
+
+// Periodic web work that has to happen outside request handlers (call after server.handleClient())
+void webRoutesLoop() {
+  g_stateStream.loop();
+  MqttProbeResult probe;
+  if (mqttProbeTakeFinished(probe) && g_stateStream.hasClients()) {
+    JsonDocument doc;
+    fillMqttProbe(doc.to<JsonObject>(), probe);
+    String data;
+    serializeJson(doc, data);
+    g_stateStream.broadcast("mqtt_test", data);
+  }
+  webLogStreamLoop();
+}
@@ -1,13 +1,13 @@
 #pragma once
 
-#include <WebServer.h>
+#include "instrumented_web_server.h"
 #include "web_routes.h"
 #include "log.h"
 
 // Initialize webserver and routes
 // This function registers all webserver endpoints and starts the webserver.
 // Ensures the UI and API are accessible over the network.
-inline void initWebServer(WebServer& server) {
+inline void initWebServer(InstrumentedWebServer& server) {
     setupWebRoutes();
     server.begin();
     logInfo("🟢 Webserver started and routes activated");
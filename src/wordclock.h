@@ -1,5 +1,7 @@
 #pragma once
+#ifndef PIO_UNIT_TESTING
 #include <Adafruit_NeoPixel.h>
+#endif
 #include "config.h"
 #include "log.h"
 #include "led_controller.h"
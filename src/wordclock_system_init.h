@@ -1,5 +1,6 @@
 #pragma once
 
+#include "secrets.h"
 #include "ui_auth.h"
 #include "wordclock.h"
 #include "log.h"
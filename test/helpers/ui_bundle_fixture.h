@@ -0,0 +1,58 @@
+#ifndef UI_BUNDLE_FIXTURE_H
+#define UI_BUNDLE_FIXTURE_H
+
+// A firmware UI bundle for native tests. Include after src/log_codec.cpp and
+// before src/ui_assets.cpp, then call uiBundleFixtureBuild() once: the pages
+// are compressed the way tools/embed_ui.py does it (fixed Huffman, gzip).
+
+#include <string>
+#include "../../src/log_codec.h"
+#include "../../src/ui_assets.h"
+
+#define UI_BUNDLE_EMBEDDED 1
+#define UI_BUNDLE_HASH "f1x7u4e0"
+
+// Sorted by path, like the generated table; gz/crc/length are filled in by uiBundleFixtureBuild()
+static UiAsset UI_BUNDLE[] = {
+    { "/dashboard.html", "text/html", nullptr, 0, 0, 0 },
+    { "/setup.html",     "text/html", nullptr, 0, 0, 0 },
+};
+
+/** @brief Page content of about @p size bytes: markup with the repetition of a real page */
+inline std::string uiBundleFixturePage(const char* path, size_t size) {
+    std::string page = std::string("<!DOCTYPE html><html><head><title>") + path + "</title></head><body>\n";
+    for (int row = 0; page.size() < size; ++row) {
+        page += "<div class=\"row\" id=\"r" + std::to_string(row) + "\"><span class=\"label\">Setting " +
+                std::to_string(row) + "</span><input type=\"range\" min=\"0\" max=\"255\"></div>\n";
+    }
+    page.resize(size > 15 ? size - 15 : size);
+    page += "</body></html>\n";
+    return page;
+}
+
+inline bool uiBundleFixtureWrite(void* ctx, const uint8_t* data, size_t len) {
+    static_cast<std::string*>(ctx)->append(reinterpret_cast<const char*>(data), len);
+    return true;
+}
+
+/** @brief Compress every bundle page (@p pageSize bytes each); returns false when deflating failed */
+inline bool uiBundleFixtureBuild(size_t pageSize = 14873) {
+    static std::string gz[sizeof(UI_BUNDLE) / sizeof(UI_BUNDLE[0])];
+    for (size_t i = 0; i < sizeof(UI_BUNDLE) / sizeof(UI_BUNDLE[0]); ++i) {
+        UiAsset& asset = UI_BUNDLE[i];
+        std::string raw = uiBundleFixturePage(asset.path, pageSize);
+        gz[i].clear();
+        LogDeflater deflater;
+        if (!deflater.begin(uiBundleFixtureWrite, &gz[i]) ||
+            !deflater.write(reinterpret_cast<const uint8_t*>(raw.data()), raw.size()) || !deflater.finish()) {
+            return false;
+        }
+        asset.gz = reinterpret_cast<const uint8_t*>(gz[i].data());
+        asset.gzSize = static_cast<uint32_t>(gz[i].size());
+        asset.crc = logCrc32(0, reinterpret_cast<const uint8_t*>(raw.data()), raw.size());
+        asset.length = static_cast<uint32_t>(raw.size());
+    }
+    return true;
+}
+
+#endif // UI_BUNDLE_FIXTURE_H
@@ -1,6 +1,20 @@
 #ifndef PUBSUBCLIENT_H
 #define PUBSUBCLIENT_H
 
+#ifdef MOCK_PUBSUBCLIENT_NET
+
+// End-to-end tests: a real MQTT client over the network (see mock_mqtt_broker.h)
+#include "mock_pubsubclient_net.h"
+
+class PubSubClient : public NetPubSubClient {
+public:
+    explicit PubSubClient(Client& client) : NetPubSubClient(client) {}
+    PubSubClient(const PubSubClient&) = delete;
+    PubSubClient& operator=(const PubSubClient&) = delete;
+};
+
+#else
+
 #include "mock_pubsubclient.h"
 
 // In test environment, PubSubClient is MockPubSubClient
@@ -12,5 +26,6 @@ public:
     PubSubClient& operator=(const PubSubClient&) = delete;
 };
 
-#endif // PUBSUBCLIENT_H
+#endif // MOCK_PUBSUBCLIENT_NET
 
+#endif // PUBSUBCLIENT_H
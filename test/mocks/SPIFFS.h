@@ -0,0 +1,176 @@
+#ifndef MOCK_SPIFFS_H
+#define MOCK_SPIFFS_H
+
+#include "mock_arduino.h"
+#include "mock_heap.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief In-memory flash filesystem with the SPIFFS File API the firmware uses
+ *
+ * Paths are flat, as on SPIFFS: "/logs/a.log" is a file and opening "/logs"
+ * lists every file under that prefix. name() returns the full path. A File
+ * keeps its contents alive after remove(), like an open handle on the device.
+ * Tests reach the contents through MockFS::contents() and put(); setReadDelay()
+ * makes every read take mock time so time-sliced readers stop mid-file.
+ * The storage stands in for flash, so it is not counted by MockHeap.
+ */
+class File {
+public:
+    File() {}
+
+    explicit operator bool() const { return (bool)data_ || dir_; }
+
+    size_t write(const uint8_t* buf, size_t len) {
+        if (!data_ || !writable_) return 0;
+        MockHeap::Pause pause;
+        if (append_) pos_ = data_->size();
+        if (pos_ + len > data_->size()) data_->resize(pos_ + len);
+        memcpy(&(*data_)[pos_], buf, len);
+        pos_ += len;
+        return len;
+    }
+    size_t write(uint8_t c) { return write(&c, 1); }
+
+    size_t read(uint8_t* buf, size_t len) {
+        if (readDelayMs) setMockMillis(millis() + readDelayMs);
+        if (!data_ || pos_ >= data_->size()) return 0;
+        size_t n = std::min(len, data_->size() - pos_);
+        memcpy(buf, data_->data() + pos_, n);
+        pos_ += n;
+        return n;
+    }
+    int read() {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+    int available() { return data_ && pos_ < data_->size() ? (int)(data_->size() - pos_) : 0; }
+
+    bool seek(uint32_t pos) {
+        if (!data_ || pos > data_->size()) return false;
+        pos_ = pos;
+        return true;
+    }
+    size_t position() const { return pos_; }
+    size_t size() const { return data_ ? data_->size() : 0; }
+    void flush() {}
+    void close() {
+        data_.reset();
+        dir_ = false;
+    }
+
+    const char* name() const { return path_.c_str(); }
+    bool isDirectory() const { return dir_; }
+    time_t getLastWrite() { return 0; }
+
+    File openNextFile() {
+        if (!dir_ || next_ >= entries_.size()) return File();
+        MockHeap::Pause pause;
+        return entries_[next_++];
+    }
+
+    // Mock millis advanced by every read, to simulate slow flash (see MockFS::setReadDelay)
+    static inline unsigned long readDelayMs = 0;
+
+private:
+    friend class MockFS;
+    std::shared_ptr<std::string> data_;
+    std::string path_;
+    size_t pos_ = 0;
+    bool writable_ = false;
+    bool append_ = false;
+    bool dir_ = false;
+    std::vector<File> entries_;
+    size_t next_ = 0;
+};
+
+class MockFS {
+public:
+    bool begin(bool = false) { return true; }
+
+    File open(const String& path, const char* mode = "r") { return open(path.c_str(), mode); }
+    File open(const char* path, const char* mode = "r") {
+        MockHeap::Pause pause;
+        File f;
+        f.path_ = path;
+        auto it = files_.find(path);
+        if (mode[0] == 'r') {
+            if (it != files_.end()) {
+                f.data_ = it->second;
+                return f;
+            }
+            // A path with files below it is a directory
+            std::string prefix = std::string(path) + "/";
+            for (auto& kv : files_) {
+                if (kv.first.compare(0, prefix.size(), prefix) == 0) {
+                    File entry;
+                    entry.path_ = kv.first;
+                    entry.data_ = kv.second;
+                    f.entries_.push_back(entry);
+                }
+            }
+            f.dir_ = !f.entries_.empty() || dirs_.count(path);
+            return f;
+        }
+        if (mode[0] == 'w' || it == files_.end()) {
+            files_[path] = std::make_shared<std::string>();
+        }
+        f.data_ = files_[path];
+        f.writable_ = true;
+        f.append_ = mode[0] == 'a';
+        if (f.append_) f.pos_ = f.data_->size();
+        return f;
+    }
+
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool exists(const char* path) {
+        MockHeap::Pause pause;
+        return files_.count(path) || dirs_.count(path);
+    }
+    bool remove(const String& path) {
+        MockHeap::Pause pause;
+        return files_.erase(path.c_str()) > 0;
+    }
+    bool rename(const String& from, const String& to) {
+        MockHeap::Pause pause;
+        auto it = files_.find(from.c_str());
+        if (it == files_.end()) return false;
+        files_[to.c_str()] = it->second;
+        files_.erase(it);
+        return true;
+    }
+    bool mkdir(const String& path) {
+        MockHeap::Pause pause;
+        dirs_.insert(path.c_str());
+        return true;
+    }
+
+    // Test helpers
+    void reset() {
+        files_.clear();
+        dirs_.clear();
+        File::readDelayMs = 0;
+    }
+    void setReadDelay(unsigned long ms) { File::readDelayMs = ms; }
+    void put(const std::string& path, const std::string& data) {
+        files_[path] = std::make_shared<std::string>(data);
+    }
+    std::string contents(const std::string& path) const {
+        auto it = files_.find(path);
+        return it == files_.end() ? std::string() : *it->second;
+    }
+
+private:
+    std::map<std::string, std::shared_ptr<std::string>> files_;
+    std::set<std::string> dirs_;
+};
+
+inline MockFS SPIFFS;
+
+#endif // MOCK_SPIFFS_H
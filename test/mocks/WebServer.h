@@ -0,0 +1,7 @@
+#ifndef WEBSERVER_H
+#define WEBSERVER_H
+
+// This file redirects WebServer.h includes to our mock implementation
+#include "mock_web_server.h"
+
+#endif // WEBSERVER_H
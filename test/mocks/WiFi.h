@@ -0,0 +1,38 @@
+#ifndef WIFI_H
+#define WIFI_H
+
+#include "mock_wifi_client.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6,
+} wl_status_t;
+
+/**
+ * @brief Mock WiFi station (connected on 127.0.0.1 unless a test changes it)
+ */
+class MockWiFiClass {
+public:
+    wl_status_t status() const { return status_; }
+    bool isConnected() const { return status_ == WL_CONNECTED; }
+
+    void macAddress(uint8_t* mac) const { memcpy(mac, mac_, sizeof(mac_)); }
+    IPAddress localIP() const { return IPAddress(127, 0, 0, 1); }
+    int8_t RSSI() const { return -55; }
+    int32_t channel() const { return 6; }
+
+    // Test helpers
+    void setStatus(wl_status_t status) { status_ = status; }
+
+private:
+    wl_status_t status_ = WL_CONNECTED;
+    uint8_t mac_[6] = { 0x24, 0x6F, 0x28, 0x12, 0x34, 0x56 };
+};
+
+inline MockWiFiClass WiFi;
+
+#endif // WIFI_H
@@ -0,0 +1,7 @@
+#ifndef WIFICLIENT_H
+#define WIFICLIENT_H
+
+// This file redirects WiFiClient.h includes to our mock implementation
+#include "mock_wifi_client.h"
+
+#endif // WIFICLIENT_H
@@ -0,0 +1,13 @@
+#ifndef ESP_HEAP_CAPS_H
+#define ESP_HEAP_CAPS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+
+// Fixed figures: 200000 bytes free (as esp_get_free_heap_size()), largest block 150000
+inline size_t heap_caps_get_free_size(uint32_t) { return 200000; }
+inline size_t heap_caps_get_largest_free_block(uint32_t) { return 150000; }
+
+#endif // ESP_HEAP_CAPS_H
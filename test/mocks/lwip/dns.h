@@ -0,0 +1,56 @@
+#ifndef MOCK_LWIP_DNS_H
+#define MOCK_LWIP_DNS_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Mock of lwIP's asynchronous resolver. Every name lookup is left in flight
+// until the test answers it with mockDnsAnswer().
+
+typedef int8_t err_t;
+#define ERR_OK          0
+#define ERR_INPROGRESS -5
+#define ERR_ARG       -16
+
+struct ip4_addr_t { uint32_t addr; };
+struct ip_addr_t { union { ip4_addr_t ip4; } u_addr; uint8_t type; };
+#define ip_2_ip4(ipaddr)      (&((ipaddr)->u_addr.ip4))
+#define ip4_addr_get_u32(a)   ((a)->addr)
+
+typedef void (*dns_found_callback)(const char* name, const ip_addr_t* ipaddr, void* callback_arg);
+
+struct MockDnsLookup {
+    std::string name;
+    dns_found_callback callback = nullptr;
+    void* arg = nullptr;
+    int lookups = 0;
+};
+
+inline MockDnsLookup& mockDnsLookup() {
+    static MockDnsLookup lookup;
+    return lookup;
+}
+
+inline err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* arg) {
+    (void)addr;
+    if (!hostname || !*hostname) return ERR_ARG;
+    MockDnsLookup& l = mockDnsLookup();
+    l.name = hostname;
+    l.callback = found;
+    l.arg = arg;
+    l.lookups++;
+    return ERR_INPROGRESS;
+}
+
+/** @brief Complete the pending lookup; @p addr 0 reports "not found" */
+inline void mockDnsAnswer(uint32_t addr) {
+    MockDnsLookup& l = mockDnsLookup();
+    if (!l.callback) return;
+    ip_addr_t ip;
+    memset(&ip, 0, sizeof(ip));
+    ip.u_addr.ip4.addr = addr;
+    l.callback(l.name.c_str(), addr ? &ip : nullptr, l.arg);
+}
+
+#endif // MOCK_LWIP_DNS_H
@@ -0,0 +1,20 @@
+#ifndef MOCK_LWIP_SOCKETS_H
+#define MOCK_LWIP_SOCKETS_H
+
+// lwIP's BSD-style socket calls, mapped to the host's sockets
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+inline int lwip_socket(int domain, int type, int protocol) { return ::socket(domain, type, protocol); }
+inline int lwip_connect(int s, const struct sockaddr* name, socklen_t namelen) { return ::connect(s, name, namelen); }
+inline int lwip_select(int n, fd_set* r, fd_set* w, fd_set* e, struct timeval* t) { return ::select(n, r, w, e, t); }
+inline int lwip_getsockopt(int s, int level, int name, void* val, socklen_t* len) { return ::getsockopt(s, level, name, val, len); }
+inline int lwip_fcntl(int s, int cmd, int val) { return ::fcntl(s, cmd, val); }
+inline int lwip_close(int s) { return ::close(s); }
+
+#endif // MOCK_LWIP_SOCKETS_H
@@ -5,6 +5,10 @@
 #include <cstring>
 #include <cstdint>
 #include <cstdio>
+#include <cstdarg>
+#include <chrono>
+#include <ctime>
+#include <algorithm>
 
 // Mock Arduino String class for native testing
 class String {
@@ -24,6 +28,8 @@ public:
     
     const char* c_str() const { return data_.c_str(); }
     size_t length() const { return data_.length(); }
+    bool isEmpty() const { return data_.empty(); }
+    char operator[](size_t index) const { return index < data_.length() ? data_[index] : '\0'; }
     
     String& operator=(const String& other) {
         data_ = other.data_;
@@ -109,6 +115,40 @@ public:
     int toInt() const {
         return std::atoi(data_.c_str());
     }
+
+    bool startsWith(const String& prefix) const {
+        return data_.compare(0, prefix.data_.length(), prefix.data_) == 0;
+    }
+    
+    bool endsWith(const String& suffix) const {
+        return data_.length() >= suffix.data_.length() &&
+               data_.compare(data_.length() - suffix.data_.length(), suffix.data_.length(), suffix.data_) == 0;
+    }
+    
+    int compareTo(const String& other) const {
+        return data_.compare(other.data_);
+    }
+
+    bool operator<(const String& other) const { return data_ < other.data_; }
+    bool operator>(const String& other) const { return data_ > other.data_; }
+
+    char charAt(size_t index) const { return (*this)[index]; }
+    bool reserve(size_t size) {
+        data_.reserve(size);
+        return true;
+    }
+    String& operator+=(const String& other) {
+        data_ += other.data_;
+        return *this;
+    }
+    String& operator+=(const char* cstr) {
+        data_ += cstr ? cstr : "";
+        return *this;
+    }
+    String& operator+=(char c) {
+        data_ += c;
+        return *this;
+    }
     
     // ArduinoJson compatibility methods
     size_t write(uint8_t c) {
@@ -143,6 +183,17 @@ private:
     std::string data_;
 };
 
+inline String operator+(const char* lhs, const String& rhs) {
+    return String(lhs) + rhs;
+}
+
+typedef uint8_t byte;
+
+template <typename T, typename L, typename H>
+inline T constrain(T value, L low, H high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
 // Mock millis
 static unsigned long mockMillis = 0;
 inline unsigned long millis() { return mockMillis; }
@@ -151,5 +202,43 @@ inline void setMockMillis(unsigned long value) { mockMillis = value; }
 // Mock delay (no-op in tests)
 inline void delay(unsigned long ms) { (void)ms; }
 
+// Real monotonic clock, so handler timings measured with micros() are meaningful
+inline unsigned long micros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+// Local time from the host clock (the core's version waits for NTP)
+inline bool getLocalTime(struct tm* info, uint32_t ms = 5000) {
+    (void)ms;
+    time_t now = time(nullptr);
+    return localtime_r(&now, info) != nullptr;
+}
+
+// Minimal Print base class (write interface plus printf)
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+    size_t print(const char* str) {
+        return write(reinterpret_cast<const uint8_t*>(str), strlen(str));
+    }
+    size_t printf(const char* format, ...) {
+        char buf[256];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (len <= 0) return 0;
+        return write(reinterpret_cast<const uint8_t*>(buf), std::min(static_cast<size_t>(len), sizeof(buf) - 1));
+    }
+};
+
 #endif // MOCK_ARDUINO_H
 
@@ -0,0 +1,103 @@
+#ifndef MOCK_HEAP_H
+#define MOCK_HEAP_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/**
+ * @brief Heap usage tracker for native tests
+ *
+ * Counts bytes allocated through operator new while tracking is enabled.
+ * The operator new/delete replacements are only compiled in the test file
+ * that defines MOCK_HEAP_IMPLEMENTATION before including this header.
+ * Mocks use MockHeap::Pause around their own bookkeeping so only the code
+ * under test is measured.
+ */
+class MockHeap {
+public:
+    static void reset() {
+        state().inUse = 0;
+        state().peak = 0;
+        state().allocations = 0;
+    }
+    static void resetPeak() { state().peak = state().inUse; }
+    static void enable(bool on) { state().enabled = on; }
+
+    static size_t inUse() { return state().inUse; }
+    static size_t peak() { return state().peak; }
+    static size_t allocations() { return state().allocations; }
+
+    /** @brief Stops counting while in scope */
+    class Pause {
+    public:
+        Pause() { state().paused++; }
+        ~Pause() { state().paused--; }
+    };
+
+    /** @return true when the block was counted (and its release must be too) */
+    static bool onAlloc(size_t size) {
+        State& s = state();
+        if (!s.enabled || s.paused) return false;
+        s.inUse += size;
+        s.allocations++;
+        if (s.inUse > s.peak) s.peak = s.inUse;
+        return true;
+    }
+
+    static void onFree(size_t size) {
+        State& s = state();
+        s.inUse = size > s.inUse ? 0 : s.inUse - size;
+    }
+
+private:
+    struct State {
+        bool enabled = false;
+        int paused = 0;
+        size_t inUse = 0;
+        size_t peak = 0;
+        size_t allocations = 0;
+    };
+    static State& state() {
+        static State s;
+        return s;
+    }
+};
+
+#ifdef MOCK_HEAP_IMPLEMENTATION
+// Each block carries its size, and whether it was counted, in front of the data
+namespace mock_heap_detail {
+constexpr size_t HEADER = alignof(std::max_align_t) >= 2 * sizeof(size_t) ? alignof(std::max_align_t)
+                                                                           : 2 * sizeof(size_t);
+
+inline void* allocate(size_t size) {
+    size_t* raw = static_cast<size_t*>(std::malloc(size + HEADER));
+    if (!raw) throw std::bad_alloc();
+    raw[0] = size;
+    raw[1] = MockHeap::onAlloc(size) ? 1 : 0;
+    return reinterpret_cast<char*>(raw) + HEADER;
+}
+
+inline void release(void* p) {
+    if (!p) return;
+    size_t* raw = reinterpret_cast<size_t*>(static_cast<char*>(p) - HEADER);
+    if (raw[1]) MockHeap::onFree(raw[0]);
+    std::free(raw);
+}
+}  // namespace mock_heap_detail
+
+void* operator new(size_t size) { return mock_heap_detail::allocate(size); }
+void* operator new[](size_t size) { return mock_heap_detail::allocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try { return mock_heap_detail::allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try { return mock_heap_detail::allocate(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { mock_heap_detail::release(p); }
+void operator delete[](void* p) noexcept { mock_heap_detail::release(p); }
+void operator delete(void* p, size_t) noexcept { mock_heap_detail::release(p); }
+void operator delete[](void* p, size_t) noexcept { mock_heap_detail::release(p); }
+#endif  // MOCK_HEAP_IMPLEMENTATION
+
+#endif  // MOCK_HEAP_H
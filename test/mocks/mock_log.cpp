@@ -24,6 +24,13 @@ void logCloseFile() { }
 void logFlushFile() { }
 String logLatestFilePath() { return String(""); }
 void logRewriteUnsynced() { }
+uint32_t logLatestSeq() { return 0; }
+uint32_t logOldestSeq() { return 0; }
+size_t logForEachSince(uint32_t since, const std::function<void(uint32_t, const String&)>& fn) {
+    (void)since;
+    (void)fn;
+    return 0;
+}
 
 // Global log level variable
 LogLevel LOG_LEVEL = LOG_LEVEL_INFO;
@@ -3,6 +3,7 @@
 
 #include "mock_arduino.h"
 #include <iostream>
+#include <functional>
 
 // Mock log level enum - only define if not already defined
 #ifndef LOG_LEVEL_ENUM_DEFINED
@@ -27,6 +28,7 @@ void logln(String msg, int level);
 #define logInfo(msg)  logln(msg, LOG_LEVEL_INFO)
 #define logWarn(msg)  logln(msg, LOG_LEVEL_WARN)
 #define logError(msg) logln(msg, LOG_LEVEL_ERROR)
+#include "../../src/log_throttle.h"
 
 // Mock other log functions
 void setLogLevel(LogLevel level);
@@ -40,6 +42,10 @@ void logCloseFile();
 void logFlushFile();
 String logLatestFilePath();
 void logRewriteUnsynced();
+void logLoop();
+uint32_t logLatestSeq();
+uint32_t logOldestSeq();
+size_t logForEachSince(uint32_t since, const std::function<void(uint32_t seq, const String& line)>& fn);
 
 #endif // MOCK_LOG_H
 
@@ -0,0 +1,402 @@
+#ifndef MOCK_MQTT_BROKER_H
+#define MOCK_MQTT_BROKER_H
+
+#include "mock_arduino.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <map>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief Minimal MQTT 3.1.1 broker on 127.0.0.1 for end-to-end tests
+ *
+ * Runs in the test's own thread: poll() accepts connections, reads whatever
+ * has arrived and routes it, and never blocks. Supports CONNECT (with will,
+ * or refused with a chosen return code), SUBSCRIBE/UNSUBSCRIBE with + and #
+ * wildcards, PUBLISH at QoS 0 and 1, retained messages, PINGREQ and
+ * DISCONNECT. Every PUBLISH received is logged with a micros() timestamp.
+ */
+class MockMqttBroker {
+public:
+    struct Message {
+        std::string topic;
+        std::string payload;
+        bool retained;
+        std::string clientId;  // Empty for publish() from the test
+        unsigned long atUs;
+    };
+
+    MockMqttBroker() {}
+    ~MockMqttBroker() { stop(); }
+    MockMqttBroker(const MockMqttBroker&) = delete;
+    MockMqttBroker& operator=(const MockMqttBroker&) = delete;
+
+    /**
+     * @brief Listen on 127.0.0.1
+     * @param port 0 for an ephemeral port (see port())
+     */
+    bool start(uint16_t port = 0) {
+        stop();
+        listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listenFd_ < 0) return false;
+        int one = 1;
+        setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        socklen_t len = sizeof(addr);
+        if (::bind(listenFd_, (sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(listenFd_, 8) < 0 ||
+            getsockname(listenFd_, (sockaddr*)&addr, &len) < 0) {
+            stop();
+            return false;
+        }
+        fcntl(listenFd_, F_SETFL, fcntl(listenFd_, F_GETFL, 0) | O_NONBLOCK);
+        port_ = ntohs(addr.sin_port);
+        connects_ = 0;
+        return true;
+    }
+
+    /** @brief Close the listener and drop all clients without sending their wills */
+    void stop() {
+        sessions_.clear();
+        if (listenFd_ >= 0) ::close(listenFd_);
+        listenFd_ = -1;
+    }
+
+    bool running() const { return listenFd_ >= 0; }
+    uint16_t port() const { return port_; }
+
+    /** @brief Accept, read and route everything pending; never blocks */
+    void poll() {
+        if (listenFd_ >= 0) {
+            int fd;
+            while ((fd = ::accept(listenFd_, nullptr, nullptr)) >= 0) {
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                sessions_.push_back(std::make_shared<Session>(fd));
+            }
+        }
+        // Routing may close sessions, so work on a snapshot
+        std::vector<std::shared_ptr<Session>> snapshot = sessions_;
+        for (auto& s : snapshot) {
+            if (s->fd < 0) continue;
+            uint8_t buf[2048];
+            ssize_t n;
+            while ((n = ::recv(s->fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+                s->rx.append((const char*)buf, (size_t)n);
+            }
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                drop(*s, true);
+                continue;
+            }
+            while (s->fd >= 0 && handlePacket(*s)) {}
+        }
+        sessions_.erase(std::remove_if(sessions_.begin(), sessions_.end(),
+                                       [](const std::shared_ptr<Session>& s) { return s->fd < 0; }),
+                        sessions_.end());
+    }
+
+    /** @brief Publish as another client would (Home Assistant sending a command) */
+    void publish(const std::string& topic, const std::string& payload, bool retain = false) {
+        route(nullptr, topic, payload, retain);
+    }
+
+    /** @brief Close every client connection abruptly; their wills are published */
+    void dropClients() {
+        for (auto& s : sessions_) drop(*s, true);
+        sessions_.clear();
+    }
+
+    /** @brief Refuse the following CONNECTs with @p code (0 accepts again) */
+    void refuseConnections(uint8_t code) { refuseCode_ = code; }
+
+    // ------------------------------------------------------------------
+    // Inspection
+    // ------------------------------------------------------------------
+
+    const std::vector<Message>& messages() const { return log_; }
+    void clearMessages() { log_.clear(); }
+
+    size_t count(const std::string& topic) const {
+        size_t n = 0;
+        for (const auto& m : log_) n += (m.topic == topic);
+        return n;
+    }
+
+    /** @return The last message published on @p topic, or nullptr */
+    const Message* last(const std::string& topic) const {
+        for (auto it = log_.rbegin(); it != log_.rend(); ++it) {
+            if (it->topic == topic) return &*it;
+        }
+        return nullptr;
+    }
+
+    /** @return The retained payload for @p topic, or nullptr */
+    const std::string* retained(const std::string& topic) const {
+        auto it = retained_.find(topic);
+        return it == retained_.end() ? nullptr : &it->second;
+    }
+
+    size_t retainedCount(const std::string& filter = "#") const {
+        size_t n = 0;
+        for (const auto& r : retained_) n += topicMatches(filter, r.first);
+        return n;
+    }
+
+    /** @brief Clients that completed CONNECT and are still connected */
+    size_t clientCount() const {
+        size_t n = 0;
+        for (const auto& s : sessions_) n += (s->fd >= 0 && s->connected);
+        return n;
+    }
+
+    /** @brief CONNECTs accepted since start() (retained messages are kept) */
+    unsigned connectCount() const { return connects_; }
+
+    bool isSubscribed(const std::string& topic) const {
+        for (const auto& s : sessions_) {
+            for (const auto& f : s->filters) {
+                if (topicMatches(f, topic)) return true;
+            }
+        }
+        return false;
+    }
+
+    size_t subscriptionCount() const {
+        size_t n = 0;
+        for (const auto& s : sessions_) n += s->filters.size();
+        return n;
+    }
+
+    /** @brief MQTT topic filter matching (+ one level, # the rest) */
+    static bool topicMatches(const std::string& filter, const std::string& topic) {
+        size_t f = 0, t = 0;
+        while (f < filter.size()) {
+            if (filter[f] == '#') return true;
+            if (filter[f] == '+') {
+                while (t < topic.size() && topic[t] != '/') ++t;
+                ++f;
+            } else {
+                if (t >= topic.size() || filter[f] != topic[t]) return false;
+                ++f;
+                ++t;
+            }
+            // "a/#" also matches "a"
+            if (t == topic.size() && filter.compare(f, std::string::npos, "/#") == 0) return true;
+        }
+        return t == topic.size();
+    }
+
+private:
+    struct Session {
+        int fd;
+        bool connected = false;
+        std::string clientId;
+        std::string rx;
+        std::vector<std::string> filters;
+        bool hasWill = false;
+        std::string willTopic, willPayload;
+        bool willRetain = false;
+
+        explicit Session(int f) : fd(f) {}
+        ~Session() { if (fd >= 0) ::close(fd); }
+    };
+
+    // Decode one complete packet from the session's buffer; false if incomplete
+    bool handlePacket(Session& s) {
+        if (s.rx.size() < 2) return false;
+        size_t remaining = 0, pos = 1;
+        for (int shift = 0;; shift += 7) {
+            if (pos >= s.rx.size()) return false;
+            uint8_t b = (uint8_t)s.rx[pos++];
+            remaining |= (size_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) break;
+            if (shift >= 21) {
+                drop(s, true);
+                return false;
+            }
+        }
+        if (s.rx.size() < pos + remaining) return false;
+        uint8_t header = (uint8_t)s.rx[0];
+        std::string body = s.rx.substr(pos, remaining);
+        s.rx.erase(0, pos + remaining);
+
+        uint8_t type = header >> 4;
+        if (!s.connected && type != 1) {
+            drop(s, false);  // First packet must be CONNECT
+            return false;
+        }
+        switch (type) {
+            case 1: onConnect(s, body); break;
+            case 3: onPublish(s, header, body); break;
+            case 8: onSubscribe(s, body); break;
+            case 10: onUnsubscribe(s, body); break;
+            case 12: sendPacket(s, 0xD0, std::string()); break;  // PINGREQ -> PINGRESP
+            case 14: drop(s, false); return false;              // DISCONNECT: no will
+            default: break;
+        }
+        return s.fd >= 0;
+    }
+
+    static std::string readString(const std::string& body, size_t& pos) {
+        if (pos + 2 > body.size()) return std::string();
+        size_t len = ((uint8_t)body[pos] << 8) | (uint8_t)body[pos + 1];
+        pos += 2;
+        std::string out = body.substr(pos, len);
+        pos += len;
+        return out;
+    }
+
+    void onConnect(Session& s, const std::string& body) {
+        size_t pos = 0;
+        std::string protocol = readString(body, pos);
+        if (protocol != "MQTT" || pos + 4 > body.size()) {
+            sendPacket(s, 0x20, std::string("\x00\x01", 2));  // Unacceptable protocol version
+            drop(s, false);
+            return;
+        }
+        uint8_t flags = (uint8_t)body[pos + 1];
+        pos += 4;  // Level, flags, keep-alive
+        s.clientId = readString(body, pos);
+        if (flags & 0x04) {
+            s.hasWill = true;
+            s.willTopic = readString(body, pos);
+            s.willPayload = readString(body, pos);
+            s.willRetain = (flags & 0x20) != 0;
+        }
+        if (refuseCode_) {
+            std::string ack("\x00", 1);
+            ack += (char)refuseCode_;
+            sendPacket(s, 0x20, ack);
+            drop(s, false);
+            return;
+        }
+        // A second connection with the same client id replaces the first
+        for (auto& other : sessions_) {
+            if (other.get() != &s && other->connected && other->clientId == s.clientId) drop(*other, false);
+        }
+        s.connected = true;
+        connects_++;
+        sendPacket(s, 0x20, std::string("\x00\x00", 2));
+    }
+
+    void onPublish(Session& s, uint8_t header, const std::string& body) {
+        size_t pos = 0;
+        std::string topic = readString(body, pos);
+        uint8_t qos = (header >> 1) & 0x03;
+        if (qos > 0) {
+            std::string id = body.substr(pos, 2);
+            pos += 2;
+            sendPacket(s, 0x40, id);  // PUBACK (QoS 2 is not supported)
+        }
+        route(&s, topic, body.substr(pos), (header & 0x01) != 0);
+    }
+
+    void onSubscribe(Session& s, const std::string& body) {
+        size_t pos = 2;
+        std::string ack = body.substr(0, 2);
+        std::vector<std::string> added;
+        while (pos < body.size()) {
+            std::string filter = readString(body, pos);
+            pos++;  // Requested QoS; everything is delivered at QoS 0
+            if (std::find(s.filters.begin(), s.filters.end(), filter) == s.filters.end()) {
+                s.filters.push_back(filter);
+            }
+            added.push_back(filter);
+            ack += '\x00';
+        }
+        sendPacket(s, 0x90, ack);
+        for (const auto& filter : added) {
+            for (const auto& r : retained_) {
+                if (topicMatches(filter, r.first)) sendPublish(s, r.first, r.second, true);
+            }
+        }
+    }
+
+    void onUnsubscribe(Session& s, const std::string& body) {
+        size_t pos = 2;
+        while (pos < body.size()) {
+            std::string filter = readString(body, pos);
+            s.filters.erase(std::remove(s.filters.begin(), s.filters.end(), filter), s.filters.end());
+        }
+        sendPacket(s, 0xB0, body.substr(0, 2));
+    }
+
+    void route(Session* from, const std::string& topic, const std::string& payload, bool retain) {
+        log_.push_back({ topic, payload, retain, from ? from->clientId : std::string(), micros() });
+        if (retain) {
+            if (payload.empty()) retained_.erase(topic);
+            else retained_[topic] = payload;
+        }
+        std::vector<std::shared_ptr<Session>> snapshot = sessions_;
+        for (auto& s : snapshot) {
+            if (s->fd < 0 || !s->connected) continue;
+            for (const auto& f : s->filters) {
+                if (topicMatches(f, topic)) {
+                    sendPublish(*s, topic, payload, false);
+                    break;
+                }
+            }
+        }
+    }
+
+    void sendPublish(Session& s, const std::string& topic, const std::string& payload, bool retain) {
+        std::string body;
+        body += (char)(topic.size() >> 8);
+        body += (char)(topic.size() & 0xFF);
+        body += topic;
+        body += payload;
+        sendPacket(s, retain ? 0x31 : 0x30, body);
+    }
+
+    void sendPacket(Session& s, uint8_t header, const std::string& body) {
+        std::string packet(1, (char)header);
+        size_t len = body.size();
+        do {
+            uint8_t b = len & 0x7F;
+            len >>= 7;
+            if (len) b |= 0x80;
+            packet += (char)b;
+        } while (len);
+        packet += body;
+        size_t sent = 0;
+        while (s.fd >= 0 && sent < packet.size()) {
+            ssize_t n = ::send(s.fd, packet.data() + sent, packet.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                drop(s, true);
+                return;
+            }
+            sent += (size_t)n;
+        }
+    }
+
+    // Close a session; an abnormal close publishes the client's will
+    void drop(Session& s, bool abnormal) {
+        if (s.fd < 0) return;
+        ::close(s.fd);
+        s.fd = -1;
+        bool will = abnormal && s.connected && s.hasWill;
+        s.connected = false;
+        s.filters.clear();
+        if (will) route(&s, s.willTopic, s.willPayload, s.willRetain);
+    }
+
+    int listenFd_ = -1;
+    uint16_t port_ = 0;
+    uint8_t refuseCode_ = 0;
+    unsigned connects_ = 0;
+    std::vector<std::shared_ptr<Session>> sessions_;
+    std::map<std::string, std::string> retained_;
+    std::vector<Message> log_;
+};
+
+#endif // MOCK_MQTT_BROKER_H
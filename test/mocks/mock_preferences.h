@@ -60,6 +60,10 @@ public:
         return (it != ns.end()) ? static_cast<uint32_t>(std::stoul(it->second)) : defaultValue;
     }
     
+    uint32_t getULong(const char* key, uint32_t defaultValue = 0) {
+        return getUInt(key, defaultValue);
+    }
+    
     bool getBool(const char* key, bool defaultValue = false) {
         auto& ns = storage_[namespace_];
         auto it = ns.find(key);
@@ -91,6 +95,10 @@ public:
         return sizeof(value);
     }
     
+    size_t putULong(const char* key, uint32_t value) {
+        return putUInt(key, value);
+    }
+    
     size_t putBool(const char* key, bool value) {
         if (readOnly_) return 0;
         storage_[namespace_][key] = value ? "1" : "0";
@@ -0,0 +1,285 @@
+#ifndef MOCK_PUBSUBCLIENT_NET_H
+#define MOCK_PUBSUBCLIENT_NET_H
+
+#include "mock_wifi_client.h"
+#include <chrono>
+#include <functional>
+#include <vector>
+
+// PubSubClient state() values
+#define MQTT_CONNECTION_TIMEOUT     -4
+#define MQTT_CONNECTION_LOST        -3
+#define MQTT_CONNECT_FAILED         -2
+#define MQTT_DISCONNECTED           -1
+#define MQTT_CONNECTED               0
+
+/**
+ * @brief PubSubClient 2.8 work-alike that speaks MQTT 3.1.1 over a Client
+ *
+ * Follows the library where the firmware depends on it: connect() skips the
+ * TCP connect when the client is already connected, writes CONNECT and then
+ * spins until it has read the CONNACK; publish() refuses packets larger than
+ * the buffer; loop() answers keep-alive and dispatches one PUBLISH per call
+ * to the callback with a NUL-terminated topic. Waits use the real clock, as
+ * millis() is frozen in tests.
+ */
+class NetPubSubClient {
+public:
+    typedef std::function<void(char*, uint8_t*, unsigned int)> Callback;
+
+    static const uint16_t KEEPALIVE_SEC = 15;
+    static const uint32_t SOCKET_TIMEOUT_MS = 15000;
+
+    explicit NetPubSubClient(Client& client) : client_(&client), buffer_(256) {}
+
+    NetPubSubClient& setServer(const char* host, uint16_t port) {
+        host_ = host ? host : "";
+        port_ = port;
+        return *this;
+    }
+
+    NetPubSubClient& setCallback(Callback callback) {
+        callback_ = callback;
+        return *this;
+    }
+
+    bool setBufferSize(uint16_t size) {
+        if (size == 0) return false;
+        buffer_.resize(size);
+        return true;
+    }
+
+    uint16_t getBufferSize() const { return (uint16_t)buffer_.size(); }
+
+    bool connect(const char* id) { return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr); }
+
+    bool connect(const char* id, const char* user, const char* pass,
+                 const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage) {
+        if (connected()) return false;
+        if (!client_->connected() && !client_->connect(host_.c_str(), port_)) {
+            state_ = MQTT_CONNECT_FAILED;
+            return false;
+        }
+        std::string body;
+        appendString(body, "MQTT");
+        body += (char)4;  // Protocol level 3.1.1
+        uint8_t flags = 0x02;  // Clean session
+        if (willTopic) flags |= 0x04 | (uint8_t)(willQos << 3) | (willRetain ? 0x20 : 0);
+        if (user) flags |= 0x80;
+        if (user && pass) flags |= 0x40;
+        body += (char)flags;
+        body += (char)(KEEPALIVE_SEC >> 8);
+        body += (char)(KEEPALIVE_SEC & 0xFF);
+        appendString(body, id);
+        if (willTopic) {
+            appendString(body, willTopic);
+            appendString(body, willMessage ? willMessage : "");
+        }
+        if (user) appendString(body, user);
+        if (user && pass) appendString(body, pass);
+        if (!writePacket(0x10, body)) {
+            state_ = MQTT_CONNECT_FAILED;
+            return false;
+        }
+
+        Clock::time_point start = Clock::now();
+        while (!client_->available()) {
+            if (elapsedMs(start) >= SOCKET_TIMEOUT_MS) {
+                state_ = MQTT_CONNECTION_TIMEOUT;
+                client_->stop();
+                return false;
+            }
+        }
+        uint8_t header;
+        std::string ack;
+        if (!readPacket(header, ack) || (header >> 4) != 2 || ack.size() < 2) {
+            state_ = MQTT_CONNECT_FAILED;
+            client_->stop();
+            return false;
+        }
+        if (ack[1] != 0) {
+            state_ = (uint8_t)ack[1];
+            client_->stop();
+            return false;
+        }
+        nextMsgId_ = 1;
+        lastIn_ = lastOut_ = Clock::now();
+        pingOutstanding_ = false;
+        state_ = MQTT_CONNECTED;
+        return true;
+    }
+
+    void disconnect() {
+        writePacket(0xE0, std::string());
+        state_ = MQTT_DISCONNECTED;
+        client_->flush();
+        client_->stop();
+    }
+
+    bool publish(const char* topic, const char* payload, bool retained = false) {
+        return publish(topic, (const uint8_t*)payload, payload ? (unsigned)strlen(payload) : 0, retained);
+    }
+
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained = false) {
+        if (!connected()) return false;
+        // PubSubClient builds the packet in its buffer (5 bytes header room)
+        size_t topicLen = strlen(topic);
+        if (5 + 2 + topicLen + length > buffer_.size()) return false;
+        std::string body;
+        appendString(body, topic);
+        body.append((const char*)payload, length);
+        return writePacket(retained ? 0x31 : 0x30, body);
+    }
+
+    bool subscribe(const char* topic, uint8_t qos = 0) {
+        if (!connected() || qos > 1) return false;
+        size_t topicLen = strlen(topic);
+        if (5 + 2 + 2 + topicLen + 1 > buffer_.size()) return false;
+        std::string body;
+        appendMsgId(body);
+        appendString(body, topic);
+        body += (char)qos;
+        return writePacket(0x82, body);
+    }
+
+    bool unsubscribe(const char* topic) {
+        if (!connected()) return false;
+        std::string body;
+        appendMsgId(body);
+        appendString(body, topic);
+        return writePacket(0xA2, body);
+    }
+
+    bool loop() {
+        if (!connected()) return false;
+        uint32_t keepAliveMs = KEEPALIVE_SEC * 1000UL;
+        if (elapsedMs(lastIn_) > keepAliveMs || elapsedMs(lastOut_) > keepAliveMs) {
+            if (pingOutstanding_) {
+                state_ = MQTT_CONNECTION_TIMEOUT;
+                client_->stop();
+                return false;
+            }
+            writePacket(0xC0, std::string());
+            pingOutstanding_ = true;
+        }
+        if (!client_->available()) return true;
+
+        uint8_t header;
+        std::string body;
+        if (!readPacket(header, body)) return true;
+        lastIn_ = Clock::now();
+        uint8_t type = header >> 4;
+        if (type == 3) {
+            dispatch(header, body);
+        } else if (type == 12) {
+            writePacket(0xD0, std::string());
+        } else if (type == 13) {
+            pingOutstanding_ = false;
+        }
+        return true;
+    }
+
+    bool connected() {
+        if (!client_->connected()) {
+            if (state_ == MQTT_CONNECTED) {
+                state_ = MQTT_CONNECTION_LOST;
+                client_->flush();
+                client_->stop();
+            }
+            return false;
+        }
+        return state_ == MQTT_CONNECTED;
+    }
+
+    int state() const { return state_; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    static uint32_t elapsedMs(Clock::time_point since) {
+        return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since).count();
+    }
+
+    static void appendString(std::string& out, const char* s) {
+        size_t len = strlen(s);
+        out += (char)(len >> 8);
+        out += (char)(len & 0xFF);
+        out.append(s, len);
+    }
+
+    void appendMsgId(std::string& out) {
+        if (++nextMsgId_ == 0) nextMsgId_ = 1;
+        out += (char)(nextMsgId_ >> 8);
+        out += (char)(nextMsgId_ & 0xFF);
+    }
+
+    bool writePacket(uint8_t header, const std::string& body) {
+        std::string packet(1, (char)header);
+        size_t len = body.size();
+        do {
+            uint8_t b = len & 0x7F;
+            len >>= 7;
+            if (len) b |= 0x80;
+            packet += (char)b;
+        } while (len);
+        packet += body;
+        size_t n = client_->write((const uint8_t*)packet.data(), packet.size());
+        lastOut_ = Clock::now();
+        return n == packet.size();
+    }
+
+    bool readByte(uint8_t& b) {
+        Clock::time_point start = Clock::now();
+        while (!client_->available()) {
+            if (elapsedMs(start) >= SOCKET_TIMEOUT_MS) return false;
+        }
+        int c = client_->read();
+        if (c < 0) return false;
+        b = (uint8_t)c;
+        return true;
+    }
+
+    // Packets too large for the buffer are read and discarded, as in the library
+    bool readPacket(uint8_t& header, std::string& body) {
+        if (!readByte(header)) return false;
+        size_t len = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t b;
+            if (!readByte(b)) return false;
+            len |= (size_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) break;
+        }
+        body.clear();
+        while (body.size() < len) {
+            uint8_t b;
+            if (!readByte(b)) return false;
+            body += (char)b;
+        }
+        return len + 5 <= buffer_.size();
+    }
+
+    void dispatch(uint8_t header, const std::string& body) {
+        if (!callback_ || body.size() < 2) return;
+        size_t topicLen = ((uint8_t)body[0] << 8) | (uint8_t)body[1];
+        size_t offset = 2 + topicLen + (((header >> 1) & 0x03) ? 2 : 0);
+        if (offset > body.size()) return;
+        // Topic and payload share the buffer; the topic is NUL-terminated in place
+        memcpy(buffer_.data(), body.data() + 2, topicLen);
+        buffer_[topicLen] = 0;
+        size_t payloadLen = body.size() - offset;
+        memcpy(buffer_.data() + topicLen + 1, body.data() + offset, payloadLen);
+        callback_((char*)buffer_.data(), buffer_.data() + topicLen + 1, (unsigned)payloadLen);
+    }
+
+    Client* client_;
+    std::vector<uint8_t> buffer_;
+    std::string host_;
+    uint16_t port_ = 0;
+    Callback callback_;
+    int state_ = MQTT_DISCONNECTED;
+    uint16_t nextMsgId_ = 1;
+    Clock::time_point lastIn_, lastOut_;
+    bool pingOutstanding_ = false;
+};
+
+#endif // MOCK_PUBSUBCLIENT_NET_H
@@ -0,0 +1,382 @@
+#ifndef MOCK_WEB_SERVER_H
+#define MOCK_WEB_SERVER_H
+
+#include "mock_arduino.h"
+#include "mock_heap.h"
+#include "mock_wifi_client.h"
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+#include <strings.h>
+#include <utility>
+#include <vector>
+
+// Method values as in the ESP32 core (http_parser); HTTP_ANY lies outside that range
+enum HTTPMethod {
+    HTTP_DELETE = 0,
+    HTTP_GET = 1,
+    HTTP_HEAD = 2,
+    HTTP_POST = 3,
+    HTTP_PUT = 4,
+    HTTP_OPTIONS = 6,
+    HTTP_PATCH = 28,
+};
+#define HTTP_ANY (HTTPMethod)(255)
+
+enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED };
+enum HTTPAuthMethod { BASIC_AUTH, DIGEST_AUTH };
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
+#define CONTENT_LENGTH_NOT_SET ((size_t) -2)
+#define HTTP_UPLOAD_BUFLEN 1436
+
+struct HTTPUpload {
+    HTTPUploadStatus status;
+    String filename;
+    String name;
+    String type;
+    size_t totalSize;
+    size_t currentSize;
+    uint8_t buf[HTTP_UPLOAD_BUFLEN];
+};
+
+class WebServer;
+
+// Same virtual interface as RequestHandler in the ESP32 core
+class RequestHandler {
+public:
+    virtual ~RequestHandler() {}
+    virtual bool canHandle(HTTPMethod method, String uri) { (void)method; (void)uri; return false; }
+    virtual bool canUpload(String uri) { (void)uri; return false; }
+    virtual bool handle(WebServer& server, HTTPMethod requestMethod, String requestUri) {
+        (void)server; (void)requestMethod; (void)requestUri;
+        return false;
+    }
+    virtual void upload(WebServer& server, String requestUri, HTTPUpload& upload) {
+        (void)server; (void)requestUri; (void)upload;
+    }
+};
+
+/**
+ * @brief Everything a handler sent for one request
+ */
+struct MockHttpResponse {
+    int code = 0;
+    std::string contentType;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+    size_t contentLength = CONTENT_LENGTH_NOT_SET;
+    size_t chunks = 0;        // Non-empty sendContent() calls
+    bool finished = false;    // Terminating empty chunk sent (chunked responses)
+
+    bool sent() const { return code != 0; }
+    bool chunked() const { return contentLength == CONTENT_LENGTH_UNKNOWN; }
+
+    /** @brief Value of a response header, or nullptr */
+    const char* header(const char* name) const {
+        for (const auto& h : headers) {
+            if (strcasecmp(h.first.c_str(), name) == 0) return h.second.c_str();
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * @brief Host stand-in for the ESP32 WebServer
+ *
+ * Production code registers routes and sends responses exactly as on the
+ * device. Tests inject requests with request()/uploadFile(); dispatch
+ * follows the core (first handler whose canHandle() accepts the request,
+ * upload callbacks before handle(), notFound otherwise) and the response
+ * is captured in a MockHttpResponse.
+ */
+class WebServer {
+public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    explicit WebServer(int port = 80) { (void)port; }
+    virtual ~WebServer() {
+        for (RequestHandler* h : owned_) delete h;
+    }
+
+    void begin() {}
+    void handleClient() {}
+    void close() {}
+
+    void on(const String& uri, THandlerFunction fn) { on(uri, HTTP_ANY, fn); }
+    void on(const String& uri, HTTPMethod method, THandlerFunction fn) { on(uri, method, fn, nullptr); }
+    void on(const String& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn) {
+        RequestHandler* h = new FunctionHandler(uri.str(), method, fn, ufn);
+        owned_.push_back(h);
+        handlers_.push_back(h);
+    }
+    void addHandler(RequestHandler* handler) { handlers_.push_back(handler); }
+    void onNotFound(THandlerFunction fn) { notFound_ = fn; }
+    void collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {
+        (void)headerKeys;
+        (void)headerKeysCount;
+    }
+
+    // Request
+    String uri() { return String(uri_); }
+    HTTPMethod method() { return method_; }
+    String arg(const String& name) {
+        for (const auto& a : args_) {
+            if (a.first == name.str()) return String(a.second);
+        }
+        return String("");
+    }
+    String arg(int i) { return i >= 0 && i < args() ? String(args_[i].second) : String(""); }
+    String argName(int i) { return i >= 0 && i < args() ? String(args_[i].first) : String(""); }
+    int args() { return static_cast<int>(args_.size()); }
+    bool hasArg(const String& name) {
+        for (const auto& a : args_) {
+            if (a.first == name.str()) return true;
+        }
+        return false;
+    }
+    String header(const String& name) {
+        const std::string* v = findHeader(name.str());
+        return v ? String(*v) : String("");
+    }
+    bool hasHeader(const String& name) { return findHeader(name.str()) != nullptr; }
+    HTTPUpload& upload() { return upload_; }
+    /** @brief Connection of the current request; never connected on the host */
+    WiFiClient client() { return WiFiClient(); }
+
+    bool authenticate(const char* user, const char* pass) {
+        (void)user;
+        (void)pass;
+        return authorized_;
+    }
+    void requestAuthentication(HTTPAuthMethod mode = BASIC_AUTH, const char* realm = nullptr,
+                               const String& authFailMsg = String("")) {
+        (void)mode;
+        sendHeader("WWW-Authenticate", String("Basic realm=\"") + (realm ? realm : "Login Required") + "\"");
+        send(401, "text/html", authFailMsg);
+    }
+
+    // Response
+    void setContentLength(const size_t len) { pendingLength_ = len; }
+    void sendHeader(const String& name, const String& value, bool first = false) {
+        MockHeap::Pause pause;
+        auto entry = std::make_pair(name.str(), value.str());
+        if (first) pendingHeaders_.insert(pendingHeaders_.begin(), entry);
+        else pendingHeaders_.push_back(entry);
+    }
+    void send(int code, const char* contentType = nullptr, const String& content = String("")) {
+        start(code, contentType, content.length());
+        append(content.c_str(), content.length());
+    }
+    void send(int code, const String& contentType, const String& content) {
+        send(code, contentType.c_str(), content);
+    }
+    void send(int code, const char* contentType, const char* content) { send(code, contentType, String(content)); }
+    void send_P(int code, const char* contentType, const char* content, size_t contentLength) {
+        start(code, contentType, contentLength);
+        append(content, contentLength);
+    }
+    void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+    void sendContent(const char* content, size_t size) {
+        if (response_.chunked() && size == 0) {
+            response_.finished = true;
+            return;
+        }
+        if (size > 0) response_.chunks++;
+        append(content, size);
+    }
+    void sendContent_P(const char* content, size_t size) { sendContent(content, size); }
+
+    /** @brief Sends anything with read(uint8_t*, size_t), like a File */
+    template <typename T>
+    size_t streamFile(T& file, const String& contentType, const int code = 200) {
+        start(code, contentType.c_str(), CONTENT_LENGTH_NOT_SET);
+        uint8_t buf[512];
+        size_t total = 0;
+        size_t n;
+        while ((n = file.read(buf, sizeof(buf))) > 0) {
+            append(reinterpret_cast<const char*>(buf), n);
+            total += n;
+        }
+        return total;
+    }
+
+    // ---- Test side ----
+
+    /** @brief Basic-auth result for authenticate() (default: credentials accepted) */
+    void setAuthorized(bool authorized) { authorized_ = authorized; }
+
+    /** @brief Set a request header for the next request() calls */
+    void setRequestHeader(const char* name, const char* value) {
+        MockHeap::Pause pause;
+        requestHeaders_[name] = value;
+    }
+    void clearRequestHeaders() { requestHeaders_.clear(); }
+
+    /**
+     * @brief Run one request through the registered handlers
+     * @param target Path with optional "?query" (form-encoded, decoded into args)
+     * @param body Raw body, exposed as the "plain" argument like the core does
+     */
+    const MockHttpResponse& request(HTTPMethod method, const char* target, const char* body = nullptr) {
+        RequestHandler* handler = prepare(method, target, body);
+        dispatch(handler);
+        return response_;
+    }
+
+    /** @brief POST a multipart upload in chunks of @p chunkSize, then run the handler */
+    const MockHttpResponse& uploadFile(const char* target, const std::string& data, const char* filename = "upload.bin",
+                                       size_t chunkSize = HTTP_UPLOAD_BUFLEN) {
+        RequestHandler* handler = prepare(HTTP_POST, target, nullptr);
+        if (handler && handler->canUpload(String(uri_))) {
+            chunkSize = std::min<size_t>(std::max<size_t>(chunkSize, 1), HTTP_UPLOAD_BUFLEN);
+            upload_.filename = filename;
+            upload_.totalSize = 0;
+            upload_.currentSize = 0;
+            upload_.status = UPLOAD_FILE_START;
+            handler->upload(*this, String(uri_), upload_);
+            for (size_t pos = 0; pos < data.size(); pos += chunkSize) {
+                upload_.status = UPLOAD_FILE_WRITE;
+                upload_.currentSize = std::min(chunkSize, data.size() - pos);
+                memcpy(upload_.buf, data.data() + pos, upload_.currentSize);
+                handler->upload(*this, String(uri_), upload_);
+                upload_.totalSize += upload_.currentSize;
+            }
+            upload_.status = UPLOAD_FILE_END;
+            upload_.currentSize = 0;
+            handler->upload(*this, String(uri_), upload_);
+        }
+        dispatch(handler);
+        return response_;
+    }
+
+    const MockHttpResponse& response() const { return response_; }
+
+private:
+    class FunctionHandler : public RequestHandler {
+    public:
+        FunctionHandler(const std::string& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn)
+            : uri_(uri), method_(method), fn_(fn), ufn_(ufn) {}
+        bool canHandle(HTTPMethod method, String uri) override {
+            return (method_ == HTTP_ANY || method_ == method) && uri.str() == uri_;
+        }
+        bool canUpload(String uri) override { return ufn_ && canHandle(HTTP_POST, uri); }
+        bool handle(WebServer&, HTTPMethod method, String uri) override {
+            if (!canHandle(method, uri)) return false;
+            fn_();
+            return true;
+        }
+        void upload(WebServer&, String uri, HTTPUpload&) override {
+            if (canUpload(uri)) ufn_();
+        }
+    private:
+        std::string uri_;
+        HTTPMethod method_;
+        THandlerFunction fn_;
+        THandlerFunction ufn_;
+    };
+
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    static std::string urlDecode(const std::string& in) {
+        std::string out;
+        for (size_t i = 0; i < in.size(); ++i) {
+            if (in[i] == '+') {
+                out += ' ';
+            } else if (in[i] == '%' && i + 2 < in.size() && hexValue(in[i + 1]) >= 0 && hexValue(in[i + 2]) >= 0) {
+                out += static_cast<char>(hexValue(in[i + 1]) * 16 + hexValue(in[i + 2]));
+                i += 2;
+            } else {
+                out += in[i];
+            }
+        }
+        return out;
+    }
+
+    const std::string* findHeader(const std::string& name) const {
+        for (const auto& h : requestHeaders_) {
+            if (strcasecmp(h.first.c_str(), name.c_str()) == 0) return &h.second;
+        }
+        return nullptr;
+    }
+
+    // Parse the request and pick the handler, like the core does before reading the body
+    RequestHandler* prepare(HTTPMethod method, const char* target, const char* body) {
+        MockHeap::Pause pause;
+        response_ = MockHttpResponse();
+        pendingHeaders_.clear();
+        pendingLength_ = CONTENT_LENGTH_NOT_SET;
+        args_.clear();
+        method_ = method;
+        std::string t(target);
+        size_t q = t.find('?');
+        uri_ = t.substr(0, q);
+        if (q != std::string::npos) {
+            std::string query = t.substr(q + 1);
+            size_t pos = 0;
+            while (pos <= query.size()) {
+                size_t amp = query.find('&', pos);
+                if (amp == std::string::npos) amp = query.size();
+                std::string pair = query.substr(pos, amp - pos);
+                if (!pair.empty()) {
+                    size_t eq = pair.find('=');
+                    std::string name = urlDecode(pair.substr(0, eq));
+                    std::string value = eq == std::string::npos ? "" : urlDecode(pair.substr(eq + 1));
+                    args_.push_back(std::make_pair(name, value));
+                }
+                pos = amp + 1;
+            }
+        }
+        if (body) args_.push_back(std::make_pair(std::string("plain"), std::string(body)));
+        for (RequestHandler* h : handlers_) {
+            if (h->canHandle(method_, String(uri_))) return h;
+        }
+        return nullptr;
+    }
+
+    void dispatch(RequestHandler* handler) {
+        bool handled = handler && handler->handle(*this, method_, String(uri_));
+        if (!handled) {
+            if (notFound_) notFound_();
+            else send(404, "text/plain", String("Not found: ") + uri_.c_str());
+        }
+    }
+
+    void start(int code, const char* contentType, size_t length) {
+        MockHeap::Pause pause;
+        response_.code = code;
+        response_.contentType = contentType ? contentType : "";
+        response_.headers = pendingHeaders_;
+        pendingHeaders_.clear();
+        response_.contentLength = pendingLength_ != CONTENT_LENGTH_NOT_SET ? pendingLength_ : length;
+        pendingLength_ = CONTENT_LENGTH_NOT_SET;
+    }
+
+    void append(const char* data, size_t len) {
+        MockHeap::Pause pause;
+        response_.body.append(data, len);
+    }
+
+    std::vector<RequestHandler*> handlers_;
+    std::vector<RequestHandler*> owned_;
+    THandlerFunction notFound_;
+
+    HTTPMethod method_ = HTTP_GET;
+    std::string uri_;
+    std::vector<std::pair<std::string, std::string>> args_;
+    std::map<std::string, std::string> requestHeaders_;
+    HTTPUpload upload_ = {};
+    bool authorized_ = true;
+
+    MockHttpResponse response_;
+    std::vector<std::pair<std::string, std::string>> pendingHeaders_;
+    size_t pendingLength_ = CONTENT_LENGTH_NOT_SET;
+};
+
+#endif // MOCK_WEB_SERVER_H
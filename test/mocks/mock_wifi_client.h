@@ -0,0 +1,150 @@
+#ifndef MOCK_WIFI_CLIENT_H
+#define MOCK_WIFI_CLIENT_H
+
+#include "mock_arduino.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <memory>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @brief Mock IPAddress (IPv4; the uint32_t form is in network byte order, as on the ESP32)
+ */
+class IPAddress {
+public:
+    IPAddress() : addr_(0) {}
+    IPAddress(uint32_t addr) : addr_(addr) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+        uint8_t bytes[4] = { a, b, c, d };
+        memcpy(&addr_, bytes, sizeof(addr_));
+    }
+
+    bool fromString(const char* text) {
+        in_addr parsed;
+        if (!text || inet_pton(AF_INET, text, &parsed) != 1) return false;
+        addr_ = parsed.s_addr;
+        return true;
+    }
+
+    operator uint32_t() const { return addr_; }
+
+    String toString() const {
+        char buf[INET_ADDRSTRLEN];
+        in_addr a;
+        a.s_addr = addr_;
+        inet_ntop(AF_INET, &a, buf, sizeof(buf));
+        return String(buf);
+    }
+
+private:
+    uint32_t addr_;
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+};
+
+class Client : public Stream {
+public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char* host, uint16_t port) = 0;
+    using Print::write;
+    virtual int read(uint8_t* buf, size_t size) = 0;
+    using Stream::read;
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+    virtual operator bool() = 0;
+};
+
+/**
+ * @brief WiFiClient on a host TCP socket (the ESP32 core wraps an lwIP socket the same way)
+ */
+class WiFiClient : public Client {
+public:
+    WiFiClient() {}
+    explicit WiFiClient(int fd) : socket_(std::make_shared<Socket>(fd)) {}
+
+    int connect(IPAddress ip, uint16_t port) override {
+        stop();
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return 0;
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = (uint32_t)ip;
+        addr.sin_port = htons(port);
+        if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            ::close(fd);
+            return 0;
+        }
+        socket_ = std::make_shared<Socket>(fd);
+        return 1;
+    }
+
+    int connect(const char* host, uint16_t port) override {
+        IPAddress ip;
+        return ip.fromString(host) ? connect(ip, port) : 0;
+    }
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+
+    size_t write(const uint8_t* buf, size_t size) override {
+        if (!socket_) return 0;
+        ssize_t n = ::send(socket_->fd, buf, size, MSG_NOSIGNAL);
+        return n < 0 ? 0 : (size_t)n;
+    }
+
+    int available() override {
+        if (!socket_) return 0;
+        int n = 0;
+        return ioctl(socket_->fd, FIONREAD, &n) == 0 ? n : 0;
+    }
+
+    int read() override {
+        uint8_t b;
+        return read(&b, 1) == 1 ? b : -1;
+    }
+
+    int read(uint8_t* buf, size_t size) override {
+        if (!socket_) return -1;
+        ssize_t n = ::recv(socket_->fd, buf, size, MSG_DONTWAIT);
+        return n <= 0 ? -1 : (int)n;
+    }
+
+    int peek() override {
+        uint8_t b;
+        if (!socket_) return -1;
+        return ::recv(socket_->fd, &b, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? b : -1;
+    }
+
+    void stop() override { socket_.reset(); }
+
+    uint8_t connected() override {
+        if (!socket_) return 0;
+        char c;
+        ssize_t n = ::recv(socket_->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (n == 0) return 0;  // Orderly shutdown by the peer
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) return 0;
+        return 1;
+    }
+
+    operator bool() override { return connected(); }
+
+private:
+    // Shared like the core's socket handle, so copies keep the connection open
+    struct Socket {
+        int fd;
+        explicit Socket(int f) : fd(f) {}
+        ~Socket() { ::close(fd); }
+    };
+    std::shared_ptr<Socket> socket_;
+};
+
+#endif // MOCK_WIFI_CLIENT_H
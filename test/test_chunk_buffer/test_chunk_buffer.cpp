@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+// Include production code (header-only)
+#include "../../src/chunk_buffer.h"
+
+namespace {
+
+struct Collector {
+    std::vector<std::string> chunks;
+};
+
+void collect(void* ctx, const char* data, size_t len) {
+    static_cast<Collector*>(ctx)->chunks.emplace_back(data, len);
+}
+
+std::string joined(const Collector& c) {
+    std::string out;
+    for (const auto& chunk : c.chunks) out += chunk;
+    return out;
+}
+
+}  // namespace
+
+TEST(ChunkBufferTest, SmallWritesStayBufferedUntilFlush) {
+    Collector c;
+    ChunkBuffer<16> buf(collect, &c);
+    buf.write((const uint8_t*)"abc", 3);
+    buf.write('d');
+    EXPECT_TRUE(c.chunks.empty());
+    buf.flush();
+    ASSERT_EQ(1u, c.chunks.size());
+    EXPECT_EQ("abcd", c.chunks[0]);
+    // Nothing buffered: no empty chunk
+    buf.flush();
+    EXPECT_EQ(1u, c.chunks.size());
+}
+
+TEST(ChunkBufferTest, LargeWriteIsSplitIntoFullChunks) {
+    Collector c;
+    ChunkBuffer<8> buf(collect, &c);
+    std::string text = "0123456789abcdefghijklmnopqrstuvwxyz";
+    buf.write((const uint8_t*)text.data(), text.size());
+    EXPECT_EQ(4u, c.chunks.size());
+    for (const auto& chunk : c.chunks) EXPECT_EQ(8u, chunk.size());
+    buf.flush();
+    EXPECT_EQ(text, joined(c));
+    EXPECT_EQ(text.size(), buf.total());
+    EXPECT_EQ(5u, buf.chunks());
+}
+
+TEST(ChunkBufferTest, ByteWritesMatchBulkWrites) {
+    Collector bytes;
+    Collector bulk;
+    ChunkBuffer<5> a(collect, &bytes);
+    ChunkBuffer<5> b(collect, &bulk);
+    std::string text = "{\"name\":\"2025-03-14.log\",\"size\":1234}";
+    for (char ch : text) a.write((uint8_t)ch);
+    b.write((const uint8_t*)text.data(), text.size());
+    a.flush();
+    b.flush();
+    EXPECT_EQ(bulk.chunks, bytes.chunks);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <cstring>
+
+// Include production code (header-only)
+#include "../../src/fixed_arena.h"
+
+class FixedArenaTest : public ::testing::Test {
+protected:
+    alignas(FixedArena::ALIGN) uint8_t buffer[256];
+    FixedArena arena{ buffer, sizeof(buffer) };
+};
+
+TEST_F(FixedArenaTest, AllocatesAlignedBlocksInsideTheBuffer) {
+    void* a = arena.allocate(3);
+    void* b = arena.allocate(10);
+    ASSERT_NE(nullptr, a);
+    ASSERT_NE(nullptr, b);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(a) % FixedArena::ALIGN);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(b) % FixedArena::ALIGN);
+    EXPECT_GE(static_cast<uint8_t*>(b), static_cast<uint8_t*>(a) + 3);
+    EXPECT_LE(static_cast<uint8_t*>(b) + 10, buffer + sizeof(buffer));
+}
+
+TEST_F(FixedArenaTest, ExhaustedBufferReturnsNull) {
+    EXPECT_EQ(nullptr, arena.allocate(sizeof(buffer)));
+    EXPECT_NE(nullptr, arena.allocate(100));
+    EXPECT_NE(nullptr, arena.allocate(100));
+    EXPECT_EQ(nullptr, arena.allocate(100));
+}
+
+TEST_F(FixedArenaTest, FreeingTheLatestBlocksRewinds) {
+    void* a = arena.allocate(16);
+    size_t afterA = arena.used();
+    void* b = arena.allocate(16);
+    void* c = arena.allocate(16);
+    arena.deallocate(a);  // Not the latest: kept
+    EXPECT_GT(arena.used(), afterA);
+    arena.deallocate(c);
+    arena.deallocate(b);
+    EXPECT_EQ(afterA, arena.used());
+    EXPECT_EQ(b, arena.allocate(16));
+}
+
+TEST_F(FixedArenaTest, ReallocateGrowsTheLatestBlockInPlace) {
+    char* a = static_cast<char*>(arena.allocate(8));
+    memcpy(a, "abcdefg", 8);
+    EXPECT_EQ(a, arena.reallocate(a, 64));
+    EXPECT_EQ(a, arena.reallocate(a, 16));
+    EXPECT_STREQ("abcdefg", a);
+    EXPECT_EQ(nullptr, arena.reallocate(a, 1024));
+}
+
+TEST_F(FixedArenaTest, ReallocateMovesAnOlderBlockWhenGrowing) {
+    char* a = static_cast<char*>(arena.allocate(8));
+    memcpy(a, "abcdefg", 8);
+    void* b = arena.allocate(8);
+    EXPECT_EQ(a, arena.reallocate(a, 4));  // Shrinking never moves
+    char* moved = static_cast<char*>(arena.reallocate(a, 32));
+    ASSERT_NE(nullptr, moved);
+    EXPECT_GT(moved, static_cast<char*>(b));
+    EXPECT_STREQ("abcdefg", moved);
+}
+
+TEST_F(FixedArenaTest, ResetKeepsTheHighWaterMark) {
+    arena.allocate(100);
+    size_t peak = arena.used();
+    arena.reset();
+    EXPECT_EQ(0u, arena.used());
+    EXPECT_EQ(peak, arena.highWater());
+    EXPECT_EQ(static_cast<void*>(buffer + 8), arena.allocate(1));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
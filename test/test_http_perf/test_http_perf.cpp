@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+// Include production code
+#include "../../src/http_perf.h"
+
+TEST(HttpPerfTest, Add_AssignsSlotsInOrder) {
+    HttpPerf perf;
+    EXPECT_EQ(0, perf.add("/", 1));
+    EXPECT_EQ(1, perf.add("/status", 1));
+    EXPECT_EQ(2, perf.count());
+    EXPECT_STREQ("/status", perf.at(1).path);
+    EXPECT_EQ(0u, perf.at(1).calls);
+}
+
+TEST(HttpPerfTest, BeginEnd_AccumulatesTimeAndMax) {
+    HttpPerf perf;
+    int slot = perf.add("/api/state", 1);
+    perf.begin(slot, 1000);
+    perf.end(1300);
+    perf.begin(slot, 5000);
+    perf.end(5100);
+    const HttpRouteStats& s = perf.at(slot);
+    EXPECT_EQ(2u, s.calls);
+    EXPECT_EQ(400u, s.totalUs);
+    EXPECT_EQ(300u, s.maxUs);
+}
+
+TEST(HttpPerfTest, End_HandlesMicrosWraparound) {
+    HttpPerf perf;
+    int slot = perf.add("/wrap", 1);
+    perf.begin(slot, 0xFFFFFF00u);
+    perf.end(0x00000100u);
+    EXPECT_EQ(0x200u, perf.at(slot).totalUs);
+}
+
+TEST(HttpPerfTest, UploadChunks_AddTimeWithoutCountingCalls) {
+    HttpPerf perf;
+    int slot = perf.add("/upload", 3);
+    perf.begin(slot, 0);
+    perf.end(50, false);
+    perf.begin(slot, 100);
+    perf.end(130);
+    EXPECT_EQ(1u, perf.at(slot).calls);
+    EXPECT_EQ(80u, perf.at(slot).totalUs);
+}
+
+TEST(HttpPerfTest, AddBytes_OnlyCountsInsideHandler) {
+    HttpPerf perf;
+    int a = perf.add("/a", 1);
+    int b = perf.add("/b", 1);
+    perf.addBytes(100);  // no handler running
+    perf.begin(b, 0);
+    perf.addBytes(512);
+    perf.addBytes(17);
+    perf.end(10);
+    perf.addBytes(64);
+    EXPECT_EQ(0u, perf.at(a).bytes);
+    EXPECT_EQ(529u, perf.at(b).bytes);
+}
+
+TEST(HttpPerfTest, FullTable_RejectsAndIgnoresExtraRoutes) {
+    HttpPerf perf;
+    for (int i = 0; i < HTTP_PERF_MAX_ROUTES; ++i) {
+        ASSERT_EQ(i, perf.add("/r", 1));
+    }
+    int extra = perf.add("/extra", 1);
+    EXPECT_EQ(-1, extra);
+    perf.begin(extra, 0);
+    perf.addBytes(10);
+    perf.end(10);
+    for (int i = 0; i < perf.count(); ++i) {
+        EXPECT_EQ(0u, perf.at(i).calls);
+        EXPECT_EQ(0u, perf.at(i).bytes);
+    }
+}
+
+TEST(HttpPerfTest, Reset_ClearsCountersKeepsRoutes) {
+    HttpPerf perf;
+    int slot = perf.add("/status", 1);
+    perf.begin(slot, 0);
+    perf.addBytes(42);
+    perf.end(99);
+    perf.reset();
+    EXPECT_EQ(1, perf.count());
+    EXPECT_STREQ("/status", perf.at(slot).path);
+    EXPECT_EQ(0u, perf.at(slot).calls);
+    EXPECT_EQ(0u, perf.at(slot).totalUs);
+    EXPECT_EQ(0u, perf.at(slot).maxUs);
+    EXPECT_EQ(0u, perf.at(slot).bytes);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <string.h>
+
+// Include production code (header-only)
+#include "../../src/http_utils.h"
+
+// Accept-Encoding negotiation
+TEST(HttpUtilsTest, AcceptsGzip_CommonBrowserHeaders) {
+    EXPECT_TRUE(httpAcceptsGzip("gzip, deflate, br"));
+    EXPECT_TRUE(httpAcceptsGzip("br;q=1.0, gzip;q=0.8, *;q=0.1"));
+    EXPECT_TRUE(httpAcceptsGzip("GZIP"));
+    EXPECT_TRUE(httpAcceptsGzip("x-gzip"));
+}
+
+TEST(HttpUtilsTest, AcceptsGzip_RefusedOrMissing) {
+    EXPECT_FALSE(httpAcceptsGzip(nullptr));
+    EXPECT_FALSE(httpAcceptsGzip(""));
+    EXPECT_FALSE(httpAcceptsGzip("identity"));
+    EXPECT_FALSE(httpAcceptsGzip("deflate, br"));
+    EXPECT_FALSE(httpAcceptsGzip("gzip;q=0"));
+    EXPECT_FALSE(httpAcceptsGzip("gzip; q=0.000, deflate"));
+    // Not fooled by codings that merely contain the word
+    EXPECT_FALSE(httpAcceptsGzip("notgzip, gzipper"));
+}
+
+TEST(HttpUtilsTest, AcceptsGzip_Wildcard) {
+    EXPECT_TRUE(httpAcceptsGzip("*"));
+    EXPECT_FALSE(httpAcceptsGzip("*;q=0"));
+    // An explicit entry wins over the wildcard
+    EXPECT_FALSE(httpAcceptsGzip("*, gzip;q=0"));
+}
+
+// ETags
+TEST(HttpUtilsTest, FormatEtag_DistinguishesEncoding) {
+    char plain[32];
+    char gz[32];
+    httpFormatEtag(plain, sizeof(plain), 0xCBF43926u, 51234, false);
+    httpFormatEtag(gz, sizeof(gz), 0xCBF43926u, 51234, true);
+    EXPECT_STREQ("\"cbf43926-c822\"", plain);
+    EXPECT_STREQ("\"cbf43926-c822-gz\"", gz);
+}
+
+TEST(HttpUtilsTest, EtagMatches_SingleAndList) {
+    const char* etag = "\"cbf43926-c822\"";
+    EXPECT_TRUE(httpEtagMatches("\"cbf43926-c822\"", etag));
+    EXPECT_TRUE(httpEtagMatches("\"aaaa-1\", \"cbf43926-c822\"", etag));
+    EXPECT_TRUE(httpEtagMatches("*", etag));
+    EXPECT_FALSE(httpEtagMatches("\"cbf43926-c822-gz\"", etag));
+    EXPECT_FALSE(httpEtagMatches("\"cbf43926-c82\"", etag));
+    EXPECT_FALSE(httpEtagMatches("", etag));
+    EXPECT_FALSE(httpEtagMatches(nullptr, etag));
+}
+
+TEST(HttpUtilsTest, EtagMatches_WeakComparison) {
+    EXPECT_TRUE(httpEtagMatches("W/\"cbf43926-c822\"", "\"cbf43926-c822\""));
+    EXPECT_TRUE(httpEtagMatches("\"cbf43926-c822\"", "W/\"cbf43926-c822\""));
+}
+
+// Range requests
+TEST(HttpUtilsTest, ParseRange_ClosedAndOpenRanges) {
+    uint32_t first = 0, last = 0;
+    EXPECT_EQ(HttpRange::Partial, httpParseRange("bytes=0-99", 1000, first, last));
+    EXPECT_EQ(0u, first);
+    EXPECT_EQ(99u, last);
+    EXPECT_EQ(HttpRange::Partial, httpParseRange("bytes=500-", 1000, first, last));
+    EXPECT_EQ(500u, first);
+    EXPECT_EQ(999u, last);
+    // End past the content is clamped
+    EXPECT_EQ(HttpRange::Partial, httpParseRange("bytes=900-5000", 1000, first, last));
+    EXPECT_EQ(900u, first);
+    EXPECT_EQ(999u, last);
+}
+
+TEST(HttpUtilsTest, ParseRange_SuffixRange) {
+    uint32_t first = 0, last = 0;
+    EXPECT_EQ(HttpRange::Partial, httpParseRange("bytes=-100", 1000, first, last));
+    EXPECT_EQ(900u, first);
+    EXPECT_EQ(999u, last);
+    EXPECT_EQ(HttpRange::Partial, httpParseRange("bytes=-5000", 1000, first, last));
+    EXPECT_EQ(0u, first);
+    EXPECT_EQ(HttpRange::Unsatisfiable, httpParseRange("bytes=-0", 1000, first, last));
+}
+
+TEST(HttpUtilsTest, ParseRange_Unsatisfiable) {
+    uint32_t first = 0, last = 0;
+    // Tail poll when nothing new was written
+    EXPECT_EQ(HttpRange::Unsatisfiable, httpParseRange("bytes=1000-", 1000, first, last));
+    EXPECT_EQ(HttpRange::Unsatisfiable, httpParseRange("bytes=0-", 0, first, last));
+}
+
+TEST(HttpUtilsTest, ParseRange_IgnoredHeaders) {
+    uint32_t first = 0, last = 0;
+    EXPECT_EQ(HttpRange::Full, httpParseRange(nullptr, 1000, first, last));
+    EXPECT_EQ(HttpRange::Full, httpParseRange("", 1000, first, last));
+    EXPECT_EQ(HttpRange::Full, httpParseRange("items=0-5", 1000, first, last));
+    EXPECT_EQ(HttpRange::Full, httpParseRange("bytes=0-5,10-20", 1000, first, last));
+    EXPECT_EQ(HttpRange::Full, httpParseRange("bytes=20-10", 1000, first, last));
+    EXPECT_EQ(HttpRange::Full, httpParseRange("bytes=-", 1000, first, last));
+    EXPECT_EQ(HttpRange::Full, httpParseRange("bytes=abc", 1000, first, last));
+}
+
+TEST(HttpUtilsTest, FormatContentRange) {
+    char buf[48];
+    httpFormatContentRange(buf, sizeof(buf), HttpRange::Partial, 900, 999, 1000);
+    EXPECT_STREQ("bytes 900-999/1000", buf);
+    httpFormatContentRange(buf, sizeof(buf), HttpRange::Unsatisfiable, 0, 0, 1000);
+    EXPECT_STREQ("bytes */1000", buf);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
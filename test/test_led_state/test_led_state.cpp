@@ -79,6 +79,38 @@ TEST_F(LedStateTest, SetRGB_Change_MarksDirty) {
     ASSERT_TRUE(ledState.isDirty());
 }
 
+TEST_F(LedStateTest, Setters_FlagLightForMqtt) {
+    ledState.setRGB(10, 20, 30);
+    ledState.setBrightness(77);
+    stateTakeDirty();
+
+    ledState.setRGB(10, 20, 30);
+    ledState.setBrightness(77);
+    ASSERT_EQ(0u, stateTakeDirty());
+
+    ledState.setBrightness(78);
+    ASSERT_EQ((uint32_t)DIRTY_LIGHT, stateTakeDirty());
+}
+
+TEST_F(LedStateTest, Setters_DropARunningTransition) {
+    // The dashboard's brightness slider and colour picker win over a fade
+    LightLevel dark = { 0, 0, 0, 255, 0 };
+    lightFader.start(dark, ledState.level(), 2000, 0);
+    ledState.setBrightness(90);
+    ASSERT_FALSE(lightFader.active());
+    EXPECT_EQ(90, lightFader.sample(500, ledState.level()).brightness);
+
+    lightFader.start(dark, ledState.level(), 2000, 0);
+    ledState.setRGB(10, 20, 30);
+    ASSERT_FALSE(lightFader.active());
+    EXPECT_EQ(10, lightFader.sample(500, ledState.level()).r);
+
+    // Setting the value already stored still ends the fade on it
+    lightFader.start(dark, ledState.level(), 2000, 0);
+    ledState.setBrightness(90);
+    EXPECT_FALSE(lightFader.active());
+}
+
 // Brightness Tests
 TEST_F(LedStateTest, SetBrightness_StoresValue) {
     ledState.setBrightness(128);
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+// Include production code (header-only)
+#include "../../src/light_fader.h"
+
+namespace {
+
+const LightLevel DIM_RED = { 200, 0, 0, 0, 20 };
+const LightLevel BRIGHT_BLUE = { 0, 0, 100, 40, 220 };
+
+}  // namespace
+
+class LightFaderTest : public ::testing::Test {
+protected:
+    LightFader fader;
+};
+
+TEST_F(LightFaderTest, IdleReturnsTheSteadyLevel) {
+    EXPECT_FALSE(fader.active());
+    LightLevel level = fader.sample(1234, BRIGHT_BLUE);
+    EXPECT_EQ(BRIGHT_BLUE.b, level.b);
+    EXPECT_EQ(BRIGHT_BLUE.brightness, level.brightness);
+}
+
+TEST_F(LightFaderTest, InterpolatesEveryChannel) {
+    fader.start(DIM_RED, BRIGHT_BLUE, 1000, 5000);
+    ASSERT_TRUE(fader.active());
+
+    LightLevel start = fader.sample(5000, DIM_RED);
+    EXPECT_EQ(200, start.r);
+    EXPECT_EQ(20, start.brightness);
+
+    LightLevel mid = fader.sample(5500, DIM_RED);
+    EXPECT_EQ(100, mid.r);
+    EXPECT_EQ(0, mid.g);
+    EXPECT_EQ(50, mid.b);
+    EXPECT_EQ(20, mid.w);
+    EXPECT_EQ(120, mid.brightness);
+
+    LightLevel quarter = fader.sample(5250, DIM_RED);
+    EXPECT_EQ(150, quarter.r);
+    EXPECT_EQ(70, quarter.brightness);
+}
+
+TEST_F(LightFaderTest, EndsOnTheTargetAndStops) {
+    fader.start(DIM_RED, BRIGHT_BLUE, 400, 0);
+    EXPECT_TRUE(fader.active());
+    LightLevel end = fader.sample(450, DIM_RED);
+    EXPECT_EQ(0, end.r);
+    EXPECT_EQ(220, end.brightness);
+    EXPECT_FALSE(fader.active());
+
+    // Afterwards the steady level is shown again
+    EXPECT_EQ(20, fader.sample(500, DIM_RED).brightness);
+}
+
+TEST_F(LightFaderTest, StepsAreMonotonicAndStayInRange) {
+    LightLevel off = { 255, 255, 255, 255, 255 };
+    LightLevel on = { 0, 0, 0, 0, 0 };
+    fader.start(off, on, 3000, 0);
+    uint8_t previous = 255;
+    for (uint32_t t = 0; t < 3000; t += 7) {
+        LightLevel level = fader.sample(t, on);
+        ASSERT_LE(level.brightness, previous) << "at " << t << " ms";
+        previous = level.brightness;
+    }
+    EXPECT_EQ(0, fader.sample(3000, on).brightness);
+}
+
+TEST_F(LightFaderTest, ZeroDurationAndCancelLeaveNoFade) {
+    fader.start(DIM_RED, BRIGHT_BLUE, 0, 100);
+    EXPECT_FALSE(fader.active());
+
+    fader.start(DIM_RED, BRIGHT_BLUE, 1000, 100);
+    fader.cancel();
+    EXPECT_FALSE(fader.active());
+    EXPECT_EQ(220, fader.sample(600, BRIGHT_BLUE).brightness);
+}
+
+TEST_F(LightFaderTest, RestartingMidFadeContinuesFromTheShownLevel) {
+    fader.start(DIM_RED, BRIGHT_BLUE, 1000, 0);
+    LightLevel shown = fader.sample(500, BRIGHT_BLUE);
+    fader.start(shown, DIM_RED, 1000, 500);
+    EXPECT_EQ(shown.brightness, fader.sample(500, DIM_RED).brightness);
+    EXPECT_EQ(70, fader.sample(1000, DIM_RED).brightness);
+    EXPECT_EQ(20, fader.sample(1500, DIM_RED).brightness);
+}
+
+TEST_F(LightFaderTest, SurvivesMillisWraparound) {
+    fader.start(DIM_RED, BRIGHT_BLUE, 1000, 0xFFFFFF00u);
+    EXPECT_EQ(120, fader.sample(0xFFFFFF00u + 500, DIM_RED).brightness);
+    EXPECT_TRUE(fader.active());
+    EXPECT_EQ(220, fader.sample(1000, DIM_RED).brightness);
+    EXPECT_FALSE(fader.active());
+}
+
+TEST_F(LightFaderTest, LongDurationsAreClampedWithoutOverflow) {
+    fader.start(DIM_RED, BRIGHT_BLUE, 0xFFFFFFF0u, 0);
+    const uint32_t half = LightFader::MAX_DURATION_MS / 2;
+    EXPECT_EQ(120, fader.sample(half, DIM_RED).brightness);
+    EXPECT_TRUE(fader.active());
+    EXPECT_EQ(220, fader.sample(LightFader::MAX_DURATION_MS, DIM_RED).brightness);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
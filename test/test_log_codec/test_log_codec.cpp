@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <string.h>
+
+// Include production code
+#include "../../src/log_codec.cpp"
+
+namespace {
+
+struct Buffer {
+    std::vector<uint8_t> data;
+    size_t readPos = 0;
+};
+
+bool writeToBuffer(void* ctx, const uint8_t* data, size_t len) {
+    Buffer* b = static_cast<Buffer*>(ctx);
+    b->data.insert(b->data.end(), data, data + len);
+    return true;
+}
+
+size_t readFromBuffer(void* ctx, uint8_t* data, size_t len) {
+    Buffer* b = static_cast<Buffer*>(ctx);
+    size_t n = std::min(len, b->data.size() - b->readPos);
+    memcpy(data, b->data.data() + b->readPos, n);
+    b->readPos += n;
+    return n;
+}
+
+std::string makeLogText(int lines) {
+    std::string text;
+    char line[128];
+    for (int i = 0; i < lines; ++i) {
+        snprintf(line, sizeof(line), "[2025-03-14 %02d:%02d:%02d.%03d CET][%s] event %d value=%d\n",
+                 (i / 3600) % 24, (i / 60) % 60, i % 60, (i * 37) % 1000,
+                 (i % 5) ? "INFO" : "WARN", i, (i * 7919) % 1013);
+        text += line;
+    }
+    return text;
+}
+
+std::string inflateAll(LogInflater& inflater, int* lastResult = nullptr) {
+    std::string out;
+    uint8_t buf[97];  // odd size: exercises resuming matches across reads
+    int n;
+    while ((n = inflater.read(buf, sizeof(buf))) > 0) {
+        out.append(reinterpret_cast<char*>(buf), n);
+    }
+    if (lastResult) *lastResult = n;
+    return out;
+}
+
+}  // namespace
+
+TEST(LogCodecTest, Crc32_KnownValue) {
+    const char* text = "123456789";
+    EXPECT_EQ(0xCBF43926u, logCrc32(0, reinterpret_cast<const uint8_t*>(text), 9));
+    // Incremental update gives the same result
+    uint32_t crc = logCrc32(0, reinterpret_cast<const uint8_t*>(text), 4);
+    EXPECT_EQ(0xCBF43926u, logCrc32(crc, reinterpret_cast<const uint8_t*>(text) + 4, 5));
+}
+
+TEST(LogCodecTest, RoundTrip_CompressesLogText) {
+    std::string text = makeLogText(2000);
+    Buffer gz;
+    LogDeflater deflater;
+    ASSERT_TRUE(deflater.begin(writeToBuffer, &gz));
+    // Feed in uneven pieces, like log writes
+    for (size_t pos = 0; pos < text.size(); pos += 333) {
+        size_t n = std::min<size_t>(333, text.size() - pos);
+        ASSERT_TRUE(deflater.write(reinterpret_cast<const uint8_t*>(text.data()) + pos, n));
+    }
+    ASSERT_TRUE(deflater.finish());
+    EXPECT_LT(gz.data.size(), text.size() / 3);
+
+    LogInflater inflater;
+    inflater.begin(readFromBuffer, &gz, true);
+    int last = -2;
+    EXPECT_EQ(text, inflateAll(inflater, &last));
+    EXPECT_EQ(0, last);
+    EXPECT_TRUE(inflater.verified());
+}
+
+TEST(LogCodecTest, RoundTrip_EmptyAndTinyInput) {
+    for (const char* text : { "", "x", "abcabcabc" }) {
+        Buffer gz;
+        LogDeflater deflater;
+        ASSERT_TRUE(deflater.begin(writeToBuffer, &gz));
+        deflater.write(reinterpret_cast<const uint8_t*>(text), strlen(text));
+        ASSERT_TRUE(deflater.finish());
+
+        LogInflater inflater;
+        inflater.begin(readFromBuffer, &gz, true);
+        EXPECT_EQ(std::string(text), inflateAll(inflater));
+        EXPECT_TRUE(inflater.verified());
+    }
+}
+
+TEST(LogCodecTest, SyncPoint_AllowsRestartAndLimit) {
+    std::string text = makeLogText(500);
+    size_t half = text.size() / 2;
+    Buffer gz;
+    LogDeflater deflater;
+    ASSERT_TRUE(deflater.begin(writeToBuffer, &gz));
+    deflater.write(reinterpret_cast<const uint8_t*>(text.data()), half);
+    ASSERT_TRUE(deflater.sync());
+    uint32_t syncOffset = deflater.offset();
+    EXPECT_EQ(gz.data.size(), syncOffset);
+    deflater.write(reinterpret_cast<const uint8_t*>(text.data()) + half, text.size() - half);
+    ASSERT_TRUE(deflater.finish());
+
+    // Raw inflate from the sync point yields the second half
+    Buffer tail = gz;
+    tail.readPos = syncOffset;
+    LogInflater fromSync;
+    fromSync.begin(readFromBuffer, &tail, false, syncOffset);
+    EXPECT_EQ(text.substr(half), inflateAll(fromSync));
+
+    // A limit at the sync point stops after the first half
+    Buffer head = gz;
+    LogInflater upToSync;
+    upToSync.begin(readFromBuffer, &head, true);
+    upToSync.setLimit(syncOffset);
+    EXPECT_EQ(text.substr(0, half), inflateAll(upToSync));
+    EXPECT_EQ(syncOffset, upToSync.inputOffset());
+}
+
+TEST(LogCodecTest, Inflate_ZlibFixedHuffmanStream) {
+    // python: zlib.compressobj(9, DEFLATED, 16 + 11, 9, Z_FIXED) of 3 identical lines
+    static const uint8_t GZ[] = {
+        0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8B, 0x36, 0x32, 0x30, 0x32, 0xD5,
+        0x35, 0x30, 0xD6, 0x35, 0x34, 0x51, 0x30, 0x34, 0xB0, 0x32, 0x00, 0x21, 0x3D, 0x03, 0x03, 0x03,
+        0x05, 0x67, 0xD7, 0x90, 0xD8, 0x68, 0x4F, 0x3F, 0x37, 0xFF, 0x58, 0x85, 0x8C, 0xD4, 0x9C, 0x9C,
+        0x7C, 0x14, 0xB2, 0x3C, 0xBF, 0x28, 0x25, 0x39, 0x27, 0x3F, 0x39, 0x9B, 0x2B, 0x7A, 0x80, 0xF5,
+        0x03, 0x00, 0x93, 0x6B, 0xF3, 0x82, 0xC0, 0x00, 0x00, 0x00 };
+    std::string line = "[2025-03-14 10:00:00.000 CET][INFO] hello hello hello wordclock\n";
+    Buffer gz;
+    gz.data.assign(GZ, GZ + sizeof(GZ));
+    LogInflater inflater;
+    inflater.begin(readFromBuffer, &gz, true);
+    EXPECT_EQ(line + line + line, inflateAll(inflater));
+    EXPECT_TRUE(inflater.verified());
+}
+
+TEST(LogCodecTest, Inflate_RejectsCorruptInput) {
+    Buffer bad;
+    const uint8_t notGzip[] = { 'h', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd', '!' };
+    bad.data.assign(notGzip, notGzip + sizeof(notGzip));
+    LogInflater inflater;
+    inflater.begin(readFromBuffer, &bad, true);
+    uint8_t buf[16];
+    EXPECT_EQ(-1, inflater.read(buf, sizeof(buf)));
+}
+
+TEST(LogCodecTest, Inflate_TruncatedStreamIsNotVerified) {
+    std::string text = makeLogText(100);
+    Buffer gz;
+    LogDeflater deflater;
+    ASSERT_TRUE(deflater.begin(writeToBuffer, &gz));
+    deflater.write(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    ASSERT_TRUE(deflater.finish());
+    gz.data.resize(gz.data.size() / 2);
+
+    LogInflater inflater;
+    inflater.begin(readFromBuffer, &gz, true);
+    int last = 0;
+    std::string out = inflateAll(inflater, &last);
+    EXPECT_EQ(-1, last);
+    EXPECT_FALSE(inflater.verified());
+    EXPECT_EQ(text.substr(0, out.size()), out);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "../mocks/mock_arduino.h"
+#include "../mocks/mock_preferences.h"
+#include "../mocks/SPIFFS.h"
+
+// Include production code: the file sink of log.cpp on the in-memory filesystem
+#undef PIO_UNIT_TESTING
+#include "../../src/log_format.cpp"
+#include "../../src/log_codec.cpp"
+#include "../../src/log.cpp"
+
+// Background maintenance of the log files driven by logLoop(): archiving
+// finished days into .log.gz a chunk at a time and rewriting the boot log
+// with real timestamps in time slices.
+
+namespace {
+
+std::string dateTag(time_t t) {
+    struct tm lt = {};
+    localtime_r(&t, &lt);
+    char buf[16];
+    strftime(buf, sizeof(buf), "%Y-%m-%d", &lt);
+    return buf;
+}
+
+size_t readString(void* ctx, uint8_t* buf, size_t len) {
+    auto* src = static_cast<std::pair<const std::string*, size_t>*>(ctx);
+    size_t n = std::min(len, src->first->size() - src->second);
+    memcpy(buf, src->first->data() + src->second, n);
+    src->second += n;
+    return n;
+}
+
+// Inflate @p gz from @p offset (a gzip stream at 0, else a sync point) up to @p limit
+std::string inflate(const std::string& gz, uint32_t offset = 0, uint32_t limit = 0, bool* verified = nullptr) {
+    std::pair<const std::string*, size_t> src(&gz, offset);
+    LogInflater inflater;
+    inflater.begin(readString, &src, offset == 0, offset);
+    if (limit) inflater.setLimit(limit);
+    std::string out;
+    uint8_t buf[256];
+    int n;
+    while ((n = inflater.read(buf, sizeof(buf))) > 0) out.append((const char*)buf, n);
+    EXPECT_EQ(0, n);
+    if (verified) *verified = inflater.verified();
+    return out;
+}
+
+std::vector<LogIndexEntry> readIndex(const std::string& idx) {
+    std::vector<LogIndexEntry> entries(idx.size() / sizeof(LogIndexEntry));
+    if (!entries.empty()) memcpy(entries.data(), idx.data(), entries.size() * sizeof(LogIndexEntry));
+    return entries;
+}
+
+}  // namespace
+
+class LogFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Preferences::reset();
+        SPIFFS.reset();
+        setMockMillis(1000);
+        setLogLevel(LOG_LEVEL_DEBUG);
+        setLogDeleteOnBoot(false);
+        today = "/logs/" + dateTag(time(nullptr));
+        yesterday = "/logs/" + dateTag(time(nullptr) - 86400);
+    }
+
+    void TearDown() override {
+        logCloseFile();
+    }
+
+    // Yesterday's log and index, as the sink wrote them, with the sink reopened on today
+    void makeFinishedDay(int lines) {
+        logEnableFileSink();
+        for (int i = 0; i < lines; ++i) {
+            log(String("record ") + i + " value=" + (i * 7919 % 1000) + "\n", i % 4);
+        }
+        logCloseFile();
+        ASSERT_TRUE(SPIFFS.rename((today + ".log").c_str(), (yesterday + ".log").c_str()));
+        ASSERT_TRUE(SPIFFS.rename((today + ".idx").c_str(), (yesterday + ".idx").c_str()));
+        plain = SPIFFS.contents(yesterday + ".log");
+        index = readIndex(SPIFFS.contents(yesterday + ".idx"));
+        logEnableFileSink();
+    }
+
+    // Run logLoop() until the archive replaced the plain log; returns the number of calls
+    int runArchive(const std::function<void()>& between = nullptr) {
+        int calls = 0;
+        while (SPIFFS.exists(yesterday + ".log") && calls < 10000) {
+            logLoop();
+            calls++;
+            if (between) between();
+        }
+        return calls;
+    }
+
+    std::string today, yesterday;
+    std::string plain;
+    std::vector<LogIndexEntry> index;
+};
+
+TEST_F(LogFileTest, ArchivesAFinishedDayInChunks) {
+    makeFinishedDay(3000);
+    ASSERT_GT(plain.size(), 20u * LOG_ARCHIVE_CHUNK);
+    ASSERT_GT(index.size(), 2u);
+
+    int calls = runArchive();
+    EXPECT_GE(calls, (int)(plain.size() / LOG_ARCHIVE_CHUNK));
+    ASSERT_FALSE(SPIFFS.exists(yesterday + ".log"));
+    ASSERT_TRUE(SPIFFS.exists(yesterday + ".log.gz"));
+    EXPECT_FALSE(SPIFFS.exists(yesterday + ".idx.tmp"));
+
+    bool verified = false;
+    std::string gz = SPIFFS.contents(yesterday + ".log.gz");
+    EXPECT_EQ(plain, inflate(gz, 0, 0, &verified));
+    EXPECT_TRUE(verified);
+    EXPECT_LT(gz.size(), plain.size() / 2);
+}
+
+TEST_F(LogFileTest, ArchivedIndexPointsAtSyncPoints) {
+    makeFinishedDay(3000);
+    runArchive();
+    std::string gz = SPIFFS.contents(yesterday + ".log.gz");
+    std::vector<LogIndexEntry> archived = readIndex(SPIFFS.contents(yesterday + ".idx"));
+    ASSERT_EQ(index.size(), archived.size());
+    for (size_t i = 0; i < index.size(); ++i) {
+        EXPECT_EQ(index[i].minSod, archived[i].minSod);
+        EXPECT_EQ(index[i].levelMask, archived[i].levelMask);
+        EXPECT_EQ(plain.substr(index[i].start, index[i].end - index[i].start),
+                  inflate(gz, archived[i].start, archived[i].end)) << "block " << i;
+    }
+}
+
+TEST_F(LogFileTest, LiveLoggingContinuesWhileArchiving) {
+    makeFinishedDay(2000);
+    int n = 0;
+    runArchive([&] { log(String("live ") + n++ + "\n", LOG_LEVEL_INFO); });
+    EXPECT_GT(n, 1);
+    EXPECT_EQ(plain, inflate(SPIFFS.contents(yesterday + ".log.gz")));
+    std::string live = SPIFFS.contents(today + ".log");
+    EXPECT_NE(std::string::npos, live.find("live 0\n"));
+    EXPECT_NE(std::string::npos, live.find("Archived " + yesterday + ".log.gz"));
+}
+
+TEST_F(LogFileTest, ClosingTheSinkDropsAPartialArchive) {
+    makeFinishedDay(2000);
+    logLoop();
+    logLoop();
+    ASSERT_TRUE(SPIFFS.exists(yesterday + ".log.gz"));
+    logCloseFile();
+    EXPECT_FALSE(SPIFFS.exists(yesterday + ".log.gz"));
+    EXPECT_FALSE(SPIFFS.exists(yesterday + ".idx.tmp"));
+    EXPECT_EQ(plain, SPIFFS.contents(yesterday + ".log"));
+
+    // The next boot starts over
+    logEnableFileSink();
+    runArchive();
+    EXPECT_EQ(plain, inflate(SPIFFS.contents(yesterday + ".log.gz")));
+}
+
+TEST_F(LogFileTest, LongBootLogLineStaysWholeAcrossRewriteSlices) {
+    const std::string payload(600, 'x');
+    std::string unsynced;
+    for (int i = 0; i < 20; ++i) unsynced += "[uptime 1." + std::to_string(100 + i) + "s][INFO] boot " + std::to_string(i) + "\n";
+    unsynced += "[uptime 2.000s][DEBUG] dump " + payload + "\n";
+    for (int i = 0; i < 20; ++i) unsynced += "[uptime 3." + std::to_string(100 + i) + "s][INFO] after " + std::to_string(i) + "\n";
+    SPIFFS.put("/logs/unsynced.log", unsynced);
+    SPIFFS.setReadDelay(3);  // A few reads per slice: the long line spans several slices
+
+    logEnableFileSink();
+    logRewriteUnsynced();
+    int n = 0;
+    while (SPIFFS.exists("/logs/unsynced.log") && n < 1000) {
+        logLoop();
+        log(String("live ") + n++ + "\n", LOG_LEVEL_INFO);
+    }
+    ASSERT_FALSE(SPIFFS.exists("/logs/unsynced.log"));
+    EXPECT_GT(n, 3);
+
+    std::string live = SPIFFS.contents(today + ".log");
+    size_t dump = live.find("[DEBUG] dump ");
+    ASSERT_NE(std::string::npos, dump);
+    EXPECT_EQ(payload + "\n", live.substr(dump + 13, payload.size() + 1));
+    EXPECT_NE(std::string::npos, live.find("] after 19\n"));
+    // Every live record starts its own line
+    for (size_t at = live.find("live "); at != std::string::npos; at = live.find("live ", at + 1)) {
+        EXPECT_EQ(' ', live[at - 1]) << live.substr(at - 40, 60);
+        EXPECT_EQ(']', live[at - 2]);
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string.h>
+
+// Include production code
+#include "../../src/log_format.cpp"
+
+class LogFormatTest : public ::testing::Test {
+protected:
+    bool parse(const char* line, LogLineInfo& info) {
+        return logParseLine(line, strlen(line), info);
+    }
+
+    bool matches(const char* line, const LogQuery& q) {
+        LogLineInfo info;
+        logParseLine(line, strlen(line), info);
+        return logLineMatches(line, strlen(line), info, q);
+    }
+};
+
+// Line prefix parsing
+TEST_F(LogFormatTest, ParseLine_DatedPrefix) {
+    LogLineInfo info;
+    ASSERT_TRUE(parse("[2025-03-14 13:45:07.123 CET][WARN] MQTT reconnect failed", info));
+    EXPECT_EQ(13u * 3600 + 45 * 60 + 7, info.sod);
+    EXPECT_EQ(2, info.level);
+}
+
+TEST_F(LogFormatTest, ParseLine_UptimePrefixHasNoTime) {
+    LogLineInfo info;
+    ASSERT_TRUE(parse("[uptime 12.345s][ERROR] boot failure", info));
+    EXPECT_EQ(LOG_SOD_INVALID, info.sod);
+    EXPECT_EQ(3, info.level);
+}
+
+TEST_F(LogFormatTest, ParseLine_RejectsGarbage) {
+    LogLineInfo info;
+    EXPECT_FALSE(parse("", info));
+    EXPECT_FALSE(parse("continuation of a previous line", info));
+    EXPECT_FALSE(parse("[2025-03-14 13:45:07.123 CET] no level", info));
+    EXPECT_FALSE(parse("[2025-03-14 13:45:07.123 CET][TRACE] unknown level", info));
+}
+
+TEST_F(LogFormatTest, LevelFromTag) {
+    EXPECT_EQ(0, logLevelFromTag("DEBUG", 5));
+    EXPECT_EQ(1, logLevelFromTag("info", 4));
+    EXPECT_EQ(3, logLevelFromTag("ERROR", 5));
+    EXPECT_EQ(-1, logLevelFromTag("ERR", 3));
+}
+
+TEST_F(LogFormatTest, ParseClock) {
+    uint32_t sod = 0;
+    ASSERT_TRUE(logParseClock("07:30", sod));
+    EXPECT_EQ(7u * 3600 + 30 * 60, sod);
+    ASSERT_TRUE(logParseClock("23:59:59", sod));
+    EXPECT_EQ(86399u, sod);
+    EXPECT_FALSE(logParseClock("24:00", sod));
+    EXPECT_FALSE(logParseClock("7:30", sod));
+    EXPECT_FALSE(logParseClock("07-30", sod));
+}
+
+
+TEST_F(LogFormatTest, ParseUptimePrefix_SplitsFields) {
+    const char* line = "[uptime 1234.056s][WARN] WiFi lost";
+    LogUptimePrefix up;
+    ASSERT_TRUE(logParseUptimePrefix(line, strlen(line), up));
+    EXPECT_EQ(1234u, up.seconds);
+    EXPECT_EQ(56u, up.millis);
+    EXPECT_EQ(std::string("WARN"), std::string(line + up.levelStart, up.levelLen));
+    EXPECT_STREQ("WiFi lost", line + up.msgOffset);
+}
+
+TEST_F(LogFormatTest, ParseUptimePrefix_EmptyMessage) {
+    const char* line = "[uptime 0.001s][INFO]";
+    LogUptimePrefix up;
+    ASSERT_TRUE(logParseUptimePrefix(line, strlen(line), up));
+    EXPECT_EQ(strlen(line), up.msgOffset);
+}
+
+TEST_F(LogFormatTest, ParseUptimePrefix_RejectsOtherLines) {
+    LogUptimePrefix up;
+    for (const char* line : { "", "[uptime ", "[uptime 12s][INFO] x", "[uptime 1.2s][INFO] x",
+                              "[uptime 1.234s] no level", "[uptime 1.234s][INFO no close",
+                              "[2025-03-14 13:45:07.123 CET][INFO] dated", "plain continuation" }) {
+        EXPECT_FALSE(logParseUptimePrefix(line, strlen(line), up)) << line;
+    }
+    // Only the given length is examined
+    const char* line = "[uptime 1.234s][INFO] x";
+    EXPECT_FALSE(logParseUptimePrefix(line, 14, up));
+}
+// Line filtering
+TEST_F(LogFormatTest, Matches_LevelTimeAndText) {
+    const char* line = "[2025-03-14 10:00:00.000 CET][WARN] WiFi lost, reconnecting";
+    LogQuery q;
+    EXPECT_TRUE(matches(line, q));
+
+    q.minLevel = 3;
+    EXPECT_FALSE(matches(line, q));
+    q.minLevel = 2;
+    EXPECT_TRUE(matches(line, q));
+
+    q.fromSod = 9 * 3600;
+    q.toSod = 9 * 3600 + 59 * 60;
+    EXPECT_FALSE(matches(line, q));
+    q.toSod = 10 * 3600;
+    EXPECT_TRUE(matches(line, q));
+
+    q.needle = "wifi LOST";
+    EXPECT_TRUE(matches(line, q));
+    q.needle = "mqtt";
+    EXPECT_FALSE(matches(line, q));
+}
+
+TEST_F(LogFormatTest, Matches_UntimedLinesOnlyWithoutTimeRange) {
+    const char* line = "[uptime 1.000s][INFO] starting";
+    LogQuery q;
+    EXPECT_TRUE(matches(line, q));
+    q.fromSod = 60;
+    EXPECT_FALSE(matches(line, q));
+}
+
+// Index blocks
+TEST_F(LogFormatTest, Builder_EmitsBlockEveryNLines) {
+    LogIndexBuilder b;
+    b.reset(100);
+    LogIndexEntry e;
+    int emitted = 0;
+    for (int i = 0; i < LOG_INDEX_BLOCK_RECORDS * 2 + 3; ++i) {
+        if (b.add(10, 3600 + i, i == 5 ? 3 : 1, true, e)) {
+            emitted++;
+            if (emitted == 1) {
+                EXPECT_EQ(100u, e.start);
+                EXPECT_EQ(100u + 10 * LOG_INDEX_BLOCK_RECORDS, e.end);
+                EXPECT_EQ(3600u, e.minSod);
+                EXPECT_EQ(3600u + LOG_INDEX_BLOCK_RECORDS - 1, e.maxSod);
+                EXPECT_EQ((1 << 1) | (1 << 3), e.levelMask);
+            } else {
+                EXPECT_EQ(100u + 10 * LOG_INDEX_BLOCK_RECORDS, e.start);
+                EXPECT_EQ((1 << 1), e.levelMask);
+            }
+        }
+    }
+    EXPECT_EQ(2, emitted);
+    EXPECT_EQ(100u + 10 * (LOG_INDEX_BLOCK_RECORDS * 2 + 3), b.offset());
+}
+
+TEST_F(LogFormatTest, Builder_BlocksStartOnLineBoundaries) {
+    LogIndexBuilder b;
+    b.reset(0);
+    LogIndexEntry e;
+    // Partial write, then the rest of the line: counts as one line
+    EXPECT_FALSE(b.add(5, 10, 1, false, e));
+    for (int i = 0; i < LOG_INDEX_BLOCK_RECORDS - 1; ++i) {
+        EXPECT_FALSE(b.add(5, 10, 1, true, e));
+    }
+    EXPECT_TRUE(b.add(5, 10, 1, true, e));
+    EXPECT_EQ(0u, e.start);
+    EXPECT_EQ(5u * (LOG_INDEX_BLOCK_RECORDS + 1), e.end);
+}
+
+TEST_F(LogFormatTest, BlockMayMatch) {
+    LogIndexEntry e = {};
+    e.minSod = 3600;
+    e.maxSod = 7200;
+    e.levelMask = (1 << 0) | (1 << 1);
+
+    LogQuery q;
+    EXPECT_TRUE(logBlockMayMatch(e, q));
+
+    q.minLevel = 2;
+    EXPECT_FALSE(logBlockMayMatch(e, q));
+    q.minLevel = 1;
+    EXPECT_TRUE(logBlockMayMatch(e, q));
+
+    q.fromSod = 7201;
+    EXPECT_FALSE(logBlockMayMatch(e, q));
+    q.fromSod = 0;
+    q.toSod = 3599;
+    EXPECT_FALSE(logBlockMayMatch(e, q));
+    q.toSod = 3600;
+    EXPECT_TRUE(logBlockMayMatch(e, q));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <string.h>
+
+// Include production code (header-only)
+#include "../../src/log_throttle.h"
+
+// Rate limiter
+TEST(LogRateLimiterTest, AllowsBurstThenSuppresses) {
+    LogRateLimiter limiter(3, 1000);
+    EXPECT_TRUE(limiter.allow(0));
+    EXPECT_TRUE(limiter.allow(1));
+    EXPECT_TRUE(limiter.allow(2));
+    EXPECT_FALSE(limiter.allow(3));
+    EXPECT_FALSE(limiter.allow(4));
+    EXPECT_EQ(2u, limiter.takeSuppressed());
+    EXPECT_EQ(0u, limiter.takeSuppressed());
+}
+
+TEST(LogRateLimiterTest, RefillsOneTokenPerInterval) {
+    LogRateLimiter limiter(2, 1000);
+    EXPECT_TRUE(limiter.allow(0));
+    EXPECT_TRUE(limiter.allow(0));
+    EXPECT_FALSE(limiter.allow(999));
+    EXPECT_TRUE(limiter.allow(1000));
+    EXPECT_FALSE(limiter.allow(1500));
+    // Long silence refills at most the burst size
+    EXPECT_TRUE(limiter.allow(60000));
+    EXPECT_TRUE(limiter.allow(60000));
+    EXPECT_FALSE(limiter.allow(60000));
+}
+
+TEST(LogRateLimiterTest, FullBucketDoesNotBankTime) {
+    LogRateLimiter limiter(1, 1000);
+    // Idle with a full bucket, then a burst: only one record passes
+    EXPECT_TRUE(limiter.allow(5000));
+    EXPECT_FALSE(limiter.allow(5001));
+    EXPECT_TRUE(limiter.allow(6000));
+}
+
+TEST(LogRateLimiterTest, HandlesMillisWraparound) {
+    LogRateLimiter limiter(1, 1000);
+    unsigned long nearWrap = (unsigned long)-500;
+    EXPECT_TRUE(limiter.allow(nearWrap));
+    EXPECT_FALSE(limiter.allow(nearWrap + 200));
+    EXPECT_TRUE(limiter.allow(nearWrap + 1000));  // wrapped past zero
+}
+
+// Repeat filter
+class LogRepeatFilterTest : public ::testing::Test {
+protected:
+    LogRepeatFilter filter;
+
+    bool check(const char* msg, int level = 2) {
+        return filter.check(msg, strlen(msg), level);
+    }
+};
+
+TEST_F(LogRepeatFilterTest, CollapsesIdenticalConsecutiveLines) {
+    EXPECT_FALSE(check("WiFi lost\n"));
+    EXPECT_TRUE(check("WiFi lost\n"));
+    EXPECT_TRUE(check("WiFi lost\n"));
+    int level = -1;
+    EXPECT_EQ(0u, filter.takeCollapsed(level));
+
+    EXPECT_FALSE(check("WiFi back\n", 1));
+    EXPECT_EQ(2u, filter.takeCollapsed(level));
+    EXPECT_EQ(2, level);
+    EXPECT_EQ(0u, filter.takeCollapsed(level));
+}
+
+TEST_F(LogRepeatFilterTest, LevelIsPartOfIdentity) {
+    EXPECT_FALSE(check("same\n", 1));
+    EXPECT_FALSE(check("same\n", 2));
+}
+
+TEST_F(LogRepeatFilterTest, PartialLinesAreNeverCollapsed) {
+    EXPECT_FALSE(check("progress "));
+    EXPECT_FALSE(check("progress "));
+}
+
+TEST_F(LogRepeatFilterTest, TakePendingRestartsCount) {
+    EXPECT_FALSE(check("tick\n"));
+    EXPECT_TRUE(check("tick\n"));
+    EXPECT_TRUE(check("tick\n"));
+    int level = -1;
+    EXPECT_EQ(2u, filter.takePending(level));
+    EXPECT_EQ(2, level);
+    // Still the same run: further repeats are counted from zero
+    EXPECT_TRUE(check("tick\n"));
+    EXPECT_FALSE(check("tock\n"));
+    EXPECT_EQ(1u, filter.takeCollapsed(level));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <map>
+#include <vector>
+#include <string>
+#include "../mocks/mock_arduino.h"
+#include "../mocks/mock_log.cpp"
+#define MOCK_HEAP_IMPLEMENTATION
+#include "../mocks/mock_heap.h"
+
+// Include production code
+#include "../../src/mqtt_command_handler.cpp"
+
+namespace {
+
+bool switchValue = false;
+int numberValue = -1;
+std::string selected;
+uint16_t timeValue = 0;
+int actions = 0;
+int publishes = 0;
+std::string lastPayload;
+
+void setSwitch(bool on) { switchValue = on; }
+void setNumber(int v) { numberValue = v; }
+void setSelect(const char* option) { selected = option; }
+void setTime(uint16_t minutes) { timeValue = minutes; }
+void onAction(const MqttPayload& payload) { actions++; lastPayload.assign(payload.data, payload.length); }
+void onPublish() { publishes++; }
+
+bool parseTime(const char* text, size_t length, uint16_t& minutes) {
+    int h = 0, m = 0;
+    std::string copy(text, length);
+    if (sscanf(copy.c_str(), "%d:%d", &h, &m) != 2 || h > 23 || m > 59) return false;
+    minutes = (uint16_t)(h * 60 + m);
+    return true;
+}
+
+const char* const LEVELS[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+constexpr MqttCommand COMMANDS[] = {
+    mqttSwitchCommand(MqttTopic::AnimSet,          "animate", setSwitch, onPublish),
+    mqttNumberCommand(MqttTopic::HetIsSet,         "hetis", 0, 360, setNumber, onPublish),
+    mqttActionCommand(MqttTopic::LightSet,         onAction),
+    mqttSelectCommand(MqttTopic::LogLvlSet,        "loglevel", LEVELS, 4, setSelect, onPublish),
+    mqttTimeCommand(MqttTopic::NightStartSet,      "night_start", parseTime, setTime, onPublish),
+    mqttActionCommand(MqttTopic::RestartCmd,       onAction),
+};
+constexpr size_t COUNT = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+static_assert(mqttCommandsSorted(COMMANDS, COUNT), "test table is sorted");
+
+constexpr MqttCommand UNSORTED[] = {
+    mqttActionCommand(MqttTopic::RestartCmd, onAction),
+    mqttActionCommand(MqttTopic::LightSet,   onAction),
+};
+static_assert(!mqttCommandsSorted(UNSORTED, 2), "out of order suffixes are detected");
+
+const MqttCommandRegistry registry(COMMANDS, COUNT);
+
+}  // namespace
+
+class MqttCommandsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        switchValue = false;
+        numberValue = -1;
+        selected.clear();
+        timeValue = 0;
+        actions = 0;
+        publishes = 0;
+        lastPayload.clear();
+    }
+};
+
+TEST_F(MqttCommandsTest, Find_BinarySearchOnSuffix) {
+    for (size_t i = 0; i < COUNT; ++i) {
+        EXPECT_EQ(&COMMANDS[i], registry.find(MQTT_TOPIC_SUFFIX[(size_t)COMMANDS[i].topic]));
+    }
+    EXPECT_EQ(nullptr, registry.find("/light/state"));
+    EXPECT_EQ(nullptr, registry.find("/light"));
+    EXPECT_EQ(nullptr, registry.find(""));
+    EXPECT_EQ(nullptr, registry.find(nullptr));
+}
+
+TEST_F(MqttCommandsTest, Switch_ParsesOnOffAndPublishes) {
+    EXPECT_TRUE(registry.handleMessage("/animate/set", "ON"));
+    EXPECT_TRUE(switchValue);
+    EXPECT_TRUE(registry.handleMessage("/animate/set", "OFF"));
+    EXPECT_FALSE(switchValue);
+    EXPECT_TRUE(registry.handleMessage("/animate/set", "true"));
+    EXPECT_TRUE(switchValue);
+    EXPECT_EQ(3, publishes);
+}
+
+TEST_F(MqttCommandsTest, Number_ClampsToRange) {
+    registry.handleMessage("/hetis/set", "42");
+    EXPECT_EQ(42, numberValue);
+    registry.handleMessage("/hetis/set", "1000");
+    EXPECT_EQ(360, numberValue);
+    registry.handleMessage("/hetis/set", "-5");
+    EXPECT_EQ(0, numberValue);
+}
+
+TEST_F(MqttCommandsTest, Number_ParsesLikeToIntWithoutOverflow) {
+    registry.handleMessage("/hetis/set", " 7");
+    EXPECT_EQ(7, numberValue);
+    registry.handleMessage("/hetis/set", "42.9");
+    EXPECT_EQ(42, numberValue);
+    registry.handleMessage("/hetis/set", "99999999999999");
+    EXPECT_EQ(360, numberValue);
+    registry.handleMessage("/hetis/set", "-99999999999999");
+    EXPECT_EQ(0, numberValue);
+    registry.handleMessage("/hetis/set", "abc");
+    EXPECT_EQ(0, numberValue);
+}
+
+TEST_F(MqttCommandsTest, Payload_IsAViewNotAString) {
+    // The client's buffer continues past the payload; only `length` bytes count
+    const char buffer[] = "120garbage";
+    EXPECT_TRUE(registry.handleMessage("/hetis/set", MqttPayload(buffer, 3)));
+    EXPECT_EQ(120, numberValue);
+    EXPECT_TRUE(registry.handleMessage("/animate/set", MqttPayload("ONE", 2)));
+    EXPECT_TRUE(switchValue);
+    EXPECT_TRUE(registry.handleMessage("/loglevel/set", MqttPayload("warning", 4)));
+    EXPECT_EQ("WARN", selected);
+    EXPECT_TRUE(registry.handleMessage("/light/set", MqttPayload("{}xyz", 2)));
+    EXPECT_EQ("{}", lastPayload);
+}
+
+TEST_F(MqttCommandsTest, Dispatch_DoesNotAllocate) {
+    const char* const messages[][2] = {
+        { "/animate/set", "ON" },
+        { "/hetis/set", "128" },
+        { "/loglevel/set", "error" },
+        { "/animate/set", "OFF" },
+    };
+    MockHeap::reset();
+    MockHeap::enable(true);
+    for (int round = 0; round < 100; ++round) {
+        for (const auto& m : messages) registry.handleMessage(m[0], m[1]);
+    }
+    MockHeap::enable(false);
+    EXPECT_EQ(0u, MockHeap::allocations());
+}
+
+TEST_F(MqttCommandsTest, Select_MatchesCaseInsensitiveAndRejectsUnknown) {
+    EXPECT_TRUE(registry.handleMessage("/loglevel/set", "WARN"));
+    EXPECT_EQ("WARN", selected);
+    EXPECT_TRUE(registry.handleMessage("/loglevel/set", "debug"));
+    EXPECT_EQ("DEBUG", selected);
+    EXPECT_FALSE(registry.handleMessage("/loglevel/set", "VERBOSE"));
+    EXPECT_EQ("DEBUG", selected);
+    EXPECT_EQ(2, publishes);
+}
+
+TEST_F(MqttCommandsTest, Time_RejectsInvalidStrings) {
+    EXPECT_TRUE(registry.handleMessage("/nightmode/start/set", "22:30"));
+    EXPECT_EQ(22 * 60 + 30, timeValue);
+    EXPECT_FALSE(registry.handleMessage("/nightmode/start/set", "25:00"));
+    EXPECT_EQ(22 * 60 + 30, timeValue);
+    EXPECT_EQ(1, publishes);
+}
+
+TEST_F(MqttCommandsTest, Action_GetsRawPayloadWithoutEcho) {
+    EXPECT_TRUE(registry.handleMessage("/light/set", "{\"state\":\"ON\"}"));
+    EXPECT_EQ("{\"state\":\"ON\"}", lastPayload);
+    EXPECT_TRUE(registry.handleMessage("/restart/press", ""));
+    EXPECT_EQ(2, actions);
+    EXPECT_EQ(0, publishes);
+}
+
+TEST_F(MqttCommandsTest, UnknownTopic_IsIgnored) {
+    EXPECT_FALSE(registry.handleMessage("/clock/set", "ON"));
+    EXPECT_FALSE(switchValue);
+    EXPECT_EQ(0, publishes);
+}
+
+// Dispatch throughput: the sorted table against the std::map keyed by full
+// topic strings that the registry used before
+TEST_F(MqttCommandsTest, Benchmark_DispatchThroughput) {
+    MqttTopics topics;
+    topics.setBase("wordclock/living_room");
+    std::vector<std::string> incoming;
+    std::map<std::string, const MqttCommand*> byTopic;
+    for (size_t i = 0; i < COUNT; ++i) {
+        incoming.push_back(topics.get(COMMANDS[i].topic));
+        byTopic[incoming.back()] = &COMMANDS[i];
+    }
+    const MqttPayload payload("ON");
+    const int rounds = 20000;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (const auto& t : incoming) {
+            const MqttCommand* cmd = registry.find(topics.suffixOf(t.c_str()));
+            ASSERT_NE(nullptr, cmd);
+            if (cmd->kind == MqttCommandKind::Switch) mqttRunCommand(*cmd, payload);
+        }
+    }
+    auto tableNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (const auto& t : incoming) {
+            auto it = byTopic.find(std::string(t.c_str()));
+            ASSERT_NE(byTopic.end(), it);
+            if (it->second->kind == MqttCommandKind::Switch) mqttRunCommand(*it->second, payload);
+        }
+    }
+    auto mapNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    const double dispatches = (double)rounds * incoming.size();
+    printf("\n[ BENCH    ] sorted table: %.1f ns/dispatch, std::map<string>: %.1f ns/dispatch\n",
+           tableNs / dispatches, mapNs / dispatches);
+    EXPECT_LT(tableNs / dispatches, 2000.0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
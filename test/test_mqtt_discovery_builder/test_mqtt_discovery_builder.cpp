@@ -104,6 +104,7 @@ TEST_F(MqttDiscoveryBuilderTest, AddLight_CreatesLightEntity) {
     ASSERT_TRUE(jsonContains(payload, "cmd_t", "light/set"));
     ASSERT_TRUE(jsonContainsKey(payload, "brightness"));
     ASSERT_TRUE(jsonContainsKey(payload, "rgb"));
+    ASSERT_TRUE(jsonContainsKey(payload, "transition"));
 }
 
 // Switch Entity Tests
@@ -258,6 +259,19 @@ TEST_F(MqttDiscoveryBuilderTest, AddSensor_WithStateClass_IncludesStateClass) {
     
     String payload = mockMqtt.getPublishedPayload("homeassistant/sensor/test123_rssi/config");
     ASSERT_TRUE(jsonContains(payload, "stat_cla", "measurement"));
+    ASSERT_FALSE(jsonContainsKey(payload, "ent_cat"));
+}
+
+TEST_F(MqttDiscoveryBuilderTest, AddSensor_WithEntityCategory_IncludesCategory) {
+    MqttDiscoveryBuilder builder = createBuilder();
+    builder.setDeviceInfo("Test Clock", "Model", "Mfg", "1.0");
+    builder.addSensor("Loop", nodeId + "_loop", "loop/state", "μs", "duration", "measurement", "diagnostic");
+    
+    builder.publish();
+    
+    String payload = mockMqtt.getPublishedPayload("homeassistant/sensor/test123_loop/config");
+    ASSERT_TRUE(jsonContains(payload, "ent_cat", "diagnostic"));
+    ASSERT_TRUE(jsonContains(payload, "dev_cla", "duration"));
 }
 
 // Text Entity Tests
@@ -329,17 +343,84 @@ TEST_F(MqttDiscoveryBuilderTest, MultipleEntities_AllPublished) {
 }
 
 // Clear Tests
-TEST_F(MqttDiscoveryBuilderTest, Clear_RemovesAllEntities) {
+TEST_F(MqttDiscoveryBuilderTest, Clear_ResetsCountAndHash) {
     MqttDiscoveryBuilder builder = createBuilder();
     builder.setDeviceInfo("Test Clock", "Model", "Mfg", "1.0");
+    uint32_t empty = builder.hash();
     builder.addSwitch("Test 1", nodeId + "_test1", "state1", "cmd1");
     builder.addSwitch("Test 2", nodeId + "_test2", "state2", "cmd2");
+    ASSERT_NE(empty, builder.hash());
     
     builder.clear();
-    int count = builder.publish();
-    
-    ASSERT_EQ(0, count);
+    ASSERT_EQ(0, builder.publish());
+    ASSERT_EQ(empty, builder.hash());
+    // Entities are streamed: the two configs were already sent
+    ASSERT_EQ(2, mockMqtt.getPublishedCount());
+}
+
+// Streaming and hashing
+TEST_F(MqttDiscoveryBuilderTest, Streaming_PublishesEachEntityWhenAdded) {
+    MqttDiscoveryBuilder builder = createBuilder();
+    builder.setDeviceInfo("Test Clock", "Model", "Mfg", "1.0");
+    builder.addSwitch("Test", nodeId + "_test", "state", "cmd");
+    ASSERT_EQ(1, mockMqtt.getPublishedCount());
+    builder.addSensor("Sensor", nodeId + "_sens", "sens/state");
+    ASSERT_EQ(2, mockMqtt.getPublishedCount());
+    ASSERT_EQ(2, builder.publish());
+}
+
+TEST_F(MqttDiscoveryBuilderTest, HashOnly_PublishesNothingAndMatchesPublishedRun) {
+    MqttDiscoveryBuilder dry = createBuilder();
+    dry.setDeviceInfo("Test Clock", "Model", "Mfg", "1.0");
+    dry.setPublishing(false);
+    dry.addLight("light/state", "light/set");
+    dry.addSwitch("Test", nodeId + "_test", "state", "cmd");
+    ASSERT_EQ(0, dry.publish());
     ASSERT_EQ(0, mockMqtt.getPublishedCount());
+    
+    MqttDiscoveryBuilder real = createBuilder();
+    real.setDeviceInfo("Test Clock", "Model", "Mfg", "1.0");
+    real.addLight("light/state", "light/set");
+    real.addSwitch("Test", nodeId + "_test", "state", "cmd");
+    ASSERT_EQ(2, real.publish());
+    ASSERT_EQ(dry.hash(), real.hash());
+    ASSERT_EQ(0, real.failed());
+}
+
+TEST_F(MqttDiscoveryBuilderTest, Select_EmitsOneEntityPerPass) {
+    for (int i = 0; i < 3; ++i) {
+        MqttDiscoveryBuilder builder = createBuilder();
+        builder.setDeviceInfo("Test Clock", "Model", "Mfg", "1.0");
+        builder.select(i);
+        builder.addSwitch("A", nodeId + "_a", "a/state", "a/set");
+        builder.addSwitch("B", nodeId + "_b", "b/state", "b/set");
+        builder.addSensor("C", nodeId + "_c", "c/state");
+        ASSERT_EQ(3, builder.count());
+        ASSERT_EQ(1, builder.publish());
+    }
+    ASSERT_EQ(3, mockMqtt.getPublishedCount());
+    ASSERT_TRUE(mockMqtt.wasPublished(String("homeassistant/switch/") + nodeId + "_a/config"));
+    ASSERT_TRUE(mockMqtt.wasPublished(String("homeassistant/sensor/") + nodeId + "_c/config"));
+}
+
+TEST_F(MqttDiscoveryBuilderTest, Hash_ChangesWithAnyConfigField) {
+    MqttDiscoveryBuilder a = createBuilder();
+    a.setDeviceInfo("Test Clock", "Model", "Mfg", "1.0");
+    a.setPublishing(false);
+    a.addSwitch("Test", nodeId + "_test", "state", "cmd");
+    
+    MqttDiscoveryBuilder b = createBuilder();
+    b.setDeviceInfo("Test Clock", "Model", "Mfg", "1.1");
+    b.setPublishing(false);
+    b.addSwitch("Test", nodeId + "_test", "state", "cmd");
+    ASSERT_NE(a.hash(), b.hash()) << "Firmware version is part of the device info";
+    
+    MqttDiscoveryBuilder c = createBuilder();
+    c.setDeviceInfo("Test Clock", "Model", "Mfg", "1.0");
+    c.setPublishing(false);
+    c.addToHash("broker:1883");
+    c.addSwitch("Test", nodeId + "_test", "state", "cmd");
+    ASSERT_NE(a.hash(), c.hash());
 }
 
 // Edge Cases
@@ -0,0 +1,474 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define MOCK_PUBSUBCLIENT_NET
+#include "../mocks/mock_arduino.h"
+#include "../mocks/mock_preferences.h"
+#include "../mocks/mock_mqtt_broker.h"
+
+// Include production code: the whole MQTT stack over real sockets
+#include "../../src/log.cpp"
+#include "../../src/grid_variants/nl_v1.cpp"
+#include "../../src/grid_variants/nl_v2.cpp"
+#include "../../src/grid_variants/nl_v3.cpp"
+#include "../../src/grid_variants/nl_v4.cpp"
+#include "../../src/grid_variants/nl_50x50_v1.cpp"
+#include "../../src/grid_variants/nl_50x50_v2.cpp"
+#include "../../src/grid_variants/nl_50x50_v3.cpp"
+#include "../../src/grid_layout.cpp"
+#include "../../src/time_mapper.cpp"
+#include "../../src/led_state.cpp"
+#include "../../src/night_mode.cpp"
+#include "../../src/state_events.cpp"
+#include "../../src/mqtt_settings.cpp"
+#include "../../src/mqtt_command_handler.cpp"
+#include "../../src/mqtt_discovery_builder.cpp"
+#include "../../src/mqtt_transport.cpp"
+#include "../../src/mqtt_client.cpp"
+
+// Runs mqtt_client.cpp against MockMqttBroker on 127.0.0.1: connect and
+// subscribe, retained state, discovery, command round-trips and reconnects,
+// plus latency and throughput figures for the command and state paths.
+
+DisplaySettings displaySettings;
+bool clockEnabled = true;
+StartupSequence startupSequence;
+
+namespace {
+
+std::vector<uint16_t> shownLeds;
+unsigned long shownAtUs = 0;
+unsigned showCount = 0;
+unsigned restartCount = 0;
+
+const char* const BASE = "wordclock";
+const unsigned long PUMP_TIMEOUT_MS = 2000;
+const unsigned long SETTLE_MS = 100;  // Covers Nagle and delayed ACKs on loopback
+
+std::string topicOf(const char* suffix) {
+    return std::string(BASE) + suffix;
+}
+
+}  // namespace
+
+void showLeds(const std::vector<uint16_t>& leds) {
+    shownLeds = leds;
+    shownAtUs = micros();
+    showCount++;
+}
+uint32_t ledFrameVersion() { return showCount; }
+void safeRestart() { restartCount++; }
+void checkForFirmwareUpdate() {}
+
+class MqttE2ETest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Preferences::reset();
+        setMockMillis(100000);
+        shownLeds.clear();
+        showCount = 0;
+        restartCount = 0;
+        clockEnabled = true;
+        ledState.begin();
+        lightFader.cancel();
+        ASSERT_TRUE(broker.start());
+        mqtt_begin();
+    }
+
+    void TearDown() override {
+        MqttSettings off;
+        off.host = "";
+        mqtt_apply_settings(off);
+        broker.stop();
+        Preferences::reset();
+    }
+
+    void configure(const char* user = "") {
+        MqttSettings s;
+        s.host = "127.0.0.1";
+        s.port = broker.port();
+        s.user = user;
+        s.pass = user[0] ? "secret" : "";
+        mqtt_apply_settings(s);
+    }
+
+    // Alternate firmware and broker passes until done() or the timeout
+    bool pumpUntil(const std::function<bool()>& done) {
+        auto start = std::chrono::steady_clock::now();
+        while (!done()) {
+            mqtt_loop();
+            broker.poll();
+            if (std::chrono::steady_clock::now() - start > std::chrono::milliseconds(PUMP_TIMEOUT_MS)) return false;
+        }
+        return true;
+    }
+
+    // Keep both sides running for @p ms, so traffic in flight arrives
+    void pump(unsigned long ms = SETTLE_MS) {
+        auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(ms)) {
+            mqtt_loop();
+            broker.poll();
+            std::this_thread::yield();
+        }
+    }
+
+    bool connect(const char* user = "") {
+        configure(user);
+        return pumpUntil([] { return mqtt_is_connected(); });
+    }
+
+    // Connected, and the discovery run has finished
+    bool settle() {
+        if (!connect() || !pumpUntil([] { return !g_discovery.active; })) return false;
+        pump();
+        return true;
+    }
+
+    size_t discoveryCount() const {
+        size_t n = 0;
+        for (const auto& m : broker.messages()) {
+            n += MockMqttBroker::topicMatches("homeassistant/+/+/config", m.topic);
+        }
+        return n;
+    }
+
+    MockMqttBroker broker;
+};
+
+// ============================================================================
+// Broker
+// ============================================================================
+
+TEST(MockMqttBrokerTest, TopicFilters) {
+    EXPECT_TRUE(MockMqttBroker::topicMatches("a/b", "a/b"));
+    EXPECT_FALSE(MockMqttBroker::topicMatches("a/b", "a/bc"));
+    EXPECT_TRUE(MockMqttBroker::topicMatches("a/+/c", "a/b/c"));
+    EXPECT_FALSE(MockMqttBroker::topicMatches("a/+", "a/b/c"));
+    EXPECT_TRUE(MockMqttBroker::topicMatches("a/#", "a/b/c"));
+    EXPECT_TRUE(MockMqttBroker::topicMatches("a/#", "a"));
+    EXPECT_TRUE(MockMqttBroker::topicMatches("#", "x/y"));
+}
+
+// ============================================================================
+// Connection
+// ============================================================================
+
+TEST_F(MqttE2ETest, ConnectsSubscribesAndPublishesRetainedState) {
+    ASSERT_TRUE(settle());
+    EXPECT_EQ(1u, broker.connectCount());
+    EXPECT_EQ(1u, broker.clientCount());
+
+    ASSERT_NE(nullptr, broker.retained(topicOf("/availability")));
+    EXPECT_EQ("online", *broker.retained(topicOf("/availability")));
+    ASSERT_NE(nullptr, broker.retained(topicOf("/light/state")));
+    EXPECT_NE(std::string::npos, broker.retained(topicOf("/light/state"))->find("\"state\":\"ON\""));
+    ASSERT_NE(nullptr, broker.retained(topicOf("/version")));
+    EXPECT_EQ(FIRMWARE_VERSION, *broker.retained(topicOf("/version")));
+
+    for (size_t i = 0; i < MQTT_COMMAND_COUNT; ++i) {
+        EXPECT_TRUE(broker.isSubscribed(g_topics.get(MQTT_COMMANDS[i].topic))) << g_topics.get(MQTT_COMMANDS[i].topic);
+    }
+    EXPECT_TRUE(broker.isSubscribed("homeassistant/status"));
+}
+
+TEST_F(MqttE2ETest, PerfDiagnosticsPublishedAsDiagnosticSensors) {
+    ASSERT_TRUE(settle());
+    ASSERT_NE(nullptr, broker.retained(topicOf("/heap_frag")));
+    EXPECT_EQ("25", *broker.retained(topicOf("/heap_frag")));
+    EXPECT_EQ("150000", *broker.retained(topicOf("/heap_block")));
+    ASSERT_NE(nullptr, broker.retained(topicOf("/perf/nvs_writes")));
+
+    size_t diagnostic = 0;
+    for (const auto& m : broker.messages()) {
+        if (MockMqttBroker::topicMatches("homeassistant/sensor/+/config", m.topic) &&
+            m.payload.find("\"ent_cat\":\"diagnostic\"") != std::string::npos) {
+            diagnostic++;
+        }
+    }
+    EXPECT_EQ(8u, diagnostic);
+
+    // The next diagnostics run reports the window since the previous one
+    for (int i = 0; i < 20; ++i) perfStats().frame(777);
+    setMockMillis(millis() + DIAG_INTERVAL_MS);
+    ASSERT_TRUE(pumpUntil([&] {
+        const std::string* st = broker.retained(topicOf("/perf/show_time"));
+        return st && *st == "777";
+    }));
+    EXPECT_EQ("0.1", *broker.retained(topicOf("/perf/fps")));  // 20 frames in 120 s
+}
+
+TEST_F(MqttE2ETest, NoBrokerConfiguredStaysOffline) {
+    pump();
+    EXPECT_FALSE(mqtt_is_connected());
+    EXPECT_EQ(0u, broker.connectCount());
+}
+
+TEST_F(MqttE2ETest, RefusedConnectionReportsBrokerState) {
+    broker.refuseConnections(5);  // Not authorized
+    configure();
+    ASSERT_TRUE(pumpUntil([] { return mqtt_last_error().length() > 0 && g_phase == MqttPhase::Idle; }));
+    EXPECT_FALSE(mqtt_is_connected());
+    EXPECT_NE(std::string::npos, mqtt_last_error().str().find("state 5")) << mqtt_last_error().c_str();
+}
+
+TEST_F(MqttE2ETest, ConnectsOnceBrokerStopsRefusing) {
+    broker.refuseConnections(3);  // Server unavailable
+    configure();
+    ASSERT_TRUE(pumpUntil([] { return reconnectAttempts == 1; }));
+
+    broker.refuseConnections(0);
+    setMockMillis(millis() + reconnectDelayMs);
+    ASSERT_TRUE(pumpUntil([] { return mqtt_is_connected(); })) << mqtt_last_error().c_str();
+    EXPECT_EQ(1u, broker.connectCount());
+}
+
+TEST_F(MqttE2ETest, WillMarksClockOfflineWhenConnectionDrops) {
+    ASSERT_TRUE(connect("clock"));
+    pump();
+    EXPECT_EQ("online", *broker.retained(topicOf("/availability")));
+
+    broker.dropClients();
+    ASSERT_NE(nullptr, broker.retained(topicOf("/availability")));
+    EXPECT_EQ("offline", *broker.retained(topicOf("/availability")));
+}
+
+TEST_F(MqttE2ETest, ReconnectsAfterBackoffWhenBrokerReturns) {
+    ASSERT_TRUE(settle());
+    uint16_t port = broker.port();
+
+    broker.stop();
+    ASSERT_TRUE(pumpUntil([] { return !mqtt_is_connected(); }));
+    // The retry after a lost connection waits for the minimum delay
+    setMockMillis(millis() + RECONNECT_DELAY_MIN_MS);
+    ASSERT_TRUE(pumpUntil([] { return reconnectAttempts == 1; }));
+    unsigned long backoff = reconnectDelayMs;
+    EXPECT_GE(backoff, RECONNECT_DELAY_MIN_MS * 2);
+
+    ASSERT_TRUE(broker.start(port));
+    pump();
+    EXPECT_FALSE(mqtt_is_connected()) << "retried before the backoff expired";
+
+    setMockMillis(millis() + backoff);
+    ASSERT_TRUE(pumpUntil([] { return mqtt_is_connected(); }));
+    EXPECT_EQ(1u, broker.connectCount());
+    EXPECT_EQ(RECONNECT_DELAY_MIN_MS, reconnectDelayMs);
+    pump();
+    EXPECT_EQ("online", *broker.retained(topicOf("/availability")));
+}
+
+// ============================================================================
+// Discovery
+// ============================================================================
+
+TEST_F(MqttE2ETest, DiscoveryPublishedOnceAndSkippedWhenUnchanged) {
+    ASSERT_TRUE(settle());
+    size_t entities = discoveryCount();
+    EXPECT_GT(entities, 20u);
+    EXPECT_EQ(entities, broker.retainedCount("homeassistant/#"));
+    ASSERT_NE(nullptr, broker.retained("homeassistant/light/" + std::string(uniqId.c_str()) + "_light/config"));
+
+    broker.dropClients();
+    broker.clearMessages();
+    setMockMillis(millis() + RECONNECT_DELAY_MIN_MS);
+    ASSERT_TRUE(pumpUntil([] { return mqtt_is_connected(); }));
+    ASSERT_TRUE(pumpUntil([] { return !g_discovery.active; }));
+    pump();
+    EXPECT_EQ(0u, discoveryCount());
+}
+
+TEST_F(MqttE2ETest, HomeAssistantBirthRepublishesDiscovery) {
+    ASSERT_TRUE(settle());
+    size_t entities = discoveryCount();
+    broker.clearMessages();
+
+    broker.publish("homeassistant/status", "online");
+    ASSERT_TRUE(pumpUntil([&] { return discoveryCount() == entities; }));
+}
+
+// ============================================================================
+// Commands
+// ============================================================================
+
+TEST_F(MqttE2ETest, LightCommandRendersAndEchoesState) {
+    ASSERT_TRUE(settle());
+    unsigned shows = showCount;
+
+    broker.publish(topicOf("/light/set"), "{\"state\":\"ON\",\"brightness\":42,\"color\":{\"r\":10,\"g\":20,\"b\":30}}");
+    ASSERT_TRUE(pumpUntil([&] {
+        const MockMqttBroker::Message* m = broker.last(topicOf("/light/state"));
+        return m && m->payload.find("\"brightness\":42") != std::string::npos;
+    }));
+    EXPECT_EQ(42, ledState.getBrightness());
+    EXPECT_EQ(shows + 1, showCount);
+    EXPECT_FALSE(shownLeds.empty());
+    EXPECT_NE(std::string::npos, broker.retained(topicOf("/light/state"))->find("\"r\":10"));
+}
+
+TEST_F(MqttE2ETest, LightTransitionFadesFromTheShownLevel) {
+    ASSERT_TRUE(settle());
+    ledState.setBrightness(100);
+
+    // The state reports the target at once; the LEDs get there over 2 s
+    broker.publish(topicOf("/light/set"), "{\"brightness\":200,\"transition\":2}");
+    ASSERT_TRUE(pumpUntil([&] {
+        const MockMqttBroker::Message* m = broker.last(topicOf("/light/state"));
+        return m && m->payload.find("\"brightness\":200") != std::string::npos;
+    }));
+    EXPECT_EQ(200, ledState.getBrightness());
+    ASSERT_TRUE(lightFader.active());
+    EXPECT_EQ(100, lightFader.sample(millis(), ledState.level()).brightness);
+    EXPECT_EQ(150, lightFader.sample(millis() + 1000, ledState.level()).brightness);
+    EXPECT_EQ(200, lightFader.sample(millis() + 2000, ledState.level()).brightness);
+    EXPECT_FALSE(lightFader.active());
+}
+
+TEST_F(MqttE2ETest, LightOffTransitionFadesToDark) {
+    ASSERT_TRUE(settle());
+    ledState.setBrightness(80);
+
+    broker.publish(topicOf("/light/set"), "{\"state\":\"OFF\",\"transition\":0.5}");
+    ASSERT_TRUE(pumpUntil([] { return !clockEnabled; }));
+    ASSERT_TRUE(lightFader.active());
+    EXPECT_EQ(40, lightFader.sample(millis() + 250, ledState.level()).brightness);
+    EXPECT_EQ(0, lightFader.sample(millis() + 500, ledState.level()).brightness);
+    EXPECT_EQ(80, ledState.getBrightness());
+
+    // A command without a transition applies at once and drops the fade
+    broker.publish(topicOf("/light/set"), "{\"state\":\"ON\",\"transition\":1}");
+    ASSERT_TRUE(pumpUntil([] { return clockEnabled; }));
+    ASSERT_TRUE(lightFader.active());
+    EXPECT_EQ(0, lightFader.sample(millis(), ledState.level()).brightness);
+    broker.publish(topicOf("/light/set"), "{\"brightness\":30}");
+    ASSERT_TRUE(pumpUntil([] { return ledState.getBrightness() == 30; }));
+    EXPECT_FALSE(lightFader.active());
+}
+
+TEST_F(MqttE2ETest, ClockSwitchedOffDuringTransitionGoesDarkAtOnce) {
+    ASSERT_TRUE(settle());
+    ledState.setBrightness(80);
+    broker.publish(topicOf("/light/set"), "{\"brightness\":200,\"transition\":10}");
+    ASSERT_TRUE(pumpUntil([] { return lightFader.active(); }));
+
+    // Switched off outside the light entity (clock switch, like the dashboard's
+    // toggle): nothing may keep the face lit until the fade would have ended
+    broker.publish(topicOf("/clock/set"), "OFF");
+    ASSERT_TRUE(pumpUntil([] { return !clockEnabled; }));
+    EXPECT_FALSE(lightFader.active());
+
+    // Likewise a brightness set directly, as the dashboard slider does
+    broker.publish(topicOf("/light/set"), "{\"state\":\"ON\",\"brightness\":50,\"transition\":10}");
+    ASSERT_TRUE(pumpUntil([] { return lightFader.active(); }));
+    ledState.setBrightness(120);
+    EXPECT_FALSE(lightFader.active());
+    EXPECT_EQ(120, lightFader.sample(millis() + 1000, ledState.level()).brightness);
+}
+
+TEST_F(MqttE2ETest, SwitchAndNumberCommandsRoundTrip) {
+    ASSERT_TRUE(settle());
+
+    broker.publish(topicOf("/animate/set"), "ON");
+    ASSERT_TRUE(pumpUntil([&] {
+        const std::string* st = broker.retained(topicOf("/animate/state"));
+        return st && *st == "ON";
+    }));
+    EXPECT_TRUE(displaySettings.getAnimateWords());
+
+    broker.publish(topicOf("/hetis/set"), "120");
+    ASSERT_TRUE(pumpUntil([&] {
+        const std::string* st = broker.retained(topicOf("/hetis/state"));
+        return st && *st == "120";
+    }));
+    EXPECT_EQ(120, displaySettings.getHetIsDurationSec());
+
+    broker.publish(topicOf("/restart/press"), "PRESS");
+    ASSERT_TRUE(pumpUntil([] { return restartCount == 1; }));
+}
+
+TEST_F(MqttE2ETest, CommandsSurviveReconnect) {
+    ASSERT_TRUE(settle());
+    broker.dropClients();
+    setMockMillis(millis() + RECONNECT_DELAY_MIN_MS);
+    ASSERT_TRUE(pumpUntil([] { return mqtt_is_connected(); }));
+
+    broker.publish(topicOf("/clock/set"), "OFF");
+    ASSERT_TRUE(pumpUntil([] { return !clockEnabled; }));
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+namespace {
+
+struct LatencyReport {
+    std::vector<unsigned long> samples;
+
+    unsigned long percentile(double p) {
+        std::sort(samples.begin(), samples.end());
+        return samples[std::min(samples.size() - 1, (size_t)(p * samples.size()))];
+    }
+    unsigned long avg() const {
+        unsigned long long total = 0;
+        for (unsigned long s : samples) total += s;
+        return (unsigned long)(total / samples.size());
+    }
+};
+
+const int BENCH_ROUNDS = 200;
+const unsigned long LATENCY_BUDGET_US = 20000;  // Loopback; generous for CI machines
+
+}  // namespace
+
+TEST_F(MqttE2ETest, Bench_CommandToRenderLatency) {
+    ASSERT_TRUE(settle());
+    LatencyReport rep;
+    for (int i = 0; i < BENCH_ROUNDS; ++i) {
+        int brightness = 1 + i % 250;
+        std::string cmd = "{\"brightness\":" + std::to_string(brightness) + "}";
+        unsigned shows = showCount;
+        unsigned long sentUs = micros();
+        broker.publish(topicOf("/light/set"), cmd);
+        ASSERT_TRUE(pumpUntil([&] { return showCount != shows; })) << "round " << i;
+        rep.samples.push_back(shownAtUs - sentUs);
+        ASSERT_EQ(brightness, ledState.getBrightness());
+    }
+    unsigned long p50 = rep.percentile(0.50), p99 = rep.percentile(0.99);
+    printf("\n[ BENCH    ] command -> render: avg %lu us, p50 %lu us, p99 %lu us over %d commands\n",
+           rep.avg(), p50, p99, BENCH_ROUNDS);
+    EXPECT_LT(p50, LATENCY_BUDGET_US);
+}
+
+TEST_F(MqttE2ETest, Bench_StatePublishThroughput) {
+    ASSERT_TRUE(settle());
+    broker.clearMessages();
+    std::string lightState = topicOf("/light/state");
+
+    LatencyReport rep;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_ROUNDS; ++i) {
+        int brightness = 1 + i % 250;
+        std::string expect = "\"brightness\":" + std::to_string(brightness) + ",";
+        unsigned long changedUs = micros();
+        ledState.setBrightness((uint8_t)brightness);
+        ASSERT_TRUE(pumpUntil([&] {
+            const MockMqttBroker::Message* m = broker.last(lightState);
+            return m && m->payload.find(expect) != std::string::npos;
+        })) << "round " << i;
+        rep.samples.push_back(broker.last(lightState)->atUs - changedUs);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("\n[ BENCH    ] state change -> broker: avg %lu us, p99 %lu us, %.0f states/s\n",
+           rep.avg(), rep.percentile(0.99), BENCH_ROUNDS / seconds);
+    EXPECT_EQ((size_t)BENCH_ROUNDS, broker.count(lightState));
+    EXPECT_LT(rep.percentile(0.50), LATENCY_BUDGET_US);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "../mocks/mock_arduino.h"
+
+// Include production code (header-only)
+#include "../../src/mqtt_outbox.h"
+
+namespace {
+
+struct Sent {
+    MqttTopic topic;
+    std::string payload;
+};
+
+std::vector<Sent> sent;
+bool accept = true;
+
+bool record(const MqttOutboxEntry& e) {
+    if (!accept) return false;
+    sent.push_back({ e.topic, std::string(e.payload, e.length) });
+    return true;
+}
+
+}  // namespace
+
+class MqttOutboxTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sent.clear();
+        accept = true;
+    }
+
+    MqttOutbox outbox;
+};
+
+TEST_F(MqttOutboxTest, DrainsInOrder) {
+    outbox.push(MqttTopic::LightState, "{\"state\":\"ON\"}");
+    outbox.push(MqttTopic::AnimState, "ON");
+    outbox.push(MqttTopic::HetIsState, "360");
+    EXPECT_EQ(3u, outbox.depth());
+
+    EXPECT_EQ(3u, outbox.drain(record, 1000000));
+    ASSERT_EQ(3u, sent.size());
+    EXPECT_EQ(MqttTopic::LightState, sent[0].topic);
+    EXPECT_EQ("{\"state\":\"ON\"}", sent[0].payload);
+    EXPECT_EQ(MqttTopic::HetIsState, sent[2].topic);
+    EXPECT_TRUE(outbox.empty());
+    EXPECT_EQ(3u, outbox.stats().sent);
+}
+
+TEST_F(MqttOutboxTest, SameTopicKeepsLatestValueInPlace) {
+    outbox.push(MqttTopic::LightState, "{\"brightness\":10}");
+    outbox.push(MqttTopic::AnimState, "ON");
+    for (int b = 11; b <= 60; ++b) {
+        std::string json = "{\"brightness\":" + std::to_string(b) + "}";
+        EXPECT_EQ(MqttOutbox::Result::Merged, outbox.push(MqttTopic::LightState, json.c_str()));
+    }
+    EXPECT_EQ(2u, outbox.depth());
+
+    outbox.drain(record, 1000000);
+    ASSERT_EQ(2u, sent.size());
+    EXPECT_EQ(MqttTopic::LightState, sent[0].topic);
+    EXPECT_EQ("{\"brightness\":60}", sent[0].payload);
+
+    MqttOutboxStats s = outbox.stats();
+    EXPECT_EQ(2u, s.queued);
+    EXPECT_EQ(50u, s.merged);
+    EXPECT_EQ(0u, s.dropped);
+}
+
+TEST_F(MqttOutboxTest, FullQueueDropsNewTopics) {
+    for (uint8_t i = 0; i < MqttOutbox::CAPACITY; ++i) {
+        EXPECT_EQ(MqttOutbox::Result::Queued, outbox.push((MqttTopic)i, "x"));
+    }
+    EXPECT_EQ(MqttOutbox::Result::Dropped, outbox.push((MqttTopic)MqttOutbox::CAPACITY, "x"));
+    // A queued topic can still be updated
+    EXPECT_EQ(MqttOutbox::Result::Merged, outbox.push((MqttTopic)0, "y"));
+
+    MqttOutboxStats s = outbox.stats();
+    EXPECT_EQ((unsigned)MqttOutbox::CAPACITY, s.depth);
+    EXPECT_EQ((unsigned)MqttOutbox::CAPACITY, s.highWater);
+    EXPECT_EQ(1u, s.dropped);
+}
+
+TEST_F(MqttOutboxTest, OversizePayloadIsDropped) {
+    std::string big(MQTT_OUTBOX_PAYLOAD_MAX + 1, 'a');
+    EXPECT_EQ(MqttOutbox::Result::Dropped, outbox.push(MqttTopic::Birth, big.c_str()));
+    big.pop_back();
+    EXPECT_EQ(MqttOutbox::Result::Queued, outbox.push(MqttTopic::Birth, big.c_str()));
+    outbox.drain(record, 1000000);
+    EXPECT_EQ(big, sent[0].payload);
+}
+
+TEST_F(MqttOutboxTest, FailedPublishKeepsEntry) {
+    outbox.push(MqttTopic::AnimState, "ON");
+    accept = false;
+    EXPECT_EQ(0u, outbox.drain(record, 1000000));
+    EXPECT_EQ(1u, outbox.depth());
+    accept = true;
+    EXPECT_EQ(1u, outbox.drain(record, 1000000));
+    EXPECT_TRUE(outbox.empty());
+}
+
+TEST_F(MqttOutboxTest, BudgetLimitsOneDrain) {
+    for (uint8_t i = 0; i < 4; ++i) outbox.push((MqttTopic)i, "x");
+    // A zero budget still sends one message per call
+    EXPECT_EQ(1u, outbox.drain(record, 0));
+    EXPECT_EQ(3u, outbox.depth());
+    EXPECT_EQ(3u, outbox.drain(record, 1000000));
+}
+
+TEST_F(MqttOutboxTest, WrapsAroundTheRing) {
+    for (int round = 0; round < 5; ++round) {
+        for (uint8_t i = 0; i < 10; ++i) outbox.push((MqttTopic)i, "x");
+        EXPECT_EQ(10u, outbox.drain(record, 1000000));
+    }
+    EXPECT_EQ(50u, sent.size());
+    EXPECT_EQ(10u, outbox.stats().highWater);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -252,6 +252,15 @@ TEST_F(MqttSettingsTest, SaveAndLoad_LongHostname) {
     ASSERT_STREQ("very-long-hostname-for-mqtt-broker.example.com", loaded.host.c_str());
 }
 
+// Discovery hash
+TEST_F(MqttSettingsTest, DiscoveryHash_DefaultsToZeroAndRoundTrips) {
+    ASSERT_EQ(0u, mqtt_discovery_hash_load());
+    mqtt_discovery_hash_save(0xDEADBEEF);
+    ASSERT_EQ(0xDEADBEEFu, mqtt_discovery_hash_load());
+    mqtt_discovery_hash_save(0);
+    ASSERT_EQ(0u, mqtt_discovery_hash_load());
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <string>
+
+// Include production code (header-only)
+#include "../../src/mqtt_topics.h"
+
+static_assert(mqttTopicLongestSuffix() == mqttTopicLength("/nightmode/override/state"),
+              "longest suffix is computed at compile time");
+
+TEST(MqttTopicsTest, Get_ComposesBaseAndSuffix) {
+    MqttTopics topics;
+    topics.setBase("wordclock");
+    EXPECT_STREQ("wordclock/light/state", topics.get(MqttTopic::LightState));
+    EXPECT_STREQ("wordclock/availability", topics.get(MqttTopic::Availability));
+    // A shorter suffix after a longer one leaves no trailing garbage
+    EXPECT_STREQ("wordclock/nightmode/override/state", topics.get(MqttTopic::NightOverrideState));
+    EXPECT_STREQ("wordclock/ip", topics.get(MqttTopic::Ip));
+    EXPECT_STREQ("wordclock", topics.base());
+}
+
+TEST(MqttTopicsTest, SetBase_StripsTrailingSlashAndReplacesOldBase) {
+    MqttTopics topics;
+    topics.setBase("living_room/clock/");
+    EXPECT_STREQ("living_room/clock/heap", topics.get(MqttTopic::Heap));
+    topics.setBase("wc");
+    EXPECT_EQ(2u, topics.baseLength());
+    EXPECT_STREQ("wc/heap", topics.get(MqttTopic::Heap));
+}
+
+TEST(MqttTopicsTest, SetBase_TruncatesOverlongBase) {
+    MqttTopics topics;
+    std::string base(MQTT_TOPIC_BASE_MAX, 'a');
+    EXPECT_TRUE(topics.setBase(base.c_str()));
+    base += "b";
+    EXPECT_FALSE(topics.setBase(base.c_str()));
+    EXPECT_EQ(MQTT_TOPIC_BASE_MAX, topics.baseLength());
+    // Every topic still fits the buffer
+    for (size_t i = 0; i < MQTT_TOPIC_COUNT; ++i) {
+        EXPECT_LE(strlen(topics.get((MqttTopic)i)), MQTT_TOPIC_MAX);
+    }
+}
+
+TEST(MqttTopicsTest, Match_RoundTripsEveryTopic) {
+    MqttTopics topics;
+    topics.setBase("wordclock/test");
+    for (size_t i = 0; i < MQTT_TOPIC_COUNT; ++i) {
+        std::string full = topics.get((MqttTopic)i);
+        MqttTopic t = MqttTopic::Count;
+        ASSERT_TRUE(topics.match(full.c_str(), t)) << full;
+        EXPECT_EQ((MqttTopic)i, t);
+    }
+}
+
+TEST(MqttTopicsTest, Match_RejectsForeignTopics) {
+    MqttTopics topics;
+    topics.setBase("wordclock");
+    MqttTopic t;
+    EXPECT_FALSE(topics.match("other/light/set", t));
+    EXPECT_FALSE(topics.match("wordclock2/light/set", t));
+    EXPECT_FALSE(topics.match("wordclock/light/sett", t));
+    EXPECT_FALSE(topics.match("wordclock/light", t));
+    EXPECT_FALSE(topics.match("wordclock", t));
+    EXPECT_FALSE(topics.match(nullptr, t));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "../mocks/mock_arduino.h"
+#include "../mocks/mock_wifi_client.h"
+#include "../mocks/lwip/dns.h"
+
+// Include production code
+#include "../../src/mqtt_transport.cpp"
+
+namespace {
+
+// Loopback listener standing in for the broker
+class Listener {
+public:
+    Listener() {
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        ::bind(fd_, (sockaddr*)&addr, sizeof(addr));
+        ::listen(fd_, 4);
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd_, (sockaddr*)&addr, &len);
+        port_ = ntohs(addr.sin_port);
+    }
+    ~Listener() {
+        if (peer_ >= 0) ::close(peer_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    uint16_t port() const { return port_; }
+    int accept() { return peer_ = ::accept(fd_, nullptr, nullptr); }
+    void send(const std::vector<uint8_t>& bytes) { ::send(peer_, bytes.data(), bytes.size(), MSG_NOSIGNAL); }
+
+    std::string receive() {
+        char buf[64];
+        ssize_t n = ::recv(peer_, buf, sizeof(buf), 0);
+        return n > 0 ? std::string(buf, n) : std::string();
+    }
+
+private:
+    int fd_ = -1;
+    int peer_ = -1;
+    uint16_t port_ = 0;
+};
+
+// Poll until the transport leaves @p step (loopback connects take microseconds)
+MqttTransport::Step pollWhile(MqttTransport& t, MqttTransport::Step step) {
+    for (int i = 0; i < 2000 && t.poll() == step; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return t.step();
+}
+
+const std::vector<uint8_t> CONNACK_OK = { 0x20, 0x02, 0x00, 0x00 };
+
+}  // namespace
+
+class MqttTransportTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        setMockMillis(1000);
+        mockDnsLookup() = MockDnsLookup();
+    }
+
+    // Open to the listener and get to Handshake with the broker side accepted
+    void handshake(MqttTransport& t, Listener& broker) {
+        t.open("127.0.0.1", broker.port());
+        ASSERT_EQ(MqttTransport::Step::Handshake, pollWhile(t, MqttTransport::Step::Connecting));
+        ASSERT_GE(broker.accept(), 0);
+    }
+};
+
+TEST_F(MqttTransportTest, ProvisionalConnackThenGatedUntilRealOne) {
+    Listener broker;
+    MqttTransport t;
+    handshake(t, broker);
+    EXPECT_TRUE(t.connected());
+
+    // What PubSubClient::connect() reads right after sending CONNECT
+    ASSERT_EQ(4, t.available());
+    uint8_t ack[4];
+    EXPECT_EQ(4, t.read(ack, sizeof(ack)));
+    EXPECT_EQ(0, memcmp(ack, CONNACK_OK.data(), 4));
+    EXPECT_EQ(0, t.available());
+
+    EXPECT_EQ(7u, t.write((const uint8_t*)"CONNECT", 7));
+    EXPECT_EQ("CONNECT", broker.receive());
+
+    // The real CONNACK and a retained message arrive together
+    std::vector<uint8_t> reply = CONNACK_OK;
+    reply.insert(reply.end(), { 0x31, 0x03, 0x00, 0x01, 'x' });
+    broker.send(reply);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(0, t.available()) << "nothing reaches PubSubClient before the CONNACK is checked";
+
+    EXPECT_EQ(MqttTransport::Step::Open, t.poll());
+    EXPECT_EQ(5, t.available());
+    EXPECT_EQ(0x31, t.read());
+}
+
+TEST_F(MqttTransportTest, RefusedConnackFails) {
+    Listener broker;
+    MqttTransport t;
+    handshake(t, broker);
+    broker.send({ 0x20, 0x02, 0x00, 0x05 });
+    EXPECT_EQ(MqttTransport::Step::Failed, pollWhile(t, MqttTransport::Step::Handshake));
+    EXPECT_STREQ("broker refused connection (state 5)", t.error());
+    EXPECT_FALSE(t.connected());
+}
+
+TEST_F(MqttTransportTest, SilentBrokerTimesOut) {
+    Listener broker;
+    MqttTransport t;
+    handshake(t, broker);
+    EXPECT_EQ(MqttTransport::Step::Handshake, t.poll());
+    setMockMillis(1000 + MqttTransport::CONNACK_TIMEOUT_MS);
+    EXPECT_EQ(MqttTransport::Step::Failed, t.poll());
+    EXPECT_STREQ("CONNACK timeout", t.error());
+}
+
+TEST_F(MqttTransportTest, ClosedPortFailsWithoutBlocking) {
+    uint16_t port;
+    {
+        Listener gone;
+        port = gone.port();
+    }
+    MqttTransport t;
+    t.open("127.0.0.1", port);
+    EXPECT_EQ(MqttTransport::Step::Failed, pollWhile(t, MqttTransport::Step::Connecting));
+    EXPECT_NE(nullptr, strstr(t.error(), "TCP connect failed"));
+}
+
+TEST_F(MqttTransportTest, HostNameIsResolvedAsynchronously) {
+    Listener broker;
+    MqttTransport t;
+    t.open("broker.local", broker.port());
+    EXPECT_EQ(MqttTransport::Step::Resolving, t.step());
+    EXPECT_EQ("broker.local", mockDnsLookup().name);
+    EXPECT_EQ(MqttTransport::Step::Resolving, t.poll());
+
+    mockDnsAnswer(htonl(INADDR_LOOPBACK));
+    EXPECT_EQ(MqttTransport::Step::Connecting, t.poll());
+    EXPECT_EQ(MqttTransport::Step::Handshake, pollWhile(t, MqttTransport::Step::Connecting));
+}
+
+TEST_F(MqttTransportTest, DnsFailureAndTimeout) {
+    MqttTransport t;
+    t.open("nowhere.local", 1883);
+    mockDnsAnswer(0);
+    EXPECT_EQ(MqttTransport::Step::Failed, t.poll());
+    EXPECT_STREQ("DNS lookup failed", t.error());
+
+    t.open("slow.local", 1883);
+    setMockMillis(1000 + MqttTransport::RESOLVE_TIMEOUT_MS);
+    EXPECT_EQ(MqttTransport::Step::Failed, t.poll());
+    EXPECT_STREQ("DNS timeout", t.error());
+}
+
+TEST_F(MqttTransportTest, LateAnswerForAbandonedLookupIsIgnored) {
+    MqttTransport t;
+    t.open("old.local", 1883);
+    MockDnsLookup stale = mockDnsLookup();
+    t.stop();
+
+    t.open("new.local", 1883);
+    ip_addr_t addr;
+    addr.u_addr.ip4.addr = htonl(INADDR_LOOPBACK);
+    stale.callback(stale.name.c_str(), &addr, stale.arg);
+    EXPECT_EQ(MqttTransport::Step::Resolving, t.poll());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -283,6 +283,18 @@ TEST_F(NightModeTest, TimeStringParsing_Invalid) {
     ASSERT_FALSE(NightMode::parseTimeString(":30", minutes));    // Missing hour
 }
 
+TEST_F(NightModeTest, TimeStringParsing_FromUnterminatedBuffer) {
+    uint16_t minutes = 0;
+    const char payload[] = " 22:30 7";  // Only the first 6 bytes are the payload
+    
+    ASSERT_TRUE(NightMode::parseTimeString(payload, 6, minutes));
+    ASSERT_EQ(22 * 60 + 30, minutes);
+    ASSERT_TRUE(NightMode::parseTimeString(payload, 8, minutes));
+    ASSERT_EQ(22 * 60 + 30, minutes) << "minute field stops at the blank, like toInt()";
+    ASSERT_FALSE(NightMode::parseTimeString(payload, 4, minutes));
+    ASSERT_FALSE(NightMode::parseTimeString("12:30", 3, minutes));
+}
+
 TEST_F(NightModeTest, FormatMinutes) {
     ASSERT_STREQ("12:30", nightMode.formatMinutes(12 * 60 + 30).c_str());
     ASSERT_STREQ("00:00", nightMode.formatMinutes(0).c_str());
@@ -362,6 +374,28 @@ TEST_F(NightModeTest, ZeroLengthSchedule) {
     ASSERT_FALSE(nightMode.isActive()) << "Zero-length schedule should never be active";
 }
 
+TEST_F(NightModeTest, SettersFlagOnlyTheirMqttFields) {
+    stateTakeDirty();
+    nightMode.setDimPercent(35);
+    ASSERT_EQ((uint32_t)DIRTY_NIGHT_DIM, stateTakeDirty());
+
+    nightMode.setDimPercent(35);
+    ASSERT_EQ(0u, stateTakeDirty()) << "Unchanged value should not be republished";
+
+    nightMode.setSchedule(21 * 60, 7 * 60);
+    ASSERT_EQ((uint32_t)DIRTY_NIGHT_SCHEDULE, stateTakeDirty());
+
+    nightMode.setEnabled(true);
+    struct tm time = createTestTime(23, 0);
+    nightMode.updateFromTime(time);
+    ASSERT_EQ((uint32_t)(DIRTY_NIGHT_ENABLED | DIRTY_NIGHT_ACTIVE), stateTakeDirty());
+
+    // Minute ticks inside the window change nothing
+    time = createTestTime(23, 1);
+    nightMode.updateFromTime(time);
+    ASSERT_EQ(0u, stateTakeDirty());
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
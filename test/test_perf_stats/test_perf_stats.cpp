@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "../mocks/mock_arduino.h"
+#include "../mocks/mock_preferences.h"
+
+// Include production code (header-only)
+#include "../../src/perf_stats.h"
+#include "../../src/counted_preferences.h"
+
+class PerfStatsTest : public ::testing::Test {
+protected:
+    PerfStats perf;
+};
+
+TEST_F(PerfStatsTest, LoopTimeIsTheGapBetweenTicks) {
+    perf.loopTick(1000);  // First tick only sets the reference
+    EXPECT_EQ(0u, perf.loop().count);
+    perf.loopTick(1400);
+    perf.loopTick(1600);
+    perf.loopTick(2600);
+    EXPECT_EQ(3u, perf.loop().count);
+    EXPECT_EQ(1000u, perf.loop().maxUs);
+    EXPECT_EQ(533u, perf.loop().avgUs());
+}
+
+TEST_F(PerfStatsTest, LoopTimeSurvivesMicrosWraparound) {
+    perf.loopTick(0xFFFFFF00u);
+    perf.loopTick(0x100u);
+    EXPECT_EQ(0x200u, perf.loop().maxUs);
+}
+
+TEST_F(PerfStatsTest, FramesGiveRateAndShowTime) {
+    perf.startWindow(10000);
+    for (int i = 0; i < 40; ++i) perf.frame(i % 2 ? 900 : 700);
+    EXPECT_EQ(800u, perf.show().avgUs());
+    EXPECT_EQ(900u, perf.show().maxUs);
+    EXPECT_EQ(200u, perf.fpsTenths(12000));  // 40 frames in 2 s
+    EXPECT_EQ(133u, perf.fpsTenths(13000));
+    EXPECT_EQ(0u, perf.fpsTenths(10000));
+}
+
+TEST_F(PerfStatsTest, EmptyWindowReportsZero) {
+    EXPECT_EQ(0u, perf.loop().avgUs());
+    EXPECT_EQ(0u, perf.show().avgUs());
+    EXPECT_EQ(0u, perf.logWrites().avgUs());
+    EXPECT_EQ(0u, perf.fpsTenths(5000));
+}
+
+TEST_F(PerfStatsTest, NewWindowClearsTimersButKeepsNvsTotal) {
+    perf.loopTick(0);
+    perf.loopTick(500);
+    perf.frame(300);
+    perf.logWrite(120);
+    perf.addNvsWrites(5);
+    perf.startWindow(1000);
+    EXPECT_EQ(0u, perf.loop().count);
+    EXPECT_EQ(0u, perf.show().count);
+    EXPECT_EQ(0u, perf.logWrites().maxUs);
+    EXPECT_EQ(5u, perf.nvsWrites());
+
+    // The loop reference survives, so the next tick is a whole iteration
+    perf.loopTick(800);
+    EXPECT_EQ(300u, perf.loop().maxUs);
+    perf.addNvsWrites(2);
+    EXPECT_EQ(7u, perf.nvsWrites());
+}
+
+TEST_F(PerfStatsTest, FragmentationPercent) {
+    EXPECT_EQ(0, PerfStats::fragmentationPercent(200000, 200000));
+    EXPECT_EQ(25, PerfStats::fragmentationPercent(200000, 150000));
+    EXPECT_EQ(99, PerfStats::fragmentationPercent(100000, 1000));
+    EXPECT_EQ(0, PerfStats::fragmentationPercent(0, 0));
+    // Large heaps (PSRAM) do not overflow
+    EXPECT_EQ(50, PerfStats::fragmentationPercent(4000000000u, 2000000000u));
+}
+
+TEST_F(PerfStatsTest, SharedInstance) {
+    perfStats().addNvsWrites(3);
+    EXPECT_EQ(&perfStats(), &perfStats());
+    EXPECT_GE(perfStats().nvsWrites(), 3u);
+}
+
+TEST_F(PerfStatsTest, CountedPreferencesCountEveryPut) {
+    Preferences::reset();
+    uint32_t before = perfStats().nvsWrites();
+    CountedPreferences prefs;
+    prefs.begin("test", false);
+    prefs.putUChar("a", 1);
+    prefs.putUShort("b", 2);
+    prefs.putUInt("c", 3);
+    prefs.putULong("d", 4);
+    prefs.putBool("e", true);
+    prefs.putString("f", "");  // Empty, but still a write
+    prefs.end();
+    EXPECT_EQ(before + 6, perfStats().nvsWrites());
+
+    // Reads are not counted, and values land in the store as usual
+    prefs.begin("test", true);
+    EXPECT_EQ(3u, prefs.getUInt("c", 0));
+    prefs.end();
+    EXPECT_EQ(before + 6, perfStats().nvsWrites());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
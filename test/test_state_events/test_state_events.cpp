@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+// Include production code (tracker is header-only)
+#include "../../src/state_events.h"
+
+namespace {
+
+std::vector<uint8_t> callsA;
+std::vector<uint8_t> callsB;
+
+void listenerA(uint8_t groups) { callsA.push_back(groups); }
+void listenerB(uint8_t groups) { callsB.push_back(groups); }
+
+}  // namespace
+
+class StateChangeTrackerTest : public ::testing::Test {
+protected:
+    StateChangeTracker tracker;
+
+    void SetUp() override {
+        callsA.clear();
+        callsB.clear();
+    }
+
+    void update(uint32_t light, uint32_t display, uint32_t night, uint32_t frame) {
+        uint32_t fp[STATE_GROUP_COUNT] = { light, display, night, frame };
+        tracker.update(fp);
+    }
+};
+
+TEST_F(StateChangeTrackerTest, FirstUpdateIsBaselineOnly) {
+    tracker.subscribe(listenerA);
+    update(1, 2, 3, 4);
+    EXPECT_EQ(0, tracker.dispatch());
+    EXPECT_TRUE(callsA.empty());
+}
+
+TEST_F(StateChangeTrackerTest, ReportsOnlyChangedGroups) {
+    tracker.subscribe(listenerA);
+    update(1, 2, 3, 4);
+    update(1, 9, 3, 5);
+    EXPECT_EQ(STATE_DISPLAY | STATE_FRAME, tracker.dispatch());
+    ASSERT_EQ(1u, callsA.size());
+    EXPECT_EQ(STATE_DISPLAY | STATE_FRAME, callsA[0]);
+    // Unchanged afterwards
+    update(1, 9, 3, 5);
+    EXPECT_EQ(0, tracker.dispatch());
+}
+
+TEST_F(StateChangeTrackerTest, ChangesAccumulateUntilDispatch) {
+    tracker.subscribe(listenerA);
+    update(1, 2, 3, 4);
+    update(7, 2, 3, 4);
+    update(7, 2, 8, 4);
+    tracker.dispatch();
+    ASSERT_EQ(1u, callsA.size());
+    EXPECT_EQ(STATE_LIGHT | STATE_NIGHT, callsA[0]);
+}
+
+TEST_F(StateChangeTrackerTest, EveryListenerGetsTheSameCall) {
+    EXPECT_TRUE(tracker.subscribe(listenerA));
+    EXPECT_TRUE(tracker.subscribe(listenerB));
+    EXPECT_TRUE(tracker.subscribe(listenerA));  // already registered
+    tracker.markChanged(STATE_LIGHT);
+    tracker.dispatch();
+    EXPECT_EQ(std::vector<uint8_t>{ STATE_LIGHT }, callsA);
+    EXPECT_EQ(std::vector<uint8_t>{ STATE_LIGHT }, callsB);
+}
+
+TEST_F(StateChangeTrackerTest, MarkChangedWorksBeforeBaseline) {
+    tracker.subscribe(listenerA);
+    tracker.markChanged(STATE_ALL);
+    EXPECT_EQ(STATE_ALL, tracker.pending());
+    EXPECT_EQ(STATE_ALL, tracker.dispatch());
+    EXPECT_EQ(0, tracker.pending());
+}
+
+TEST_F(StateChangeTrackerTest, ListenerTableIsBounded) {
+    void (*listeners[])(uint8_t) = {
+        [](uint8_t) {}, [](uint8_t) {}, [](uint8_t) {}, [](uint8_t) {}, [](uint8_t) {} };
+    for (uint8_t i = 0; i < StateChangeTracker::MAX_LISTENERS; ++i) {
+        EXPECT_TRUE(tracker.subscribe(listeners[i]));
+    }
+    EXPECT_FALSE(tracker.subscribe(listeners[StateChangeTracker::MAX_LISTENERS]));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
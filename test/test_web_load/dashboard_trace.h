@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Synthetic dashboard session, written by hand after the requests dashboard.html
+// makes (not a recording): page load, the deferred loaders, a few minutes of
+// polling, the usual slider/toggle interactions and a reload, on which the
+// browser revalidates the page it has cached.
+
+enum class TraceBody : uint8_t {
+    Page,     // Embedded asset, sent in one piece with send_P()
+    Json,     // JsonDocument streamed through sendJson()
+    Stream,   // Text streamed through ChunkedResponse (log tail)
+    Text,     // Short text built in a String
+};
+
+struct TraceRequest {
+    uint32_t atMs;
+    uint8_t method;        // HTTP_GET / HTTP_POST
+    const char* target;    // Path and query string
+    const char* payload;   // POST body, or nullptr
+    int status;
+    const char* type;
+    TraceBody body;
+    bool conditional = false;  // Sent with If-None-Match: the ETag of the previous response for this path
+};
+
+#define TRACE_GET  1
+#define TRACE_POST 3
+
+static const TraceRequest DASHBOARD_TRACE[] = {
+    // Page load
+    {      0, TRACE_GET,  "/",                             nullptr, 200, "text/html",        TraceBody::Page    },
+    {    212, TRACE_GET,  "/api/state",                    nullptr, 200, "application/json", TraceBody::Json    },
+    {    415, TRACE_GET,  "/listGridVariants",             nullptr, 200, "application/json", TraceBody::Json    },
+    {    608, TRACE_GET,  "/api/logs/summary",             nullptr, 200, "application/json", TraceBody::Json    },
+    {    655, TRACE_GET,  "/api/logs/tail?since=0",        nullptr, 200, "text/plain",       TraceBody::Stream  },
+    {    903, TRACE_GET,  "/favicon.ico",                  nullptr, 204, "",                 TraceBody::Text    },
+    // Brightness slider (debounced)
+    {   8120, TRACE_GET,  "/setBrightness?level=96",       nullptr, 200, "text/plain",       TraceBody::Text    },
+    {   8410, TRACE_GET,  "/setBrightness?level=128",      nullptr, 200, "text/plain",       TraceBody::Text    },
+    {   8735, TRACE_GET,  "/setBrightness?level=160",      nullptr, 200, "text/plain",       TraceBody::Text    },
+    // Colour picker
+    {  12002, TRACE_GET,  "/setColor?color=ff8800",        nullptr, 200, "text/plain",       TraceBody::Text    },
+    {  13550, TRACE_GET,  "/setColor?color=FFD0A0",        nullptr, 200, "text/plain",       TraceBody::Text    },
+    // Log poll
+    {  30655, TRACE_GET,  "/api/logs/tail?since=183",      nullptr, 200, "text/plain",       TraceBody::Stream  },
+    // Settings tab
+    {  41210, TRACE_GET,  "/setAnimate?state=on",          nullptr, 200, "text/plain",       TraceBody::Text    },
+    {  44022, TRACE_GET,  "/setHetIsDuration?seconds=30",  nullptr, 200, "text/plain",       TraceBody::Text    },
+    {  47300, TRACE_POST, "/setNightModeConfig",
+      "{\"enabled\":true,\"effect\":\"dim\",\"dim_percent\":20,\"start\":\"22:00\",\"end\":\"06:30\"}",
+                                                                200, "application/json", TraceBody::Json    },
+    {  52111, TRACE_GET,  "/toggle?state=off",             nullptr, 200, "text/plain",       TraceBody::Text    },
+    {  55987, TRACE_GET,  "/toggle?state=on",              nullptr, 200, "text/plain",       TraceBody::Text    },
+    {  60655, TRACE_GET,  "/api/logs/tail?since=191",      nullptr, 200, "text/plain",       TraceBody::Stream  },
+    // Reload: the cached page is still current
+    {  72030, TRACE_GET,  "/",                             nullptr, 304, "",                 TraceBody::Page, true },
+    {  72240, TRACE_GET,  "/api/state",                    nullptr, 200, "application/json", TraceBody::Json    },
+    {  72410, TRACE_GET,  "/listGridVariants",             nullptr, 200, "application/json", TraceBody::Json    },
+    {  72600, TRACE_GET,  "/api/logs/summary",             nullptr, 200, "application/json", TraceBody::Json    },
+    {  72650, TRACE_GET,  "/api/logs/tail?since=0",        nullptr, 200, "text/plain",       TraceBody::Stream  },
+    { 102650, TRACE_GET,  "/api/logs/tail?since=204",      nullptr, 200, "text/plain",       TraceBody::Stream  },
+    { 132650, TRACE_GET,  "/api/logs/tail?since=206",      nullptr, 200, "text/plain",       TraceBody::Stream  },
+};
+
+static const size_t DASHBOARD_TRACE_LEN = sizeof(DASHBOARD_TRACE) / sizeof(DASHBOARD_TRACE[0]);
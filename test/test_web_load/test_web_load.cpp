@@ -0,0 +1,297 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#define MOCK_HEAP_IMPLEMENTATION
+#include "../mocks/mock_heap.h"
+#include "../mocks/mock_arduino.h"
+#include "../mocks/mock_preferences.h"
+#include "../mocks/SPIFFS.h"
+#include "../mocks/mock_web_server.h"
+
+// Include production code: the real log (ring buffer and file sink), not its unit-test stub
+#undef PIO_UNIT_TESTING
+#include "../../src/log_format.cpp"
+#include "../../src/log_codec.cpp"
+#include "../../src/log.cpp"
+#define PIO_UNIT_TESTING 1
+
+#include "../helpers/ui_bundle_fixture.h"
+#include "../../src/ui_assets.cpp"
+#include "../../src/grid_variants/nl_v1.cpp"
+#include "../../src/grid_variants/nl_v2.cpp"
+#include "../../src/grid_variants/nl_v3.cpp"
+#include "../../src/grid_variants/nl_v4.cpp"
+#include "../../src/grid_variants/nl_50x50_v1.cpp"
+#include "../../src/grid_variants/nl_50x50_v2.cpp"
+#include "../../src/grid_variants/nl_50x50_v3.cpp"
+#include "../../src/grid_layout.cpp"
+#include "../../src/time_mapper.cpp"
+#include "../../src/led_state.cpp"
+#include "../../src/led_controller.cpp"
+#include "../../src/night_mode.cpp"
+#include "../../src/setup_state.cpp"
+#include "../../src/event_stream.cpp"
+#include "../../src/web_pages.cpp"
+#include "../../src/web_dashboard.cpp"
+#include "../../src/web_router.h"
+
+#include "dashboard_trace.h"
+
+// Replays a dashboard session through the real page and dashboard handlers
+// (web_pages.cpp, web_dashboard.cpp) bound to their own WebContext, behind the
+// production router, HttpPerf and ChunkedResponse, and reports per route
+// latency, heap high-water mark and response size. The page comes from a
+// fixture bundle; the log tail serves records logged during setup.
+
+InstrumentedWebServer server(80);
+DisplaySettings displaySettings;
+bool clockEnabled = true;
+
+namespace {
+
+// Budgets for one request on the host. Pages go out from flash with send_P,
+// short answers are a String or two and the log tail streams the ring buffer
+// through one chunk, so a body that starts buffering on the heap shows up as a
+// peak of its size. JSON routes also hold their document while it streams.
+const size_t PAGE_HEAP_BUDGET = 512;
+const size_t TEXT_HEAP_BUDGET = 512;
+const size_t STREAM_HEAP_BUDGET = 512;
+const size_t JSON_HEAP_BUDGET = 12288;
+const unsigned long LATENCY_BUDGET_US = 20000;
+const int REPLAY_ROUNDS = 25;
+const int SEEDED_LOG_LINES = 220;
+
+void fillSystemInfo(JsonObject sys) {
+    sys["git_branch"] = "native";
+    sys["heap_free"] = 0;
+    sys["rssi"] = 0;
+}
+
+WebContext context = { server, ledState, displaySettings, nightMode, setupState, clockEnabled, fillSystemInfo };
+
+// The dashboard's routes from the production table
+constexpr WebRoute ROUTES[] = {
+    { "/",                   HTTP_GET,  WebAuth::None, handleRoot,               nullptr },
+    { "/api/logs/summary",   HTTP_GET,  WebAuth::Ui,   handleApiLogsSummary,     nullptr },
+    { "/api/logs/tail",      HTTP_GET,  WebAuth::Ui,   handleApiLogsTail,        nullptr },
+    { "/api/state",          HTTP_GET,  WebAuth::Ui,   handleApiState,           nullptr },
+    { "/favicon.ico",        HTTP_GET,  WebAuth::None, handleFaviconIco,         nullptr },
+    { "/listGridVariants",   HTTP_ANY,  WebAuth::Ui,   handleListGridVariants,   nullptr },
+    { "/setAnimate",         HTTP_ANY,  WebAuth::Ui,   handleSetAnimate,         nullptr },
+    { "/setBrightness",      HTTP_ANY,  WebAuth::Ui,   handleSetBrightness,      nullptr },
+    { "/setColor",           HTTP_GET,  WebAuth::Ui,   handleSetColor,           nullptr },
+    { "/setHetIsDuration",   HTTP_ANY,  WebAuth::Ui,   handleSetHetIsDuration,   nullptr },
+    { "/setNightModeConfig", HTTP_POST, WebAuth::Ui,   handleSetNightModeConfig, nullptr },
+    { "/toggle",             HTTP_ANY,  WebAuth::Ui,   handleToggle,             nullptr },
+};
+static_assert(webRoutesSorted(ROUTES, sizeof(ROUTES) / sizeof(ROUTES[0])), "ROUTES must be sorted by path");
+
+bool authorize(const WebRoute&) { return true; }
+
+WebRouter router(ROUTES, sizeof(ROUTES) / sizeof(ROUTES[0]), authorize);
+
+struct RouteReport {
+    uint32_t calls = 0;
+    unsigned long maxUs = 0;
+    uint64_t totalUs = 0;
+    size_t heapPeak = 0;
+    size_t maxBytes = 0;
+    uint64_t bytes = 0;
+};
+
+std::string pathOf(const char* target) {
+    std::string t(target);
+    return t.substr(0, t.find('?'));
+}
+
+size_t heapBudget(TraceBody body) {
+    switch (body) {
+        case TraceBody::Page:   return PAGE_HEAP_BUDGET;
+        case TraceBody::Stream: return STREAM_HEAP_BUDGET;
+        case TraceBody::Json:   return JSON_HEAP_BUDGET;
+        default:                return TEXT_HEAP_BUDGET;
+    }
+}
+
+}  // namespace
+
+class WebLoadTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        ASSERT_TRUE(uiBundleFixtureBuild());
+        router.attach(server);
+        webBind(context);
+        webPagesBegin();
+    }
+
+    void SetUp() override {
+        Preferences::reset();
+        SPIFFS.reset();
+        setMockMillis(0);
+        setLogLevel(LOG_LEVEL_INFO);
+        setLogDeleteOnBoot(false);
+        logEnableFileSink();
+        for (int i = 0; i < SEEDED_LOG_LINES; ++i) {
+            logInfo(String("[seed] record ") + i + " of the session log");
+        }
+        logFlushFile();
+        setupState.markComplete();
+        clockEnabled = true;
+        server.setRequestHeader("Accept-Encoding", "gzip, deflate, br");
+        server.perf().reset();
+        reports.clear();
+        etags.clear();
+        MockHeap::reset();
+    }
+
+    void TearDown() override {
+        MockHeap::enable(false);
+        server.clearRequestHeaders();
+        logCloseFile();
+    }
+
+    // One pass over the trace; checks status and content type of every response
+    void replay() {
+        for (size_t i = 0; i < DASHBOARD_TRACE_LEN; ++i) {
+            const TraceRequest& t = DASHBOARD_TRACE[i];
+            const std::string path = pathOf(t.target);
+            if (t.conditional) {
+                ASSERT_TRUE(etags.count(path)) << t.target << " revalidated before it was served";
+                server.setRequestHeader("If-None-Match", etags[path].c_str());
+            }
+            setMockMillis(t.atMs);
+            MockHeap::resetPeak();
+            size_t heapBefore = MockHeap::inUse();
+            MockHeap::enable(true);
+            unsigned long start = micros();
+            const MockHttpResponse& r = server.request(static_cast<HTTPMethod>(t.method), t.target, t.payload);
+            unsigned long elapsed = micros() - start;
+            MockHeap::enable(false);
+            if (t.conditional) {
+                server.clearRequestHeaders();
+                server.setRequestHeader("Accept-Encoding", "gzip, deflate, br");
+            }
+
+            ASSERT_EQ(t.status, r.code) << t.target << ": " << r.body;
+            ASSERT_EQ(std::string(t.type), r.contentType) << t.target;
+            if (r.code == 304) {
+                EXPECT_TRUE(r.body.empty()) << t.target;
+            }
+            if (r.header("ETag")) etags[path] = r.header("ETag");
+
+            RouteReport& rep = reports[path];
+            rep.calls++;
+            rep.totalUs += elapsed;
+            rep.maxUs = std::max(rep.maxUs, elapsed);
+            rep.heapPeak = std::max(rep.heapPeak, MockHeap::peak() - std::min(MockHeap::peak(), heapBefore));
+            rep.maxBytes = std::max<size_t>(rep.maxBytes, r.body.size());
+            rep.bytes += r.body.size();
+        }
+    }
+
+    void printReport() const {
+        printf("\n%-22s %6s %9s %9s %10s %10s\n", "route", "calls", "avg us", "max us", "heap peak", "max bytes");
+        for (const auto& kv : reports) {
+            const RouteReport& r = kv.second;
+            printf("%-22s %6u %9llu %9lu %10zu %10zu\n", kv.first.c_str(), r.calls,
+                   (unsigned long long)(r.totalUs / r.calls), r.maxUs, r.heapPeak, r.maxBytes);
+        }
+    }
+
+    std::map<std::string, RouteReport> reports;
+    std::map<std::string, std::string> etags;
+};
+
+TEST_F(WebLoadTest, Replay_AnswersEveryRequest) {
+    replay();
+    EXPECT_EQ(DASHBOARD_TRACE_LEN, [this] {
+        size_t n = 0;
+        for (const auto& kv : reports) n += kv.second.calls;
+        return n;
+    }());
+}
+
+TEST_F(WebLoadTest, Replay_HandlersApplyTheSession) {
+    replay();
+    EXPECT_TRUE(clockEnabled);
+    EXPECT_EQ(160, ledState.getBrightness());
+    uint8_t r, g, b, w;
+    ledState.getRGBW(r, g, b, w);
+    EXPECT_EQ(0xFF, r);
+    EXPECT_EQ(0xD0, g);
+    EXPECT_EQ(0xA0, b);
+    EXPECT_TRUE(displaySettings.getAnimateWords());
+    EXPECT_EQ(30, displaySettings.getHetIsDurationSec());
+    EXPECT_TRUE(nightMode.isEnabled());
+    EXPECT_EQ(22 * 60, nightMode.getStartMinutes());
+    EXPECT_EQ(6 * 60 + 30, nightMode.getEndMinutes());
+
+    const MockHttpResponse& state = server.request(HTTP_GET, "/api/state");
+    EXPECT_NE(std::string::npos, state.body.find("\"color\":\"FFD0A0\"")) << state.body;
+    EXPECT_NE(std::string::npos, state.body.find("\"brightness\":160")) << state.body;
+}
+
+TEST_F(WebLoadTest, Replay_PageComesFromTheBundle) {
+    const UiAsset* page = uiAssetFind("/dashboard.html");
+    ASSERT_NE(nullptr, page);
+    const MockHttpResponse& r = server.request(HTTP_GET, "/");
+    ASSERT_EQ(200, r.code);
+    ASSERT_NE(nullptr, r.header("Content-Encoding"));
+    EXPECT_STREQ("gzip", r.header("Content-Encoding"));
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(page->gz), page->gzSize), r.body);
+}
+
+TEST_F(WebLoadTest, Replay_LogTailServesTheSeededRecords) {
+    const MockHttpResponse& r = server.request(HTTP_GET, "/api/logs/tail?since=0");
+    ASSERT_EQ(200, r.code);
+    EXPECT_TRUE(r.chunked());
+    ASSERT_NE(nullptr, r.header("X-Log-Seq"));
+    EXPECT_EQ(String(logLatestSeq()).str(), r.header("X-Log-Seq"));
+    // The ring buffer holds the newest LOG_BUFFER_SIZE records
+    EXPECT_EQ(LOG_BUFFER_SIZE, std::count(r.body.begin(), r.body.end(), '\n'));
+    EXPECT_NE(std::string::npos, r.body.find("[seed] record 219 "));
+
+    const MockHttpResponse& none = server.request(HTTP_GET, (std::string("/api/logs/tail?since=") + r.header("X-Log-Seq")).c_str());
+    EXPECT_EQ(200, none.code);
+    EXPECT_TRUE(none.body.empty()) << none.body;
+}
+
+TEST_F(WebLoadTest, Replay_HeapStaysWithinBudget) {
+    replay();
+    for (size_t i = 0; i < DASHBOARD_TRACE_LEN; ++i) {
+        const TraceRequest& t = DASHBOARD_TRACE[i];
+        const RouteReport& r = reports[pathOf(t.target)];
+        EXPECT_LE(r.heapPeak, heapBudget(t.body)) << t.target;
+    }
+}
+
+TEST_F(WebLoadTest, Replay_PerfCountersAgreeWithResponses) {
+    replay();
+    const HttpPerf& perf = server.perf();
+    for (const auto& kv : reports) {
+        bool found = false;
+        for (int i = 0; i < perf.count(); ++i) {
+            if (kv.first != perf.at(i).path || perf.at(i).calls == 0) continue;
+            found = true;
+            EXPECT_EQ(kv.second.calls, perf.at(i).calls) << kv.first;
+            EXPECT_EQ(kv.second.bytes, perf.at(i).bytes) << kv.first;
+        }
+        EXPECT_TRUE(found) << kv.first;
+    }
+}
+
+TEST_F(WebLoadTest, Replay_LatencyReport) {
+    for (int round = 0; round < REPLAY_ROUNDS; ++round) replay();
+    printReport();
+    for (const auto& kv : reports) {
+        EXPECT_LT(kv.second.maxUs, LATENCY_BUDGET_US) << kv.first;
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "../mocks/mock_arduino.h"
+#include "../mocks/mock_preferences.h"
+#include "../mocks/SPIFFS.h"
+#include "../mocks/mock_web_server.h"
+
+// Include production code
+#include "../../src/log.cpp"
+#include "../../src/log_codec.cpp"
+#include "../helpers/ui_bundle_fixture.h"
+#include "../../src/ui_assets.cpp"
+#include "../../src/setup_state.cpp"
+#include "../../src/web_pages.cpp"
+
+// Page handlers against a firmware bundle and SPIFFS: a firmware-only flash
+// (bundle, empty SPIFFS) must serve every page, and 404 is left for pages that
+// neither has.
+
+InstrumentedWebServer server(80);
+
+namespace {
+
+LedState led;
+DisplaySettings display;
+NightMode night;
+SetupState setup;
+bool clockOn = true;
+
+WebContext context = { server, led, display, night, setup, clockOn, nullptr };
+
+std::string bundled(const char* path) {
+    const UiAsset* asset = uiAssetFind(path);
+    return asset ? std::string(reinterpret_cast<const char*>(asset->gz), asset->gzSize) : std::string();
+}
+
+}  // namespace
+
+class WebPagesTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        ASSERT_TRUE(uiBundleFixtureBuild(4096));
+        server.on("/", HTTP_GET, handleRoot);
+        server.on("/setup.html", HTTP_GET, handleSetupPage);
+        server.on("/admin.html", HTTP_GET, handleAdminPage);
+        webBind(context);
+    }
+
+    void SetUp() override {
+        Preferences::reset();
+        SPIFFS.reset();
+        webPagesBegin();
+        setup.reset();
+        server.clearRequestHeaders();
+        server.setRequestHeader("Accept-Encoding", "gzip, deflate");
+    }
+};
+
+TEST_F(WebPagesTest, RootServesTheBundledDashboardWithEmptySpiffs) {
+    setup.markComplete();
+    const MockHttpResponse& r = server.request(HTTP_GET, "/");
+    ASSERT_EQ(200, r.code) << r.body;
+    EXPECT_EQ("text/html", r.contentType);
+    ASSERT_NE(nullptr, r.header("Content-Encoding"));
+    EXPECT_STREQ("gzip", r.header("Content-Encoding"));
+    EXPECT_EQ(bundled("/dashboard.html"), r.body);
+}
+
+TEST_F(WebPagesTest, RootServesTheBundledSetupPageUntilSetupIsComplete) {
+    const MockHttpResponse& r = server.request(HTTP_GET, "/");
+    ASSERT_EQ(200, r.code) << r.body;
+    EXPECT_EQ(bundled("/setup.html"), r.body);
+}
+
+TEST_F(WebPagesTest, SetupPageServesTheBundleWithEmptySpiffs) {
+    const MockHttpResponse& r = server.request(HTTP_GET, "/setup.html");
+    ASSERT_EQ(200, r.code) << r.body;
+    EXPECT_EQ(bundled("/setup.html"), r.body);
+}
+
+TEST_F(WebPagesTest, PageInNeitherBundleNorSpiffsIs404) {
+    const MockHttpResponse& r = server.request(HTTP_GET, "/admin.html");
+    EXPECT_EQ(404, r.code);
+    EXPECT_EQ("/admin.html not found", r.body);
+}
+
+TEST_F(WebPagesTest, PageMissingFromTheBundleFallsBackToSpiffs) {
+    SPIFFS.put("/admin.html", "<html>admin</html>");
+    const MockHttpResponse& r = server.request(HTTP_GET, "/admin.html");
+    ASSERT_EQ(200, r.code);
+    EXPECT_EQ("<html>admin</html>", r.body);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+// Include production code (header-only)
+#include "../../src/web_route_table.h"
+
+namespace {
+
+// Values as in the ESP32 core: HTTP_ANY lies outside the parser's method range
+constexpr uint8_t GET = 1;
+constexpr uint8_t POST = 3;
+constexpr uint8_t ANY = 255;
+
+void handlerA() {}
+void handlerB() {}
+
+constexpr WebRoute ROUTES[] = {
+    { "/",                GET,  WebAuth::None,  handlerA, nullptr },
+    { "/api/mqtt/config", GET,  WebAuth::Ui,    handlerA, nullptr },
+    { "/api/mqtt/config", POST, WebAuth::Ui,    handlerB, nullptr },
+    { "/log",             ANY,  WebAuth::Ui,    handlerA, nullptr },
+    { "/log/download",    GET,  WebAuth::Ui,    handlerB, nullptr },
+    { "/logs.html",       GET,  WebAuth::Ui,    handlerA, nullptr },
+    { "/setLogLevel",     ANY,  WebAuth::Ui,    handlerA, nullptr },
+    { "/setLogLevel",     GET,  WebAuth::Ui,    handlerB, nullptr },
+    { "/uploadFirmware",  POST, WebAuth::Admin, handlerA, handlerB },
+};
+constexpr size_t COUNT = sizeof(ROUTES) / sizeof(ROUTES[0]);
+
+static_assert(webRoutesSorted(ROUTES, COUNT), "test table is sorted");
+
+constexpr WebRoute UNSORTED[] = {
+    { "/b", GET, WebAuth::None, handlerA, nullptr },
+    { "/a", GET, WebAuth::None, handlerA, nullptr },
+};
+static_assert(!webRoutesSorted(UNSORTED, 2), "out of order paths are detected");
+
+int find(const char* path, uint8_t method) {
+    return webRouteFind(ROUTES, COUNT, path, method, ANY);
+}
+
+}  // namespace
+
+TEST(WebRouteTableTest, PathCompare_MatchesStrcmpOrder) {
+    EXPECT_EQ(0, webPathCompare("/log", "/log"));
+    EXPECT_LT(webPathCompare("/log", "/log/download"), 0);
+    EXPECT_LT(webPathCompare("/log/download", "/logs.html"), 0);
+    EXPECT_GT(webPathCompare("/setup.html", "/setUIPassword"), 0);
+}
+
+TEST(WebRouteTableTest, Find_ExactPathAndMethod) {
+    EXPECT_EQ(0, find("/", GET));
+    EXPECT_EQ(1, find("/api/mqtt/config", GET));
+    EXPECT_EQ(2, find("/api/mqtt/config", POST));
+    EXPECT_EQ(8, find("/uploadFirmware", POST));
+}
+
+TEST(WebRouteTableTest, Find_PrefixesAreDistinctPaths) {
+    EXPECT_EQ(3, find("/log", GET));
+    EXPECT_EQ(4, find("/log/download", GET));
+    EXPECT_EQ(5, find("/logs.html", GET));
+    EXPECT_EQ(-1, find("/lo", GET));
+    EXPECT_EQ(-1, find("/log/", GET));
+}
+
+TEST(WebRouteTableTest, Find_AnyMethodEntry) {
+    EXPECT_EQ(3, find("/log", POST));
+    // An exact method entry wins over an "any" entry for the same path
+    EXPECT_EQ(7, find("/setLogLevel", GET));
+    EXPECT_EQ(6, find("/setLogLevel", POST));
+}
+
+TEST(WebRouteTableTest, Find_UnknownPathOrMethod) {
+    EXPECT_EQ(-1, find("/missing", GET));
+    EXPECT_EQ(-1, find("/zzz", GET));
+    EXPECT_EQ(-1, find("", GET));
+    EXPECT_EQ(-1, find("/api/mqtt/config", 4));
+    EXPECT_EQ(-1, find("/uploadFirmware", GET));
+    EXPECT_EQ(-1, webRouteFind(ROUTES, 0, "/", GET, ANY));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "../mocks/mock_arduino.h"
+#include "../mocks/mock_web_server.h"
+
+// Include production code
+#include "../../src/chunked_response.h"
+#include "../../src/instrumented_web_server.h"
+#include "../../src/web_router.h"
+
+InstrumentedWebServer server(80);
+
+namespace {
+
+int handlerCalls = 0;
+std::string uploaded;
+int uploadEvents = 0;
+
+void handleState() {
+    handlerCalls++;
+    ChunkedResponse response(server);
+    response.begin(200, "application/json");
+    response.print("{\"pad\":\"");
+    for (int i = 0; i < 2990; ++i) response.write('x');
+    response.print("\"}");
+    response.end();
+}
+
+void handleAdmin() {
+    handlerCalls++;
+    server.send(200, "text/html", "admin");
+}
+
+void handleSetBrightness() {
+    handlerCalls++;
+    if (!server.hasArg("level")) {
+        server.send(400, "text/plain", "Missing brightness level");
+        return;
+    }
+    server.send(200, "text/plain", server.arg("level"));
+}
+
+void handleUpload() {
+    handlerCalls++;
+    server.send(200, "text/plain", "Upload done");
+}
+
+void handleUploadChunk() {
+    HTTPUpload& upload = server.upload();
+    uploadEvents++;
+    if (upload.status == UPLOAD_FILE_WRITE) uploaded.append(reinterpret_cast<char*>(upload.buf), upload.currentSize);
+}
+
+constexpr WebRoute ROUTES[] = {
+    { "/admin.html",     HTTP_GET,  WebAuth::Admin, handleAdmin,         nullptr },
+    { "/api/state",      HTTP_GET,  WebAuth::Ui,    handleState,         nullptr },
+    { "/setBrightness",  HTTP_ANY,  WebAuth::Ui,    handleSetBrightness, nullptr },
+    { "/uploadFirmware", HTTP_POST, WebAuth::Ui,    handleUpload,        handleUploadChunk },
+};
+static_assert(webRoutesSorted(ROUTES, sizeof(ROUTES) / sizeof(ROUTES[0])), "ROUTES must be sorted by path");
+
+bool authorize(const WebRoute& route) {
+    if (route.auth != WebAuth::Admin) return true;
+    if (server.authenticate("admin", "secret")) return true;
+    server.requestAuthentication(BASIC_AUTH, "Wordclock");
+    return false;
+}
+
+WebRouter router(ROUTES, sizeof(ROUTES) / sizeof(ROUTES[0]), authorize);
+
+int slotOf(const char* path) {
+    for (int i = 0; i < server.perf().count(); ++i) {
+        if (strcmp(server.perf().at(i).path, path) == 0) return i;
+    }
+    return -1;
+}
+
+}  // namespace
+
+class WebRouterTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        router.attach(server);
+    }
+
+    void SetUp() override {
+        handlerCalls = 0;
+        uploadEvents = 0;
+        uploaded.clear();
+        server.setAuthorized(true);
+        server.perf().reset();
+    }
+};
+
+TEST_F(WebRouterTest, Dispatch_RunsHandlerWithDecodedArgs) {
+    const MockHttpResponse& r = server.request(HTTP_GET, "/setBrightness?level=1%32%38&x=a+b");
+    EXPECT_EQ(1, handlerCalls);
+    EXPECT_EQ(200, r.code);
+    EXPECT_EQ("text/plain", r.contentType);
+    EXPECT_EQ("128", r.body);
+}
+
+TEST_F(WebRouterTest, Dispatch_AnyMethodAndUnknownPaths) {
+    EXPECT_EQ(400, server.request(HTTP_POST, "/setBrightness").code);
+    EXPECT_EQ(404, server.request(HTTP_GET, "/nope").code);
+    // Registered path, but not for this method
+    EXPECT_EQ(404, server.request(HTTP_POST, "/api/state").code);
+    EXPECT_EQ(1, handlerCalls);
+}
+
+TEST_F(WebRouterTest, Auth_RefusedRequestNeverReachesHandler) {
+    server.setAuthorized(false);
+    const MockHttpResponse& r = server.request(HTTP_GET, "/admin.html");
+    EXPECT_EQ(401, r.code);
+    ASSERT_NE(nullptr, r.header("WWW-Authenticate"));
+    EXPECT_EQ(0, handlerCalls);
+
+    server.setAuthorized(true);
+    EXPECT_EQ("admin", server.request(HTTP_GET, "/admin.html").body);
+}
+
+TEST_F(WebRouterTest, ChunkedResponse_StreamsFixedChunks) {
+    const MockHttpResponse& r = server.request(HTTP_GET, "/api/state");
+    EXPECT_TRUE(r.chunked());
+    EXPECT_TRUE(r.finished);
+    EXPECT_EQ(3000u, r.body.size());
+    EXPECT_EQ(3u, r.chunks);  // 1024 + 1024 + 952
+}
+
+TEST_F(WebRouterTest, Perf_CountsCallsAndBytesPerRoute) {
+    server.request(HTTP_GET, "/api/state");
+    server.request(HTTP_GET, "/api/state");
+    server.request(HTTP_GET, "/setBrightness?level=7");
+    int state = slotOf("/api/state");
+    int brightness = slotOf("/setBrightness");
+    ASSERT_GE(state, 0);
+    ASSERT_GE(brightness, 0);
+    EXPECT_EQ(2u, server.perf().at(state).calls);
+    EXPECT_EQ(6000u, server.perf().at(state).bytes);
+    EXPECT_EQ(1u, server.perf().at(brightness).calls);
+    EXPECT_EQ(1u, server.perf().at(brightness).bytes);
+    EXPECT_GE(server.perf().at(state).totalUs, server.perf().at(state).maxUs);
+}
+
+TEST_F(WebRouterTest, Upload_ChunksArriveBeforeHandler) {
+    std::string image(5000, '\0');
+    for (size_t i = 0; i < image.size(); ++i) image[i] = static_cast<char>(i * 31);
+    const MockHttpResponse& r = server.uploadFile("/uploadFirmware", image, "firmware.bin", 1024);
+    EXPECT_EQ(200, r.code);
+    EXPECT_EQ(image, uploaded);
+    EXPECT_EQ(7, uploadEvents);  // start + 5 writes + end
+    EXPECT_EQ(1, handlerCalls);
+    // Upload chunks add time but are not extra calls
+    EXPECT_EQ(1u, server.perf().at(slotOf("/uploadFirmware")).calls);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,119 @@
+"""Compress the web UI in data/ into a byte table linked into the firmware.
+
+Writes include/ui_bundle.h with one gzip stream per asset plus the CRC32 and
+length of its uncompressed content (used as ETag). The streams are produced
+with fixed Huffman codes and a 2 KB window so the firmware's own inflater
+(src/log_codec.cpp) can decode them for the rare client without gzip.
+
+Runs as a PlatformIO extra script, or standalone:
+    python tools/embed_ui.py [data_dir] [output_header]
+"""
+
+import os
+import sys
+import zlib
+
+try:
+    Import("env")  # noqa: F821 (provided by PlatformIO)
+except NameError:
+    env = None
+
+
+MIME_TYPES = {
+    ".html": "text/html",
+    ".htm": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".txt": "text/plain",
+}
+
+# Must match LOG_CODEC_WINDOW in src/log_codec.h
+WINDOW_BITS = 11
+
+
+def gzip_fixed(data):
+    comp = zlib.compressobj(9, zlib.DEFLATED, 16 + WINDOW_BITS, 9, zlib.Z_FIXED)
+    return comp.compress(data) + comp.flush()
+
+
+def collect_assets(data_dir):
+    assets = []
+    for root, _, files in os.walk(data_dir):
+        for name in sorted(files):
+            ext = os.path.splitext(name)[1].lower()
+            if ext not in MIME_TYPES:
+                continue
+            path = os.path.join(root, name)
+            rel = "/" + os.path.relpath(path, data_dir).replace(os.sep, "/")
+            with open(path, "rb") as f:
+                raw = f.read()
+            assets.append((rel, MIME_TYPES[ext], raw))
+    assets.sort(key=lambda a: a[0])
+    return assets
+
+
+def render_header(assets):
+    lines = [
+        "#pragma once",
+        "// Generated by tools/embed_ui.py from data/ -- do not edit.",
+        "",
+        "#include \"ui_assets.h\"",
+        "",
+    ]
+    bundle_crc = 0
+    entries = []
+    for i, (path, mime, raw) in enumerate(assets):
+        gz = gzip_fixed(raw)
+        crc = zlib.crc32(raw) & 0xFFFFFFFF
+        bundle_crc = zlib.crc32(gz, bundle_crc) & 0xFFFFFFFF
+        lines.append(f"// {path}: {len(raw)} -> {len(gz)} bytes")
+        lines.append(f"static const uint8_t UI_ASSET_{i}[] = {{")
+        for off in range(0, len(gz), 16):
+            chunk = ", ".join(f"0x{b:02X}" for b in gz[off:off + 16])
+            lines.append(f"  {chunk},")
+        lines.append("};")
+        lines.append("")
+        entries.append(f"  {{ \"{path}\", \"{mime}\", UI_ASSET_{i}, sizeof(UI_ASSET_{i}), "
+                       f"0x{crc:08X}u, {len(raw)}u }},")
+    lines.append(f"#define UI_BUNDLE_HASH \"{bundle_crc:08x}\"")
+    lines.append("")
+    lines.append("// Sorted by path")
+    lines.append("static const UiAsset UI_BUNDLE[] = {")
+    lines.extend(entries)
+    lines.append("};")
+    lines.append("")
+    return "\n".join(lines)
+
+
+def write_if_changed(path, content):
+    if os.path.exists(path):
+        with open(path, "r", encoding="utf-8") as f:
+            if f.read() == content:
+                return False
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(content)
+    return True
+
+
+def embed(data_dir, out_path):
+    assets = collect_assets(data_dir)
+    changed = write_if_changed(out_path, render_header(assets))
+    raw_total = sum(len(a[2]) for a in assets)
+    state = "written" if changed else "unchanged"
+    print(f"[embed_ui] {len(assets)} asset(s), {raw_total} bytes -> {out_path} ({state})")
+
+
+if env is not None:
+    project_dir = env["PROJECT_DIR"]
+    data_dir = env.subst("$PROJECT_DATA_DIR")
+    if not data_dir or data_dir == "$PROJECT_DATA_DIR":
+        data_dir = os.path.join(project_dir, "data")
+    # Runs while the script is loaded, so the header exists before anything compiles
+    embed(data_dir, os.path.join(env.subst("$PROJECT_INCLUDE_DIR"), "ui_bundle.h"))
+elif __name__ == "__main__":
+    here = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    embed(sys.argv[1] if len(sys.argv) > 1 else os.path.join(here, "data"),
+          sys.argv[2] if len(sys.argv) > 2 else os.path.join(here, "include", "ui_bundle.h"))
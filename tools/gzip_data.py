@@ -1,14 +1,31 @@
 Import("env")
 
 import os
-import gzip
-import shutil
+import zlib
 
 
 TEXT_EXTS = {
     ".html", ".htm", ".css", ".js", ".json", ".svg", ".txt", ".map"
 }
 
+# The firmware inflates these for clients without gzip support, and its
+# decoder only takes fixed-Huffman blocks within a 2 KB window. Must match
+# LOG_CODEC_WINDOW in src/log_codec.h (and gzip_fixed() in embed_ui.py).
+WINDOW_BITS = 11
+
+
+def gzip_fixed(data):
+    comp = zlib.compressobj(9, zlib.DEFLATED, 16 + WINDOW_BITS, 9, zlib.Z_FIXED)
+    return comp.compress(data) + comp.flush()
+
+
+def is_fixed_gzip(path):
+    # zlib writes a bare 10-byte header; older builds left dynamic-Huffman
+    # files with a file name in it, which have to be redone
+    with open(path, 'rb') as f:
+        head = f.read(11)
+    return len(head) == 11 and head[3] == 0 and (head[10] >> 1) & 3 == 1
+
 
 def should_compress(path):
     if os.environ.get("WORDCLOCK_DISABLE_GZIP"):
@@ -22,13 +39,14 @@ def should_compress(path):
 def compress_if_needed(src):
     dst = src + ".gz"
     try:
-        if os.path.exists(dst) and os.path.getmtime(dst) >= os.path.getmtime(src):
+        if (os.path.exists(dst) and os.path.getmtime(dst) >= os.path.getmtime(src)
+                and is_fixed_gzip(dst)):
             return False
         os.makedirs(os.path.dirname(dst), exist_ok=True)
-        with open(src, 'rb') as fin, open(dst, 'wb') as raw_out:
-            with gzip.GzipFile(filename=os.path.basename(src), mode='wb',
-                               fileobj=raw_out, compresslevel=9, mtime=0) as fout:
-                shutil.copyfileobj(fin, fout)
+        with open(src, 'rb') as fin:
+            data = fin.read()
+        with open(dst, 'wb') as fout:
+            fout.write(gzip_fixed(data))
         print(f"[gzip_data] Compressed: {src} -> {dst}")
         return True
     except Exception as e: